@@ -63,25 +63,25 @@ Sim1Machine::Sim1Machine (xf::Xefis& xefis):
 
 	_rigid_body_solver.set_baumgarte_factor (0.8);
 
-	_simulation.emplace (300_Hz, _logger, [&] (si::Time const dt) {
+	_simulation.emplace (300_Hz, _logger, [&, aircraft_copy = aircraft, tt = 0_s] (si::Time const dt) mutable {
+		auto const angle = 60_deg * std::sin (tt / 1_s);
+		aircraft_copy.aileron_l_servo->set_setpoint (+angle);
+		aircraft_copy.aileron_r_servo->set_setpoint (-angle);
+		tt += dt;
+
 		_rigid_body_solver.evolve (dt);
 		_electrical_network_solver.evolve (dt);
 	});
 
+	// Run physics in its own thread, independently of the viewer's refresh rate:
+	_simulation_thread.emplace (*_simulation, 300_Hz, 100_ms, [&] (si::Time const simulation_time) {
+		_rigid_body_snapshots.publish (_rigid_body_system, simulation_time);
+	});
+
 	QWidget w (nullptr);
 	auto const lh = neutrino::default_line_height (&w);
-	auto tt = 0_s;
 
-	_rigid_body_viewer.emplace (_rigid_body_system, QSize (50 * lh, 50 * lh), xf::RigidBodyViewer::AutoFPS, [&, aircraft_copy = aircraft] (si::Time const dt) {
-		_simulation->evolve (dt, 1_s);
-
-		auto const angle = 60_deg * std::sin (tt / 1_s);
-		std::cout << angle << "\n";
-		aircraft_copy.aileron_l_servo->set_setpoint (+angle);
-		aircraft_copy.aileron_r_servo->set_setpoint (-angle);
-
-		tt += dt;
-	});
+	_rigid_body_viewer.emplace (_rigid_body_snapshots, QSize (50 * lh, 50 * lh), xf::RigidBodyViewer::AutoFPS, &*_simulation_thread);
 	_rigid_body_viewer->set_followed (aircraft.center_body);
 	_rigid_body_viewer->set_planet (&earth);
 	_rigid_body_viewer->show();
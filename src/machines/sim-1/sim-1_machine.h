@@ -26,7 +26,9 @@
 #include <xefis/support/simulation/rigid_body/group.h>
 #include <xefis/support/simulation/rigid_body/impulse_solver.h>
 #include <xefis/support/simulation/rigid_body/system.h>
+#include <xefis/support/simulation/rigid_body/system_snapshot.h>
 #include <xefis/support/simulation/simulation.h>
+#include <xefis/support/simulation/simulation_thread.h>
 #include <xefis/support/ui/rigid_body_viewer.h>
 
 // Neutrino:
@@ -61,13 +63,16 @@ class Sim1Machine: public xf::Machine
 	construct_aircraft();
 
   private:
-	xf::Logger							_logger;
-	xf::rigid_body::System				_rigid_body_system;
-	xf::rigid_body::ImpulseSolver		_rigid_body_solver			{ _rigid_body_system, 5 };
-	xf::electrical::Network				_electrical_network;
-	xf::electrical::NodeVoltageSolver	_electrical_network_solver	{ _electrical_network, 1e-3 };
-	std::optional<xf::RigidBodyViewer>	_rigid_body_viewer;
-	std::optional<xf::Simulation>		_simulation;
+	xf::Logger								_logger;
+	xf::rigid_body::System					_rigid_body_system;
+	xf::rigid_body::ImpulseSolver			_rigid_body_solver				{ _rigid_body_system, 5 };
+	xf::electrical::Network					_electrical_network;
+	xf::electrical::NodeVoltageSolver		_electrical_network_solver		{ _electrical_network, 1e-3 };
+	xf::rigid_body::SystemSnapshotBuffer	_rigid_body_snapshots;
+	std::optional<xf::Simulation>			_simulation;
+	// Must be destroyed before the system and the simulation:
+	std::optional<xf::SimulationThread>		_simulation_thread;
+	std::optional<xf::RigidBodyViewer>		_rigid_body_viewer;
 };
 
 #endif
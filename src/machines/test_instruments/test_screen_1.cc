@@ -219,23 +219,24 @@ TestScreen1::create_instruments()
 	_adi.emplace (std::move (adi_io), _graphics, "adi");
 	register_instrument (*_adi, _adi_work_performer);
 	set (**_adi, { 0.0f, 0.0f, 0.5f, 0.63f });
+	set_critical (**_adi);
 
 	_hsi.emplace (std::move (hsi_io), _graphics, _navaid_storage, _logger, "hsi");
 	register_instrument (*_hsi, _hsi_work_performer);
 	set (**_hsi, { 0.0f, 0.63f, 0.5f, 1.0f - 0.63f });
 
 	{
-		auto to_n1 = [](si::AngularVelocity velocity) -> float128_t
+		auto to_n1 = [](si::AngularVelocity velocity) -> double
 		{
 			return 100.0 * velocity / 11'500_rpm;
 		};
 
-		auto to_degrees = [](si::Temperature temperature) -> float128_t
+		auto to_degrees = [](si::Temperature temperature) -> double
 		{
 			return temperature.template in<si::Celsius>();
 		};
 
-		auto to_g = [](si::Acceleration acceleration) -> float128_t
+		auto to_g = [](si::Acceleration acceleration) -> double
 		{
 			return acceleration.template in<si::Gravity>();
 		};
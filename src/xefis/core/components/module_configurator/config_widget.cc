@@ -28,6 +28,14 @@
 
 namespace xf::configurator {
 
+void
+ConfigWidget::set_refresh_rate (si::Frequency const rate)
+{
+	if (_refresher)
+		_refresher->set_rate (rate);
+}
+
+
 std::tuple<xf::HistogramWidget*, xf::HistogramStatsWidget*, QWidget*>
 ConfigWidget::create_performance_widget (QWidget* parent, QString const& title) const
 {
@@ -50,5 +58,12 @@ ConfigWidget::create_performance_widget (QWidget* parent, QString const& title)
 	return { histogram_widget, stats_widget, group_box };
 }
 
+
+void
+ConfigWidget::refresh_while_visible (QWidget& widget, VisibilityRefresher::Callback callback)
+{
+	_refresher = new VisibilityRefresher (widget, kDataRefreshRate, std::move (callback));
+}
+
 } // namespace xf::configurator
 
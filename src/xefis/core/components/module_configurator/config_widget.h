@@ -24,6 +24,7 @@
 
 // Xefis:
 #include <xefis/config/all.h>
+#include <xefis/support/qt/visibility_refresher.h>
 #include <xefis/support/ui/histogram_widget.h>
 #include <xefis/support/ui/histogram_stats_widget.h>
 #include <xefis/support/ui/widget.h>
@@ -33,15 +34,31 @@ namespace xf::configurator {
 
 class ConfigWidget: public Widget
 {
-  protected:
+  public:
 	static constexpr si::Frequency kDataRefreshRate = 5_Hz;
 
+  public:
+	/**
+	 * Set rate at which displayed data is updated.
+	 */
+	virtual void
+	set_refresh_rate (si::Frequency);
+
   protected:
 	using Widget::Widget;
 
   protected:
 	std::tuple<xf::HistogramWidget*, xf::HistogramStatsWidget*, QWidget*>
 	create_performance_widget (QWidget* parent, QString const& title) const;
+
+	/**
+	 * Call refresh function periodically, but only while given widget (eg. a tab) is visible.
+	 */
+	void
+	refresh_while_visible (QWidget&, VisibilityRefresher::Callback);
+
+  private:
+	VisibilityRefresher*	_refresher	{ nullptr };
 };
 
 } // namespace xf::configurator
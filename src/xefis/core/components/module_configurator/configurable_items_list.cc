@@ -60,16 +60,10 @@ ConfigurableItemsList::ConfigurableItemsList (Machine& machine, QWidget* parent)
 	auto lh = default_line_height (this);
 	setMinimumWidth (25.0f * lh);
 
-	_refresh_timer = new QTimer (this);
-	_refresh_timer->setInterval (100);
-	_refresh_timer->setSingleShot (false);
-	QObject::connect (_refresh_timer, SIGNAL (timeout()), this, SLOT (read()));
-	_refresh_timer->start();
-
-	read();
-
 	_tmp_processing_loop_ptrs.reserve (100);
 	_tmp_module_ptrs.reserve (1000);
+
+	_refresher = new VisibilityRefresher (*this, kDefaultRefreshRate, [this] { read(); });
 }
 
 
@@ -81,6 +75,13 @@ ConfigurableItemsList::deselect()
 }
 
 
+void
+ConfigurableItemsList::set_refresh_rate (si::Frequency const rate)
+{
+	_refresher->set_rate (rate);
+}
+
+
 template<class TempContainer, class ItemToPointerMapper>
 	inline void
 	ConfigurableItemsList::populate_subtree (QTreeWidgetItem& tree, TempContainer& container, ItemToPointerMapper&& item_to_pointer)
@@ -18,7 +18,6 @@
 #include <cstddef>
 
 // Qt:
-#include <QtCore/QTimer>
 #include <QtWidgets/QWidget>
 #include <QtWidgets/QTreeWidget>
 
@@ -28,6 +27,7 @@
 #include <xefis/core/module.h>
 #include <xefis/core/processing_loop.h>
 #include <xefis/core/screen.h>
+#include <xefis/support/qt/visibility_refresher.h>
 
 
 // TODO Fix this to xf::configurator when Qt MOC parsing bugs get fixed
@@ -41,6 +41,9 @@ class ConfigurableItemsList: public QWidget
   public:
 	constexpr static int NameColumn	= 0;
 
+	// Modules are rarely added or removed, so the list doesn't need to be refreshed often:
+	constexpr static si::Frequency kDefaultRefreshRate = 2_Hz;
+
   public:
 	// Ctor
 	explicit
@@ -52,6 +55,12 @@ class ConfigurableItemsList: public QWidget
 	void
 	deselect();
 
+	/**
+	 * Set rate at which list of modules is updated.
+	 */
+	void
+	set_refresh_rate (si::Frequency);
+
   signals:
 	/**
 	 * Emitted when user selects a ProcessingLoop item.
@@ -98,7 +107,7 @@ class ConfigurableItemsList: public QWidget
   private:
 	Machine&						_machine;
 	QTreeWidget*					_list			= nullptr;
-	QTimer*							_refresh_timer	= nullptr;
+	VisibilityRefresher*			_refresher		= nullptr;
 	std::vector<ProcessingLoop*>	_tmp_processing_loop_ptrs;
 	std::vector<Screen*>			_tmp_screen_ptrs;
 	std::vector<BasicModule*>		_tmp_module_ptrs;
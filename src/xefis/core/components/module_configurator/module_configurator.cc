@@ -55,13 +55,38 @@ ModuleConfigurator::ModuleConfigurator (Machine& machine, QWidget* parent):
 }
 
 
+template<class Widget>
+	inline Widget*
+	ModuleConfigurator::setup (Widget* widget)
+	{
+		widget->set_refresh_rate (_data_refresh_rate);
+		return widget;
+	}
+
+
+void
+ModuleConfigurator::set_data_refresh_rate (si::Frequency const rate)
+{
+	_data_refresh_rate = rate;
+
+	for (auto& pair: _processing_loop_widgets)
+		pair.second->set_refresh_rate (rate);
+
+	for (auto& pair: _screen_widgets)
+		pair.second->set_refresh_rate (rate);
+
+	for (auto& pair: _module_widgets)
+		pair.second->set_refresh_rate (rate);
+}
+
+
 void
 ModuleConfigurator::processing_loop_selected (ProcessingLoop& processing_loop)
 {
 	auto plw = _processing_loop_widgets.find (&processing_loop);
 
 	if (plw == _processing_loop_widgets.end())
-		plw = _processing_loop_widgets.insert ({ &processing_loop, new ProcessingLoopWidget (processing_loop, this) }).first;
+		plw = _processing_loop_widgets.insert ({ &processing_loop, setup (new ProcessingLoopWidget (processing_loop, this)) }).first;
 
 	if (_stack->indexOf (plw->second) == -1)
 		_stack->addWidget (plw->second);
@@ -76,7 +101,7 @@ ModuleConfigurator::screen_selected (Screen& screen)
 	auto sw = _screen_widgets.find (&screen);
 
 	if (sw == _screen_widgets.end())
-		sw = _screen_widgets.insert ({ &screen, new ScreenWidget (screen, this) }).first;
+		sw = _screen_widgets.insert ({ &screen, setup (new ScreenWidget (screen, this)) }).first;
 
 	if (_stack->indexOf (sw->second) == -1)
 		_stack->addWidget (sw->second);
@@ -91,7 +116,7 @@ ModuleConfigurator::module_selected (BasicModule& module)
 	auto gmw = _module_widgets.find (&module);
 
 	if (gmw == _module_widgets.end())
-		gmw = _module_widgets.insert ({ &module, new ModuleWidget (module, this) }).first;
+		gmw = _module_widgets.insert ({ &module, setup (new ModuleWidget (module, this)) }).first;
 
 	if (_stack->indexOf (gmw->second) == -1)
 		_stack->addWidget (gmw->second);
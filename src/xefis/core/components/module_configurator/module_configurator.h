@@ -42,6 +42,12 @@ class ModuleConfigurator: public QWidget
 	explicit
 	ModuleConfigurator (Machine&, QWidget* parent);
 
+	/**
+	 * Set rate at which data shown in configuration widgets is updated.
+	 */
+	void
+	set_data_refresh_rate (si::Frequency);
+
   private:
 	void
 	processing_loop_selected (ProcessingLoop&);
@@ -55,6 +61,13 @@ class ModuleConfigurator: public QWidget
 	void
 	none_selected();
 
+	/**
+	 * Configure newly created config widget.
+	 */
+	template<class Widget>
+		Widget*
+		setup (Widget*);
+
   private:
 	Machine&														_machine;
 	configurator::ConfigurableItemsList*							_configurable_items_list	{ nullptr };
@@ -63,6 +76,7 @@ class ModuleConfigurator: public QWidget
 	std::map<ProcessingLoop*, configurator::ProcessingLoopWidget*>	_processing_loop_widgets;
 	std::map<Screen*, configurator::ScreenWidget*>					_screen_widgets;
 	std::map<BasicModule*, configurator::ModuleWidget*>				_module_widgets;
+	si::Frequency													_data_refresh_rate			{ configurator::ConfigWidget::kDataRefreshRate };
 };
 
 } // namespace xf
@@ -47,8 +47,9 @@ ModuleWidget::ModuleWidget (BasicModule& module, QWidget* parent):
 	QColor color = _instrument ? QColor (0xff, 0x66, 0xff) : QColor (0x50, 0x79, 0xff);
 	QWidget* name_label = create_colored_strip_label (module_type + full_name_str.toHtmlEscaped(), color, Qt::AlignBottom, this);
 
+	auto* performance_tab = create_performance_tab();
 	auto tabs = new QTabWidget (this);
-	tabs->addTab (create_performance_tab(), "Performance");
+	tabs->addTab (performance_tab, "Performance");
 
 	if (auto* io_base = _module.io_base())
 	{
@@ -74,13 +75,19 @@ ModuleWidget::ModuleWidget (BasicModule& module, QWidget* parent):
 	layout->addItem (new QSpacerItem (0, em_pixels (0.15f), QSizePolicy::Fixed, QSizePolicy::Fixed));
 	layout->addWidget (tabs);
 
-	_refresh_timer = new QTimer (this);
-	_refresh_timer->setSingleShot (false);
-	_refresh_timer->setInterval (1000_Hz / ConfigWidget::kDataRefreshRate);
-	QObject::connect (_refresh_timer, &QTimer::timeout, this, &ModuleWidget::refresh);
-	_refresh_timer->start();
+	// Histograms are refreshed only while the performance tab is shown; property trees refresh themselves:
+	refresh_while_visible (*performance_tab, [this] { refresh(); });
+}
+
+
+void
+ModuleWidget::set_refresh_rate (si::Frequency const rate)
+{
+	ConfigWidget::set_refresh_rate (rate);
 
-	refresh();
+	for (auto* property_tree: { _inputs_property_tree, _outputs_property_tree })
+		if (property_tree)
+			property_tree->set_refresh_rate (rate);
 }
 
 
@@ -20,7 +20,6 @@
 // Qt:
 #include <QLabel>
 #include <QStackedWidget>
-#include <QTimer>
 #include <QWidget>
 
 // Xefis:
@@ -57,6 +56,10 @@ class ModuleWidget: public ConfigWidget
 	BasicModule&
 	module() const noexcept;
 
+	// ConfigWidget API
+	void
+	set_refresh_rate (si::Frequency) override;
+
   private:
 	void
 	refresh();
@@ -67,8 +70,8 @@ class ModuleWidget: public ConfigWidget
   private:
 	BasicModule&				_module;
 	BasicInstrument*			_instrument						{ nullptr };
-	PropertyTree*				_inputs_property_tree;
-	PropertyTree*				_outputs_property_tree;
+	PropertyTree*				_inputs_property_tree			{ nullptr };
+	PropertyTree*				_outputs_property_tree			{ nullptr };
 	QWidget*					_communication_time_group		{ nullptr };
 	xf::HistogramWidget*		_communication_time_histogram	{ nullptr };
 	xf::HistogramStatsWidget*	_communication_time_stats		{ nullptr };
@@ -77,7 +80,6 @@ class ModuleWidget: public ConfigWidget
 	xf::HistogramStatsWidget*	_processing_time_stats			{ nullptr };
 	xf::HistogramWidget*		_painting_time_histogram		{ nullptr };
 	xf::HistogramStatsWidget*	_painting_time_stats			{ nullptr };
-	QTimer*						_refresh_timer;
 };
 
 
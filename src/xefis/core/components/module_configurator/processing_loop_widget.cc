@@ -39,8 +39,9 @@ ProcessingLoopWidget::ProcessingLoopWidget (ProcessingLoop& processing_loop, QWi
 {
 	auto* name_label = create_colored_strip_label (QString::fromStdString (_processing_loop.instance()).toHtmlEscaped(), QColor (0xff, 0xd7, 0), Qt::AlignBottom, this);
 
+	auto* performance_tab = create_performance_tab();
 	auto tabs = new QTabWidget (this);
-	tabs->addTab (create_performance_tab(), "Performance");
+	tabs->addTab (performance_tab, "Performance");
 
 	auto* layout = new QVBoxLayout (this);
 	layout->setMargin (0);
@@ -48,13 +49,7 @@ ProcessingLoopWidget::ProcessingLoopWidget (ProcessingLoop& processing_loop, QWi
 	layout->addItem (new QSpacerItem (0, em_pixels (0.15f), QSizePolicy::Fixed, QSizePolicy::Fixed));
 	layout->addWidget (tabs);
 
-	_refresh_timer = new QTimer (this);
-	_refresh_timer->setSingleShot (false);
-	_refresh_timer->setInterval (1000_Hz / ConfigWidget::kDataRefreshRate);
-	QObject::connect (_refresh_timer, &QTimer::timeout, this, &ProcessingLoopWidget::refresh);
-	_refresh_timer->start();
-
-	refresh();
+	refresh_while_visible (*performance_tab, [this] { refresh(); });
 }
 
 
@@ -18,7 +18,6 @@
 #include <cstddef>
 
 // Qt:
-#include <QTimer>
 #include <QWidget>
 
 // Xefis:
@@ -57,7 +56,6 @@ class ProcessingLoopWidget: public ConfigWidget
 	xf::HistogramStatsWidget*	_processing_time_stats			{ nullptr };
 	xf::HistogramWidget*		_processing_latency_histogram	{ nullptr };
 	xf::HistogramStatsWidget*	_processing_latency_stats		{ nullptr };
-	QTimer*						_refresh_timer;
 };
 
 } // namespace xf::configurator
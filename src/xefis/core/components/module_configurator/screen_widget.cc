@@ -38,8 +38,9 @@ ScreenWidget::ScreenWidget (Screen& screen, QWidget* parent):
 {
 	auto* name_label = create_colored_strip_label (QString::fromStdString (_screen.instance()).toHtmlEscaped(), QColor (0xff, 0xaa, 0x00), Qt::AlignBottom, this);
 
+	auto* performance_tab = create_performance_tab();
 	auto tabs = new QTabWidget (this);
-	tabs->addTab (create_performance_tab(), "Performance");
+	tabs->addTab (performance_tab, "Performance");
 
 	auto* layout = new QVBoxLayout (this);
 	layout->setMargin (0);
@@ -47,13 +48,7 @@ ScreenWidget::ScreenWidget (Screen& screen, QWidget* parent):
 	layout->addItem (new QSpacerItem (0, em_pixels (0.15f), QSizePolicy::Fixed, QSizePolicy::Fixed));
 	layout->addWidget (tabs);
 
-	_refresh_timer = new QTimer (this);
-	_refresh_timer->setSingleShot (false);
-	_refresh_timer->setInterval (1000_Hz / ConfigWidget::kDataRefreshRate);
-	QObject::connect (_refresh_timer, &QTimer::timeout, this, &ScreenWidget::refresh);
-	_refresh_timer->start();
-
-	refresh();
+	refresh_while_visible (*performance_tab, [this] { refresh(); });
 }
 
 
@@ -67,10 +62,14 @@ ScreenWidget::refresh()
 
 	for (auto const& widgets_pair: _work_performer_widgets)
 	{
+		auto const& widgets = widgets_pair.second;
+
+		// Skip WorkPerformers whose tabs aren't shown:
+		if (!widgets.start_latency_group->isVisible())
+			continue;
+
 		if (auto metrics = _screen.work_performer_metrics_for (widgets_pair.first))
 		{
-			auto const& widgets = widgets_pair.second;
-
 			auto const update_histogram = [](auto const& samples, auto& histogram_widget, auto& stats_widget)
 			{
 				if (!samples.empty())
@@ -148,6 +147,9 @@ ScreenWidget::create_performance_tab()
 		}
 	}
 
+	// Only the current tab is refreshed, so refresh immediately when it changes:
+	QObject::connect (tabs, &QTabWidget::currentChanged, this, &ScreenWidget::refresh);
+
 	auto* widget_layout = new QGridLayout (widget);
 	widget_layout->setMargin (0);
 	widget_layout->addWidget (tabs, 0, 0);
@@ -19,7 +19,6 @@
 #include <unordered_map>
 
 // Qt:
-#include <QTimer>
 #include <QWidget>
 
 // Xefis:
@@ -68,7 +67,6 @@ class ScreenWidget: public ConfigWidget
 	Screen&						_screen;
 	xf::HistogramWidget*		_painting_time_histogram	{ nullptr };
 	xf::HistogramStatsWidget*	_painting_time_stats		{ nullptr };
-	QTimer*						_refresh_timer;
 	std::unordered_map<WorkPerformer const*, Widgets>
 								_work_performer_widgets		{ 10 };
 };
@@ -33,7 +33,13 @@ PropertyItem::PropertyItem (BasicProperty* property, QTreeWidgetItem& parent):
 	_property (property)
 {
 	if (_property)
+	{
 		setText (PropertyTree::UseCountColumn, QString::number (_property->use_count()));
+		setTextAlignment (PropertyTree::ActualValueColumn, Qt::AlignRight);
+		setTextAlignment (PropertyTree::SetValueColumn, Qt::AlignRight);
+		setTextAlignment (PropertyTree::FallbackValueColumn, Qt::AlignRight);
+		setText (PropertyTree::FallbackValueColumn, "x");
+	}
 }
 
 
@@ -51,24 +57,27 @@ PropertyItem::read()
 {
 	if (_property)
 	{
-		PropertyConversionSettings conv_settings;
-		conv_settings.numeric_format = boost::format ("%.12f");
-		conv_settings.preferred_units = {
-			si::Celsius::dynamic_unit(),
-			si::Degree::dynamic_unit(),
-		};
+		auto const serial = _property->serial();
 
-		std::string const actual_value = _property->to_string (conv_settings);
-		std::string const set_value = _property->to_string (conv_settings);
+		if (_read_serial && *_read_serial == serial)
+			return;
 
-		setTextAlignment (PropertyTree::ActualValueColumn, Qt::AlignRight);
-		setText (PropertyTree::ActualValueColumn, QString::fromStdString (actual_value));
+		_read_serial = serial;
 
-		setTextAlignment (PropertyTree::SetValueColumn, Qt::AlignRight);
-		setText (PropertyTree::SetValueColumn, QString::fromStdString (set_value));
+		static PropertyConversionSettings const conv_settings = [] {
+			PropertyConversionSettings settings;
+			settings.numeric_format = boost::format ("%.12f");
+			settings.preferred_units = {
+				si::Celsius::dynamic_unit(),
+				si::Degree::dynamic_unit(),
+			};
+			return settings;
+		}();
 
-		setTextAlignment (PropertyTree::FallbackValueColumn, Qt::AlignRight);
-		setText (PropertyTree::FallbackValueColumn, "x");
+		auto const value = QString::fromStdString (_property->to_string (conv_settings));
+
+		setText (PropertyTree::ActualValueColumn, value);
+		setText (PropertyTree::SetValueColumn, value);
 	}
 }
 
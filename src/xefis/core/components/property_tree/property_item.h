@@ -16,6 +16,7 @@
 
 // Standard:
 #include <cstddef>
+#include <optional>
 
 // Qt:
 #include <QtWidgets/QTreeWidgetItem>
@@ -41,11 +42,15 @@ class PropertyItem: public QTreeWidgetItem
 	void
 	setup_appereance();
 
+	/**
+	 * Update displayed value. Does nothing if property's serial hasn't changed since last read.
+	 */
 	void
 	read();
 
   private:
-	BasicProperty* _property;
+	BasicProperty*							_property;
+	std::optional<BasicProperty::Serial>	_read_serial;
  };
 
 } // namespace xf
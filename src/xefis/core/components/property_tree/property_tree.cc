@@ -17,6 +17,7 @@
 // Qt:
 #include <QBoxLayout>
 #include <QHeaderView>
+#include <QScrollBar>
 #include <QTreeWidgetItem>
 #include <QTreeWidgetItemIterator>
 
@@ -54,43 +55,47 @@ PropertyTree::PropertyTree (QWidget* parent):
 	layout->setMargin (0);
 	layout->addWidget (_tree);
 
-	_refresh_timer = new QTimer (this);
-	_refresh_timer->setInterval ((100_ms).in<si::Millisecond>());
-	QObject::connect (_refresh_timer, &QTimer::timeout, this, &PropertyTree::read_values);
+	_refresher = new VisibilityRefresher (*this, kDefaultRefreshRate, [this] { read_values(); });
+
+	// Read rows as soon as they become visible:
+	auto const request_refresh = [this] { _refresher->request(); };
+	QObject::connect (_tree->verticalScrollBar(), &QScrollBar::valueChanged, request_refresh);
+	QObject::connect (_tree, &QTreeWidget::itemExpanded, request_refresh);
+	QObject::connect (_tree->header(), &QHeaderView::sortIndicatorChanged, request_refresh);
 
 	// TODO QObject::connect (this, &QTreeWidget::customContextMenuRequested, this, &PropertyTreeWidget::handle_context_menu_request);
 }
 
 
 void
-PropertyTree::setup_icons()
+PropertyTree::set_refresh_rate (si::Frequency const rate)
 {
-	for (QTreeWidgetItemIterator item (_tree); *item; ++item)
-		if (auto* property_item = dynamic_cast<PropertyItem*> (*item))
-			property_item->setup_appereance();
+	_refresher->set_rate (rate);
 }
 
 
 void
-PropertyTree::read_values()
+PropertyTree::setup_icons()
 {
 	for (QTreeWidgetItemIterator item (_tree); *item; ++item)
 		if (auto* property_item = dynamic_cast<PropertyItem*> (*item))
-			property_item->read();
+			property_item->setup_appereance();
 }
 
 
 void
-PropertyTree::showEvent (QShowEvent*)
+PropertyTree::read_values()
 {
-	_refresh_timer->start();
-}
+	auto const viewport_rect = _tree->viewport()->rect();
 
+	for (auto* item = _tree->itemAt (viewport_rect.topLeft()); item; item = _tree->itemBelow (item))
+	{
+		if (_tree->visualItemRect (item).top() > viewport_rect.bottom())
+			break;
 
-void
-PropertyTree::hideEvent (QHideEvent*)
-{
-	_refresh_timer->stop();
+		if (auto* property_item = dynamic_cast<PropertyItem*> (item))
+			property_item->read();
+	}
 }
 
 } // namespace xf
@@ -22,7 +22,6 @@
 
 // Qt:
 #include <QTreeWidget>
-#include <QTimer>
 
 // Neutrino:
 #include <neutrino/qt/qutils.h>
@@ -31,6 +30,7 @@
 // Xefis:
 #include <xefis/config/all.h>
 #include <xefis/core/module.h>
+#include <xefis/support/qt/visibility_refresher.h>
 
 // Local:
 #include "property_item.h"
@@ -47,6 +47,8 @@ class PropertyTree: public QWidget
 	constexpr static int SetValueColumn			= 3;
 	constexpr static int FallbackValueColumn	= 4;
 
+	constexpr static si::Frequency kDefaultRefreshRate = 10_Hz;
+
   private:
 	/**
 	 * Helper class used by populate_tree to effectively create a tree of
@@ -124,25 +126,26 @@ class PropertyTree: public QWidget
 		void
 		populate (Sequence<Iterator> const&);
 
+	/**
+	 * Set rate at which displayed values are updated.
+	 */
+	void
+	set_refresh_rate (si::Frequency);
+
   private:
 	void
 	setup_icons();
 
+	/**
+	 * Update values of rows visible in the viewport. Does nothing for properties that
+	 * haven't changed since last read.
+	 */
 	void
 	read_values();
 
-  protected:
-	// QWdiget API
-	void
-	showEvent (QShowEvent*) override;
-
-	// QWdiget API
-	void
-	hideEvent (QHideEvent*) override;
-
   private:
-	QTreeWidget*	_tree;
-	QTimer*			_refresh_timer;
+	QTreeWidget*			_tree;
+	VisibilityRefresher*	_refresher;
 };
 
 
@@ -157,6 +160,7 @@ template<class Iterator>
 				root.add_child (*basic_property);
 
 		setup_icons();
+		_refresher->request();
 	}
 
 } // namespace xf
@@ -0,0 +1,238 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <array>
+#include <cstring>
+
+// System:
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+// Neutrino:
+#include <neutrino/time_helper.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Local:
+#include "io_reactor.h"
+
+
+namespace xf {
+
+// Epoll data of the stop eventfd; sources get IDs starting from 1:
+static constexpr uint64_t kStopID = 0;
+
+
+IOReactor::Source::Source (IOReactor& reactor, uint64_t id, std::shared_ptr<Buffer> buffer):
+	_reactor (reactor),
+	_id (id),
+	_buffer (std::move (buffer))
+{ }
+
+
+IOReactor::Source::~Source()
+{
+	_reactor.remove (_id);
+}
+
+
+void
+IOReactor::Source::take (Chunks& chunks)
+{
+	chunks.clear();
+
+	std::lock_guard lock (_buffer->mutex);
+	std::swap (chunks, _buffer->chunks);
+	_buffer->size = 0;
+}
+
+
+IOReactor::IOReactor (Logger const& logger):
+	_logger (logger.with_scope ("<io-reactor>"))
+{
+	_epoll_fd = ::epoll_create1 (EPOLL_CLOEXEC);
+
+	if (_epoll_fd < 0)
+		throw Exception ("could not create epoll instance: " + std::string (strerror (errno)));
+
+	_stop_fd = ::eventfd (0, EFD_CLOEXEC);
+
+	if (_stop_fd < 0)
+	{
+		::close (_epoll_fd);
+		throw Exception ("could not create eventfd: " + std::string (strerror (errno)));
+	}
+
+	::epoll_event event {};
+	event.events = EPOLLIN;
+	event.data.u64 = kStopID;
+	::epoll_ctl (_epoll_fd, EPOLL_CTL_ADD, _stop_fd, &event);
+
+	_thread = std::thread (&IOReactor::run, this);
+}
+
+
+IOReactor::~IOReactor()
+{
+	uint64_t const one = 1;
+	[[maybe_unused]] auto const written = ::write (_stop_fd, &one, sizeof (one));
+	_thread.join();
+	::close (_stop_fd);
+	::close (_epoll_fd);
+}
+
+
+std::unique_ptr<IOReactor::Source>
+IOReactor::add (int fd, std::size_t buffer_capacity)
+{
+	if (int const flags = ::fcntl (fd, F_GETFL); flags < 0 || ::fcntl (fd, F_SETFL, flags | O_NONBLOCK) < 0)
+		throw Exception ("could not set non-blocking mode on file descriptor: " + std::string (strerror (errno)));
+
+	auto buffer = std::make_shared<Buffer>();
+	buffer->fd = fd;
+	buffer->capacity = buffer_capacity;
+
+	uint64_t id;
+
+	{
+		std::lock_guard lock (_buffers_mutex);
+		id = _next_id++;
+		_buffers[id] = buffer;
+	}
+
+	::epoll_event event {};
+	event.events = EPOLLIN;
+	event.data.u64 = id;
+
+	if (::epoll_ctl (_epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+	{
+		auto const error = errno;
+		std::lock_guard lock (_buffers_mutex);
+		_buffers.erase (id);
+		throw Exception ("could not watch file descriptor: " + std::string (strerror (error)));
+	}
+
+	return std::unique_ptr<Source> (new Source (*this, id, std::move (buffer)));
+}
+
+
+void
+IOReactor::remove (uint64_t id)
+{
+	std::lock_guard lock (_buffers_mutex);
+
+	if (auto b = _buffers.find (id); b != _buffers.end())
+	{
+		// Fails harmlessly if the fd was already removed after a failure:
+		::epoll_ctl (_epoll_fd, EPOLL_CTL_DEL, b->second->fd, nullptr);
+		_buffers.erase (b);
+	}
+}
+
+
+void
+IOReactor::run()
+{
+	std::array<::epoll_event, kMaxEvents> events;
+
+	for (;;)
+	{
+		int const n = ::epoll_wait (_epoll_fd, events.data(), events.size(), -1);
+
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			_logger << "epoll_wait() failed: " << strerror (errno) << "; I/O reactor stopped." << std::endl;
+			return;
+		}
+
+		for (int i = 0; i < n; ++i)
+		{
+			uint64_t const id = events[i].data.u64;
+
+			if (id == kStopID)
+				return;
+
+			// Reads are non-blocking, so keep the lock while reading. This way remove() returns only after
+			// the reactor is done with the fd and the owner can safely close it:
+			std::lock_guard lock (_buffers_mutex);
+
+			// Source might have been removed after epoll_wait() returned:
+			if (auto b = _buffers.find (id); b != _buffers.end())
+				read_from (*b->second);
+		}
+	}
+}
+
+
+void
+IOReactor::read_from (Buffer& buffer)
+{
+	auto const timestamp = TimeHelper::now();
+	std::array<uint8_t, kReadSize> data;
+
+	for (;;)
+	{
+		auto const n = ::read (buffer.fd, data.data(), data.size());
+
+		if (n > 0)
+		{
+			std::lock_guard lock (buffer.mutex);
+
+			buffer.chunks.push_back ({ timestamp, Blob (data.begin(), data.begin() + n) });
+			buffer.size += n;
+
+			// Keep the most recent data:
+			std::size_t drop = 0;
+			std::size_t dropped_bytes = 0;
+
+			while (buffer.size > buffer.capacity && drop < buffer.chunks.size() - 1)
+			{
+				buffer.size -= buffer.chunks[drop].data.size();
+				dropped_bytes += buffer.chunks[drop].data.size();
+				++drop;
+			}
+
+			if (drop > 0)
+			{
+				buffer.chunks.erase (buffer.chunks.begin(), buffer.chunks.begin() + drop);
+				buffer.dropped.fetch_add (dropped_bytes, std::memory_order_relaxed);
+			}
+		}
+		else if (n < 0 && errno == EINTR)
+			continue;
+		else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return;
+		else
+		{
+			// End of file or I/O error; level-triggered epoll would wake us up repeatedly, so stop watching:
+			if (n < 0)
+				_logger << "Error reading file descriptor " << buffer.fd << ": " << strerror (errno) << std::endl;
+
+			::epoll_ctl (_epoll_fd, EPOLL_CTL_DEL, buffer.fd, nullptr);
+			buffer.failed.store (true, std::memory_order_release);
+			return;
+		}
+	}
+}
+
+} // namespace xf
+
@@ -0,0 +1,183 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__CORE__IO_REACTOR_H__INCLUDED
+#define XEFIS__CORE__IO_REACTOR_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Neutrino:
+#include <neutrino/logger.h>
+#include <neutrino/noncopyable.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+
+namespace xf {
+
+/**
+ * Waits for incoming data on file descriptors of device modules in a single epoll thread.
+ * Data is read as soon as it arrives, timestamped and buffered until the module takes it,
+ * usually in its communicate() method. This way modules neither block the processing loop
+ * on reads nor need their own threads or Qt socket notifiers.
+ */
+class IOReactor: private Noncopyable
+{
+  public:
+	static constexpr std::size_t	kMaxEvents				= 16;
+	static constexpr std::size_t	kReadSize				= 4096;
+	static constexpr std::size_t	kDefaultBufferCapacity	= 64 * 1024;
+
+	/**
+	 * Data from a single read().
+	 */
+	struct Chunk
+	{
+		// Time when the reactor was woken up by the data:
+		si::Time	timestamp;
+		Blob		data;
+	};
+
+	using Chunks = std::vector<Chunk>;
+
+  private:
+	struct Buffer
+	{
+		int						fd;
+		std::size_t				capacity;
+		std::mutex				mutex;
+		Chunks					chunks;
+		std::size_t				size		{ 0 };
+		std::atomic<bool>		failed		{ false };
+		std::atomic<uint64_t>	dropped		{ 0 };
+	};
+
+  public:
+	/**
+	 * Registration of a file descriptor. File descriptor is unregistered when Source is destroyed,
+	 * but it's not closed.
+	 */
+	class Source: private Noncopyable
+	{
+		friend class IOReactor;
+
+	  public:
+		// Dtor
+		~Source();
+
+		/**
+		 * Move data received since last call to the given vector. Previous contents of the vector are
+		 * discarded, but its capacity is reused.
+		 */
+		void
+		take (Chunks&);
+
+		/**
+		 * Return true if end of file or an I/O error was encountered. The file descriptor is not watched
+		 * anymore, but data received before the failure can still be taken.
+		 */
+		[[nodiscard]]
+		bool
+		failed() const noexcept;
+
+		/**
+		 * Return number of bytes discarded because the buffer was full.
+		 */
+		[[nodiscard]]
+		uint64_t
+		dropped() const noexcept;
+
+	  private:
+		// Ctor
+		explicit
+		Source (IOReactor&, uint64_t id, std::shared_ptr<Buffer>);
+
+	  private:
+		IOReactor&				_reactor;
+		uint64_t				_id;
+		std::shared_ptr<Buffer>	_buffer;
+	};
+
+  public:
+	// Ctor
+	explicit
+	IOReactor (Logger const&);
+
+	// Dtor
+	~IOReactor();
+
+	/**
+	 * Start watching the file descriptor. It's switched to non-blocking mode.
+	 * When more than buffer_capacity bytes are waiting to be taken, oldest chunks are discarded.
+	 * The file descriptor must stay open as long as returned Source exists.
+	 */
+	[[nodiscard]]
+	std::unique_ptr<Source>
+	add (int fd, std::size_t buffer_capacity = kDefaultBufferCapacity);
+
+  private:
+	/**
+	 * Stop watching the source.
+	 */
+	void
+	remove (uint64_t id);
+
+	/**
+	 * Reactor thread loop.
+	 */
+	void
+	run();
+
+	/**
+	 * Read all available data into the buffer. Must be called with _buffers_mutex locked.
+	 */
+	void
+	read_from (Buffer&);
+
+  private:
+	Logger										_logger;
+	int											_epoll_fd	{ -1 };
+	int											_stop_fd	{ -1 };
+	std::mutex									_buffers_mutex;
+	std::map<uint64_t, std::shared_ptr<Buffer>>	_buffers;
+	uint64_t									_next_id	{ 1 };
+	std::thread									_thread;
+};
+
+
+inline bool
+IOReactor::Source::failed() const noexcept
+{
+	return _buffer->failed.load (std::memory_order_acquire);
+}
+
+
+inline uint64_t
+IOReactor::Source::dropped() const noexcept
+{
+	return _buffer->dropped.load (std::memory_order_relaxed);
+}
+
+} // namespace xf
+
+#endif
+
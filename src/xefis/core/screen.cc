@@ -16,6 +16,7 @@
 #include <functional>
 #include <algorithm>
 #include <thread>
+#include <utility>
 
 // Qt:
 #include <QPainter>
@@ -46,8 +47,14 @@ InstrumentDetails::InstrumentDetails (BasicInstrument& instrument, WorkPerformer
 } // namespace detail
 
 
-static constexpr char		kLogoPath[]			= "share/images/xefis.svg";
-static constexpr si::Time	kLogoDisplayTime	= 2_s;
+static constexpr char			kLogoPath[]				= "share/images/xefis.svg";
+static constexpr si::Time		kLogoDisplayTime		= 2_s;
+// Maximum factor by which frame rate of non-critical instruments is reduced:
+static constexpr unsigned int	kMaxThrottleFactor		= 8;
+// Number of consecutive refreshes with prompt paint starts needed to halve the throttle factor:
+static constexpr unsigned int	kRecoveryPromptFrames	= 30;
+// Maximum number of consecutive paintings of an instrument dropped for missing their deadline:
+static constexpr unsigned int	kMaxConsecutiveDrops	= 2;
 
 
 Screen::Screen (ScreenSpec const& spec, Graphics const& graphics, Machine& machine, std::string_view const& instance, Logger const& logger):
@@ -133,6 +140,30 @@ Screen::set_z_index (BasicInstrument const& instrument, int const new_z_index)
 }
 
 
+void
+Screen::set_frame_rate (BasicInstrument const& instrument, si::Frequency const frame_rate)
+{
+	if (auto* details = find_details (instrument))
+		details->frame_time = 1 / frame_rate;
+}
+
+
+void
+Screen::set_critical (BasicInstrument const& instrument, bool const critical)
+{
+	if (auto* details = find_details (instrument))
+		details->critical = critical;
+}
+
+
+void
+Screen::set_priority (BasicInstrument const& instrument, int const priority)
+{
+	if (auto* details = find_details (instrument))
+		details->priority = priority;
+}
+
+
 void
 Screen::set_paint_bounding_boxes (bool enable)
 {
@@ -214,6 +245,7 @@ void
 Screen::paint_instruments_to_buffer()
 {
 	QSize const canvas_size = _canvas.size();
+	auto const now = TimeHelper::now();
 
 	_canvas.fill (Qt::black);
 
@@ -240,51 +272,61 @@ Screen::paint_instruments_to_buffer()
 		{
 			if (details.result.valid() && is_ready (details.result))
 			{
+				bool dropped = true;
+
 				Exception::catch_and_log (_logger, [&] {
 					auto const perf_metrics = details.result.get();
-					// Update per-instrument metrics:
+					auto& wp_metrics = _work_performer_metrics[details.work_performer];
+					dropped = perf_metrics.dropped;
+
+					if (dropped)
+					{
+						++wp_metrics.dropped_paintings;
+						++details.consecutive_drops;
+						// Paint again with current data:
+						instrument.mark_dirty();
+					}
+					else
 					{
+						details.consecutive_drops = 0;
+						// Update per-instrument metrics:
 						auto accounting_api = BasicInstrument::AccountingAPI (instrument);
 						accounting_api.set_frame_time (_frame_time);
 						accounting_api.add_painting_time (perf_metrics.painting_time);
 					}
+
 					// Update per-WorkPerformer metrics:
-					_work_performer_metrics[details.work_performer].start_latencies.push_back (perf_metrics.start_latency);
-					_work_performer_metrics[details.work_performer].total_latencies.push_back (perf_metrics.start_latency + perf_metrics.painting_time);
+					wp_metrics.start_latencies.push_back (perf_metrics.start_latency);
+					wp_metrics.total_latencies.push_back (perf_metrics.start_latency + perf_metrics.painting_time);
+					wp_metrics.frame_start_latency = std::max (wp_metrics.frame_start_latency.value_or (0_s), perf_metrics.start_latency);
 				});
 
-				std::swap (details.canvas, details.canvas_to_use);
+				if (!dropped)
+					std::swap (details.canvas, details.canvas_to_use);
 			}
 
-			// Start new painting job:
-			if (!details.result.valid() && instrument.dirty_since_last_check())
-			{
-				prepare_canvas_for_instrument (details.canvas, details.computed_position->size());
-
-				PaintRequest::Metric metric (details.computed_position->size(), _screen_spec.pixel_density(), _screen_spec.base_pen_width(), _screen_spec.base_font_height());
-				PaintRequest paint_request (*details.canvas, metric, details.previous_size);
-
-				details.previous_size = details.computed_position->size();
-
-				auto task = instrument.paint (std::move (paint_request));
-				auto request_time = TimeHelper::now();
-				auto measured_task = [t = std::move (task), request_time]() mutable noexcept {
-					auto const start_time = TimeHelper::now();
-					auto const painting_time = TimeHelper::measure (t);
-
-					return detail::PaintPerformanceMetrics {
-						start_time - request_time,
-						painting_time,
-					};
-				};
-
-				details.result = details.work_performer->submit (std::move (measured_task));
-			}
+			// Check the dirty flag last, since it's reset by the check:
+			if (!details.result.valid() && paint_due (details, now) && instrument.dirty_since_last_check())
+				_paint_queue.push_back (disclosure);
 		}
 		else
 			std::clog << "Instrument " << identifier (instrument) << " has invalid size/position." << std::endl;
 	}
 
+	// Many paintings that were delayed by the same overload finish in the same refresh, so count them once:
+	for (auto& [work_performer, wp_metrics]: _work_performer_metrics)
+		update_throttling (wp_metrics);
+
+	// WorkPerformers serve jobs in FIFO order, so submit most important jobs first:
+	std::stable_sort (_paint_queue.begin(), _paint_queue.end(), [](auto const* a, auto const* b) {
+		return std::pair (a->details().critical, a->details().priority) > std::pair (b->details().critical, b->details().priority);
+	});
+
+	for (auto* disclosure: _paint_queue)
+		start_painting (*disclosure, now);
+
+	_paint_queue.clear();
+
 	// Compose all images into our painting buffer:
 	{
 		QPainter canvas_painter (&_canvas);
@@ -314,6 +356,47 @@ Screen::paint_instruments_to_buffer()
 }
 
 
+void
+Screen::start_painting (InstrumentTracker::Disclosure& disclosure, si::Time const now)
+{
+	auto& instrument = disclosure.value();
+	auto& details = disclosure.details();
+
+	details.last_paint_request_time = now;
+	prepare_canvas_for_instrument (details.canvas, details.computed_position->size());
+
+	PaintRequest::Metric metric (details.computed_position->size(), _screen_spec.pixel_density(), _screen_spec.base_pen_width(), _screen_spec.base_font_height());
+	PaintRequest paint_request (*details.canvas, metric, details.previous_size);
+	bool const size_changed = paint_request.size_changed();
+
+	details.previous_size = details.computed_position->size();
+
+	auto task = instrument.paint (std::move (paint_request));
+	auto request_time = TimeHelper::now();
+	// If painting doesn't start before next screen refresh, a newer painting can be requested instead.
+	// Don't drop critical instruments and don't starve others. Don't drop paintings after resize either,
+	// since next request would not report the size change anymore:
+	auto const deadline = request_time + _frame_time;
+	bool const droppable = !details.critical && !size_changed && details.consecutive_drops < kMaxConsecutiveDrops;
+	auto measured_task = [t = std::move (task), request_time, deadline, droppable]() mutable noexcept {
+		auto const start_time = TimeHelper::now();
+
+		if (droppable && start_time > deadline)
+			return detail::PaintPerformanceMetrics { start_time - request_time, 0_s, true };
+
+		auto const painting_time = TimeHelper::measure (t);
+
+		return detail::PaintPerformanceMetrics {
+			start_time - request_time,
+			painting_time,
+			false,
+		};
+	};
+
+	details.result = details.work_performer->submit (std::move (measured_task));
+}
+
+
 void
 Screen::wait_for_async_paint (InstrumentTracker::Disclosure& disclosure)
 {
@@ -324,6 +407,60 @@ Screen::wait_for_async_paint (InstrumentTracker::Disclosure& disclosure)
 }
 
 
+detail::InstrumentDetails*
+Screen::find_details (BasicInstrument const& instrument)
+{
+	for (auto& disclosure: _instrument_tracker)
+		if (&disclosure.value() == &instrument)
+			return &disclosure.details();
+
+	return nullptr;
+}
+
+
+void
+Screen::update_throttling (WorkPerformerMetrics& metrics)
+{
+	if (!metrics.frame_start_latency)
+		return;
+
+	auto const start_latency = *metrics.frame_start_latency;
+	metrics.frame_start_latency.reset();
+
+	// Painting that waited in the queue longer than a frame means the WorkPerformer is overloaded:
+	if (start_latency > _frame_time)
+	{
+		metrics.throttle_factor = std::min (2 * metrics.throttle_factor, kMaxThrottleFactor);
+		metrics.prompt_frames = 0;
+	}
+	else if (start_latency < 0.25 * _frame_time)
+	{
+		// Recover slowly to avoid oscillations:
+		if (metrics.throttle_factor > 1 && ++metrics.prompt_frames >= kRecoveryPromptFrames)
+		{
+			metrics.throttle_factor /= 2;
+			metrics.prompt_frames = 0;
+		}
+	}
+	else
+		metrics.prompt_frames = 0;
+}
+
+
+bool
+Screen::paint_due (detail::InstrumentDetails const& details, si::Time const now) const
+{
+	auto frame_time = std::max (details.frame_time, _frame_time);
+
+	if (!details.critical)
+		if (auto metrics = _work_performer_metrics.find (details.work_performer); metrics != _work_performer_metrics.end())
+			frame_time = frame_time * static_cast<double> (metrics->second.throttle_factor);
+
+	// Allow for refresh timer jitter, so that an instrument isn't delayed by a whole screen frame:
+	return now - details.last_paint_request_time >= frame_time - 0.5 * _frame_time;
+}
+
+
 void
 Screen::prepare_canvas_for_instrument (std::unique_ptr<QImage>& canvas, QSize size)
 {
@@ -52,6 +52,8 @@ class PaintPerformanceMetrics
   public:
 	si::Time	start_latency;
 	si::Time	painting_time;
+	// True if painting was skipped because it started after its deadline:
+	bool		dropped			{ false };
 };
 
 
@@ -75,6 +77,14 @@ class InstrumentDetails
 	std::unique_ptr<QImage>					canvas;
 	std::unique_ptr<QImage>					canvas_to_use;
 	WorkPerformer*							work_performer;
+	// Minimum time between paintings of the instrument; 0 means screen's frame time:
+	si::Time								frame_time				{ 0_s };
+	// Critical instruments are not throttled when their WorkPerformer can't keep up:
+	bool									critical				{ false };
+	// Instruments with higher priority are submitted to their WorkPerformers first:
+	int										priority				{ 0 };
+	si::Time								last_paint_request_time	{ 0_s };
+	unsigned int							consecutive_drops		{ 0 };
 
   public:
 	// Ctor
@@ -98,9 +108,17 @@ class WorkPerformerMetrics
 
   public:
 	// Time between issuing a paint request and actual start of painting:
-	boost::circular_buffer<si::Time>	start_latencies	{ kMaxBackLog };
+	boost::circular_buffer<si::Time>	start_latencies		{ kMaxBackLog };
 	// Metrics of how much time it took to finish the painting since the request was issued:
-	boost::circular_buffer<si::Time>	total_latencies	{ kMaxBackLog };
+	boost::circular_buffer<si::Time>	total_latencies		{ kMaxBackLog };
+	// Frame rate of non-critical instruments painted by the WorkPerformer is currently divided by this factor:
+	unsigned int						throttle_factor		{ 1 };
+	// Worst start latency of paintings finished since the last refresh:
+	std::optional<si::Time>				frame_start_latency;
+	// Number of consecutive refreshes in which all finished paintings started without delay:
+	unsigned int						prompt_frames		{ 0 };
+	// Number of paintings skipped because they would be superseded by newer ones:
+	uint64_t							dropped_paintings	{ 0 };
 };
 
 
@@ -151,6 +169,27 @@ class Screen:
 	void
 	set_z_index (BasicInstrument const&, int z_index);
 
+	/**
+	 * Limit frame rate of an instrument. By default instruments are repainted on each screen refresh,
+	 * if they're dirty.
+	 */
+	void
+	set_frame_rate (BasicInstrument const&, si::Frequency);
+
+	/**
+	 * Critical instruments are always painted at their full frame rate. Frame rates of other instruments
+	 * are lowered when their WorkPerformer can't keep up.
+	 */
+	void
+	set_critical (BasicInstrument const&, bool critical = true);
+
+	/**
+	 * Set painting priority of an instrument. On each refresh, painting jobs are submitted to WorkPerformers
+	 * in order of priority (critical instruments first). Default priority is 0.
+	 */
+	void
+	set_priority (BasicInstrument const&, int priority);
+
 	/**
 	 * Enable/disable debug bounding boxes of instruments.
 	 */
@@ -218,6 +257,32 @@ class Screen:
 	void
 	wait_for_async_paint (InstrumentTracker::Disclosure&);
 
+	/**
+	 * Submit painting job of an instrument to its WorkPerformer.
+	 */
+	void
+	start_painting (InstrumentTracker::Disclosure&, si::Time now);
+
+	/**
+	 * Return details of the instrument or nullptr if it's not registered.
+	 */
+	detail::InstrumentDetails*
+	find_details (BasicInstrument const&);
+
+	/**
+	 * Adjust WorkPerformer's throttle factor according to the worst start latency of paintings
+	 * finished since the last refresh. Called once per refresh.
+	 */
+	void
+	update_throttling (WorkPerformerMetrics&);
+
+	/**
+	 * Return true if it's time to paint the instrument again.
+	 */
+	[[nodiscard]]
+	bool
+	paint_due (detail::InstrumentDetails const&, si::Time now) const;
+
 	/**
 	 * Prepare canvas for an instrument.
 	 * Ensure it has requested size and set it to full alpha with color black.
@@ -266,6 +331,9 @@ class Screen:
 	std::optional<QImage>		_logo_image;
 	std::vector<InstrumentTracker::Disclosure*>
 								_z_index_sorted_disclosures;
+	// Instruments to be painted in current refresh; member to avoid reallocations:
+	std::vector<InstrumentTracker::Disclosure*>
+								_paint_queue;
 	ScreenSpec					_screen_spec;
 	si::Time const				_frame_time;
 	bool						_displaying_logo		{ true };
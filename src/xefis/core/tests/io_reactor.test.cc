@@ -0,0 +1,166 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <chrono>
+#include <thread>
+
+// System:
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+// Neutrino:
+#include <neutrino/logger.h>
+#include <neutrino/test/auto_test.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/core/io_reactor.h>
+
+
+namespace xf::test {
+namespace {
+
+xf::LoggerOutput g_logger_output (std::clog);
+xf::Logger g_logger (g_logger_output);
+
+
+struct Pipe
+{
+	Pipe()
+	{
+		if (::pipe (fds) != 0)
+			throw Exception ("could not create pipe");
+	}
+
+	~Pipe()
+	{
+		close_write_end();
+		::close (fds[0]);
+	}
+
+	void
+	write (Blob const& data)
+	{
+		[[maybe_unused]] auto const written = ::write (fds[1], data.data(), data.size());
+	}
+
+	/**
+	 * Wait until everything written has been read from the pipe. Return false on timeout.
+	 */
+	bool
+	wait_until_read()
+	{
+		for (int i = 0; i < 1000; ++i)
+		{
+			int available = 0;
+
+			if (::ioctl (fds[0], FIONREAD, &available) == 0 && available == 0)
+				return true;
+
+			std::this_thread::sleep_for (std::chrono::milliseconds (1));
+		}
+
+		return false;
+	}
+
+	void
+	close_write_end()
+	{
+		if (fds[1] >= 0)
+			::close (fds[1]);
+
+		fds[1] = -1;
+	}
+
+	int fds[2];
+};
+
+
+/**
+ * Take chunks until predicate is satisfied or timeout passes. Return all data taken.
+ */
+template<class Predicate>
+	Blob
+	take_until (IOReactor::Source& source, Predicate predicate)
+	{
+		Blob result;
+		IOReactor::Chunks chunks;
+
+		for (int i = 0; i < 1000 && !predicate (result); ++i)
+		{
+			source.take (chunks);
+
+			for (auto const& chunk: chunks)
+				result.insert (result.end(), chunk.data.begin(), chunk.data.end());
+
+			if (!predicate (result))
+				std::this_thread::sleep_for (std::chrono::milliseconds (1));
+		}
+
+		return result;
+	}
+
+
+AutoTest t1 ("IOReactor: buffering data and detecting end of file", []{
+	IOReactor reactor (g_logger);
+	Pipe pipe;
+	auto source = reactor.add (pipe.fds[0]);
+
+	pipe.write ({ 1, 2, 3 });
+	pipe.write ({ 4, 5 });
+
+	auto const data = take_until (*source, [] (Blob const& data) { return data.size() >= 5; });
+	test_asserts::verify ("all data is received in order", data == Blob { 1, 2, 3, 4, 5 });
+	test_asserts::verify ("source didn't fail", !source->failed());
+
+	IOReactor::Chunks chunks;
+	source->take (chunks);
+	test_asserts::verify ("taken data is not returned again", chunks.empty());
+
+	pipe.close_write_end();
+	take_until (*source, [&] (Blob const&) { return source->failed(); });
+	test_asserts::verify ("end of file is detected", source->failed());
+});
+
+
+AutoTest t2 ("IOReactor: buffer overflow drops oldest data", []{
+	IOReactor reactor (g_logger);
+	Pipe pipe;
+	auto source = reactor.add (pipe.fds[0], 4);
+
+	// Each write is read with a separate read() call only if the previous one has been read entirely,
+	// so wait for that to get each write in a separate chunk:
+	for (uint8_t i = 0; i < 4; ++i)
+	{
+		pipe.write ({ i, i });
+		test_asserts::verify ("reactor reads the pipe", pipe.wait_until_read());
+	}
+
+	// Chunks are dropped after the last one is buffered, so when all expected data is dropped,
+	// the buffer is complete:
+	for (int i = 0; i < 1000 && source->dropped() < 4; ++i)
+		std::this_thread::sleep_for (std::chrono::milliseconds (1));
+
+	IOReactor::Chunks chunks;
+	source->take (chunks);
+	test_asserts::verify ("oldest chunks are dropped", source->dropped() == 4);
+	test_asserts::verify ("two most recent chunks are kept", chunks.size() == 2);
+	test_asserts::verify ("most recent chunks are kept", chunks[0].data == Blob { 2, 2 } && chunks[1].data == Blob { 3, 3 });
+	test_asserts::verify ("chunks are timestamped in order", chunks[0].timestamp <= chunks[1].timestamp);
+});
+
+} // namespace
+} // namespace xf::test
+
@@ -59,6 +59,7 @@ Xefis::Xefis (int& argc, char** argv):
 	Exception::log (_logger, [&] {
 		_system = std::make_unique<System> (_logger);
 		_graphics = std::make_unique<Graphics> (_logger);
+		_io_reactor = std::make_unique<IOReactor> (_logger);
 		_machine = ::xefis_machine (*this);
 		_configurator_widget = std::make_unique<ConfiguratorWidget> (*_machine, nullptr);
 
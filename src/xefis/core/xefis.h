@@ -34,6 +34,7 @@
 #include <xefis/config/all.h>
 #include <xefis/core/components/configurator/configurator_widget.h>
 #include <xefis/core/graphics.h>
+#include <xefis/core/io_reactor.h>
 #include <xefis/core/system.h>
 
 
@@ -142,6 +143,13 @@ class Xefis: public QApplication
 	Graphics&
 	graphics() const;
 
+	/**
+	 * Return IOReactor shared by device modules.
+	 */
+	[[nodiscard]]
+	IOReactor&
+	io_reactor() const;
+
 	/**
 	 * Return configurator widget.
 	 * May return nullptr, if configurator widget is disabled
@@ -205,6 +213,7 @@ class Xefis: public QApplication
 	std::unique_ptr<ConfiguratorWidget>	_configurator_widget;
 	std::unique_ptr<OptionsHelper>		_options_helper;
 	std::unique_ptr<Graphics>			_graphics;
+	std::unique_ptr<IOReactor>			_io_reactor;
 	std::unique_ptr<Machine>			_machine;
 };
 
@@ -273,6 +282,16 @@ Xefis::graphics() const
 }
 
 
+inline IOReactor&
+Xefis::io_reactor() const
+{
+	if (!_io_reactor)
+		throw UninitializedServiceException ("IOReactor");
+
+	return *_io_reactor.get();
+}
+
+
 inline ConfiguratorWidget&
 Xefis::configurator_widget() const
 {
@@ -13,14 +13,16 @@
 
 // Standard:
 #include <cstddef>
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <random>
+#include <set>
 
 // Lib:
 #include <boost/endian/conversion.hpp>
 
 // Neutrino:
-#include <neutrino/crypto/hmac.h>
 #include <neutrino/qt/qdom.h>
 #include <neutrino/qt/qdom_iterator.h>
 #include <neutrino/stdexcept.h>
@@ -54,6 +56,24 @@ LinkProtocol::Sequence::size() const
 }
 
 
+std::optional<Blob::size_type>
+LinkProtocol::Sequence::input_size (Blob::const_iterator begin, Blob::const_iterator end) const
+{
+	auto const available = static_cast<Blob::size_type> (std::distance (begin, end));
+	Blob::size_type s = 0;
+
+	for (auto const& packet: _packets)
+	{
+		if (auto const packet_size = packet->input_size (begin + std::min (s, available), end))
+			s += *packet_size;
+		else
+			return std::nullopt;
+	}
+
+	return s;
+}
+
+
 void
 LinkProtocol::Sequence::produce (Blob& blob)
 {
@@ -204,14 +224,169 @@ LinkProtocol::Bitfield::failsafe()
 }
 
 
+LinkProtocol::Delta::Delta (KeyframeEvery keyframe_every, FieldList fields):
+	_fields (fields),
+	_last_sent (_fields.size()),
+	_eaten (_fields.size(), false),
+	_mask_size ((_fields.size() + 7) / 8),
+	_keyframe_every (std::max<uint64_t> (*keyframe_every, 1))
+{ }
+
+
+Blob::size_type
+LinkProtocol::Delta::size() const
+{
+	Blob::size_type s = _mask_size;
+
+	for (auto const& field: _fields)
+		s += field.packet->size();
+
+	return s;
+}
+
+
+std::optional<Blob::size_type>
+LinkProtocol::Delta::input_size (Blob::const_iterator begin, Blob::const_iterator end) const
+{
+	auto const available = static_cast<Blob::size_type> (std::distance (begin, end));
+
+	if (available < _mask_size)
+		return std::nullopt;
+
+	Blob::size_type s = _mask_size;
+
+	for (std::size_t i = 0; i < _fields.size(); ++i)
+	{
+		if (present (begin, i))
+		{
+			if (auto const field_size = _fields[i].packet->input_size (begin + std::min (s, available), end))
+				s += *field_size;
+			else
+				return std::nullopt;
+		}
+	}
+
+	return s;
+}
+
+
+void
+LinkProtocol::Delta::produce (Blob& blob)
+{
+	bool const keyframe = _send_pos % _keyframe_every == 0;
+	auto const mask_pos = blob.size();
+
+	++_send_pos;
+	blob.resize (blob.size() + _mask_size, 0);
+
+	for (std::size_t i = 0; i < _fields.size(); ++i)
+	{
+		auto const& field = _fields[i];
+		auto const field_pos = blob.size();
+
+		// Serialize directly into the output and drop the data if it's not needed:
+		field.packet->produce (blob);
+
+		auto const field_begin = blob.begin() + field_pos;
+		auto& last_sent = _last_sent[i];
+		bool const send = field.changed
+			? field.changed (keyframe)
+			: keyframe || !std::equal (field_begin, blob.end(), last_sent.begin(), last_sent.end());
+
+		if (send)
+		{
+			if (!field.changed)
+				last_sent.assign (field_begin, blob.end());
+
+			blob[mask_pos + i / 8] |= 1u << (i % 8);
+		}
+		else
+			blob.resize (field_pos);
+	}
+}
+
+
+Blob::const_iterator
+LinkProtocol::Delta::eat (Blob::const_iterator begin, Blob::const_iterator end)
+{
+	if (std::distance (begin, end) < static_cast<Blob::difference_type> (_mask_size))
+		throw InsufficientDataError();
+
+	auto const mask = begin;
+
+	// Bits past the last field must be zero:
+	for (std::size_t i = _fields.size(); i < 8 * _mask_size; ++i)
+		if (present (mask, i))
+			throw ParseError();
+
+	begin += _mask_size;
+
+	for (std::size_t i = 0; i < _fields.size(); ++i)
+	{
+		_eaten[i] = present (mask, i);
+
+		if (_eaten[i])
+			begin = _fields[i].packet->eat (begin, end);
+	}
+
+	return begin;
+}
+
+
+void
+LinkProtocol::Delta::apply()
+{
+	// Fields not present in the packet retain values received earlier:
+	for (std::size_t i = 0; i < _fields.size(); ++i)
+		if (_eaten[i])
+			_fields[i].packet->apply();
+}
+
+
+void
+LinkProtocol::Delta::failsafe()
+{
+	for (auto const& field: _fields)
+		field.packet->failsafe();
+}
+
+
 LinkProtocol::Signature::Signature (NonceBytes nonce_bytes, SignatureBytes signature_bytes, Key key, PacketList packets):
+	Signature (SignatureAlgorithm::HMACSHA1, nonce_bytes, signature_bytes, key, packets)
+{ }
+
+
+LinkProtocol::Signature::Signature (SignatureAlgorithm algorithm, NonceBytes nonce_bytes, SignatureBytes signature_bytes, Key key, PacketList packets):
 	Sequence (packets),
+	_algorithm (algorithm),
 	_nonce_bytes (*nonce_bytes),
 	_signature_bytes (*signature_bytes),
 	_key (*key),
 	_rng (std::random_device{}())
 {
-	_temp.reserve (size());
+	switch (_algorithm)
+	{
+		case SignatureAlgorithm::HMACSHA1:
+			if (_signature_bytes > xf::HMACSHA1::kResultSize)
+				throw xf::InvalidArgument ("HMAC-SHA1 signature can't be longer than 20 bytes");
+
+			_hmac_sha1.emplace (_key.data(), _key.size());
+			break;
+
+		case SignatureAlgorithm::SipHash24:
+		{
+			if (_key.size() != xf::SipHash::kKeySize)
+				throw xf::InvalidArgument ("SipHash signature requires a 16-byte key");
+
+			if (_signature_bytes > xf::SipHash::kResultSize)
+				throw xf::InvalidArgument ("SipHash signature can't be longer than 8 bytes");
+
+			xf::SipHash::Key siphash_key;
+			std::copy (_key.begin(), _key.end(), siphash_key.begin());
+			_siphash.emplace (siphash_key);
+			break;
+		}
+	}
 }
 
 
@@ -222,60 +397,90 @@ LinkProtocol::Signature::size() const
 }
 
 
+std::optional<Blob::size_type>
+LinkProtocol::Signature::input_size (Blob::const_iterator begin, Blob::const_iterator end) const
+{
+	if (auto const data_size = Sequence::input_size (begin, end))
+		return *data_size + _nonce_bytes + _signature_bytes;
+	else
+		return std::nullopt;
+}
+
+
 void
 LinkProtocol::Signature::produce (Blob& blob)
 {
-	_temp.clear();
+	auto const start = blob.size();
 
 	// Add data:
-	Sequence::produce (_temp);
+	Sequence::produce (blob);
 
 	// Append nonce:
 	std::uniform_int_distribution<uint8_t> dist;
 
 	for (unsigned int i = 0; i < _nonce_bytes; ++i)
-		_temp.push_back (dist (_rng));
-
-	xf::HMAC hmac (xf::HMAC::Key (_key), _temp, xf::Hash::SHA1);
-
-	// Add some of the bytes of HMAC signature:
-	size_t hmac_bytes = std::min<size_t> (_signature_bytes, std::distance (hmac.begin(), hmac.end()));
-	_temp.insert (_temp.end(), hmac.begin(), hmac.begin() + hmac_bytes);
+		blob.push_back (dist (_rng));
 
-	// Output:
-	blob.insert (blob.end(), _temp.begin(), _temp.end());
+	// Append signature computed directly over the output blob:
+	auto const signed_size = blob.size() - start;
+	blob.resize (blob.size() + _signature_bytes);
+	compute_mac (blob.data() + start, signed_size, blob.data() + start + signed_size);
 }
 
 
 Blob::const_iterator
 LinkProtocol::Signature::eat (Blob::const_iterator begin, Blob::const_iterator end)
 {
-	auto const data_size = Sequence::size();
-	auto const whole_size = size();
+	auto const data_size = Sequence::input_size (begin, end);
+
+	if (!data_size)
+		throw InsufficientDataError();
+
+	auto const whole_size = *data_size + _nonce_bytes + _signature_bytes;
 
 	if (std::distance (begin, end) < static_cast<Blob::difference_type> (whole_size))
 		throw InsufficientDataError();
 
-	auto const sign_begin = begin + data_size + _nonce_bytes;
+	auto const sign_begin = begin + *data_size + _nonce_bytes;
 	auto const sign_end = begin + whole_size;
 
-	// Make a temporary copy of the data:
-	_temp.resize (data_size + _nonce_bytes);
-	std::copy (begin, sign_begin, _temp.begin());
-
-	xf::HMAC hmac (xf::HMAC::Key (_key), _temp, xf::Hash::SHA1);
+	// Verify in place, without copying the signed data:
+	std::array<uint8_t, 256> mac;
+	compute_mac (&*begin, std::distance (begin, sign_begin), mac.data());
 
-	// If HMACs differ, that's a parsing error:
-	if (!std::equal (sign_begin, sign_end, hmac.begin()))
+	// If MACs differ, that's a parsing error:
+	if (!std::equal (sign_begin, sign_end, mac.begin()))
 		throw ParseError();
 
-	if (Sequence::eat (begin, begin + data_size) != begin + data_size)
+	if (Sequence::eat (begin, begin + *data_size) != begin + *data_size)
 		throw ParseError();
 
 	return begin + whole_size;
 }
 
 
+void
+LinkProtocol::Signature::compute_mac (uint8_t const* data, std::size_t size, uint8_t* output)
+{
+	switch (_algorithm)
+	{
+		case SignatureAlgorithm::HMACSHA1:
+		{
+			auto const mac = (*_hmac_sha1) (data, size);
+			std::copy (mac.begin(), mac.begin() + _signature_bytes, output);
+			break;
+		}
+
+		case SignatureAlgorithm::SipHash24:
+		{
+			auto const mac = (*_siphash) (data, size);
+			std::copy (mac.begin(), mac.begin() + _signature_bytes, output);
+			break;
+		}
+	}
+}
+
+
 LinkProtocol::Envelope::Envelope (Magic magic, PacketList packets):
 	Sequence (packets),
 	_magic (*magic)
@@ -324,13 +529,22 @@ LinkProtocol::LinkProtocol (EnvelopeList envelopes):
 	{
 		_magic_size = _envelopes[0]->magic().size();
 
+		if (_magic_size == 0)
+			throw InvalidMagicSize();
+
+		std::set<uint8_t> first_bytes;
+
 		for (auto const& e: _envelopes)
 		{
 			if (e->magic().size() != _magic_size)
 				throw InvalidMagicSize();
 
-			_envelope_magics[e->magic()] = e;
+			_magic_first_bytes[e->magic()[0]] = true;
+			first_bytes.insert (e->magic()[0]);
 		}
+
+		if (first_bytes.size() == 1)
+			_common_magic_first_byte = *first_bytes.begin();
 	}
 }
 
@@ -354,86 +568,110 @@ LinkProtocol::eat (Blob::const_iterator begin, Blob::const_iterator end, LinkIO*
 	logger << "Recv: " << to_string (Blob (begin, end)) << std::endl;
 #endif
 
-	_aux_magic_buffer.resize (_magic_size);
+	int64_t error_bytes = 0;
+
+	// Called on each run of invalid bytes, not on each invalid byte:
+	auto const skip_invalid_bytes = [&] (Blob::const_iterator const next) {
+		error_bytes += std::distance (begin, next);
+		begin = next;
+
+		// Since there was an error, stop the reacquire timer:
+		if (reacquire_timer)
+			reacquire_timer->stop();
+	};
 
 	while (std::distance (begin, end) > static_cast<Blob::difference_type> (_magic_size + 1))
 	{
-		auto skip_byte_and_retry = [&]() {
-			// Skip one byte and try again:
-			if (std::distance (begin, end) >= 1)
-				++begin;
+		auto* const envelope = find_envelope (begin);
 
-			if (io)
-				io->link_error_bytes = io->link_error_bytes.value_or (0) + 1;
+		// If magic not found, resynchronize on the next byte that can start a magic string:
+		if (!envelope)
+		{
+			skip_invalid_bytes (find_magic_candidate (begin + 1, end));
+			continue;
+		}
+
+		// Now see if we have enough data in input buffer for this envelope type.
+		// If not, return and retry when enough data is read. Envelopes containing Delta packets
+		// have variable size that's known only after reading some of their data.
+		auto const envelope_size = envelope->input_size (begin + _magic_size, end);
 
-			// Since there was an error, stop the reacquire timer:
-			if (reacquire_timer)
-				reacquire_timer->stop();
-		};
+		if (!envelope_size || static_cast<Blob::size_type> (std::distance (begin, end)) - _magic_size < *envelope_size)
+			break;
 
-		bool return_from_outer_function = false;
-		Blob::const_iterator outer_result = begin;
+		std::optional<Blob::const_iterator> envelope_end;
 
 		xf::Exception::catch_and_log (logger, [&] {
 			try {
-				// Find the right magic and envelope:
-				std::copy (begin, begin + _magic_size, _aux_magic_buffer.begin());
-				auto envelope_and_magic = _envelope_magics.find (_aux_magic_buffer);
-
-				// If not found, retry starting with next byte:
-				if (envelope_and_magic == _envelope_magics.end())
-					throw LinkProtocol::ParseError();
-
-				auto envelope = envelope_and_magic->second;
-				// Now see if we have enough data in input buffer for this envelope type.
-				// If not, return and retry when enough data is read.
-				if (static_cast<Blob::size_type> (std::distance (begin, end)) - _magic_size < envelope->size())
-				{
-					return_from_outer_function = true;
-					outer_result = begin;
-					return;
-				}
-
-				auto e = envelope->eat (begin + _magic_size, end);
-
-				if (e != begin)
-				{
-					envelope->apply();
-					begin = e;
-				}
-
-				if (io)
-					io->link_valid_envelopes = io->link_valid_envelopes.value_or (0) + 1;
-
-				// Restart failsafe timer:
-				if (failsafe_timer)
-					failsafe_timer->start();
-
-				// If link is not valid, and we got valid envelope,
-				// start reacquire timer:
-				if (reacquire_timer && io)
-					if (!io->link_valid.value_or (false) && !reacquire_timer->isActive())
-						reacquire_timer->start();
+				envelope_end = envelope->eat (begin + _magic_size, end);
 			}
 			catch (LinkProtocol::ParseError&)
 			{
-				skip_byte_and_retry();
-			}
-			catch (...)
-			{
-				skip_byte_and_retry();
-				throw;
+				// Invalid envelope (eg. wrong signature), treat it as noise.
 			}
 		});
 
-		if (return_from_outer_function)
-			return outer_result;
+		if (!envelope_end)
+		{
+			skip_invalid_bytes (begin + 1);
+			continue;
+		}
+
+		envelope->apply();
+		begin = *envelope_end;
+
+		if (io)
+			io->link_valid_envelopes = io->link_valid_envelopes.value_or (0) + 1;
+
+		// Restart failsafe timer:
+		if (failsafe_timer)
+			failsafe_timer->start();
+
+		// If link is not valid, and we got valid envelope,
+		// start reacquire timer:
+		if (reacquire_timer && io)
+			if (!io->link_valid.value_or (false) && !reacquire_timer->isActive())
+				reacquire_timer->start();
 	}
 
+	if (io && error_bytes > 0)
+		io->link_error_bytes = io->link_error_bytes.value_or (0) + error_bytes;
+
 	return begin;
 }
 
 
+LinkProtocol::Envelope*
+LinkProtocol::find_envelope (Blob::const_iterator const begin) const
+{
+	if (!_magic_first_bytes[*begin])
+		return nullptr;
+
+	for (auto const& envelope: _envelopes)
+		if (std::equal (envelope->magic().begin(), envelope->magic().end(), begin))
+			return envelope.get();
+
+	return nullptr;
+}
+
+
+Blob::const_iterator
+LinkProtocol::find_magic_candidate (Blob::const_iterator const begin, Blob::const_iterator const end) const
+{
+	if (begin >= end)
+		return end;
+
+	// memchr() is vectorized by the C library:
+	if (_common_magic_first_byte)
+	{
+		auto const* const found = static_cast<uint8_t const*> (std::memchr (&*begin, *_common_magic_first_byte, std::distance (begin, end)));
+		return found ? begin + (found - &*begin) : end;
+	}
+	else
+		return std::find_if (begin, end, [this] (uint8_t const byte) { return _magic_first_bytes[byte]; });
+}
+
+
 Blob::size_type
 LinkProtocol::size() const
 {
@@ -16,6 +16,9 @@
 
 // Standard:
 #include <cstddef>
+#include <array>
+#include <cmath>
+#include <cstring>
 #include <memory>
 #include <random>
 #include <vector>
@@ -24,6 +27,8 @@
 #include <functional>
 #include <type_traits>
 #include <initializer_list>
+#include <tuple>
+#include <utility>
 
 // Qt:
 #include <QtCore/QTimer>
@@ -40,6 +45,8 @@
 #include <xefis/core/module_io.h>
 #include <xefis/core/property.h>
 #include <xefis/core/setting.h>
+#include <xefis/support/crypto/hmac_sha1.h>
+#include <xefis/support/crypto/siphash.h>
 #include <xefis/utility/actions.h>
 #include <xefis/utility/types.h>
 
@@ -65,6 +72,18 @@ class LinkProtocol
 	using Retained			= xf::StrongType<bool, struct RetainedType>;
 	using NonceBytes		= xf::StrongType<uint8_t, struct NonceBytesType>;
 	using SignatureBytes	= xf::StrongType<uint8_t, struct SignatureBytesType>;
+	using KeyframeEvery		= xf::StrongType<std::size_t, struct KeyframeEveryType>;
+
+	/**
+	 * MAC algorithm used by Signature packets.
+	 */
+	enum class SignatureAlgorithm
+	{
+		// HMAC with SHA-1, up to 20 bytes of signature:
+		HMACSHA1,
+		// SipHash-2-4, much faster, up to 8 bytes of signature, requires 16-byte key:
+		SipHash24,
+	};
 
 	/**
 	 * Thrown on known parse errors.
@@ -108,6 +127,15 @@ class LinkProtocol
 		virtual Blob::size_type
 		size() const = 0;
 
+		/**
+		 * Return size of the data that will be consumed by eat() from given input.
+		 * Return std::nullopt if there's not enough input to tell. Only variable-size packets
+		 * need to override this; for them size() returns the maximum size.
+		 */
+		virtual std::optional<Blob::size_type>
+		input_size (Blob::const_iterator, Blob::const_iterator) const
+			{ return size(); }
+
 		/**
 		 * Serialize data and add it to the blob.
 		 */
@@ -149,6 +177,9 @@ class LinkProtocol
 		Blob::size_type
 		size() const override;
 
+		std::optional<Blob::size_type>
+		input_size (Blob::const_iterator, Blob::const_iterator) const override;
+
 		void
 		produce (Blob&) override;
 
@@ -213,6 +244,14 @@ class LinkProtocol
 				explicit
 				Property (xf::Property<Value>&, Retained retained, std::optional<Value> offset = {});
 
+			/**
+			 * Return the property that's transmitted.
+			 */
+			[[nodiscard]]
+			xf::Property<Value> const&
+			property() const noexcept
+				{ return _property; }
+
 			Blob::size_type
 			size() const override;
 
@@ -256,6 +295,138 @@ class LinkProtocol
 										_eat;
 		};
 
+	/**
+	 * Type used to serialize Value on the wire.
+	 */
+	template<class Value, std::size_t Bytes, bool = std::is_integral_v<Value>>
+		struct FlatWireType
+		{
+			using Type = xf::int_for_width_t<Bytes>;
+		};
+
+	template<class Value, std::size_t Bytes>
+		struct FlatWireType<Value, Bytes, false>
+		{
+			using Type = ne::float_for_width_t<Bytes>;
+		};
+
+	/**
+	 * Property with size known at compile time, to be used in a FlatSequence.
+	 * Wire format is the same as of the Property packet.
+	 */
+	template<uint8_t pBytes, class pValue>
+		class FlatProperty
+		{
+		  public:
+			using Value = pValue;
+
+			static constexpr std::size_t kBytes { pBytes };
+
+			static_assert ((std::is_integral<Value>() &&
+							(kBytes == 1 || kBytes == 2 || kBytes == 4 || kBytes == 8)) ||
+						   ((std::is_floating_point<Value>() || si::is_quantity<Value>()) &&
+							(kBytes == 2 || kBytes == 4 || kBytes == 8)));
+
+		  private:
+			using WireType = typename FlatWireType<Value, kBytes>::Type;
+
+		  public:
+			/**
+			 * Ctor for integrals
+			 * See Property for the description of parameters.
+			 */
+			template<class U = Value>
+				requires (std::is_integral_v<U>)
+				explicit
+				FlatProperty (xf::Property<Value>&, Retained retained, Value fallback_value);
+
+			/**
+			 * Ctor for floating-point values and SI values
+			 * See Property for the description of parameters.
+			 */
+			template<class U = Value>
+				requires (std::is_floating_point_v<U> || si::is_quantity_v<U>)
+				explicit
+				FlatProperty (xf::Property<Value>&, Retained retained, std::optional<Value> offset = {});
+
+			/**
+			 * Write kBytes bytes of serialized property value.
+			 */
+			void
+			encode (uint8_t* output) const;
+
+			/**
+			 * Read kBytes bytes and store the value until apply() is called.
+			 */
+			void
+			decode (uint8_t const* input);
+
+			void
+			apply();
+
+			void
+			failsafe();
+
+		  private:
+			xf::Property<Value>&		_property;
+			xf::PropertyOut<Value>*		_property_out;
+			si::decay_quantity_t<Value>	_fallback_value {};
+			std::optional<Value>		_value;
+			bool						_retained;
+			std::optional<Value>		_offset;
+		};
+
+	/**
+	 * A sequence of FlatProperties with layout computed at compile time.
+	 * Serializes/parses all fields at fixed offsets in a single call, without virtual calls or allocations
+	 * per field. Can be used anywhere a Packet can, eg. inside Signatures and Envelopes.
+	 */
+	template<class ...Fields>
+		class FlatSequence: public Packet
+		{
+		  public:
+			static constexpr std::size_t kSize { (Fields::kBytes + ... + 0) };
+
+			static constexpr std::array<std::size_t, sizeof... (Fields)> kOffsets = [] {
+				std::array<std::size_t, sizeof... (Fields)> offsets {};
+				std::size_t offset = 0;
+				std::size_t index = 0;
+				((offsets[index++] = offset, offset += Fields::kBytes), ...);
+				return offsets;
+			}();
+
+		  public:
+			// Ctor
+			explicit
+			FlatSequence (Fields ...fields);
+
+			Blob::size_type
+			size() const override;
+
+			void
+			produce (Blob&) override;
+
+			Blob::const_iterator
+			eat (Blob::const_iterator, Blob::const_iterator) override;
+
+			void
+			apply() override;
+
+			void
+			failsafe() override;
+
+		  private:
+			/**
+			 * Call function (field, offset) for each field.
+			 */
+			template<class Function, std::size_t ...Index>
+				void
+				for_each_field (Function&&, std::index_sequence<Index...>);
+
+		  private:
+			std::tuple<Fields...> _fields;
+		};
+
 	/**
 	 * An packet that contains boolean or limited-width integers.
 	 * Refers to multiple boolean/integer Properties.
@@ -302,6 +473,67 @@ class LinkProtocol
 		Blob::size_type				_size;
 	};
 
+	/**
+	 * A packet that transmits only those of its fields that changed since they were last sent.
+	 * Fields are preceded by a bitmask telling which of them are present. Every Nth packet is a keyframe
+	 * that contains all fields, so that receiver resynchronizes after lost packets.
+	 * Wire size varies; size() returns the size of a keyframe.
+	 */
+	class Delta: public Packet
+	{
+	  public:
+		struct Field
+		{
+			std::shared_ptr<Packet>				packet;
+			// Called on the transmitting side with force = true on keyframes. Returns true if field needs to be sent.
+			// If not set, field is sent whenever its serialized data changes:
+			std::function<bool (bool force)>	changed;
+		};
+
+		using FieldList = std::initializer_list<Field>;
+
+	  public:
+		// Ctor
+		explicit
+		Delta (KeyframeEvery, FieldList);
+
+		Blob::size_type
+		size() const override;
+
+		std::optional<Blob::size_type>
+		input_size (Blob::const_iterator, Blob::const_iterator) const override;
+
+		void
+		produce (Blob&) override;
+
+		Blob::const_iterator
+		eat (Blob::const_iterator, Blob::const_iterator) override;
+
+		void
+		apply() override;
+
+		void
+		failsafe() override;
+
+	  private:
+		/**
+		 * Return true if field's bit is set in the presence bitmask starting at given position.
+		 */
+		static bool
+		present (Blob::const_iterator mask, std::size_t field_index)
+			{ return (mask[field_index / 8] >> (field_index % 8)) & 1; }
+
+	  private:
+		std::vector<Field>	_fields;
+		// Serialized data of fields when they were last sent (for fields without change functions):
+		std::vector<Blob>	_last_sent;
+		// Fields present in the last eaten packet:
+		std::vector<bool>	_eaten;
+		Blob::size_type		_mask_size;
+		uint64_t			_keyframe_every	= 1;
+		uint64_t			_send_pos		= 0;
+	};
+
 	/**
 	 * A packet that adds or verifies simple digital signature of the contained
 	 * packets.
@@ -312,12 +544,20 @@ class LinkProtocol
 	class Signature: public Sequence
 	{
 	  public:
+		// Ctor
 		explicit
 		Signature (NonceBytes, SignatureBytes, Key, PacketList);
 
+		// Ctor
+		explicit
+		Signature (SignatureAlgorithm, NonceBytes, SignatureBytes, Key, PacketList);
+
 		Blob::size_type
 		size() const override;
 
+		std::optional<Blob::size_type>
+		input_size (Blob::const_iterator, Blob::const_iterator) const override;
+
 		void
 		produce (Blob&) override;
 
@@ -325,11 +565,21 @@ class LinkProtocol
 		eat (Blob::const_iterator, Blob::const_iterator) override;
 
 	  private:
-		uint8_t			_nonce_bytes		{ 0 };
-		uint8_t			_signature_bytes	{ 0 };
-		Blob			_key;
-		std::mt19937	_rng;
-		Blob			_temp;
+		/**
+		 * Compute MAC of given data and write first _signature_bytes of it to output.
+		 */
+		void
+		compute_mac (uint8_t const* data, std::size_t size, uint8_t* output);
+
+	  private:
+		SignatureAlgorithm			_algorithm;
+		uint8_t						_nonce_bytes		{ 0 };
+		uint8_t						_signature_bytes	{ 0 };
+		Blob						_key;
+		// Key schedules prepared once:
+		std::optional<xf::HMACSHA1>	_hmac_sha1;
+		std::optional<xf::SipHash>	_siphash;
+		std::mt19937				_rng;
 	};
 
 	/**
@@ -410,6 +660,34 @@ class LinkProtocol
 			return std::make_shared<Property<Bytes, Value>> (property, retained, std::optional<Value> (offset));
 		}
 
+	template<size_t Bytes, class Value, class = std::enable_if_t<std::is_integral_v<Value>>>
+		static auto
+		flat_property (xf::Property<Value>& property, Retained retained, Value fallback_value)
+		{
+			return FlatProperty<Bytes, Value> (property, retained, fallback_value);
+		}
+
+	template<size_t Bytes, class Value, class = std::enable_if_t<std::is_floating_point_v<Value> || si::is_quantity_v<Value>>>
+		static auto
+		flat_property (xf::Property<Value>& property, Retained retained)
+		{
+			return FlatProperty<Bytes, Value> (property, retained);
+		}
+
+	template<size_t Bytes, class Value, class Offset, class = std::enable_if_t<std::is_floating_point_v<Value> || si::is_quantity_v<Value>>>
+		static auto
+		flat_property (xf::Property<Value>& property, Retained retained, Offset offset)
+		{
+			return FlatProperty<Bytes, Value> (property, retained, std::optional<Value> (offset));
+		}
+
+	template<class ...Fields>
+		static auto
+		flat_sequence (Fields&& ...fields)
+		{
+			return std::make_shared<FlatSequence<std::remove_cvref_t<Fields>...>> (std::forward<Fields> (fields)...);
+		}
+
 	static auto
 	bitfield (std::initializer_list<Bitfield::SourceVariant>&& properties)
 	{
@@ -442,6 +720,50 @@ class LinkProtocol
 		return std::make_shared<Signature> (nonce_bytes, signature_bytes, key, std::forward<PacketList> (packets));
 	}
 
+	static auto
+	signature (SignatureAlgorithm algorithm, NonceBytes nonce_bytes, SignatureBytes signature_bytes, Key key, PacketList&& packets)
+	{
+		return std::make_shared<Signature> (algorithm, nonce_bytes, signature_bytes, key, std::forward<PacketList> (packets));
+	}
+
+	static auto
+	delta (KeyframeEvery keyframe_every, Delta::FieldList&& fields)
+	{
+		return std::make_shared<Delta> (keyframe_every, std::forward<Delta::FieldList> (fields));
+	}
+
+	/**
+	 * Delta field sent whenever its serialized data changes.
+	 */
+	static Delta::Field
+	delta_field (std::shared_ptr<Packet> packet)
+	{
+		return { std::move (packet), nullptr };
+	}
+
+	/**
+	 * Delta field sent when property value differs by more than threshold from the value last sent,
+	 * or when it becomes nil or non-nil.
+	 */
+	template<uint8_t Bytes, class Value, class Threshold>
+		static Delta::Field
+		delta_field (std::shared_ptr<Property<Bytes, Value>> packet, Threshold threshold)
+		{
+			auto changed = [&property = packet->property(), threshold = Value (threshold), last_sent = std::optional<Value>()] (bool const force) mutable {
+				auto const value = property.get_optional();
+				bool const send = force
+					|| value.has_value() != last_sent.has_value()
+					|| (value && (*value > *last_sent ? *value - *last_sent : *last_sent - *value) > threshold);
+
+				if (send)
+					last_sent = value;
+
+				return send;
+			};
+
+			return { std::move (packet), changed };
+		}
+
 	static auto
 	envelope (Magic magic, PacketList&& packets)
 	{
@@ -465,11 +787,26 @@ class LinkProtocol
 	static constexpr bool
 	fits_in_bits (uint_least64_t value, Bits bits);
 
+	/**
+	 * Return envelope which magic string starts at given position or nullptr.
+	 * There must be at least _magic_size bytes available.
+	 */
+	Envelope*
+	find_envelope (Blob::const_iterator begin) const;
+
+	/**
+	 * Return position of the first byte that can start one of the magic strings or end.
+	 */
+	Blob::const_iterator
+	find_magic_candidate (Blob::const_iterator begin, Blob::const_iterator end) const;
+
   private:
 	std::vector<std::shared_ptr<Envelope>>		_envelopes;
-	std::map<Blob, std::shared_ptr<Envelope>>	_envelope_magics;
 	Blob::size_type								_magic_size			{ 0 };
-	Blob										_aux_magic_buffer;
+	// True for bytes that start any of the magic strings:
+	std::array<bool, 256>						_magic_first_bytes	{};
+	// Set if all magic strings start with the same byte:
+	std::optional<uint8_t>						_common_magic_first_byte;
 };
 
 
@@ -729,6 +1066,201 @@ template<uint8_t B, class V>
 		}
 
 
+template<uint8_t B, class V>
+	template<class U>
+		requires (std::is_integral_v<U>)
+		inline
+		LinkProtocol::FlatProperty<B, V>::FlatProperty (xf::Property<Value>& property, Retained retained, Value fallback_value):
+			_property (property),
+			_property_out (dynamic_cast<xf::PropertyOut<Value>*> (&property)),
+			_fallback_value (fallback_value),
+			_retained (*retained)
+		{ }
+
+
+template<uint8_t B, class V>
+	template<class U>
+		requires (std::is_floating_point_v<U> || si::is_quantity_v<U>)
+		inline
+		LinkProtocol::FlatProperty<B, V>::FlatProperty (xf::Property<Value>& property, Retained retained, std::optional<Value> offset):
+			_property (property),
+			_property_out (dynamic_cast<xf::PropertyOut<Value>*> (&property)),
+			_fallback_value (std::numeric_limits<decltype (_fallback_value)>::quiet_NaN()),
+			_retained (*retained),
+			_offset (offset)
+		{ }
+
+
+template<uint8_t B, class V>
+	inline void
+	LinkProtocol::FlatProperty<B, V>::encode (uint8_t* output) const
+	{
+		WireType casted;
+
+		if constexpr (std::is_integral<Value>())
+		{
+			int64_t const int_value = _property
+				? *_property
+				: _fallback_value;
+
+			casted = static_cast<WireType> (int_value);
+		}
+		else if constexpr (si::is_quantity<Value>())
+		{
+			typename Value::Value const value = _property
+				? _offset
+					? (*_property - *_offset).base_value()
+					: (*_property).base_value()
+				: _fallback_value;
+
+			casted = static_cast<WireType> (value);
+		}
+		else if constexpr (std::is_floating_point<Value>())
+		{
+			Value const value = _property
+				? _offset
+					? *_property - *_offset
+					: *_property
+				: _fallback_value;
+
+			casted = static_cast<WireType> (value);
+		}
+
+		// Same byte order as Property::serialize():
+		boost::endian::native_to_little (casted);
+		std::memcpy (output, &casted, sizeof (casted));
+	}
+
+
+template<uint8_t B, class V>
+	inline void
+	LinkProtocol::FlatProperty<B, V>::decode (uint8_t const* input)
+	{
+		WireType casted;
+		std::memcpy (&casted, input, sizeof (casted));
+		boost::endian::little_to_native (casted);
+
+		if constexpr (std::is_integral<Value>())
+			_value = casted;
+		else
+		{
+			if (std::isnan (casted))
+				_value.reset();
+			else if constexpr (si::is_quantity<Value>())
+				_value = Value { casted };
+			else if constexpr (std::is_floating_point<Value>())
+				_value = casted;
+		}
+	}
+
+
+template<uint8_t B, class V>
+	inline void
+	LinkProtocol::FlatProperty<B, V>::apply()
+	{
+		if (_property_out)
+		{
+			if (_value)
+			{
+				if constexpr (std::is_integral<Value>())
+					*_property_out = _value;
+				else
+				{
+					*_property_out = _offset
+						? *_value + *_offset
+						: *_value;
+				}
+			}
+			else if (!_retained)
+				*_property_out = xf::nil;
+		}
+	}
+
+
+template<uint8_t B, class V>
+	inline void
+	LinkProtocol::FlatProperty<B, V>::failsafe()
+	{
+		if (_property_out && !_retained)
+			*_property_out = xf::nil;
+	}
+
+
+template<class ...F>
+	inline
+	LinkProtocol::FlatSequence<F...>::FlatSequence (F ...fields):
+		_fields (std::move (fields)...)
+	{ }
+
+
+template<class ...F>
+	inline Blob::size_type
+	LinkProtocol::FlatSequence<F...>::size() const
+	{
+		return kSize;
+	}
+
+
+template<class ...F>
+	inline void
+	LinkProtocol::FlatSequence<F...>::produce (Blob& blob)
+	{
+		auto const start = blob.size();
+		blob.resize (start + kSize);
+		uint8_t* const output = blob.data() + start;
+
+		for_each_field ([output] (auto& field, std::size_t offset) {
+			field.encode (output + offset);
+		}, std::index_sequence_for<F...>());
+	}
+
+
+template<class ...F>
+	inline Blob::const_iterator
+	LinkProtocol::FlatSequence<F...>::eat (Blob::const_iterator begin, Blob::const_iterator end)
+	{
+		if (std::distance (begin, end) < static_cast<Blob::difference_type> (kSize))
+			throw InsufficientDataError();
+
+		uint8_t const* const input = &*begin;
+
+		for_each_field ([input] (auto& field, std::size_t offset) {
+			field.decode (input + offset);
+		}, std::index_sequence_for<F...>());
+
+		return begin + kSize;
+	}
+
+
+template<class ...F>
+	inline void
+	LinkProtocol::FlatSequence<F...>::apply()
+	{
+		for_each_field ([] (auto& field, std::size_t) {
+			field.apply();
+		}, std::index_sequence_for<F...>());
+	}
+
+
+template<class ...F>
+	inline void
+	LinkProtocol::FlatSequence<F...>::failsafe()
+	{
+		for_each_field ([] (auto& field, std::size_t) {
+			field.failsafe();
+		}, std::index_sequence_for<F...>());
+	}
+
+
+template<class ...F>
+	template<class Function, std::size_t ...Index>
+		inline void
+		LinkProtocol::FlatSequence<F...>::for_each_field (Function&& function, std::index_sequence<Index...>)
+		{
+			(function (std::get<Index> (_fields), kOffsets[Index]), ...);
+		}
+
+
 constexpr bool
 LinkProtocol::fits_in_bits (uint_least64_t value, Bits bits)
 {
@@ -13,6 +13,8 @@
 
 // Standard:
 #include <cstddef>
+#include <chrono>
+#include <random>
 
 // Neutrino:
 #include <neutrino/test/auto_test.h>
@@ -113,6 +115,99 @@ class GCS_Rx_LinkProtocol: public LinkProtocol
 };
 
 
+/**
+ * Envelope made of runtime Property packets.
+ */
+class RuntimeSchemaLinkProtocol: public LinkProtocol
+{
+  public:
+	// Ctor
+	template<class IO>
+		explicit
+		RuntimeSchemaLinkProtocol (IO* io):
+			LinkProtocol ({
+				envelope (Magic ({ 0x5a, 0x11 }), {
+					property<8> (io->nil_prop,					Retained (false)),
+					property<4> (io->angle_prop,				Retained (false)),
+					property<2> (io->velocity_prop,				Retained (false)),
+					property<2> (io->velocity_prop_offset,		Retained (false),	1000_kph),
+					property<2> (io->int_prop,					Retained (false),	0L),
+					property<1> (io->uint_prop,					Retained (true),	0UL),
+				}),
+			})
+		{ }
+};
+
+
+/**
+ * The same envelope as RuntimeSchemaLinkProtocol, but made with FlatSequence.
+ */
+class FlatSchemaLinkProtocol: public LinkProtocol
+{
+  public:
+	// Ctor
+	template<class IO>
+		explicit
+		FlatSchemaLinkProtocol (IO* io):
+			LinkProtocol ({
+				envelope (Magic ({ 0x5a, 0x11 }), {
+					flat_sequence (
+						flat_property<8> (io->nil_prop,				Retained (false)),
+						flat_property<4> (io->angle_prop,			Retained (false)),
+						flat_property<2> (io->velocity_prop,		Retained (false)),
+						flat_property<2> (io->velocity_prop_offset,	Retained (false),	1000_kph),
+						flat_property<2> (io->int_prop,				Retained (false),	0L),
+						flat_property<1> (io->uint_prop,			Retained (true),	0UL)
+					),
+				}),
+			})
+		{ }
+};
+
+
+class SipHashLinkProtocol: public LinkProtocol
+{
+  public:
+	// Ctor
+	template<class IO>
+		explicit
+		SipHashLinkProtocol (IO* io):
+			LinkProtocol ({
+				envelope (Magic ({ 0x7e, 0x31 }), {
+					signature (SignatureAlgorithm::SipHash24, NonceBytes (4), SignatureBytes (8),
+							   Key ({ 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff }), {
+						property<8> (io->angle_prop,	Retained (false)),
+						property<2> (io->int_prop,		Retained (false),	0L),
+					}),
+				}),
+			})
+		{ }
+};
+
+
+class DeltaLinkProtocol: public LinkProtocol
+{
+  public:
+	// Ctor
+	template<class IO>
+		explicit
+		DeltaLinkProtocol (IO* io):
+			LinkProtocol ({
+				envelope (Magic ({ 0x3c, 0x0d }), {
+					signature (SignatureAlgorithm::SipHash24, NonceBytes (2), SignatureBytes (4),
+							   Key ({ 0x0f, 0x1e, 0x2d, 0x3c, 0x4b, 0x5a, 0x69, 0x78, 0x87, 0x96, 0xa5, 0xb4, 0xc3, 0xd2, 0xe1, 0xf0 }), {
+						delta (KeyframeEvery (4), {
+							delta_field (property<4> (io->angle_prop,		Retained (false)),		0.01_rad),
+							delta_field (property<2> (io->velocity_prop,	Retained (false)),		1_kph),
+							delta_field (property<2> (io->int_prop,			Retained (false),	0L)),
+						}),
+					}),
+				}),
+			})
+		{ }
+};
+
+
 void transmit (LinkProtocol& tx_protocol, LinkProtocol& rx_protocol)
 {
 	Blob blob;
@@ -351,6 +446,207 @@ AutoTest t5 ("modules/io/link: protocol: send-every/send-offset", []{
 	test_asserts::verify ("last envelope sent for the second time", *rx_io.dummy == kSecondInt);
 });
 
+
+AutoTest t6 ("modules/io/link: protocol: resynchronization after noise", []{
+	GCS_Tx_LinkIO tx_io;
+	Aircraft_Rx_LinkIO rx_io;
+	GCS_Tx_LinkProtocol tx_protocol (&tx_io);
+	GCS_Tx_LinkProtocol rx_protocol (&rx_io);
+	std::mt19937 rng (1);
+	std::uniform_int_distribution<unsigned int> random_byte (0, 255);
+	Blob input;
+
+	auto const receive = [&] {
+		auto const end = rx_protocol.eat (input.begin(), input.end(), &rx_io, nullptr, nullptr, g_logger);
+		input.erase (input.cbegin(), end);
+	};
+
+	for (int64_t i = 0; i < 100; ++i)
+	{
+		tx_io.int_prop << xf::ConstantSource (i);
+
+		for (int k = 0; k < 50; ++k)
+			input.push_back (static_cast<uint8_t> (random_byte (rng)));
+
+		tx_protocol.produce (input, g_logger);
+		receive();
+	}
+
+	// Noise might have contained beginning of a magic string, which waits for more data.
+	// Valid envelopes must get through anyway:
+	for (int k = 0; k < 3; ++k)
+	{
+		tx_protocol.produce (input, g_logger);
+		receive();
+	}
+
+	test_asserts::verify ("envelopes after noise are received", *rx_io.int_prop == 99);
+	test_asserts::verify ("most envelopes get through the noise", rx_io.link_valid_envelopes.value_or (0) >= 200);
+	test_asserts::verify ("noise is counted as error bytes", rx_io.link_error_bytes.value_or (0) > 0);
+});
+
+
+AutoTest t7 ("modules/io/link: protocol: noise parsing benchmark", []{
+	constexpr std::size_t kNoiseBytes = 16 * 1024 * 1024;
+
+	Aircraft_Rx_LinkIO rx_io;
+	GCS_Tx_LinkProtocol rx_protocol (&rx_io);
+	std::mt19937 rng (1);
+	std::uniform_int_distribution<unsigned int> random_byte (0, 255);
+	Blob noise (kNoiseBytes);
+
+	for (auto& byte: noise)
+		byte = static_cast<uint8_t> (random_byte (rng));
+
+	auto const start = std::chrono::steady_clock::now();
+	auto const end = rx_protocol.eat (noise.begin(), noise.end(), &rx_io, nullptr, nullptr, g_logger);
+	std::chrono::duration<double> const duration = std::chrono::steady_clock::now() - start;
+
+	g_logger << "Link noise parsing: " << (kNoiseBytes / duration.count() / 1024 / 1024) << " MiB/s" << std::endl;
+	test_asserts::verify ("all noise is consumed except for possible beginning of an envelope", std::distance (end, noise.cend()) < 1024);
+});
+
+
+AutoTest t8 ("modules/io/link: protocol: flat sequences match runtime schema", []{
+	GCS_Tx_LinkIO tx_io;
+	Aircraft_Rx_LinkIO runtime_rx_io;
+	Aircraft_Rx_LinkIO flat_rx_io;
+	RuntimeSchemaLinkProtocol runtime_tx_protocol (&tx_io);
+	FlatSchemaLinkProtocol flat_tx_protocol (&tx_io);
+	RuntimeSchemaLinkProtocol runtime_rx_protocol (&runtime_rx_io);
+	FlatSchemaLinkProtocol flat_rx_protocol (&flat_rx_io);
+
+	static_assert (FlatSchemaLinkProtocol::FlatSequence<
+		FlatSchemaLinkProtocol::FlatProperty<8, si::Angle>,
+		FlatSchemaLinkProtocol::FlatProperty<2, int64_t>,
+		FlatSchemaLinkProtocol::FlatProperty<1, uint64_t>
+	>::kOffsets == std::array<std::size_t, 3> { 0, 8, 10 });
+
+	test_asserts::verify ("sizes are equal", runtime_tx_protocol.size() == flat_tx_protocol.size());
+
+	auto const test = [&] {
+		Blob runtime_blob;
+		Blob flat_blob;
+		runtime_tx_protocol.produce (runtime_blob, g_logger);
+		flat_tx_protocol.produce (flat_blob, g_logger);
+		test_asserts::verify ("flat sequence produces the same bytes as runtime packets", runtime_blob == flat_blob);
+
+		// Cross-parse:
+		flat_rx_protocol.eat (runtime_blob.begin(), runtime_blob.end(), nullptr, nullptr, nullptr, g_logger);
+		runtime_rx_protocol.eat (flat_blob.begin(), flat_blob.end(), nullptr, nullptr, nullptr, g_logger);
+
+		test_asserts::verify ("nil_prop parsed the same way", flat_rx_io.nil_prop.get_optional() == runtime_rx_io.nil_prop.get_optional());
+		test_asserts::verify ("angle_prop parsed the same way", flat_rx_io.angle_prop.get_optional() == runtime_rx_io.angle_prop.get_optional());
+		test_asserts::verify ("velocity_prop parsed the same way", flat_rx_io.velocity_prop.get_optional() == runtime_rx_io.velocity_prop.get_optional());
+		test_asserts::verify ("velocity_prop_offset parsed the same way", flat_rx_io.velocity_prop_offset.get_optional() == runtime_rx_io.velocity_prop_offset.get_optional());
+		test_asserts::verify ("int_prop parsed the same way", flat_rx_io.int_prop.get_optional() == runtime_rx_io.int_prop.get_optional());
+		test_asserts::verify ("uint_prop parsed the same way", flat_rx_io.uint_prop.get_optional() == runtime_rx_io.uint_prop.get_optional());
+	};
+
+	test();
+
+	tx_io.angle_prop << xf::ConstantSource (1.25_rad);
+	tx_io.velocity_prop << xf::ConstantSource (101_kph);
+	tx_io.velocity_prop_offset << xf::ConstantSource (1001_kph);
+	tx_io.uint_prop << xf::ConstantSource (200u);
+
+	for (auto i: { -300, -1, 0, 1, 7, 32000 })
+	{
+		tx_io.int_prop << xf::ConstantSource (i);
+		test();
+	}
+
+	test_asserts::verify_equal_with_epsilon ("velocity transmitted properly", *flat_rx_io.velocity_prop_offset, 1001_kph, 0.1_kph);
+});
+
+
+AutoTest t9 ("modules/io/link: protocol: SipHash signatures", []{
+	GCS_Tx_LinkIO tx_io;
+	Aircraft_Rx_LinkIO rx_io;
+	SipHashLinkProtocol tx_protocol (&tx_io);
+	SipHashLinkProtocol rx_protocol (&rx_io);
+
+	tx_io.angle_prop << xf::ConstantSource (0.5_rad);
+	tx_io.int_prop << xf::ConstantSource (-7);
+	transmit (tx_protocol, rx_protocol);
+	test_asserts::verify ("angle_prop transmitted properly", *rx_io.angle_prop == 0.5_rad);
+	test_asserts::verify ("int_prop transmitted properly", *rx_io.int_prop == -7);
+
+	tx_io.int_prop << xf::ConstantSource (5);
+
+	Blob blob;
+	tx_protocol.produce (blob, g_logger);
+	test_asserts::verify ("envelope has expected size", blob.size() == 2 + 8 + 2 + 4 + 8);
+	// Corrupt the payload:
+	blob[3] ^= 0x01;
+	rx_protocol.eat (blob.begin(), blob.end(), nullptr, nullptr, nullptr, g_logger);
+	test_asserts::verify ("corrupted envelope is rejected", *rx_io.int_prop == -7);
+});
+
+
+AutoTest t10 ("modules/io/link: protocol: delta encoding", []{
+	GCS_Tx_LinkIO tx_io;
+	Aircraft_Rx_LinkIO rx_io;
+	DeltaLinkProtocol tx_protocol (&tx_io);
+	DeltaLinkProtocol rx_protocol (&rx_io);
+
+	auto const transmit_and_measure = [&] {
+		Blob blob;
+		tx_protocol.produce (blob, g_logger);
+		auto const end = rx_protocol.eat (blob.begin(), blob.end(), nullptr, nullptr, nullptr, g_logger);
+		test_asserts::verify ("rx_protocol ate all input bytes", end == blob.end());
+		return blob.size();
+	};
+
+	// Magic + mask + nonce + signature:
+	constexpr std::size_t kOverhead = 2 + 1 + 2 + 4;
+
+	tx_io.angle_prop << xf::ConstantSource (1_rad);
+	tx_io.velocity_prop << xf::ConstantSource (100_kph);
+	tx_io.int_prop << xf::ConstantSource (3);
+
+	test_asserts::verify ("keyframe contains all fields", transmit_and_measure() == kOverhead + 4 + 2 + 2);
+	test_asserts::verify ("angle_prop transmitted properly", *rx_io.angle_prop == 1_rad);
+	test_asserts::verify ("int_prop transmitted properly", *rx_io.int_prop == 3);
+
+	test_asserts::verify ("unchanged fields are not sent", transmit_and_measure() == kOverhead);
+
+	tx_io.angle_prop << xf::ConstantSource (1.005_rad);
+	test_asserts::verify ("changes below threshold are not sent", transmit_and_measure() == kOverhead);
+	test_asserts::verify ("receiver retains value", *rx_io.angle_prop == 1_rad);
+
+	tx_io.angle_prop << xf::ConstantSource (1.5_rad);
+	tx_io.int_prop << xf::ConstantSource (4);
+	test_asserts::verify ("changed fields are sent", transmit_and_measure() == kOverhead + 4 + 2);
+	test_asserts::verify ("angle_prop updated", *rx_io.angle_prop == 1.5_rad);
+	test_asserts::verify ("int_prop updated", *rx_io.int_prop == 4);
+	test_asserts::verify_equal_with_epsilon ("velocity_prop retained", *rx_io.velocity_prop, 100_kph, 1_kph);
+
+	test_asserts::verify ("next keyframe contains all fields", transmit_and_measure() == kOverhead + 4 + 2 + 2);
+});
+
+
+AutoTest t11 ("modules/io/link: protocol: signatures longer than MAC are rejected", []{
+	using SignatureAlgorithm = LinkProtocol::SignatureAlgorithm;
+
+	auto const rejected = [] (SignatureAlgorithm algorithm, uint8_t signature_bytes) {
+		try {
+			[[maybe_unused]] LinkProtocol::Signature const signature (algorithm, LinkProtocol::NonceBytes (0), LinkProtocol::SignatureBytes (signature_bytes),
+																	  LinkProtocol::Key (Blob (16, 0x42)), {});
+		}
+		catch (xf::InvalidArgument const&)
+		{
+			return true;
+		}
+
+		return false;
+	};
+
+	test_asserts::verify ("20-byte HMAC-SHA1 signature is accepted", !rejected (SignatureAlgorithm::HMACSHA1, 20));
+	test_asserts::verify ("21-byte HMAC-SHA1 signature is rejected", rejected (SignatureAlgorithm::HMACSHA1, 21));
+	test_asserts::verify ("9-byte SipHash signature is rejected", rejected (SignatureAlgorithm::SipHash24, 9));
+});
+
 } // namespace
 } // namespace xf::test
 
@@ -536,62 +536,24 @@ ArtificialHorizon::paint_pitch_scale (AdiPaintRequest& pr) const
 
 		pr.painter.setPen (pr.aids.get_pen (Qt::white, 1.f));
 
-		// 10° lines, exclude +/-90°:
-		for (int deg = -90; deg <= 90; deg += 10)
-		{
-			if (deg_range.includes (1_deg * deg) && deg != 0)
-			{
-				float const d = pr.pitch_to_px (1_deg * deg);
-				pr.painter.paint (get_shadow (pr, deg), [&] {
-					pr.painter.drawLine (QPointF (-z, d), QPointF (z, d));
-				});
-				// Degs number:
-				int const abs_deg = std::abs (deg);
-				QString const deg_t = QString::number (abs_deg > 90 ? 180 - abs_deg : abs_deg);
-				//// Text:
-				QRectF const lbox (-z - 4.25f * fpxs, d - 0.5f * fpxs, 4.f * fpxs, fpxs);
-				QRectF const rbox (+z + 0.25f * fpxs, d - 0.5f * fpxs, 4.f * fpxs, fpxs);
-				pr.painter.fast_draw_text (lbox, Qt::AlignVCenter | Qt::AlignRight, deg_t, pr.default_shadow);
-				pr.painter.fast_draw_text (rbox, Qt::AlignVCenter | Qt::AlignLeft, deg_t, pr.default_shadow);
-			}
-		}
+		// Each line with its labels is a cached sprite drawn with the horizon transform:
+		QRectF const line_bounds (-z - 4.5f * fpxs, -fpxs, 2.f * z + 9.f * fpxs, 2.f * fpxs);
 
-		// 5° lines:
-		for (int deg = -90; deg <= 90; deg += 5)
+		for (int decidegrees = -900; decidegrees <= 900; decidegrees += 25)
 		{
-			if (deg_range.includes (1_deg * deg) && deg % 10 != 0)
+			if (decidegrees != 0 && deg_range.includes (1_deg * decidegrees / 10.f))
 			{
-				float const d = pr.pitch_to_px (1_deg * deg);
-				pr.painter.paint (get_shadow (pr, deg), [&] {
-					pr.painter.drawLine (QPointF (-z / 2.f, d), QPointF (z / 2.f, d));
-				});
-			}
-		}
+				auto const layer_id = kPitchLineLayers + static_cast<std::size_t> (decidegrees + 900);
 
-		// 2.5° lines:
-		for (int deg = -900; deg <= 900; deg += 25)
-		{
-			if (deg_range.includes (1_deg * deg / 10) && deg % 50 != 0)
-			{
-				float const d = pr.pitch_to_px (1_deg * deg / 10.f);
-				pr.painter.paint (get_shadow (pr, deg), [&] {
-					pr.painter.drawLine (QPointF (-z / 4.f, d), QPointF (z / 4.f, d));
+				pr.painter.setTransform (_horizon_transform);
+				pr.painter.translate (0.f, pr.pitch_to_px (1_deg * decidegrees / 10.f));
+				_layers.paint (pr.painter, pr.paint_request.metric(), layer_id, line_bounds, 0, [&] (xf::InstrumentPainter& painter) {
+					paint_pitch_line (pr, painter, decidegrees);
 				});
 			}
 		}
 
-		// -90°, 90° lines:
-		if (deg_range.includes (-90_deg) || deg_range.includes (+90_deg))
-		{
-			for (float deg: { -90.f, 90.f })
-			{
-				float const d = pr.pitch_to_px (1_deg * deg);
-				pr.painter.setPen (pr.aids.get_pen (Qt::white, 1.75f));
-				pr.painter.paint (get_shadow (pr, deg), [&] {
-					pr.painter.drawLine (QPointF (-z, d), QPointF (z, d));
-				});
-			}
-		}
+		pr.painter.setTransform (_horizon_transform);
 
 		// FPA bug:
 		if (pr.params.cmd_fpa)
@@ -627,39 +589,9 @@ ArtificialHorizon::paint_roll_scale (AdiPaintRequest& pr) const
 
 	pr.painter.setTransform (pr.precomputed.center_transform);
 	pr.painter.setClipRect (QRectF (-w, -w, 2.f * w, 2.25f * w));
-
-	for (float deg: { -60.f, -45.f, -30.f, -20.f, -10.f, 0.f, +10.f, +20.f, +30.f, +45.f, +60.f })
-	{
-		pr.painter.setTransform (pr.precomputed.center_transform);
-		pr.painter.rotate (1.f * deg);
-		pr.painter.translate (0.f, -0.795f * w);
-
-		if (deg == 0.f)
-		{
-			// Triangle:
-			QPointF const p0 (0.f, 0.f);
-			QPointF const px (0.025f * w, 0.f);
-			QPointF const py (0.f, 0.05f * w);
-			QPolygonF const poly ({ p0, p0 - px - py, p0 + px - py });
-
-			pr.painter.paint (pr.default_shadow, [&] {
-				pr.painter.drawPolygon (poly);
-			});
-		}
-		else
-		{
-			float length = -0.05f * w;
-
-			if (std::abs (std::fmod (deg, 60.f)) < 1.f)
-				length *= 1.6f;
-			else if (std::abs (std::fmod (deg, 30.f)) < 1.f)
-				length *= 2.2f;
-
-			pr.painter.paint (get_shadow (pr, deg), [&] {
-				pr.painter.drawLine (QPointF (0.f, 0.f), QPointF (0.f, length));
-			});
-		}
-	}
+	_layers.paint (pr.painter, pr.paint_request.metric(), kRollScaleLayer, QRectF (-w, -w, 2.f * w, w), 0, [&] (xf::InstrumentPainter& painter) {
+		paint_roll_ticks (pr, painter);
+	});
 
 	if (pr.params.orientation_roll)
 	{
@@ -928,6 +860,92 @@ ArtificialHorizon::get_shadow (AdiPaintRequest& pr, int degrees) const
 }
 
 
+void
+ArtificialHorizon::paint_pitch_line (AdiPaintRequest& pr, xf::InstrumentPainter& painter, int decidegrees) const
+{
+	float const w = pr.aids.lesser_dimension() * (2.0f / 9.0f);
+	float const z = 0.5f * w;
+	float const fpxs = pr.aids.font_1.font.pixelSize();
+	bool const zenith_or_nadir = std::abs (decidegrees) == 900;
+
+	painter.setPen (pr.aids.get_pen (Qt::white, zenith_or_nadir ? 1.75f : 1.f));
+	painter.setFont (pr.aids.scaled_default_font (1.2f));
+
+	// 10° lines:
+	if (decidegrees % 100 == 0)
+	{
+		painter.paint (get_shadow (pr, decidegrees), [&] {
+			painter.drawLine (QPointF (-z, 0.f), QPointF (z, 0.f));
+		});
+		// Degs number:
+		QString const deg_t = QString::number (std::abs (decidegrees) / 10);
+		//// Text:
+		QRectF const lbox (-z - 4.25f * fpxs, -0.5f * fpxs, 4.f * fpxs, fpxs);
+		QRectF const rbox (+z + 0.25f * fpxs, -0.5f * fpxs, 4.f * fpxs, fpxs);
+		painter.fast_draw_text (lbox, Qt::AlignVCenter | Qt::AlignRight, deg_t, pr.default_shadow);
+		painter.fast_draw_text (rbox, Qt::AlignVCenter | Qt::AlignLeft, deg_t, pr.default_shadow);
+	}
+	// 5° lines:
+	else if (decidegrees % 50 == 0)
+	{
+		painter.paint (get_shadow (pr, decidegrees), [&] {
+			painter.drawLine (QPointF (-z / 2.f, 0.f), QPointF (z / 2.f, 0.f));
+		});
+	}
+	// 2.5° lines:
+	else
+	{
+		painter.paint (get_shadow (pr, decidegrees), [&] {
+			painter.drawLine (QPointF (-z / 4.f, 0.f), QPointF (z / 4.f, 0.f));
+		});
+	}
+}
+
+
+void
+ArtificialHorizon::paint_roll_ticks (AdiPaintRequest& pr, xf::InstrumentPainter& painter) const
+{
+	float const w = pr.aids.lesser_dimension() * 3.f / 9.f;
+	QTransform const base = painter.transform();
+
+	painter.setPen (pr.aids.get_pen (Qt::white, 1.f));
+	painter.setBrush (QBrush (Qt::white));
+
+	for (float deg: { -60.f, -45.f, -30.f, -20.f, -10.f, 0.f, +10.f, +20.f, +30.f, +45.f, +60.f })
+	{
+		painter.setTransform (base);
+		painter.rotate (1.f * deg);
+		painter.translate (0.f, -0.795f * w);
+
+		if (deg == 0.f)
+		{
+			// Triangle:
+			QPointF const p0 (0.f, 0.f);
+			QPointF const px (0.025f * w, 0.f);
+			QPointF const py (0.f, 0.05f * w);
+			QPolygonF const poly ({ p0, p0 - px - py, p0 + px - py });
+
+			painter.paint (pr.default_shadow, [&] {
+				painter.drawPolygon (poly);
+			});
+		}
+		else
+		{
+			float length = -0.05f * w;
+
+			if (std::abs (std::fmod (deg, 60.f)) < 1.f)
+				length *= 1.6f;
+			else if (std::abs (std::fmod (deg, 30.f)) < 1.f)
+				length *= 2.2f;
+
+			painter.paint (get_shadow (pr, deg), [&] {
+				painter.drawLine (QPointF (0.f, 0.f), QPointF (0.f, length));
+			});
+		}
+	}
+}
+
+
 void
 VelocityLadder::paint (AdiPaintRequest& pr) const
 {
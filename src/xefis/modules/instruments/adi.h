@@ -33,6 +33,7 @@
 #include <xefis/core/property_observer.h>
 #include <xefis/core/setting.h>
 #include <xefis/core/xefis.h>
+#include <xefis/support/instrument/cached_layers.h>
 #include <xefis/support/instrument/instrument_support.h>
 #include <xefis/utility/event_timestamper.h>
 
@@ -582,6 +583,18 @@ class ArtificialHorizon
 	xf::Shadow
 	get_shadow (AdiPaintRequest&, int degrees) const;
 
+	/**
+	 * Paint pitch scale line for given angle (in tenths of degree) at y = 0.
+	 */
+	void
+	paint_pitch_line (AdiPaintRequest&, xf::InstrumentPainter&, int decidegrees) const;
+
+	/**
+	 * Paint static roll scale ticks with the center of the scale at 0, 0.
+	 */
+	void
+	paint_roll_ticks (AdiPaintRequest&, xf::InstrumentPainter&) const;
+
   private:
 	static QColor
 	get_darker_alpha (QColor color, int darker, int alpha)
@@ -597,6 +610,10 @@ class ArtificialHorizon
 	static inline QColor const	kGroundColor	{ QColor::fromHsv (34, 255, 125) };
 	static inline QColor const	kGroundShadow	{ get_darker_alpha (kGroundColor, 400, 127) };
 
+	// Layer IDs for _layers. Pitch lines use kPitchLineLayers + 900 + pitch angle in tenths of degree:
+	static constexpr std::size_t	kRollScaleLayer		= 0;
+	static constexpr std::size_t	kPitchLineLayers	= 1000;
+
   private:
 	xf::Synchronized<ArtificialHorizon*> mutable
 					_mutable_this { this };
@@ -612,6 +629,8 @@ class ArtificialHorizon
 	QPointF			_flight_path_marker_position;
 	QPainterPath	_old_horizon_clip;
 	QPainterPath	_pitch_scale_clipping_path;
+	xf::CachedLayers
+					_layers;
 };
 
 
@@ -17,6 +17,9 @@
 // Standard:
 #include <cstddef>
 #include <cmath>
+#include <functional>
+#include <optional>
+#include <type_traits>
 
 // Boost:
 #include <boost/format.hpp>
@@ -59,6 +62,13 @@ template<class Value>
 
 class BasicGauge
 {
+  public:
+	/**
+	 * Converts value to a number to display (eg. to different units).
+	 */
+	template<class Value>
+		using Converter = std::function<double (Value const&)>;
+
   protected:
 	/**
 	 * Normalized and preprocessed data trasferred to the painting object.
@@ -78,7 +88,7 @@ class BasicGauge
 
 	  public:
 		void
-		get_from (auto const& io, auto const& range, std::optional<float128_t> value);
+		get_from (auto const& io, auto const& range, std::optional<double> value);
 	};
 
   protected:
@@ -88,19 +98,27 @@ class BasicGauge
 	static inline		QColor const		kCriticalColor		{ 255, 35, 35 };
 
   protected:
+	/**
+	 * Return value of the property as a number to display, using native arithmetic of the Value type.
+	 * Avoids Property::to_floating_point(), which returns software-emulated float128_t.
+	 */
+	template<class Value>
+		static std::optional<double>
+		to_number (xf::PropertyIn<Value> const&, std::type_identity_t<Converter<Value>> const&);
+
 	static std::string
-	stringify (auto value, boost::format const& format, xf::Setting<int32_t> const& precision);
+	stringify (std::optional<double> value, boost::format const& format, xf::Setting<int32_t> const& precision);
 };
 
 
 inline void
-BasicGauge::GaugeValues::get_from (auto const& io, auto const& range, std::optional<float128_t> floating_point_value)
+BasicGauge::GaugeValues::get_from (auto const& io, auto const& range, std::optional<double> number)
 {
 	format = *io.format;
 
 	if (io.value)
 	{
-		value_str = BasicGauge::stringify (floating_point_value, *io.format, io.precision);
+		value_str = BasicGauge::stringify (number, *io.format, io.precision);
 		normalized_value = xf::renormalize (xf::clamped (*io.value, range), range, kNormalizedRange);
 	}
 
@@ -128,8 +146,23 @@ BasicGauge::GaugeValues::get_from (auto const& io, auto const& range, std::optio
 }
 
 
+template<class Value>
+	inline std::optional<double>
+	BasicGauge::to_number (xf::PropertyIn<Value> const& property, std::type_identity_t<Converter<Value>> const& converter)
+	{
+		if (!property)
+			return std::nullopt;
+		else if (converter)
+			return converter (*property);
+		else if constexpr (si::is_quantity<Value>())
+			return property->value();
+		else
+			return static_cast<double> (*property);
+	}
+
+
 inline std::string
-BasicGauge::stringify (auto value, boost::format const& format, xf::Setting<int32_t> const& precision)
+BasicGauge::stringify (std::optional<double> value, boost::format const& format, xf::Setting<int32_t> const& precision)
 {
 	if (value)
 	{
@@ -369,28 +369,47 @@ void
 PaintingWork::paint()
 {
 	paint_radio_range_map();
+	// Only functions that paint nothing but primitives with black shadow can use a shadowed layer.
+	// Others paint unshadowed elements (navaid symbols, texts, boxes, lines with their own shadow pens)
+	// or the compass rose which is already shadowed in its cached layer:
 	paint_navaids();
-	paint_flight_ranges();
+	paint_shadowed ([&] { paint_flight_ranges(); });
 	paint_altitude_reach();
 	paint_track (false);
 	paint_directions();
-	paint_track (true);
+	paint_shadowed ([&] { paint_track (true); });
 	paint_ap_settings();
 	paint_speeds_and_wind();
 	paint_home_direction();
 	paint_range();
 	paint_hints();
-	paint_trend_vector();
-	paint_tcas();
+	paint_shadowed ([&] {
+		paint_trend_vector();
+		paint_tcas();
+	});
 	paint_course();
 	paint_selected_navaid_info();
 	paint_tcas_and_navaid_info();
-	paint_pointers();
+	paint_shadowed ([&] { paint_pointers(); });
 	paint_aircraft();
 	paint_navperf();
 }
 
 
+void
+PaintingWork::paint_shadowed (std::function<void()> paint_function)
+{
+	if (_p.single_pass_shadows)
+	{
+		_painter.begin_shadowed_layer();
+		paint_function();
+		_painter.end_shadowed_layer (_c.black_shadow);
+	}
+	else
+		paint_function();
+}
+
+
 void
 PaintingWork::paint_aircraft()
 {
@@ -676,19 +695,44 @@ PaintingWork::paint_directions()
 	if (!_p.heading_magnetic || !_p.heading_true)
 		return;
 
-	QPen pen = _aids.get_pen (Qt::white, 1.f, Qt::SolidLine, Qt::RoundCap);
+	// Rose only rotates with heading, so it's painted once into a layer for each display mode:
+	QRectF const rose_bounds (-1.05f * _c.r, -1.05f * _c.r, 2.1f * _c.r, 2.1f * _c.r);
 
 	_painter.setTransform (_c.aircraft_center_transform);
 	_painter.setClipRect (_c.map_clip_rect);
-	_painter.setPen (pen);
-	_painter.setFont (_c.radials_font);
-	_painter.setBrush (Qt::NoBrush);
-
-	QTransform t = _rotation_transform * _c.aircraft_center_transform;
+	_painter.setTransform (_rotation_transform * _c.aircraft_center_transform);
+	_c.layers.paint (_painter, _paint_request.metric(), 0, rose_bounds, static_cast<std::size_t> (_p.display_mode), [&] (xf::InstrumentPainter& painter) {
+		paint_compass_rose (painter);
+	});
 
-	_painter.paint (_c.black_shadow, [&] (bool painting_shadow) {
+	if (_p.display_mode == hsi::DisplayMode::Rose)
+	{
+		_painter.setClipping (false);
+		_painter.setPen (_aids.get_pen (Qt::white, 1.f, Qt::SolidLine, Qt::RoundCap));
 		_painter.setTransform (_c.aircraft_center_transform);
+		// 8 lines around the circle:
+		for (int deg = 45; deg < 360; deg += 45)
+		{
+			_painter.rotate (45);
+			_painter.paint (_c.black_shadow, [&] {
+				_painter.drawLine (QPointF (0.f, -1.025f * _c.r), QPointF (0.f, -1.125f * _c.r));
+			});
+		}
+	}
+}
+
+
+void
+PaintingWork::paint_compass_rose (xf::InstrumentPainter& painter)
+{
+	QPen pen = _aids.get_pen (Qt::white, 1.f, Qt::SolidLine, Qt::RoundCap);
+	QTransform const t = painter.transform();
+
+	painter.setPen (pen);
+	painter.setFont (_c.radials_font);
+	painter.setBrush (Qt::NoBrush);
 
+	painter.paint (_c.black_shadow, [&] (bool painting_shadow) {
 		QPointF line_long;
 		QPointF line_short;
 		float radial_ypos;
@@ -709,36 +753,25 @@ PaintingWork::paint_directions()
 		for (int deg = 5; deg <= 360; deg += 5)
 		{
 			QPointF sp = deg % 10 == 0 ? line_long : line_short;
-			_painter.setTransform (t);
-			_painter.rotate (deg);
-			_painter.drawLine (QPointF (0.f, -_c.r + 0.025 * _c.q), sp);
+			painter.setTransform (t);
+			painter.rotate (deg);
+			painter.drawLine (QPointF (0.f, -_c.r + 0.025 * _c.q), sp);
 
 			if (!painting_shadow)
 			{
 				if (deg % 30 == 0)
-					_painter.fast_draw_text (QRectF (-_c.q, radial_ypos, 2.f * _c.q, 0.5f * _c.q),
-											 Qt::AlignVCenter | Qt::AlignHCenter, QString::number (deg / 10));
+					painter.fast_draw_text (QRectF (-_c.q, radial_ypos, 2.f * _c.q, 0.5f * _c.q),
+											Qt::AlignVCenter | Qt::AlignHCenter, QString::number (deg / 10));
 			}
 		}
 
 		// Circle around radials:
 		if (_p.display_mode == hsi::DisplayMode::Expanded)
-			_painter.drawEllipse (QRectF (-_c.r, -_c.r, 2.f * _c.r, 2.f * _c.r));
-	});
-
-	if (_p.display_mode == hsi::DisplayMode::Rose)
-	{
-		_painter.setClipping (false);
-		_painter.setTransform (_c.aircraft_center_transform);
-		// 8 lines around the circle:
-		for (int deg = 45; deg < 360; deg += 45)
 		{
-			_painter.rotate (45);
-			_painter.paint (_c.black_shadow, [&] {
-				_painter.drawLine (QPointF (0.f, -1.025f * _c.r), QPointF (0.f, -1.125f * _c.r));
-			});
+			painter.setTransform (t);
+			painter.drawEllipse (QRectF (-_c.r, -_c.r, 2.f * _c.r, 2.f * _c.r));
 		}
-	}
+	});
 }
 
 
@@ -2189,6 +2222,7 @@ HSI::process (xf::Cycle const& cycle)
 	params.trend_vector_min_ranges = *io.trend_vector_min_ranges;
 	params.trend_vector_max_range = *io.trend_vector_max_range;
 	params.radio_range_pattern_scale = *io.radio_range_pattern_scale;
+	params.single_pass_shadows = *io.single_pass_shadows;
 	params.round_clip = false;
 
 	if (io.flight_range_warning_longitude && io.flight_range_warning_latitude && io.flight_range_warning_radius)
@@ -17,6 +17,7 @@
 // Standard:
 #include <array>
 #include <cstddef>
+#include <functional>
 #include <future>
 
 // Neutrino:
@@ -30,6 +31,7 @@
 #include <xefis/core/setting.h>
 #include <xefis/core/xefis.h>
 #include <xefis/support/earth/navigation/navaid_storage.h>
+#include <xefis/support/instrument/cached_layers.h>
 #include <xefis/support/instrument/instrument_support.h>
 #include <xefis/utility/event_timestamper.h>
 #include <xefis/utility/temporal.h>
@@ -187,6 +189,8 @@ class HSI_IO: public xf::ModuleIO
 	xf::Setting<si::Length>					trend_vector_max_range					{ this, "trend_vector_max_range", 30_nmi };
 	// How big should be dots on the radio range heat map? 1.0 means 1x1 hardware pixel. Value 2…3 is recommended.
 	xf::Setting<double>						radio_range_pattern_scale				{ this, "radio_range_pattern_scale", 2.5 };
+	// Paint elements that have only black-shadowed primitives into layers and compute shadows from their alpha channel instead of painting each primitive twice:
+	xf::Setting<bool>						single_pass_shadows						{ this, "single_pass_shadows", false };
 
 	/*
 	 * Input
@@ -343,6 +347,7 @@ class Parameters
 	std::array<si::Length, 3>				trend_vector_min_ranges;
 	si::Length								trend_vector_max_range;
 	double									radio_range_pattern_scale;
+	bool									single_pass_shadows;
 	bool									round_clip								{ false };
 	std::optional<CircularArea>				flight_range_warning;
 	std::optional<CircularArea>				flight_range_critical;
@@ -390,6 +395,9 @@ struct ResizeCache
 	QPolygonF		ap_bug_shape;
 	xf::Shadow		black_shadow;
 	QImage			radio_range_heat_map;
+	// Pre-rendered compass rose:
+	xf::CachedLayers
+					layers;
 };
 
 
@@ -429,6 +437,13 @@ class PaintingWork
 	paint();
 
   private:
+	/**
+	 * Call paint function. If single-pass shadows are enabled, paint into a shadowed layer,
+	 * so everything painted by the function gets black shadow.
+	 */
+	void
+	paint_shadowed (std::function<void()>);
+
 	void
 	paint_aircraft();
 
@@ -444,6 +459,12 @@ class PaintingWork
 	void
 	paint_directions();
 
+	/**
+	 * Paint compass rose (not rotated) centered at 0, 0.
+	 */
+	void
+	paint_compass_rose (xf::InstrumentPainter&);
+
 	void
 	paint_track (bool paint_heading_triangle);
 
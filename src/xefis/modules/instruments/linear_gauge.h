@@ -115,7 +115,7 @@ template<class Value>
 		private BasicLinearGauge
 	{
 	  public:
-		using Converter = std::function<float128_t (Value const&)>;
+		using Converter = BasicGauge::Converter<Value>;
 
 	  public:
 		// Ctor
@@ -168,7 +168,7 @@ template<class Value>
 		xf::Range const range { *io.value_minimum, *io.value_maximum };
 
 		GaugeValues values;
-		values.get_from (io, range, (_converter && io.value) ? _converter (*io.value) : io.value.to_floating_point());
+		values.get_from (io, range, to_number (io.value, _converter));
 		values.mirrored_style = *io.mirrored_style;
 		values.line_hidden = *io.line_hidden;
 		values.font_scale = *io.font_scale;
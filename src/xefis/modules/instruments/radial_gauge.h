@@ -118,7 +118,7 @@ template<class Value>
 		private BasicRadialGauge
 	{
 	  public:
-		using Converter = std::function<float128_t (Value const&)>;
+		using Converter = BasicGauge::Converter<Value>;
 
 	  public:
 		// Ctor
@@ -173,13 +173,12 @@ template<class Value>
 		xf::Range const range { *io.value_minimum, *io.value_maximum };
 
 		GaugeValues values;
-		values.get_from (io, range, (_converter && io.value) ? _converter (*io.value) : io.value.to_floating_point());
+		values.get_from (io, range, to_number (io.value, _converter));
 		values.dial_scale = *io.dial_scale;
 
 		if (io.reference)
 		{
-			auto v = (_converter && io.reference) ? _converter (*io.reference) : io.reference.to_floating_point();
-			values.reference_str = BasicGauge::stringify (v, *io.format, io.precision);
+			values.reference_str = BasicGauge::stringify (to_number (io.reference, _converter), *io.format, io.precision);
 			values.normalized_reference = xf::renormalize (xf::clamped (*io.reference, range), range, kNormalizedRange);
 		}
 
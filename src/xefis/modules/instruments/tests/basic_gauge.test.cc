@@ -0,0 +1,106 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <chrono>
+
+// Neutrino:
+#include <neutrino/logger.h>
+#include <neutrino/test/auto_test.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/core/property.h>
+#include <xefis/modules/instruments/basic_gauge.h>
+
+
+namespace xf::test {
+namespace {
+
+xf::LoggerOutput g_logger_output (std::clog);
+xf::Logger g_logger (g_logger_output);
+
+
+class TestGaugeIO: public BasicGaugeIO<si::Force>
+{
+  public:
+	xf::PropertyIn<si::Force>	value	{ this, "value" };
+};
+
+
+/**
+ * Exposes protected parts of BasicGauge.
+ */
+class TestGauge: public BasicGauge
+{
+  public:
+	using BasicGauge::GaugeValues;
+	using BasicGauge::stringify;
+	using BasicGauge::to_number;
+};
+
+
+AutoTest t1 ("BasicGauge: GaugeValues computation benchmark", []{
+	constexpr std::size_t kIterations = 100'000;
+
+	TestGaugeIO io;
+	io.format = boost::format ("%5.2f");
+	io.value_minimum = 0_N;
+	io.value_maximum_warning = 4_N;
+	io.value_maximum = 4.5_N;
+	io.value << xf::ConstantSource (4.25_N);
+
+	xf::Range const range { *io.value_minimum, *io.value_maximum };
+	std::size_t checksum = 0;
+
+	auto const measure = [&] (auto&& get_values) {
+		auto const start = std::chrono::steady_clock::now();
+
+		for (std::size_t i = 0; i < kIterations; ++i)
+		{
+			TestGauge::GaugeValues values;
+			get_values (values);
+			checksum += values.value_str->size();
+		}
+
+		std::chrono::duration<double> const duration = std::chrono::steady_clock::now() - start;
+		return kIterations / duration.count();
+	};
+
+	TestGauge::GaugeValues values;
+	values.get_from (io, range, TestGauge::to_number (io.value, nullptr));
+	test_asserts::verify ("value is formatted", values.value_str == " 4.25");
+	test_asserts::verify ("value is normalized", values.normalized_value && std::abs (*values.normalized_value - 4.25f / 4.5f) < 1e-6f);
+	test_asserts::verify ("warning condition is detected", values.warning_condition && !values.critical_condition);
+
+	auto const native_rate = measure ([&] (TestGauge::GaugeValues& values) {
+		values.get_from (io, range, TestGauge::to_number (io.value, nullptr));
+	});
+
+	// Former path through Property::to_floating_point():
+	auto const float128_rate = measure ([&] (TestGauge::GaugeValues& values) {
+		values.get_from (io, range, std::nullopt);
+		values.value_str = (boost::format (*io.format) % *io.value.to_floating_point()).str();
+	});
+
+	auto const converted = TestGauge::to_number<si::Force> (io.value, [](si::Force force) { return force.in<si::Newton>() * 2.0; });
+	test_asserts::verify ("converter is used", converted && *converted == 8.5);
+	test_asserts::verify ("checksum", checksum == 2 * kIterations * values.value_str->size());
+
+	g_logger << "GaugeValues: native: " << native_rate << "/s, float128_t: " << float128_rate << "/s" << std::endl;
+});
+
+} // namespace
+} // namespace xf::test
+
@@ -87,6 +87,8 @@ CHRUM6::process (xf::Cycle const&)
 {
 	if (_sensor && _serial_port.good())
 	{
+		_sensor->process_timeouts();
+
 		// Earth acceleration = measured acceleration + centripetal acceleration.
 
 		if (_output_acceleration_x_changed() || _input_centripetal_x_changed())
@@ -172,7 +174,9 @@ CHRUM6::restart()
 void
 CHRUM6::status_check()
 {
-	_sensor->read (xf::CHRUM6::DataAddress::Status, std::bind (&CHRUM6::status_verify, this, std::placeholders::_1));
+	// Don't pile up status requests if UM6 responds slowly:
+	if (!_status_read || _status_read->finished())
+		_status_read = _sensor->read (xf::CHRUM6::DataAddress::Status, std::bind (&CHRUM6::status_verify, this, std::placeholders::_1));
 }
 
 
@@ -182,9 +186,37 @@ CHRUM6::initialize()
 	_logger << "Begin initialization." << std::endl;
 
 	_stage = Stage::Initialize;
+	_initialization_failed = false;
 	_initialization_timer->start();
 
+	// UM6 executes requests in order, so all of them can be sent at once without waiting for
+	// responses. If any fails, initialization_complete() will not be called and the initialization
+	// timer will trigger failure.
 	setup_communication();
+	setup_misc_config();
+	log_firmware_version();
+	set_ekf_process_variance();
+	reset_ekf();
+
+	if (_gyro_bias_xy)
+		restore_gyro_bias_xy();
+
+	if (_gyro_bias_xy && _gyro_bias_z)
+		restore_gyro_bias_z();
+	else
+		align_gyros();
+}
+
+
+bool
+CHRUM6::initialization_step_done (xf::CHRUM6::Request const& req)
+{
+	describe_errors (req);
+
+	if (!req.success())
+		_initialization_failed = true;
+
+	return !_initialization_failed;
 }
 
 
@@ -202,9 +234,7 @@ CHRUM6::setup_communication()
 	data |= xf::CHRUM6::sample_rate_setting (*io.sample_rate);
 
 	_sensor->write (ConfigurationAddress::Communication, data, [this] (xf::CHRUM6::Write req) {
-		describe_errors (req);
-		if (req.success())
-			setup_misc_config();
+		initialization_step_done (req);
 	});
 }
 
@@ -219,9 +249,7 @@ CHRUM6::setup_misc_config()
 	data |= static_cast<uint32_t> (xf::CHRUM6::MiscConfigRegister::QUAT);
 
 	_sensor->write (ConfigurationAddress::MiscConfig, data, [this] (xf::CHRUM6::Write req) {
-		describe_errors (req);
-		if (req.success())
-			log_firmware_version();
+		initialization_step_done (req);
 	});
 }
 
@@ -230,12 +258,8 @@ void
 CHRUM6::log_firmware_version()
 {
 	_sensor->command (CommandAddress::GetFWVersion, [this] (xf::CHRUM6::Command req) {
-		describe_errors (req);
-		if (req.success())
-		{
+		if (initialization_step_done (req))
 			_logger << "Firmware version: " << req.firmware_version() << std::endl;
-			set_ekf_process_variance();
-		}
 	});
 }
 
@@ -244,9 +268,7 @@ void
 CHRUM6::set_ekf_process_variance()
 {
 	_sensor->write (ConfigurationAddress::EKFProcessVariance, *io.ekf_process_variance, [this] (xf::CHRUM6::Write req) {
-		describe_errors (req);
-		if (req.success())
-			reset_ekf();
+		initialization_step_done (req);
 	});
 }
 
@@ -255,9 +277,7 @@ void
 CHRUM6::reset_ekf()
 {
 	_sensor->command (CommandAddress::ResetEKF, [this] (xf::CHRUM6::Command req) {
-		describe_errors (req);
-		if (req.success())
-			restore_gyro_bias_xy();
+		initialization_step_done (req);
 	});
 }
 
@@ -265,36 +285,23 @@ CHRUM6::reset_ekf()
 void
 CHRUM6::restore_gyro_bias_xy()
 {
-	if (_gyro_bias_xy)
-	{
-		_logger << "Restoring previously acquired gyro biases: XY" << std::endl;
+	_logger << "Restoring previously acquired gyro biases: XY" << std::endl;
 
-		_sensor->write (ConfigurationAddress::GyroBiasXY, *_gyro_bias_xy, [this] (xf::CHRUM6::Write req) {
-			describe_errors (req);
-			if (req.success())
-				restore_gyro_bias_z();
-		});
-	}
-	else
-		align_gyros();
+	_sensor->write (ConfigurationAddress::GyroBiasXY, *_gyro_bias_xy, [this] (xf::CHRUM6::Write req) {
+		initialization_step_done (req);
+	});
 }
 
 
 void
 CHRUM6::restore_gyro_bias_z()
 {
-	if (_gyro_bias_z)
-	{
-		_logger << "Restoring previously acquired gyro biases: Z" << std::endl;
+	_logger << "Restoring previously acquired gyro biases: Z" << std::endl;
 
-		_sensor->write (ConfigurationAddress::GyroBiasZ, *_gyro_bias_z, [this] (xf::CHRUM6::Write req) {
-			describe_errors (req);
-			if (req.success())
-				initialization_complete();
-		});
-	}
-	else
-		align_gyros();
+	_sensor->write (ConfigurationAddress::GyroBiasZ, *_gyro_bias_z, [this] (xf::CHRUM6::Write req) {
+		if (initialization_step_done (req))
+			initialization_complete();
+	});
 }
 
 
@@ -302,8 +309,7 @@ void
 CHRUM6::align_gyros()
 {
 	_sensor->command (CommandAddress::ZeroGyros, [this] (xf::CHRUM6::Command req) {
-		describe_errors (req);
-		if (req.success())
+		if (initialization_step_done (req))
 		{
 			_logger << "Gyros aligned." << std::endl;
 			initialization_complete();
@@ -341,6 +347,10 @@ CHRUM6::reset()
 	io.magnetic_z = xf::nil;
 
 	_stage = Stage::Initialize;
+	_status_read.reset();
+
+	if (_sensor)
+		_sensor->reset();
 }
 
 
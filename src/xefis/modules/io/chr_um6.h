@@ -162,6 +162,13 @@ class CHRUM6:
 	void
 	initialize();
 
+	/**
+	 * Log errors of an initialization request.
+	 * Return false if this or any previous initialization request has failed.
+	 */
+	bool
+	initialization_step_done (xf::CHRUM6::Request const&);
+
 	/**
 	 * Initialization chain: setup Communication register.
 	 */
@@ -193,13 +200,13 @@ class CHRUM6:
 	reset_ekf();
 
 	/**
-	 * Restore XY gyro biases after a failure.
+	 * Initialization chain: restore XY gyro biases after a failure.
 	 */
 	void
 	restore_gyro_bias_xy();
 
 	/**
-	 * Restore Z gyro bias after a failure.
+	 * Initialization chain: restore Z gyro bias after a failure.
 	 */
 	void
 	restore_gyro_bias_z();
@@ -270,6 +277,8 @@ class CHRUM6:
 	std::unique_ptr<xf::CHRUM6>			_sensor;
 	int									_failure_count						{ 0 };
 	Stage								_stage								{ Stage::Initialize };
+	bool								_initialization_failed				{ false };
+	std::optional<xf::CHRUM6::Read>		_status_read;
 	xf::PropChanged<si::Acceleration>	_input_centripetal_x_changed		{ io.centripetal_x };
 	xf::PropChanged<si::Acceleration>	_input_centripetal_y_changed		{ io.centripetal_y };
 	xf::PropChanged<si::Acceleration>	_input_centripetal_z_changed		{ io.centripetal_z };
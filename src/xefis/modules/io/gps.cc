@@ -14,6 +14,7 @@
 // Standard:
 #include <cstddef>
 #include <memory>
+#include <optional>
 #include <string>
 #include <ctime>
 
@@ -27,6 +28,7 @@
 #include <xefis/core/xefis.h>
 #include <xefis/support/protocols/nmea/parser.h>
 #include <xefis/support/protocols/nmea/mtk.h>
+#include <xefis/support/protocols/ubx/ubx.h>
 
 // Local:
 #include "gps.h"
@@ -109,6 +111,13 @@ void
 GPS::Connection::initialize_device()
 {
 	_gps_module.logger() << "Sending initialization commands." << std::endl;
+
+	if (*_gps_module.io.protocol == GPSProtocol::UBX)
+	{
+		_serial_port->write (get_ubx_setup_messages (_serial_port_config.baud_rate()));
+		return;
+	}
+
 	_serial_port->write (xf::nmea::make_mtk_sentence (get_nmea_frequencies_setup_messages (_serial_port_config.baud_rate())));
 	// Now send user setup commands:
 	for (auto const& s: *_gps_module.io.boot_pmtk_commands)
@@ -127,8 +136,15 @@ GPS::Connection::request_new_baud_rate (unsigned int baud_rate)
 	using namespace std::literals;
 
 	_gps_module.logger() << "Requesting baud-rate switch from " << _serial_port_config.baud_rate() << " to " << baud_rate << std::endl;
-	std::string set_baud_rate_message = xf::nmea::make_mtk_sentence (MTK_SET_NMEA_BAUDRATE + ","s + std::to_string (baud_rate));
-	_serial_port->write (set_baud_rate_message);
+
+	if (*_gps_module.io.protocol == GPSProtocol::UBX)
+		_serial_port->write (xf::ubx::make_cfg_prt_uart (baud_rate));
+	else
+	{
+		std::string set_baud_rate_message = xf::nmea::make_mtk_sentence (MTK_SET_NMEA_BAUDRATE + ","s + std::to_string (baud_rate));
+		_serial_port->write (set_baud_rate_message);
+	}
+
 	_serial_port->flush();
 	_serial_port->close();
 }
@@ -157,9 +173,24 @@ GPS::Connection::failure (std::string_view const& reason)
 void
 GPS::Connection::serial_data_ready()
 {
-	_nmea_parser.feed (_serial_port->input_buffer());
-	_serial_port->input_buffer().clear();
+	if (*_gps_module.io.protocol == GPSProtocol::UBX)
+	{
+		_ubx_parser.feed (_serial_port->input_buffer());
+		_serial_port->input_buffer().clear();
+		process_ubx_input();
+	}
+	else
+	{
+		_nmea_parser.feed (_serial_port->input_buffer());
+		_serial_port->input_buffer().clear();
+		process_nmea_input();
+	}
+}
+
 
+void
+GPS::Connection::process_nmea_input()
+{
 	bool try_next = true;
 
 	do {
@@ -178,15 +209,31 @@ GPS::Connection::serial_data_ready()
 				[&] (xf::nmea::GPRMC const& msg) {
 					process_nmea_sentence (msg);
 				},
+				[&] (xf::nmea::GPVTG const& msg) {
+					process_nmea_sentence (msg);
+				},
+				[&] (xf::nmea::GPGST const& msg) {
+					process_nmea_sentence (msg);
+				},
+				[&] (xf::nmea::GPZDA const& msg) {
+					process_nmea_sentence (msg);
+				},
 				[&] (xf::nmea::PMTKACK const& msg) {
 					process_nmea_sentence (msg);
 				},
 				[&] (std::monostate) noexcept {
 					try_next = false;
 				},
+				[&] (xf::nmea::ParseError error) {
+					_gps_module.io.read_errors = *_gps_module.io.read_errors + 1;
+
+					if (error == xf::nmea::ParseError::InputOverflow)
+						_gps_module.logger() << "NMEA input buffer overflow, dropped buffered data" << std::endl;
+				},
 			}, gps_message);
 
-			if (try_next)
+			// Garbage (eg. at wrong baud rate) doesn't prove that the device is alive:
+			if (try_next && !std::holds_alternative<xf::nmea::ParseError> (gps_message))
 				_alive_check_timer->start();
 		}
 		catch (...)
@@ -198,6 +245,37 @@ GPS::Connection::serial_data_ready()
 }
 
 
+void
+GPS::Connection::process_ubx_input()
+{
+	while (true)
+	{
+		auto const result = _ubx_parser.process_next();
+
+		if (auto const* frame = std::get_if<xf::ubx::Frame> (&result))
+		{
+			if (auto const pvt = xf::ubx::NavPVT::parse (*frame))
+				process_ubx_message (*pvt);
+			else if (auto const ack = xf::ubx::Ack::parse (*frame))
+				process_ubx_message (*ack);
+			else
+				continue;
+
+			_alive_check_timer->start();
+		}
+		else if (auto const* error = std::get_if<xf::ubx::ParseError> (&result))
+		{
+			_gps_module.io.read_errors = *_gps_module.io.read_errors + 1;
+
+			if (*error == xf::ubx::ParseError::InputOverflow)
+				_gps_module.logger() << "UBX input buffer overflow, dropped buffered data" << std::endl;
+		}
+		else
+			break;
+	}
+}
+
+
 void
 GPS::Connection::serial_failure()
 {
@@ -258,6 +336,10 @@ GPS::Connection::process_nmea_sentence (xf::nmea::GPGSA const& sentence)
 	_gps_module.io.vdop = sentence.vdop;
 	_gps_module.io.hdop = sentence.hdop;
 
+	// Don't overwrite errors reported by the device itself:
+	if (_last_gst_timestamp && xf::TimeHelper::now() - *_last_gst_timestamp < 1.5_s)
+		return;
+
 	if (sentence.hdop)
 		_gps_module.io.lateral_stddev = *_gps_module.io.receiver_accuracy * *sentence.hdop;
 	else
@@ -304,6 +386,50 @@ GPS::Connection::process_nmea_sentence (xf::nmea::GPRMC const& sentence)
 }
 
 
+void
+GPS::Connection::process_nmea_sentence (xf::nmea::GPVTG const& sentence)
+{
+	message_received();
+
+	_gps_module.io.ground_speed = sentence.ground_speed;
+	_gps_module.io.track_true = sentence.track_true;
+}
+
+
+void
+GPS::Connection::process_nmea_sentence (xf::nmea::GPGST const& sentence)
+{
+	message_received();
+
+	std::optional<si::Length> lateral_stddev;
+	std::optional<si::Length> position_stddev;
+
+	if (sentence.latitude_stddev && sentence.longitude_stddev)
+		lateral_stddev = std::max (*sentence.latitude_stddev, *sentence.longitude_stddev);
+
+	if (lateral_stddev && sentence.altitude_stddev)
+		position_stddev = std::max (*lateral_stddev, *sentence.altitude_stddev);
+
+	_gps_module.io.lateral_stddev = lateral_stddev;
+	_gps_module.io.vertical_stddev = sentence.altitude_stddev;
+	_gps_module.io.position_stddev = position_stddev;
+
+	if (lateral_stddev || sentence.altitude_stddev)
+		_last_gst_timestamp = xf::TimeHelper::now();
+}
+
+
+void
+GPS::Connection::process_nmea_sentence (xf::nmea::GPZDA const& sentence)
+{
+	message_received();
+
+	if (_gps_module._reliable_fix_quality)
+		if (sentence.date && sentence.time)
+			_gps_module.update_clock (*sentence.date, *sentence.time);
+}
+
+
 void
 GPS::Connection::process_nmea_sentence (xf::nmea::PMTKACK const& sentence)
 {
@@ -344,6 +470,64 @@ GPS::Connection::process_nmea_sentence (xf::nmea::PMTKACK const& sentence)
 }
 
 
+void
+GPS::Connection::process_ubx_message (xf::ubx::NavPVT const& pvt)
+{
+	message_received();
+
+	using xf::nmea::to_string;
+
+	bool const reliable_fix = pvt.reliable_fix();
+
+	if (reliable_fix)
+	{
+		_gps_module.io.fix_quality = to_string (pvt.differential ? xf::nmea::GPSFixQuality::DGPS : xf::nmea::GPSFixQuality::GPS);
+		_gps_module.io.fix_mode = pvt.fix_type == xf::ubx::FixType::Fix2D ? "2D" : "3D";
+		_gps_module.io.latitude = pvt.latitude;
+		_gps_module.io.longitude = pvt.longitude;
+		_gps_module.io.altitude_amsl = pvt.altitude_amsl;
+		_gps_module.io.geoid_height = pvt.height_above_ellipsoid - pvt.altitude_amsl;
+		_gps_module.io.ground_speed = pvt.ground_speed;
+		_gps_module.io.track_true = pvt.heading_of_motion;
+		_gps_module.io.pdop = pvt.pdop;
+		_gps_module.io.lateral_stddev = pvt.horizontal_accuracy;
+		_gps_module.io.vertical_stddev = pvt.vertical_accuracy;
+		_gps_module.io.position_stddev = std::max (pvt.horizontal_accuracy, pvt.vertical_accuracy);
+	}
+	else
+	{
+		_gps_module.reset_data_properties();
+		_gps_module.io.fix_quality = to_string (pvt.fix_type == xf::ubx::FixType::DeadReckoning ? xf::nmea::GPSFixQuality::Estimated : xf::nmea::GPSFixQuality::Invalid);
+	}
+
+	_gps_module.io.tracked_satellites = pvt.satellites;
+	_gps_module.io.magnetic_declination = pvt.magnetic_declination;
+	// NAV-PVT doesn't report horizontal and vertical DOPs:
+	_gps_module.io.hdop = xf::nil;
+	_gps_module.io.vdop = xf::nil;
+	_gps_module.io.dgps_station_id = xf::nil;
+	// Use system time as reference:
+	_gps_module.io.fix_system_timestamp = xf::TimeHelper::now();
+	_gps_module.io.fix_gps_timestamp = pvt.unix_time;
+	_gps_module._reliable_fix_quality = reliable_fix;
+
+	if (reliable_fix && pvt.unix_time)
+		_gps_module.update_clock (*pvt.unix_time);
+}
+
+
+void
+GPS::Connection::process_ubx_message (xf::ubx::Ack const& ack)
+{
+	message_received();
+
+	if (ack.acknowledged)
+		_gps_module.logger() << "Command result: " << to_string (ack.message) << ": OK" << std::endl;
+	else
+		_gps_module.logger() << "Command rejected: " << to_string (ack.message) << std::endl;
+}
+
+
 std::string
 GPS::Connection::get_nmea_frequencies_setup_messages (unsigned int baud_rate)
 {
@@ -414,6 +598,32 @@ GPS::Connection::get_nmea_frequencies_setup_messages (unsigned int baud_rate)
 }
 
 
+Blob
+GPS::Connection::get_ubx_setup_messages (unsigned int baud_rate)
+{
+	// NAV-PVT frame has 100 bytes, 10 bits per byte on the wire:
+	constexpr unsigned int kNavPVTBits = 10 * (xf::ubx::kHeaderSize + xf::ubx::NavPVT::kPayloadSize + xf::ubx::kChecksumSize);
+
+	// Leave some margin for ACKs and other occasional messages:
+	auto const max_rate = 0.8 * baud_rate / kNavPVTBits * 1_Hz;
+	auto rate = *_gps_module.io.navigation_rate;
+
+	if (rate > max_rate)
+	{
+		rate = max_rate;
+		_gps_module.logger() << "Navigation rate limited by baud rate to " << rate << std::endl;
+	}
+
+	// Make sure the output protocol is UBX (device may come up with NMEA output only):
+	Blob messages = xf::ubx::make_cfg_prt_uart (baud_rate);
+
+	for (auto const& message: { xf::ubx::make_cfg_rate (rate), xf::ubx::make_cfg_msg (xf::ubx::Message::NavPVT, 1) })
+		messages.insert (messages.end(), message.begin(), message.end());
+
+	return messages;
+}
+
+
 inline void
 GPS::Connection::message_received()
 {
@@ -597,18 +807,24 @@ GPS::reset_data_properties()
 }
 
 
+void
+GPS::update_clock (si::Time const unix_time)
+{
+	// Synchronize OS clock only once:
+	if (*io.synchronize_system_clock && !_clock_synchronized)
+	{
+		if (_system->set_clock (unix_time))
+			_logger << "System clock synchronized from GPS." << std::endl;
+		_clock_synchronized = true;
+	}
+}
+
+
 void
 GPS::update_clock (xf::nmea::GPSDate const& date, xf::nmea::GPSTimeOfDay const& time)
 {
 	try {
-		si::Time unix_time = xf::nmea::to_unix_time (date, time);
-		// Synchronize OS clock only once:
-		if (*io.synchronize_system_clock && !_clock_synchronized)
-		{
-			if (_system->set_clock (unix_time))
-				_logger << "System clock synchronized from GPS." << std::endl;
-			_clock_synchronized = true;
-		}
+		update_clock (xf::nmea::to_unix_time (date, time));
 	}
 	catch (xf::nmea::BadDateTime const& e)
 	{
@@ -18,6 +18,7 @@
 #include <cstddef>
 #include <array>
 #include <map>
+#include <optional>
 
 // Qt:
 #include <QtCore/QSocketNotifier>
@@ -33,12 +34,26 @@
 #include <xefis/core/setting.h>
 #include <xefis/core/system.h>
 #include <xefis/support/protocols/nmea/parser.h>
+#include <xefis/support/protocols/ubx/messages.h>
+#include <xefis/support/protocols/ubx/parser.h>
 
 
 namespace si = neutrino::si;
 using namespace neutrino::si::literals;
 
 
+/**
+ * Protocol used to read data from the device.
+ */
+enum class GPSProtocol
+{
+	// NMEA 0183 sentences, device configured with MTK commands:
+	NMEA,
+	// u-blox binary protocol, NAV-PVT messages:
+	UBX,
+};
+
+
 class GPS_IO: public xf::ModuleIO
 {
   public:
@@ -51,6 +66,9 @@ class GPS_IO: public xf::ModuleIO
 	xf::Setting<unsigned int>				target_baud_rate			{ this, "target_baud_rate", 9600 };
 	xf::Setting<si::Length>					receiver_accuracy			{ this, "receiver_accuracy" };
 	xf::Setting<bool>						synchronize_system_clock	{ this, "synchronize_system_clock", false };
+	xf::Setting<GPSProtocol>				protocol					{ this, "protocol", GPSProtocol::NMEA };
+	// Requested navigation solution rate for the UBX protocol. Limited by baud rate:
+	xf::Setting<si::Frequency>				navigation_rate				{ this, "navigation_rate", 5_Hz };
 
 	/*
 	 * Output
@@ -88,7 +106,7 @@ class GPS_IO: public xf::ModuleIO
 /**
  * Warning: this module uses I/O in main thread, which may block.
  *
- * Read NMEA 0183 GPS data from a serial port.
+ * Read NMEA 0183 or u-blox UBX GPS data from a serial port.
  * TODO make a thread-object that handles the device in a separate thread.
  */
 class GPS:
@@ -143,7 +161,7 @@ class GPS:
 		requested_physical_baud_rate() const;
 
 		/**
-		 * Request baud-rate change to desired value over the MTK protocol.
+		 * Request baud-rate change to desired value over the MTK or UBX protocol.
 		 * This sends command to the GPS to change the baud-rate. The device then becomes
 		 * disconnected and new Connection object needs to be created using new baud-rate.
 		 */
@@ -188,6 +206,18 @@ class GPS:
 		void
 		serial_data_ready();
 
+		/**
+		 * Parse and process buffered NMEA sentences.
+		 */
+		void
+		process_nmea_input();
+
+		/**
+		 * Parse and process buffered UBX frames.
+		 */
+		void
+		process_ubx_input();
+
 		/**
 		 * Callback from SerialPort.
 		 */
@@ -212,12 +242,42 @@ class GPS:
 		void
 		process_nmea_sentence (xf::nmea::GPRMC const&);
 
+		/**
+		 * Process message: GPVTG - Track made good and ground speed.
+		 */
+		void
+		process_nmea_sentence (xf::nmea::GPVTG const&);
+
+		/**
+		 * Process message: GPGST - Pseudorange error statistics.
+		 */
+		void
+		process_nmea_sentence (xf::nmea::GPGST const&);
+
+		/**
+		 * Process message: GPZDA - Date and time.
+		 */
+		void
+		process_nmea_sentence (xf::nmea::GPZDA const&);
+
 		/**
 		 * Process MTK ACK message.
 		 */
 		void
 		process_nmea_sentence (xf::nmea::PMTKACK const&);
 
+		/**
+		 * Process message: NAV-PVT - Navigation position, velocity and time solution.
+		 */
+		void
+		process_ubx_message (xf::ubx::NavPVT const&);
+
+		/**
+		 * Process message: ACK-ACK or ACK-NAK.
+		 */
+		void
+		process_ubx_message (xf::ubx::Ack const&);
+
 		/**
 		 * Compute maximum reliable NMEA messages frequency that can be requested from GPS device
 		 * without overloading serial port. Result is based on serial port baud rate.
@@ -225,6 +285,13 @@ class GPS:
 		static std::string
 		get_nmea_frequencies_setup_messages (unsigned int baud_rate);
 
+		/**
+		 * Return UBX configuration messages that enable NAV-PVT at the highest rate (up to
+		 * requested navigation_rate) that fits in the baud rate.
+		 */
+		Blob
+		get_ubx_setup_messages (unsigned int baud_rate);
+
 		/**
 		 * Notify (once!) PowerCycle that stable connection is established.
 		 */
@@ -242,8 +309,11 @@ class GPS:
 		xf::SerialPort::Configuration		_serial_port_config;
 		std::unique_ptr<xf::SerialPort>		_serial_port;
 		xf::nmea::Parser					_nmea_parser;
+		xf::ubx::Parser						_ubx_parser;
 		bool								_reliable_fix_quality	= false;
 		bool								_first_message_received	= false;
+		// Time of the last GST message; GST errors are preferred over DOP-based estimates:
+		std::optional<si::Time>				_last_gst_timestamp;
 	};
 
 	/**
@@ -342,6 +412,12 @@ class GPS:
 	 * CAP_SYS_TIME capability, set it with "setcap cap_sys_time+ep xefis".
 	 */
 	void
+	update_clock (si::Time unix_time);
+
+	/**
+	 * Set system time from NMEA date and time.
+	 */
+	void
 	update_clock (xf::nmea::GPSDate const&, xf::nmea::GPSTimeOfDay const&);
 
 	xf::Logger&
@@ -13,6 +13,7 @@
 
 // Standard:
 #include <cstddef>
+#include <cstring>
 #include <functional>
 
 // System:
@@ -173,9 +174,10 @@ JoystickInput::Axis::set_value (float value)
 }
 
 
-JoystickInput::JoystickInput (std::unique_ptr<JoystickInputIO> module_io, QDomElement const& config, xf::Logger const& logger, std::string_view const& instance):
+JoystickInput::JoystickInput (std::unique_ptr<JoystickInputIO> module_io, xf::IOReactor& io_reactor, QDomElement const& config, xf::Logger const& logger, std::string_view const& instance):
 	Module (std::move (module_io), instance),
-	_logger (logger.with_scope (std::string (kLoggerScope) + "#" + instance))
+	_logger (logger.with_scope (std::string (kLoggerScope) + "#" + instance)),
+	_io_reactor (io_reactor)
 {
 	for (std::size_t handler_id = 0; handler_id < kMaxEventID; ++handler_id)
 		_button_properties[handler_id] = std::make_unique<xf::PropertyOut<bool>> (&io, "buttons/" + std::to_string (handler_id));
@@ -261,6 +263,22 @@ JoystickInput::initialize()
 }
 
 
+void
+JoystickInput::communicate (xf::Cycle const&)
+{
+	if (!_source)
+		return;
+
+	_source->take (_chunks);
+
+	for (auto const& chunk: _chunks)
+		read (chunk.data);
+
+	if (_source->failed())
+		failure();
+}
+
+
 void
 JoystickInput::open_device()
 {
@@ -277,9 +295,8 @@ JoystickInput::open_device()
 		else
 		{
 			_failure_count = 0;
-			_notifier = std::make_unique<QSocketNotifier> (_device, QSocketNotifier::Read, this);
-			_notifier->setEnabled (true);
-			QObject::connect (_notifier.get(), SIGNAL (activated (int)), this, SLOT (read()));
+			_pending.clear();
+			_source = _io_reactor.add (_device);
 		}
 	}
 	catch (...)
@@ -296,7 +313,7 @@ JoystickInput::failure()
 		_logger << "Failure detected, closing device " << *_device_path << std::endl;
 
 	_failure_count += 1;
-	_notifier.reset();
+	_source.reset();
 	::close (_device);
 
 	restart();
@@ -312,15 +329,17 @@ JoystickInput::restart()
 
 
 void
-JoystickInput::read()
+JoystickInput::read (xf::Blob const& data)
 {
-	::js_event ev;
-	ssize_t n = ::read (_device, &ev, sizeof (ev));
+	_pending.insert (_pending.end(), data.begin(), data.end());
 
-	if (n < 0)
-		failure();
-	else if (n == sizeof (ev))
+	std::size_t offset = 0;
+
+	for (; offset + sizeof (::js_event) <= _pending.size(); offset += sizeof (::js_event))
 	{
+		::js_event ev;
+		std::memcpy (&ev, _pending.data() + offset, sizeof (ev));
+
 		HandlerID handler_id = ev.number;
 
 		if (handler_id < _handlers.size())
@@ -353,6 +372,8 @@ JoystickInput::read()
 		else
 			_logger << "Joystick event with ID " << handler_id << " greater than max supported " << kMaxEventID << std::endl;
 	}
+
+	_pending.erase (_pending.begin(), _pending.begin() + offset);
 }
 
 
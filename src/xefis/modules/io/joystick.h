@@ -22,7 +22,6 @@
 
 // Qt:
 #include <QObject>
-#include <QSocketNotifier>
 #include <QTimer>
 #include <QDomElement>
 
@@ -32,6 +31,7 @@
 
 // Xefis:
 #include <xefis/config/all.h>
+#include <xefis/core/io_reactor.h>
 #include <xefis/core/module.h>
 #include <xefis/core/property.h>
 #include <xefis/core/setting.h>
@@ -170,12 +170,16 @@ class JoystickInput:
   public:
 	// Ctor
 	explicit
-	JoystickInput (std::unique_ptr<JoystickInputIO>, QDomElement const& config, xf::Logger const&, std::string_view const& instance = {});
+	JoystickInput (std::unique_ptr<JoystickInputIO>, xf::IOReactor&, QDomElement const& config, xf::Logger const&, std::string_view const& instance = {});
 
 	// Module API
 	void
 	initialize() override;
 
+	// Module API
+	void
+	communicate (xf::Cycle const&) override;
+
 	/**
 	 * Return reference to a button property.
 	 */
@@ -215,13 +219,13 @@ class JoystickInput:
 	void
 	restart();
 
+  private:
 	/**
-	 * Read event from the device.
+	 * Handle events read from the device.
 	 */
 	void
-	read();
+	read (xf::Blob const&);
 
-  private:
 	/**
 	 * Set all properties to nil.
 	 */
@@ -232,7 +236,11 @@ class JoystickInput:
 	xf::Logger							_logger;
 	std::optional<std::string>			_device_path;
 	int									_device				= 0;
-	std::unique_ptr<QSocketNotifier>	_notifier;
+	xf::IOReactor&						_io_reactor;
+	std::unique_ptr<xf::IOReactor::Source>	_source;
+	xf::IOReactor::Chunks				_chunks;
+	// Incomplete event from previous chunk:
+	xf::Blob							_pending;
 	std::unique_ptr<QTimer>				_reopen_timer;
 	std::set<HandlerID>					_available_buttons;
 	std::set<HandlerID>					_available_axes;
@@ -13,6 +13,7 @@
 
 // Standard:
 #include <cstddef>
+#include <cmath>
 #include <random>
 #include <tuple>
 #include <iomanip>
@@ -48,6 +49,91 @@
 XBee::XBee (std::unique_ptr<XBeeIO> module_io, xf::Logger const& logger, std::string_view const& instance):
 	Module (std::move (module_io), instance),
 	_logger (logger.with_scope (std::string (kLoggerScope) + "#" + instance))
+{
+	if (*io.local_address == 0xffff)
+	{
+		_logger << "Can't use local address ff:ff, 64-bit addressing is unsupported. Setting to default 00:00." << std::endl;
+		*io.local_address = 0x0000;
+	}
+
+	if (*io.remote_address == 0xffff)
+	{
+		_logger << "Can't use remote address ff:ff, 64-bit addressing is unsupported. Setting to default 00:00." << std::endl;
+		*io.remote_address = 0x0000;
+	}
+
+	io.serviceable.set_fallback (false);
+	io.input_errors.set_fallback (0);
+	io.failures.set_fallback (0);
+	io.cca_failures.set_fallback (0);
+
+	XBeeDevice::Configuration configuration {
+		*io.debug,
+		*io.device_path,
+		*io.baud_rate,
+		*io.channel,
+		*io.pan_id,
+		*io.local_address,
+		*io.remote_address,
+		io.power_level ? std::optional<uint16_t> (*io.power_level) : std::nullopt,
+	};
+
+	_device = new XBeeDevice (configuration, _exchange, _logger);
+	_device->moveToThread (&_thread);
+	QObject::connect (&_thread, &QThread::finished, _device, &QObject::deleteLater);
+	_thread.start();
+	QMetaObject::invokeMethod (_device, "start", Qt::QueuedConnection);
+}
+
+
+XBee::~XBee()
+{
+	_thread.quit();
+	_thread.wait();
+}
+
+
+void
+XBee::process (xf::Cycle const&)
+{
+	// Pass data to the device thread without waiting for it:
+	if (io.send && _send_changed())
+	{
+		if (_exchange.send.push (*io.send))
+			QMetaObject::invokeMethod (_device, "send_queued", Qt::QueuedConnection);
+		else
+			_logger << "Send queue full, dropping data." << std::endl;
+	}
+
+	bool const serviceable = _exchange.serviceable.load();
+
+	io.serviceable = serviceable;
+	io.input_errors = _exchange.input_errors.load();
+	io.failures = _exchange.failures.load();
+	io.cca_failures = _exchange.cca_failures.load();
+
+	if (auto const rssi_W = _exchange.rssi_W.load(); std::isnan (rssi_W))
+		io.rssi = xf::nil;
+	else
+		io.rssi = si::Power (rssi_W);
+
+	// Received data is a byte stream, so concatenate all packets that came since the last cycle:
+	_received.clear();
+
+	while (auto data = _exchange.received.pop())
+		_received += *data;
+
+	if (!serviceable)
+		io.receive = xf::nil;
+	else if (!_received.empty())
+		io.receive = _received;
+}
+
+
+XBeeDevice::XBeeDevice (Configuration const& configuration, XBeeExchange& exchange, xf::Logger const& logger):
+	_config (configuration),
+	_exchange (exchange),
+	_logger (logger)
 {
 	_restart_timer = new QTimer (this);
 	_restart_timer->setInterval (kRestartAfter.in<si::Millisecond>());
@@ -85,92 +171,86 @@ XBee::XBee (std::unique_ptr<XBeeIO> module_io, xf::Logger const& logger, std::st
 	_rssi_timer->setInterval (kRSSITimeout.in<si::Millisecond>());
 	_rssi_timer->setSingleShot (true);
 	QObject::connect (_rssi_timer, SIGNAL (timeout()), this, SLOT (rssi_timeout()));
-	_rssi_timer->start();
+}
 
-	if (*io.local_address == 0xffff)
-	{
-		_logger << "Can't use local address ff:ff, 64-bit addressing is unsupported. Setting to default 00:00." << std::endl;
-		*io.local_address = 0x0000;
-	}
 
-	if (*io.remote_address == 0xffff)
-	{
-		_logger << "Can't use remote address ff:ff, 64-bit addressing is unsupported. Setting to default 00:00." << std::endl;
-		*io.remote_address = 0x0000;
-	}
+XBeeDevice::~XBeeDevice()
+{
+	if (_device != 0)
+		::close (_device);
+}
 
-	io.serviceable.set_fallback (false);
-	io.input_errors.set_fallback (0);
-	io.failures.set_fallback (0);
-	io.cca_failures.set_fallback (0);
 
+void
+XBeeDevice::start()
+{
+	// Timers must be started in the thread they live in:
+	_rssi_timer->start();
 	open_device();
 }
 
 
-XBee::~XBee()
+void
+XBeeDevice::send_queued()
 {
-	if (_device != 0)
-		::close (_device);
+	while (auto data = _exchange.send.pop())
+	{
+		// If device is not open or modem is not configured yet, drop the data:
+		if (_notifier && configured())
+			send (*data);
+	}
 }
 
 
 void
-XBee::process (xf::Cycle const&)
+XBeeDevice::send (std::string_view const& data_to_send)
 {
-	// If device is not open, skip.
-	if (!_notifier)
-		return;
+	std::string data = _output_buffer + std::string (data_to_send);
+	std::vector<std::string> packets = packetize (data, 100); // Max 100 bytes per packet according to XBee docs.
 
-	if (io.send && _send_changed() && configured())
+	auto send_back_to_output_buffer = [&] (std::string_view const& front) -> void
 	{
-		std::string data = _output_buffer + *io.send;
-		std::vector<std::string> packets = packetize (data, 100); // Max 100 bytes per packet according to XBee docs.
+		// Add the rest of packets back to output buffer:
+		_output_buffer.clear();
+		_output_buffer += front;
 
-		auto send_back_to_output_buffer = [&] (std::string_view const& front) -> void
-		{
-			// Add the rest of packets back to output buffer:
-			_output_buffer.clear();
-			_output_buffer += front;
+		for (auto const& s: packets)
+			_output_buffer += s;
+	};
 
-			for (auto const& s: packets)
-				_output_buffer += s;
-		};
+	while (!packets.empty())
+	{
+		std::string s = packets.front();
+		std::string frame = make_frame (make_tx16_command (_config.remote_address, s));
+		packets.erase (packets.begin());
 
-		while (!packets.empty())
+		int written = 0;
+		switch (send_frame (frame, written))
 		{
-			std::string s = packets.front();
-			std::string frame = make_frame (make_tx16_command (*io.remote_address, s));
-			packets.erase (packets.begin());
-
-			int written = 0;
-			switch (send_frame (frame, written))
-			{
-				case SendResult::Success:
-					break;
+			case SendResult::Success:
+				break;
 
-				case SendResult::Retry:
-					if (send_failed_with_retry())
-					{
-						// Probably too fast data transmission for given modem settings.
-						// Drop this packet.
-						_logger << "Possibly too fast data transmission. Consider increasing baud rate of the modem." << std::endl;
-						failure ("multiple EAGAIN during write, restarting");
-					}
-					break;
+			case SendResult::Retry:
+				if (send_failed_with_retry())
+				{
+					// Probably too fast data transmission for given modem settings.
+					// Drop this packet.
+					_logger << "Possibly too fast data transmission. Consider increasing baud rate of the modem." << std::endl;
+					failure ("multiple EAGAIN during write, restarting");
+				}
+				break;
 
-				case SendResult::Failure:
-					send_back_to_output_buffer (s);
-					failure ("sending packet");
-					break;
-			}
+			case SendResult::Failure:
+				send_back_to_output_buffer (s);
+				failure ("sending packet");
+				break;
 		}
 	}
 }
 
 
 void
-XBee::read()
+XBeeDevice::read()
 {
 	std::string buffer;
 
@@ -232,18 +312,18 @@ XBee::read()
 
 
 void
-XBee::open_device()
+XBeeDevice::open_device()
 {
 	try {
-		_logger << "Opening device " << *io.device_path << std::endl;
+		_logger << "Opening device " << _config.device_path << std::endl;
 
 		reset();
 
-		_device = ::open (io.device_path->c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+		_device = ::open (_config.device_path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
 
 		if (_device < 0)
 		{
-			_logger << "Could not open device file " << *io.device_path << ": " << strerror (errno) << std::endl;
+			_logger << "Could not open device file " << _config.device_path << ": " << strerror (errno) << std::endl;
 			restart();
 		}
 		else
@@ -268,37 +348,36 @@ XBee::open_device()
 
 
 void
-XBee::failure (std::string_view const& reason)
+XBeeDevice::failure (std::string_view const& reason)
 {
 	auto log = _logger << "Failure detected";
 
 	if (!reason.empty())
 		log << ": " << reason;
 
-	log << ", closing device " << *io.device_path << std::endl;
+	log << ", closing device " << _config.device_path << std::endl;
 	_notifier.reset();
 	::close (_device);
-	io.failures = *io.failures + 1;
+	++_exchange.failures;
 	restart();
 }
 
 
 void
-XBee::reset()
+XBeeDevice::reset()
 {
 	pong();
 	stop_periodic_ping();
 	_configuration_step = ConfigurationStep::Unconfigured;
-	io.serviceable = false;
+	_exchange.serviceable = false;
 	_output_buffer.clear();
 	_restart_timer->stop();
 	_after_reset_timer->stop();
-	io.receive = xf::nil;
 }
 
 
 void
-XBee::restart()
+XBeeDevice::restart()
 {
 	reset();
 	_restart_timer->start();
@@ -306,7 +385,7 @@ XBee::restart()
 
 
 void
-XBee::periodic_ping()
+XBeeDevice::periodic_ping()
 {
 	// Start or restart periodic ping timer:
 	_periodic_ping_timer->start();
@@ -338,7 +417,7 @@ XBee::periodic_ping()
 
 
 void
-XBee::clear_channel_check()
+XBeeDevice::clear_channel_check()
 {
 	int written = 0;
 	switch (send_frame (make_frame (make_at_command ("EC", kClearChannelFrameID)), written))
@@ -363,42 +442,42 @@ XBee::clear_channel_check()
 
 
 void
-XBee::pong_timeout()
+XBeeDevice::pong_timeout()
 {
 	failure ("alive-check timeout");
 }
 
 
 void
-XBee::periodic_pong_timeout()
+XBeeDevice::periodic_pong_timeout()
 {
 	failure ("periodic alive-check timeout");
 }
 
 
 void
-XBee::continue_after_reset()
+XBeeDevice::continue_after_reset()
 {
 	configure_modem (static_cast<uint8_t> (_configuration_step), ATResponseStatus::OK, "");
 }
 
 
 void
-XBee::rssi_timeout()
+XBeeDevice::rssi_timeout()
 {
-	io.rssi = xf::nil;
+	_exchange.rssi_W = std::numeric_limits<double>::quiet_NaN();
 }
 
 
 bool
-XBee::set_device_options()
+XBeeDevice::set_device_options()
 {
-	_logger << "Setting baud rate to " << *io.baud_rate << std::endl;
+	_logger << "Setting baud rate to " << _config.baud_rate << std::endl;
 
 #if 0 // TODO
 	SerialPort::Configuration configuration;
 	configuration.set_read_timeout (0.1_s);
-	configuration.set_baud_rate (*io.baud_rate);
+	configuration.set_baud_rate (_config.baud_rate);
 #else
 	termios options;
 	bzero (&options, sizeof (options));
@@ -413,20 +492,20 @@ XBee::set_device_options()
 	options.c_oflag = 0;
 	options.c_lflag = 0;
 
-	cfsetispeed (&options, *io.baud_rate);
-	cfsetospeed (&options, *io.baud_rate);
+	cfsetispeed (&options, _config.baud_rate);
+	cfsetospeed (&options, _config.baud_rate);
 
 	tcflush (_device, TCIOFLUSH);
 
 	if (tcsetattr (_device, TCSANOW, &options) != 0)
 	{
-		_logger << "Could not setup serial port: " << *io.device_path << ": " << strerror (errno) << std::endl;
+		_logger << "Could not setup serial port: " << _config.device_path << ": " << strerror (errno) << std::endl;
 		return false;
 	}
 
 	if (tcflow (_device, TCOON | TCION) != 0)
 	{
-		_logger << "Could not enable flow: tcflow(): " << *io.device_path << ": " << strerror (errno) << std::endl;
+		_logger << "Could not enable flow: tcflow(): " << _config.device_path << ": " << strerror (errno) << std::endl;
 		return false;
 	}
 #endif
@@ -436,7 +515,7 @@ XBee::set_device_options()
 
 
 void
-XBee::configure_modem (uint8_t frame_id, ATResponseStatus status, std::string_view const& response)
+XBeeDevice::configure_modem (uint8_t frame_id, ATResponseStatus status, std::string_view const& response)
 {
 	auto request_at = [&] (ConfigurationStep next_step, std::string const& at, std::vector<uint8_t> data_bytes = {}) -> void
 	{
@@ -447,7 +526,7 @@ XBee::configure_modem (uint8_t frame_id, ATResponseStatus status, std::string_vi
 		for (uint8_t b: data_bytes)
 			full_at += static_cast<char> (b);
 
-		if (*io.debug)
+		if (_config.debug)
 			debug() << "Sending AT command " << at << ": " << xf::to_hex_string (full_at) << std::endl;
 
 		int written = 0;
@@ -476,7 +555,7 @@ XBee::configure_modem (uint8_t frame_id, ATResponseStatus status, std::string_vi
 		{
 			case ConfigurationStep::Unconfigured:
 				_logger << "Starting modem configuration." << std::endl;
-				io.serviceable = false;
+				_exchange.serviceable = false;
 
 				request_at (ConfigurationStep::SoftwareReset, "FR");
 				// Note: this will cause immediate response and also 'watchdog reset' after a while.
@@ -538,11 +617,11 @@ XBee::configure_modem (uint8_t frame_id, ATResponseStatus status, std::string_vi
 				break;
 
 			case ConfigurationStep::SetAssociationParams:
-				request_at (ConfigurationStep::SetChannel, "CH", { static_cast<uint8_t> (*io.channel) });
+				request_at (ConfigurationStep::SetChannel, "CH", { static_cast<uint8_t> (_config.channel) });
 				break;
 
 			case ConfigurationStep::SetChannel:
-				request_at (ConfigurationStep::SetPersonalAreaNetworkID, "ID", { static_cast<uint8_t> (*io.pan_id >> 8), static_cast<uint8_t> (*io.pan_id) });
+				request_at (ConfigurationStep::SetPersonalAreaNetworkID, "ID", { static_cast<uint8_t> (_config.pan_id >> 8), static_cast<uint8_t> (_config.pan_id) });
 				break;
 
 			case ConfigurationStep::SetPersonalAreaNetworkID:
@@ -550,17 +629,17 @@ XBee::configure_modem (uint8_t frame_id, ATResponseStatus status, std::string_vi
 				break;
 
 			case ConfigurationStep::SetDestinationAddressH:
-				request_at (ConfigurationStep::SetDestinationAddressL, "DL", { 0x00, 0x00, static_cast<uint8_t> (*io.remote_address >> 8), static_cast<uint8_t> (*io.remote_address) });
+				request_at (ConfigurationStep::SetDestinationAddressL, "DL", { 0x00, 0x00, static_cast<uint8_t> (_config.remote_address >> 8), static_cast<uint8_t> (_config.remote_address) });
 				break;
 
 			case ConfigurationStep::SetDestinationAddressL:
-				request_at (ConfigurationStep::SetLocalAddress, "MY", { static_cast<uint8_t> (*io.local_address >> 8), static_cast<uint8_t> (*io.local_address) });
+				request_at (ConfigurationStep::SetLocalAddress, "MY", { static_cast<uint8_t> (_config.local_address >> 8), static_cast<uint8_t> (_config.local_address) });
 				break;
 
 			case ConfigurationStep::SetLocalAddress:
-				if (io.power_level)
+				if (_config.power_level)
 				{
-					request_at (ConfigurationStep::SetPowerLevel, "PL", { static_cast<uint8_t> (*io.power_level) });
+					request_at (ConfigurationStep::SetPowerLevel, "PL", { static_cast<uint8_t> (*_config.power_level) });
 					break;
 				}
 				else
@@ -574,7 +653,7 @@ XBee::configure_modem (uint8_t frame_id, ATResponseStatus status, std::string_vi
 			case ConfigurationStep::SetCoordinatorMode:
 				_logger << "Modem configured." << std::endl;
 				_configuration_step = ConfigurationStep::Configured;
-				io.serviceable = true;
+				_exchange.serviceable = true;
 				periodic_ping();
 				break;
 
@@ -588,7 +667,7 @@ XBee::configure_modem (uint8_t frame_id, ATResponseStatus status, std::string_vi
 
 
 int
-XBee::baud_rate_to_xbee_code (int baud_rate)
+XBeeDevice::baud_rate_to_xbee_code (int baud_rate)
 {
 	switch (baud_rate)
 	{
@@ -606,7 +685,7 @@ XBee::baud_rate_to_xbee_code (int baud_rate)
 
 
 std::string
-XBee::make_frame (std::string_view const& data) const
+XBeeDevice::make_frame (std::string_view const& data) const
 {
 	if (data.size() > 0xffff)
 		throw xf::Exception ("max frame size is 0xffff");
@@ -632,7 +711,7 @@ XBee::make_frame (std::string_view const& data) const
 
 
 std::string
-XBee::make_tx64_command (uint64_t address, std::string_view const& data) const
+XBeeDevice::make_tx64_command (uint64_t address, std::string_view const& data) const
 {
 	std::string result;
 
@@ -653,7 +732,7 @@ XBee::make_tx64_command (uint64_t address, std::string_view const& data) const
 
 
 std::string
-XBee::make_tx16_command (uint16_t address, std::string_view const& data) const
+XBeeDevice::make_tx16_command (uint16_t address, std::string_view const& data) const
 {
 	std::string result;
 
@@ -674,7 +753,7 @@ XBee::make_tx16_command (uint16_t address, std::string_view const& data) const
 
 
 std::string
-XBee::make_at_command (std::string_view const& at_command, uint8_t frame_id)
+XBeeDevice::make_at_command (std::string_view const& at_command, uint8_t frame_id)
 {
 	std::string result;
 
@@ -689,8 +768,8 @@ XBee::make_at_command (std::string_view const& at_command, uint8_t frame_id)
 }
 
 
-XBee::SendResult
-XBee::send_frame (std::string_view const& frame, int& written)
+XBeeDevice::SendResult
+XBeeDevice::send_frame (std::string_view const& frame, int& written)
 {
 	written = ::write (_device, frame.data(), frame.size());
 
@@ -715,7 +794,7 @@ XBee::send_frame (std::string_view const& frame, int& written)
 
 
 bool
-XBee::send_failed_with_retry()
+XBeeDevice::send_failed_with_retry()
 {
 	_write_failure_count++;
 	bool should_restart = _write_failure_count > kMaxWriteFailureCount || _output_buffer.size() > kMaxOutputBufferSize;
@@ -728,7 +807,7 @@ XBee::send_failed_with_retry()
 
 
 std::vector<std::string>
-XBee::packetize (std::string_view const& data, std::size_t size) const
+XBeeDevice::packetize (std::string_view const& data, std::size_t size) const
 {
 	if (data.size() <= size)
 		return { std::string (data) };
@@ -743,7 +822,7 @@ XBee::packetize (std::string_view const& data, std::size_t size) const
 
 
 bool
-XBee::vector_to_uint16 (std::vector<uint8_t> const& vector, uint16_t& result) const
+XBeeDevice::vector_to_uint16 (std::vector<uint8_t> const& vector, uint16_t& result) const
 {
 	if (vector.size() != 2)
 		return false;
@@ -754,7 +833,7 @@ XBee::vector_to_uint16 (std::vector<uint8_t> const& vector, uint16_t& result) co
 
 
 void
-XBee::process_input()
+XBeeDevice::process_input()
 {
 	ResponseAPI api;
 	std::string data;
@@ -788,7 +867,7 @@ XBee::process_input()
 
 
 bool
-XBee::process_packet (std::string& input, ResponseAPI& api, std::string& data)
+XBeeDevice::process_packet (std::string& input, ResponseAPI& api, std::string& data)
 {
 	for (;;)
 	{
@@ -803,7 +882,7 @@ XBee::process_packet (std::string& input, ResponseAPI& api, std::string& data)
 		// Discard non-parseable data:
 		input.erase (input.begin(), input.begin() + p);
 
-		io.input_errors = *io.input_errors + p;
+		_exchange.input_errors += p;
 
 		// Delimiter (1B) + packet size (2B) + data (1B) + checksum (1B) gives
 		// at least 5 bytes:
@@ -840,9 +919,9 @@ XBee::process_packet (std::string& input, ResponseAPI& api, std::string& data)
 
 
 void
-XBee::process_rx64_frame (std::string_view const& frame)
+XBeeDevice::process_rx64_frame (std::string_view const& frame)
 {
-	if (*io.debug)
+	if (_config.debug)
 		debug() << ">> RX64 data: " << xf::to_hex_string (frame) << std::endl;
 
 	// At least 11 bytes:
@@ -868,15 +947,15 @@ XBee::process_rx64_frame (std::string_view const& frame)
 	}
 
 	// Frame data:
-	write_output_property (frame.substr (10));
+	write_output (frame.substr (10));
 	report_rssi (rssi);
 }
 
 
 void
-XBee::process_rx16_frame (std::string_view const& frame)
+XBeeDevice::process_rx16_frame (std::string_view const& frame)
 {
-	if (*io.debug)
+	if (_config.debug)
 		debug() << ">> RX16 data: " << xf::to_hex_string (frame) << std::endl;
 
 	// At least 5 bytes:
@@ -886,7 +965,7 @@ XBee::process_rx16_frame (std::string_view const& frame)
 	// 16-bit address:
 	uint16_t address = (static_cast<uint16_t> (frame[0]) << 8) | frame[1];
 	// Address must match our peer's address:
-	if (address != *io.remote_address)
+	if (address != _config.remote_address)
 	{
 		_logger << "Got packet from unknown address: " << xf::to_hex_string (frame.substr (0, 2)) << ". Ignoring." << std::endl;
 		return;
@@ -906,15 +985,15 @@ XBee::process_rx16_frame (std::string_view const& frame)
 	}
 
 	// Frame data:
-	write_output_property (frame.substr (4));
+	write_output (frame.substr (4));
 	report_rssi (rssi);
 }
 
 
 void
-XBee::process_modem_status_frame (std::string_view const& data)
+XBeeDevice::process_modem_status_frame (std::string_view const& data)
 {
-	if (*io.debug)
+	if (_config.debug)
 		debug() << ">> Modem status: " << xf::to_hex_string (data) << std::endl;
 
 	if (data.size() < 1)
@@ -971,9 +1050,9 @@ XBee::process_modem_status_frame (std::string_view const& data)
 
 
 void
-XBee::process_at_response_frame (std::string_view const& frame)
+XBeeDevice::process_at_response_frame (std::string_view const& frame)
 {
-	if (*io.debug)
+	if (_config.debug)
 		debug() << ">> AT status: " << xf::to_hex_string (frame) << std::endl;
 
 	// Response must be at least 4 bytes long:
@@ -993,7 +1072,7 @@ XBee::process_at_response_frame (std::string_view const& frame)
 	// Data:
 	std::string_view response_data = frame.substr (4);
 
-	if (*io.debug)
+	if (_config.debug)
 	{
 		auto log = debug();
 		log << "Command result: " << command << " ";
@@ -1019,15 +1098,16 @@ XBee::process_at_response_frame (std::string_view const& frame)
 
 
 void
-XBee::write_output_property (std::string_view const& data)
+XBeeDevice::write_output (std::string_view const& data)
 {
 	if (configured())
-		io.receive = std::string (data);
+		if (!_exchange.received.push (std::string (data)))
+			_exchange.input_errors += data.size();
 }
 
 
 void
-XBee::report_rssi (int dbm)
+XBeeDevice::report_rssi (int dbm)
 {
 	// Restart timer:
 	_rssi_timer->start();
@@ -1035,13 +1115,13 @@ XBee::report_rssi (int dbm)
 	// Convert dBm to milliwatts:
 	si::Power power = 1_mW * std::pow (10.0, 0.1 * static_cast<double> (dbm));
 	si::Time now = xf::TimeHelper::now();
-	io.rssi = _rssi_smoother (power, now - _last_rssi_time);
+	_exchange.rssi_W = _rssi_smoother (power, now - _last_rssi_time).base_value();
 	_last_rssi_time = now;
 }
 
 
 void
-XBee::ping (si::Time const timeout)
+XBeeDevice::ping (si::Time const timeout)
 {
 	_pong_timer->stop();
 	_pong_timer->setInterval (timeout.in<si::Millisecond>());
@@ -1050,14 +1130,14 @@ XBee::ping (si::Time const timeout)
 
 
 void
-XBee::pong()
+XBeeDevice::pong()
 {
 	_pong_timer->stop();
 }
 
 
 void
-XBee::periodic_pong (ATResponseStatus status, std::string_view const& data)
+XBeeDevice::periodic_pong (ATResponseStatus status, std::string_view const& data)
 {
 	if (status != ATResponseStatus::OK)
 		failure ("check-alive packet status non-OK");
@@ -1072,7 +1152,7 @@ XBee::periodic_pong (ATResponseStatus status, std::string_view const& data)
 
 
 void
-XBee::stop_periodic_ping()
+XBeeDevice::stop_periodic_ping()
 {
 	_periodic_ping_timer->stop();
 	_periodic_pong_timer->stop();
@@ -1081,12 +1161,12 @@ XBee::stop_periodic_ping()
 
 
 void
-XBee::clear_channel_result (ATResponseStatus status, std::string_view const& result)
+XBeeDevice::clear_channel_result (ATResponseStatus status, std::string_view const& result)
 {
 	if (status == ATResponseStatus::OK && result.size() >= 2)
 	{
 		uint16_t failures = (static_cast<uint16_t> (result[0]) >> 8) | result[1];
-		io.cca_failures = *io.cca_failures + failures;
+		_exchange.cca_failures += failures;
 	}
 }
 
@@ -16,10 +16,16 @@
 
 // Standard:
 #include <cstddef>
+#include <atomic>
+#include <limits>
 #include <map>
+#include <optional>
+#include <string>
 
 // Qt:
 #include <QtCore/QSocketNotifier>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
 
 // Neutrino:
 #include <neutrino/logger.h>
@@ -31,6 +37,7 @@
 #include <xefis/core/setting.h>
 #include <xefis/utility/actions.h>
 #include <xefis/utility/smoother.h>
+#include <xefis/utility/spsc_queue.h>
 
 
 namespace si = neutrino::si;
@@ -73,19 +80,35 @@ class XBeeIO: public xf::ModuleIO
 
 
 /**
- * Warning: This module is not IO-safe: it uses IO commands in the main thread, which may block.
+ * State shared between the XBee module and its device thread.
+ * Only lock-free operations are used on both sides.
+ */
+struct XBeeExchange
+{
+	// Data to send; pushed by the module, popped by the device thread:
+	xf::SPSCQueue<std::string>	send			{ 64 };
+	// Received data; pushed by the device thread, popped by the module:
+	xf::SPSCQueue<std::string>	received		{ 256 };
+	std::atomic<bool>			serviceable		{ false };
+	std::atomic<int64_t>		input_errors	{ 0 };
+	std::atomic<int64_t>		failures		{ 0 };
+	std::atomic<int64_t>		cca_failures	{ 0 };
+	// RSSI in watts or NaN if unknown:
+	std::atomic<double>			rssi_W			{ std::numeric_limits<double>::quiet_NaN() };
+};
+
+
+/**
+ * Device side of the XBee module. Lives in the device thread and performs all serial I/O,
+ * modem configuration and API frame parsing there. Communicates with XBee module only through XBeeExchange.
  *
  * XBee Pro modem. Supports only the API mode 1 (non-escaped chars).  Use XBee firmware that starts in correct API mode
  * by default, or prepare the modem by issuing "ATAP1" AT command and writing config permanently with "ATWR".
  */
-class XBee:
-	public QObject,
-	public xf::Module<XBeeIO>
+class XBeeDevice: public QObject
 {
 	Q_OBJECT
 
-	static constexpr char		kLoggerScope[]				= "mod::XBee";
-
 	static constexpr int		kMaxReadFailureCount		= 10;
 	static constexpr int		kMaxWriteFailureCount		= 10;
 	static constexpr size_t		kMaxOutputBufferSize		= 256;
@@ -173,15 +196,42 @@ class XBee:
 		CoordinatorStarted		= 6,
 	};
 
+  public:
+	/**
+	 * Copy of module settings, so that the device thread doesn't access module IO.
+	 */
+	struct Configuration
+	{
+		bool					debug;
+		std::string				device_path;
+		unsigned int			baud_rate;
+		int						channel;
+		uint16_t				pan_id;
+		uint16_t				local_address;
+		uint16_t				remote_address;
+		std::optional<uint16_t>	power_level;
+	};
+
   public:
 	// Ctor
-	XBee (std::unique_ptr<XBeeIO>, xf::Logger const&, std::string_view const& instance = {});
+	explicit
+	XBeeDevice (Configuration const&, XBeeExchange&, xf::Logger const&);
 
 	// Dtor
-	~XBee();
+	~XBeeDevice();
+
+  public slots:
+	/**
+	 * Start operation. Must be called in the device thread.
+	 */
+	void
+	start();
 
+	/**
+	 * Send all data queued in XBeeExchange::send.
+	 */
 	void
-	process (xf::Cycle const&) override;
+	send_queued();
 
   private slots:
 	/**
@@ -310,6 +360,12 @@ class XBee:
 	std::string
 	make_at_command (std::string_view const& at_command, uint8_t frame_id = 0x00);
 
+	/**
+	 * Send data to the remote modem.
+	 */
+	void
+	send (std::string_view const& data);
+
 	/**
 	 * Send frame.
 	 */
@@ -376,10 +432,10 @@ class XBee:
 	process_at_response_frame (std::string_view const& data);
 
 	/**
-	 * Write output data to the output property.
+	 * Pass received data to the module.
 	 */
 	void
-	write_output_property (std::string_view const& data);
+	write_output (std::string_view const& data);
 
 	/**
 	 * Report RSSI. Add it to data smoother and
@@ -428,6 +484,8 @@ class XBee:
 	debug() const;
 
   private:
+	Configuration						_config;
+	XBeeExchange&						_exchange;
 	xf::Logger							_logger;
 	std::unique_ptr<QSocketNotifier>	_notifier;
 	int									_device					= 0;
@@ -448,19 +506,47 @@ class XBee:
 	xf::Smoother<si::Power>				_rssi_smoother			{ 200_ms };
 	si::Time							_last_rssi_time;
 	uint8_t								_at_frame_id			{ 0x00 };
+};
+
+
+/**
+ * XBee modem module. All device I/O is done by XBeeDevice in a separate thread, so a stalled serial port
+ * doesn't block the processing loop. Data is exchanged with the device thread through lock-free queues.
+ */
+class XBee: public xf::Module<XBeeIO>
+{
+	static constexpr char		kLoggerScope[]				= "mod::XBee";
+
+  public:
+	// Ctor
+	XBee (std::unique_ptr<XBeeIO>, xf::Logger const&, std::string_view const& instance = {});
+
+	// Dtor
+	~XBee();
+
+	void
+	process (xf::Cycle const&) override;
+
+  private:
+	xf::Logger							_logger;
+	XBeeExchange						_exchange;
+	QThread								_thread;
+	// Deleted in the device thread when _thread finishes:
+	XBeeDevice*							_device					= nullptr;
+	std::string							_received;
 	xf::PropChanged<std::string>		_send_changed			{ io.send };
 };
 
 
 inline bool
-XBee::configured() const noexcept
+XBeeDevice::configured() const noexcept
 {
 	return _configuration_step == ConfigurationStep::Configured;
 }
 
 
 inline xf::LogBlock
-XBee::debug() const
+XBeeDevice::debug() const
 {
 	return _logger << "DEBUG ";
 }
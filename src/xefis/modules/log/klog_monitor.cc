@@ -14,10 +14,18 @@
 // Standard:
 #include <cstddef>
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <charconv>
+#include <cstring>
+#include <iterator>
 
 // System:
-#include <sys/klog.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 // Neutrino:
 #include <neutrino/qt/qdom.h>
@@ -30,43 +38,174 @@
 
 
 KLogMonitor::KLogMonitor (std::unique_ptr<KLogMonitorIO> module_io, std::string_view const& instance):
-	Module (std::move (module_io), instance)
+	Module (std::move (module_io), instance),
+	_device_path (*io.device_path)
 {
-	_timer = new QTimer (this);
-	_timer->setInterval (100);
-	_timer->setSingleShot (false);
-	QObject::connect (_timer, SIGNAL (timeout()), this, SLOT (check_klog()));
-	_timer->start();
-
-	io.flag_oom = true;
-	io.flag_io = true;
-	io.flag_oops = true;
-	io.flag_bug = true;
+	_stop_event = ::eventfd (0, EFD_CLOEXEC);
+
+	if (_stop_event < 0)
+		throw xf::Exception ("could not create eventfd: " + std::string (strerror (errno)));
+
+	_reader = std::thread (&KLogMonitor::read_records, this);
+}
+
+
+KLogMonitor::~KLogMonitor()
+{
+	uint64_t const one = 1;
+	[[maybe_unused]] auto const written = ::write (_stop_event, &one, sizeof (one));
+	_reader.join();
+	::close (_stop_event);
+}
+
+
+void
+KLogMonitor::process (xf::Cycle const&)
+{
+	io.flag_oom = _flag_oom.load();
+	io.flag_io = _flag_io.load();
+	io.flag_oops = _flag_oops.load();
+	io.flag_bug = _flag_bug.load();
+	io.lost_records = _lost_records.load();
+}
+
+
+void
+KLogMonitor::read_records()
+{
+	std::array<char, kRecordBufferSize> buffer;
+	// Incomplete last line; /dev/kmsg returns whole records, but regular files return arbitrary chunks:
+	std::string pending;
+
+	for (;;)
+	{
+		int const device = ::open (_device_path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+
+		if (device >= 0)
+		{
+			pending.clear();
+
+			for (bool reopen = false; !reopen; )
+			{
+				std::array<pollfd, 2> fds {{
+					{ device, POLLIN, 0 },
+					{ _stop_event, POLLIN, 0 },
+				}};
+
+				if (::poll (fds.data(), fds.size(), -1) < 0 && errno != EINTR)
+					break;
+
+				if (fds[1].revents & POLLIN)
+				{
+					::close (device);
+					return;
+				}
+
+				auto const n = ::read (device, buffer.data(), buffer.size());
+
+				if (n > 0)
+				{
+					pending.append (buffer.data(), n);
+
+					std::string_view const data (pending);
+					std::string_view::size_type start = 0;
+
+					for (auto eol = data.find ('\n'); eol != std::string_view::npos; eol = data.find ('\n', start))
+					{
+						process_record (data.substr (start, eol - start));
+						start = eol + 1;
+					}
+
+					pending.erase (0, start);
+				}
+				else if (n == 0)
+				{
+					// End of a regular file; follow it like tail -f does:
+					if (wait_for_stop (100))
+					{
+						::close (device);
+						return;
+					}
+				}
+				// EPIPE means that records were overwritten before we read them; sequence numbers
+				// will tell how many were lost:
+				else if (errno != EAGAIN && errno != EINTR && errno != EPIPE)
+					reopen = true;
+			}
+
+			::close (device);
+		}
+
+		if (wait_for_stop (1000))
+			return;
+	}
 }
 
 
 void
-KLogMonitor::check_klog()
+KLogMonitor::process_record (std::string_view const record)
 {
-	const int read_all_command = 3;
-	std::size_t len = klogctl (read_all_command, _buffer.data(), _buffer.size());
-	std::string buffer (_buffer.data(), len);
-	std::transform (buffer.begin(), buffer.end(), buffer.begin(), tolower);
+	if (record.empty() || record.front() == ' ')
+		return;
+
+	auto const semicolon = record.find (';');
+
+	if (semicolon == std::string_view::npos)
+		return;
+
+	// Sequence number is the second field of the header:
+	auto const header = record.substr (0, semicolon);
+
+	if (auto const comma = header.find (','); comma != std::string_view::npos)
+	{
+		auto const sequence_string = header.substr (comma + 1);
+		uint64_t sequence = 0;
+
+		if (std::from_chars (sequence_string.data(), sequence_string.data() + sequence_string.size(), sequence).ec == std::errc())
+		{
+			if (_last_sequence)
+			{
+				// Already seen (after reopening the device):
+				if (sequence <= *_last_sequence)
+					return;
+
+				if (sequence > *_last_sequence + 1)
+					_lost_records += sequence - *_last_sequence - 1;
+			}
+
+			_last_sequence = sequence;
+		}
+	}
+
+	auto const message = record.substr (semicolon + 1);
+
+	// Leading space allows patterns like " oops" to match at the beginning of the message:
+	_lowercase_message.assign (1, ' ');
+	std::transform (message.begin(), message.end(), std::back_inserter (_lowercase_message), [](unsigned char c) {
+		return static_cast<char> (std::tolower (c));
+	});
 
 	// Search for OOMs:
-	if (buffer.find ("oom-killer") != std::string::npos)
-		io.flag_oom = true;
+	if (_lowercase_message.find ("oom-killer") != std::string::npos)
+		_flag_oom = true;
 
 	// Search for I/O errors:
-	if (buffer.find ("i/o error") != std::string::npos)
-		io.flag_io = true;
+	if (_lowercase_message.find ("i/o error") != std::string::npos)
+		_flag_io = true;
 
 	// Search for Oopses:
-	if (buffer.find (" oops") != std::string::npos)
-		io.flag_oops = true;
+	if (_lowercase_message.find (" oops") != std::string::npos)
+		_flag_oops = true;
 
 	// Search for BUGs:
-	if (buffer.find (" bug") != std::string::npos)
-		io.flag_bug = true;
+	if (_lowercase_message.find (" bug") != std::string::npos)
+		_flag_bug = true;
 }
 
+
+bool
+KLogMonitor::wait_for_stop (int const timeout_ms) const
+{
+	pollfd fd { _stop_event, POLLIN, 0 };
+	return ::poll (&fd, 1, timeout_ms) > 0 && (fd.revents & POLLIN);
+}
@@ -16,53 +16,93 @@
 
 // Standard:
 #include <cstddef>
-#include <array>
-
-// Qt:
-#include <QtCore/QTimer>
+#include <atomic>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
 
 // Xefis:
 #include <xefis/config/all.h>
 #include <xefis/core/module.h>
 #include <xefis/core/property.h>
+#include <xefis/core/setting.h>
 
 
 class KLogMonitorIO: public xf::ModuleIO
 {
   public:
+	/*
+	 * Settings
+	 */
+
+	// Kernel log device or a file in the same format (eg. for testing):
+	xf::Setting<std::string>	device_path		{ this, "device_path", "/dev/kmsg" };
+
 	/*
 	 * Output
 	 */
 
-	xf::PropertyOut<bool>	flag_oom	{ this, "flags/oom" };
-	xf::PropertyOut<bool>	flag_io		{ this, "flags/io-error" };
-	xf::PropertyOut<bool>	flag_oops	{ this, "flags/oops" };
-	xf::PropertyOut<bool>	flag_bug	{ this, "flags/bug" };
+	xf::PropertyOut<bool>		flag_oom		{ this, "flags/oom" };
+	xf::PropertyOut<bool>		flag_io			{ this, "flags/io-error" };
+	xf::PropertyOut<bool>		flag_oops		{ this, "flags/oops" };
+	xf::PropertyOut<bool>		flag_bug		{ this, "flags/bug" };
+	xf::PropertyOut<int64_t>	lost_records	{ this, "lost-records" };
 };
 
 
-class KLogMonitor:
-	public QObject,
-	public xf::Module<KLogMonitorIO>
+/**
+ * Watches kernel log for OOMs, I/O errors, oopses and BUGs.
+ * Records are streamed from /dev/kmsg by a background thread, so that each record is read and scanned only once.
+ */
+class KLogMonitor: public xf::Module<KLogMonitorIO>
 {
-	Q_OBJECT
-
   private:
-	static constexpr std::size_t	kBufferSize = 1024 * 1024;
+	static constexpr std::size_t	kRecordBufferSize	= 8192;
 
   public:
 	// Ctor
 	explicit
 	KLogMonitor (std::unique_ptr<KLogMonitorIO>, std::string_view const& instance = {});
 
-  private slots:
+	// Dtor
+	~KLogMonitor();
+
 	void
-	check_klog();
+	process (xf::Cycle const&) override;
+
+  private:
+	/**
+	 * Reader thread loop. Reads records until _stop_event is signalled.
+	 */
+	void
+	read_records();
+
+	/**
+	 * Process a single log line in kmsg format: "priority,sequence,timestamp,flags;message".
+	 * Continuation lines (starting with space) are ignored.
+	 */
+	void
+	process_record (std::string_view record);
+
+	/**
+	 * Wait until stop is requested or timeout passes. Return true if stop was requested.
+	 */
+	bool
+	wait_for_stop (int timeout_ms) const;
 
   private:
-	QTimer*							_timer		{ nullptr };
-	bool							_open		{ false };
-	std::array<char, kBufferSize>	_buffer;
+	std::string					_device_path;
+	int							_stop_event		{ -1 };
+	std::atomic<bool>			_flag_oom		{ false };
+	std::atomic<bool>			_flag_io		{ false };
+	std::atomic<bool>			_flag_oops		{ false };
+	std::atomic<bool>			_flag_bug		{ false };
+	std::atomic<int64_t>		_lost_records	{ 0 };
+	// Used only by the reader thread:
+	std::optional<uint64_t>		_last_sequence;
+	std::string					_lowercase_message;
+	std::thread					_reader;
 };
 
 #endif
@@ -0,0 +1,130 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+// System:
+#include <stdlib.h>
+
+// Neutrino:
+#include <neutrino/logger.h>
+#include <neutrino/test/auto_test.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/core/cycle.h>
+#include <xefis/modules/log/klog_monitor.h>
+
+
+namespace xf::test {
+namespace {
+
+xf::LoggerOutput g_logger_output (std::clog);
+xf::Logger g_logger (g_logger_output);
+
+
+/**
+ * Temporary file in the kmsg format, removed in dtor.
+ */
+struct TemporaryLog
+{
+	TemporaryLog()
+	{
+		std::string name_template = std::filesystem::temp_directory_path() / "xefis-klog-XXXXXX";
+
+		if (!::mkdtemp (name_template.data()))
+			throw Exception ("could not create temporary directory");
+
+		directory = name_template;
+		path = directory / "kmsg";
+		std::ofstream (path).flush();
+	}
+
+	~TemporaryLog()
+	{
+		std::filesystem::remove_all (directory);
+	}
+
+	void
+	append (std::string const& records)
+	{
+		std::ofstream (path, std::ios::app) << records;
+	}
+
+	std::filesystem::path directory;
+	std::filesystem::path path;
+};
+
+
+/**
+ * Call process() on the module until predicate is satisfied or timeout passes.
+ */
+bool
+process_until (KLogMonitor& module, std::function<bool()> const predicate)
+{
+	Cycle const cycle (1, 0_s, 1_s, 1_s, g_logger);
+
+	for (int i = 0; i < 5000; ++i)
+	{
+		module.process (cycle);
+
+		if (predicate())
+			return true;
+
+		std::this_thread::sleep_for (std::chrono::milliseconds (1));
+	}
+
+	return false;
+}
+
+
+AutoTest t1 ("KLogMonitor: lost records are counted from sequence gaps", []{
+	TemporaryLog log;
+	log.append ("6,1,1000,-;first record\n"
+				"6,2,1001,-;second record\n"
+				// Records 3 and 4 were overwritten:
+				"3,5,1002,-;sd 0:0:0:0: [sda] I/O error, dev sda, sector 2048\n"
+				" SUBSYSTEM=scsi\n");
+
+	auto module_io = std::make_unique<KLogMonitorIO>();
+	auto& io = *module_io;
+	io.device_path = log.path.string();
+	KLogMonitor module (std::move (module_io));
+
+	test_asserts::verify ("gap of two records is detected", process_until (module, [&] { return io.lost_records.get_optional() == 2; }));
+	test_asserts::verify ("I/O error is detected", io.flag_io.get_optional() == true);
+	test_asserts::verify ("continuation line isn't treated as record", io.flag_oom.get_optional() == false);
+
+	// Record split between two writes, then a record seen before (eg. after reopening the device),
+	// then another gap:
+	log.append ("4,6,1003,-;Out of memory: ");
+	log.append ("oom-killer invoked\n"
+				"6,2,1001,-;second record\n"
+				"6,9,1004,-;last record\n");
+
+	test_asserts::verify ("following gaps are added up", process_until (module, [&] { return io.lost_records.get_optional() == 4; }));
+	test_asserts::verify ("split record is read", io.flag_oom.get_optional() == true);
+	test_asserts::verify ("no other flags are set", io.flag_oops.get_optional() == false && io.flag_bug.get_optional() == false);
+});
+
+} // namespace
+} // namespace xf::test
+
@@ -0,0 +1,190 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <algorithm>
+#include <optional>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/nature/constants.h>
+
+// Local:
+#include "adc_multi.h"
+
+
+namespace {
+
+/**
+ * Return median of all non-nil values of given field.
+ * For even number of values, return mean of two middle values.
+ */
+template<class Value>
+	std::optional<Value>
+	median (std::vector<xf::AirDataResult> const& results, std::optional<Value> xf::AirDataResult::* field)
+	{
+		std::vector<Value> values;
+		values.reserve (results.size());
+
+		for (auto const& result: results)
+			if (auto const& value = result.*field)
+				values.push_back (*value);
+
+		if (values.empty())
+			return std::nullopt;
+
+		auto const mid = values.begin() + values.size() / 2;
+		std::nth_element (values.begin(), mid, values.end());
+
+		if (values.size() % 2 == 1)
+			return *mid;
+		else
+		{
+			auto const lower = *std::max_element (values.begin(), mid);
+			return lower + 0.5 * (*mid - lower);
+		}
+	}
+
+} // namespace
+
+
+MultiChannelAirDataComputerIO::Channel::Channel (xf::ModuleIO* io, std::string const& prefix):
+	pressure_static (io, prefix + "sensors/pressure/static"),
+	pressure_total (io, prefix + "sensors/pressure/total"),
+	total_air_temperature (io, prefix + "sensors/air-temperature/total"),
+	pressure_dynamic (io, prefix + "pressure/dynamic"),
+	altitude_amsl (io, prefix + "altitude/amsl"),
+	altitude_amsl_std (io, prefix + "altitude/amsl.std"),
+	density_altitude (io, prefix + "density-altitude"),
+	air_density (io, prefix + "air-density"),
+	speed_ias (io, prefix + "speed/ias"),
+	speed_cas (io, prefix + "speed/cas"),
+	speed_tas (io, prefix + "speed/tas"),
+	speed_eas (io, prefix + "speed/eas"),
+	speed_mach (io, prefix + "speed/mach"),
+	speed_sound (io, prefix + "speed/sound"),
+	static_air_temperature (io, prefix + "air-temperature/static"),
+	dynamic_viscosity (io, prefix + "viscosity/dynamic"),
+	reynolds_number (io, prefix + "reynolds-number"),
+	miscompare (io, prefix + "miscompare")
+{ }
+
+
+MultiChannelAirDataComputerIO::MultiChannelAirDataComputerIO (std::size_t const number_of_channels)
+{
+	_channels.reserve (number_of_channels);
+
+	for (std::size_t i = 0; i < number_of_channels; ++i)
+		_channels.push_back (std::make_unique<Channel> (this, "channel/" + std::to_string (i) + "/"));
+}
+
+
+MultiChannelAirDataComputer::MultiChannelAirDataComputer (std::unique_ptr<MultiChannelAirDataComputerIO> module_io, xf::Airframe* airframe, std::string_view const& instance):
+	Module (std::move (module_io), instance),
+	_airframe (airframe)
+{
+	_inputs.resize (io.channels().size());
+	_results.reserve (io.channels().size());
+}
+
+
+void
+MultiChannelAirDataComputer::process (xf::Cycle const&)
+{
+	auto const& channels = io.channels();
+
+	for (std::size_t i = 0; i < channels.size(); ++i)
+	{
+		auto const& channel = *channels[i];
+		auto& input = _inputs[i];
+
+		input.pressure_static = channel.pressure_static.get_optional();
+		input.pressure_total = channel.pressure_total.get_optional();
+		input.total_air_temperature = channel.total_air_temperature.get_optional();
+	}
+
+	xf::AirDataParameters params;
+	params.pressure_setting = *io.pressure_use_std ? std::optional (xf::kStdAirPressure) : io.pressure_qnh.get_optional();
+	params.ram_rise_factor = *io.ram_rise_factor;
+	params.ias_valid_minimum = *io.ias_valid_minimum;
+	params.ias_valid_maximum = *io.ias_valid_maximum;
+
+	if (_airframe)
+		params.reference_length = _airframe->wings_chord();
+
+	_batch.compute (params, _inputs, _results);
+	publish_channels();
+	vote();
+}
+
+
+void
+MultiChannelAirDataComputer::publish_channels()
+{
+	auto const& channels = io.channels();
+
+	for (std::size_t i = 0; i < channels.size(); ++i)
+	{
+		auto& channel = *channels[i];
+		auto const& result = _results[i];
+
+		channel.pressure_dynamic = result.pressure_dynamic;
+		channel.altitude_amsl = result.altitude_amsl;
+		channel.altitude_amsl_std = result.altitude_amsl_std;
+		channel.density_altitude = result.density_altitude;
+		channel.air_density = result.air_density;
+		channel.speed_ias = result.speed_ias;
+		channel.speed_cas = result.speed_cas;
+		channel.speed_tas = result.speed_tas;
+		channel.speed_eas = result.speed_eas;
+		channel.speed_mach = result.speed_mach;
+		channel.speed_sound = result.speed_sound;
+		channel.static_air_temperature = result.static_air_temperature;
+		channel.dynamic_viscosity = result.dynamic_viscosity;
+		channel.reynolds_number = result.reynolds_number;
+	}
+}
+
+
+void
+MultiChannelAirDataComputer::vote()
+{
+	auto const voted_altitude_std = median (_results, &xf::AirDataResult::altitude_amsl_std);
+	auto const voted_cas = median (_results, &xf::AirDataResult::speed_cas);
+
+	io.altitude_amsl = median (_results, &xf::AirDataResult::altitude_amsl);
+	io.altitude_amsl_std = voted_altitude_std;
+	io.speed_ias = median (_results, &xf::AirDataResult::speed_ias);
+	io.speed_cas = voted_cas;
+	io.speed_tas = median (_results, &xf::AirDataResult::speed_tas);
+	io.speed_mach = median (_results, &xf::AirDataResult::speed_mach);
+	io.static_air_temperature = median (_results, &xf::AirDataResult::static_air_temperature);
+
+	auto const& channels = io.channels();
+
+	for (std::size_t i = 0; i < channels.size(); ++i)
+	{
+		auto const& result = _results[i];
+		bool miscompare = false;
+
+		if (voted_altitude_std && result.altitude_amsl_std)
+			miscompare |= si::abs (*result.altitude_amsl_std - *voted_altitude_std) > *io.altitude_miscompare_threshold;
+
+		if (voted_cas && result.speed_cas)
+			miscompare |= si::abs (*result.speed_cas - *voted_cas) > *io.cas_miscompare_threshold;
+
+		channels[i]->miscompare = miscompare;
+	}
+}
+
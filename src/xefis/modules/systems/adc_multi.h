@@ -0,0 +1,177 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__MODULES__SYSTEMS__ADC_MULTI_H__INCLUDED
+#define XEFIS__MODULES__SYSTEMS__ADC_MULTI_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/core/module.h>
+#include <xefis/core/property.h>
+#include <xefis/core/setting.h>
+#include <xefis/support/airframe/airframe.h>
+#include <xefis/support/earth/air/air_data.h>
+
+
+namespace si = neutrino::si;
+using namespace neutrino::si::literals;
+
+
+class MultiChannelAirDataComputerIO: public xf::ModuleIO
+{
+  public:
+	/**
+	 * Properties of a single air data channel.
+	 * Property paths are prefixed with "channel/<index>/".
+	 */
+	class Channel
+	{
+	  public:
+		/*
+		 * Input
+		 */
+
+		xf::PropertyIn<si::Pressure>			pressure_static;
+		xf::PropertyIn<si::Pressure>			pressure_total;
+		xf::PropertyIn<si::Temperature>			total_air_temperature;
+
+		/*
+		 * Output
+		 */
+
+		xf::PropertyOut<si::Pressure>			pressure_dynamic;
+		xf::PropertyOut<si::Length>				altitude_amsl;
+		xf::PropertyOut<si::Length>				altitude_amsl_std;
+		xf::PropertyOut<si::Length>				density_altitude;
+		xf::PropertyOut<si::Density>			air_density;
+		xf::PropertyOut<si::Velocity>			speed_ias;
+		xf::PropertyOut<si::Velocity>			speed_cas;
+		xf::PropertyOut<si::Velocity>			speed_tas;
+		xf::PropertyOut<si::Velocity>			speed_eas;
+		xf::PropertyOut<double>					speed_mach;
+		xf::PropertyOut<si::Velocity>			speed_sound;
+		xf::PropertyOut<si::Temperature>		static_air_temperature;
+		xf::PropertyOut<si::DynamicViscosity>	dynamic_viscosity;
+		xf::PropertyOut<double>					reynolds_number;
+		// Set when channel's altitude or CAS deviates from the voted value more than allowed:
+		xf::PropertyOut<bool>					miscompare;
+
+	  public:
+		// Ctor
+		explicit
+		Channel (xf::ModuleIO*, std::string const& prefix);
+	};
+
+  public:
+	/*
+	 * Settings
+	 */
+
+	xf::Setting<si::Velocity>				ias_valid_minimum				{ this, "ias_valid_minimum" };
+	xf::Setting<si::Velocity>				ias_valid_maximum				{ this, "ias_valid_maximum" };
+	xf::Setting<double>						ram_rise_factor					{ this, "ram_rise_factor", 0.2 };
+	xf::Setting<si::Length>					altitude_miscompare_threshold	{ this, "altitude_miscompare_threshold", 100_ft };
+	xf::Setting<si::Velocity>				cas_miscompare_threshold		{ this, "cas_miscompare_threshold", 5_kt };
+
+	/*
+	 * Input
+	 */
+
+	xf::PropertyIn<bool>					pressure_use_std				{ this, "settings/pressure/use-std", false };
+	xf::PropertyIn<si::Pressure>			pressure_qnh					{ this, "settings/pressure/qnh" };
+
+	/*
+	 * Output
+	 *
+	 * Values voted (median) from all valid channels.
+	 */
+
+	xf::PropertyOut<si::Length>				altitude_amsl					{ this, "voted/altitude/amsl" };
+	xf::PropertyOut<si::Length>				altitude_amsl_std				{ this, "voted/altitude/amsl.std" };
+	xf::PropertyOut<si::Velocity>			speed_ias						{ this, "voted/speed/ias" };
+	xf::PropertyOut<si::Velocity>			speed_cas						{ this, "voted/speed/cas" };
+	xf::PropertyOut<si::Velocity>			speed_tas						{ this, "voted/speed/tas" };
+	xf::PropertyOut<double>					speed_mach						{ this, "voted/speed/mach" };
+	xf::PropertyOut<si::Temperature>		static_air_temperature			{ this, "voted/air-temperature/static" };
+
+  public:
+	// Ctor
+	explicit
+	MultiChannelAirDataComputerIO (std::size_t number_of_channels);
+
+	/**
+	 * Return list of channels.
+	 */
+	std::vector<std::unique_ptr<Channel>> const&
+	channels() const noexcept
+		{ return _channels; }
+
+	/**
+	 * Return channel of given index.
+	 */
+	Channel&
+	channel (std::size_t index) const
+		{ return *_channels.at (index); }
+
+  private:
+	std::vector<std::unique_ptr<Channel>> _channels;
+};
+
+
+/**
+ * Computes air data for many redundant channels at once, using the batched xf::AirDataBatch kernel,
+ * and votes the results between channels every cycle.
+ *
+ * Unlike AirDataComputer, this module doesn't smooth its outputs and doesn't compute lookahead values.
+ * It's meant for redundant sensor sets and monitors; use AirDataComputer on the voted values if smoothing
+ * is required.
+ */
+class MultiChannelAirDataComputer: public xf::Module<MultiChannelAirDataComputerIO>
+{
+  public:
+	// Ctor
+	explicit
+	MultiChannelAirDataComputer (std::unique_ptr<MultiChannelAirDataComputerIO>, xf::Airframe*, std::string_view const& instance = {});
+
+  protected:
+	// Module API
+	void
+	process (xf::Cycle const&) override;
+
+  private:
+	/**
+	 * Fan-out computed results to channels' output properties.
+	 */
+	void
+	publish_channels();
+
+	/**
+	 * Compute voted values and set miscompare flags.
+	 */
+	void
+	vote();
+
+  private:
+	xf::Airframe*					_airframe	{ nullptr };
+	xf::AirDataBatch				_batch;
+	std::vector<xf::AirDataInput>	_inputs;
+	std::vector<xf::AirDataResult>	_results;
+};
+
+#endif
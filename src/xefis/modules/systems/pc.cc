@@ -13,7 +13,6 @@
 
 // Standard:
 #include <cstddef>
-#include <limits>
 
 // Neutrino:
 #include <neutrino/exception.h>
@@ -296,35 +295,18 @@ PerformanceComputer::compute_speeds_vbg()
 {
 	// V-bg - "best glide" - speed for best unpowered range.
 	//
-	// Find AOA and IAS for which lift/drag is at maximum
-	// (equivalent to C_L/C_D).
+	// Use AOA for which lift/drag is at maximum
+	// (equivalent to C_L/C_D), precomputed by the Airframe.
 
 	if (_airframe && io.flaps_angle && io.spoilers_angle)
 	{
 		xf::FlapsAngle flaps_angle (*io.flaps_angle);
 		xf::SpoilersAngle spoilers_angle (*io.spoilers_angle);
+		auto const& envelope = _airframe->performance_envelope (flaps_angle, spoilers_angle);
 
-		xf::Range<si::Angle> aoa_range = _airframe->get_defined_aoa_range();
-
-		std::optional<si::Angle> v_bg_aoa;
-		double v_bg_ratio = std::numeric_limits<double>::max();
-
-		for (si::Angle aoa = aoa_range.min(); aoa < aoa_range.max(); aoa += 0.25_deg)
+		if (envelope.best_lift_to_drag_aoa)
 		{
-			double cl = _airframe->get_cl (aoa, flaps_angle, spoilers_angle);
-			double cd = _airframe->get_cd (aoa, flaps_angle, spoilers_angle);
-			double new_ratio = cl / cd;
-
-			if (new_ratio < v_bg_ratio)
-			{
-				v_bg_ratio = new_ratio;
-				v_bg_aoa = aoa;
-			}
-		}
-
-		if (v_bg_aoa)
-		{
-			auto tas = aoa_to_tas_now (*v_bg_aoa);
+			auto tas = cl_to_tas_now (envelope.best_lift_to_drag_cl);
 
 			if (tas)
 				io.v_bg = tas_to_ias (*tas);
@@ -345,14 +327,14 @@ PerformanceComputer::get_stall_ias (si::Angle const max_bank_angle) const
 	// Formula:
 	//   V_s = sqrt((load_factor * weight) / (0.5 * air_density * wings_area * C_L_max)).
 
-	if (_airframe)
+	if (_airframe && io.flaps_angle && io.spoilers_angle)
 	{
-		xf::FlapsAngle flaps_angle (io.flaps_angle.value_or (0_deg));
-		xf::SpoilersAngle spoilers_angle (io.spoilers_angle.value_or (0_deg));
-		si::Angle max_safe_aoa = _airframe->get_max_safe_aoa (flaps_angle, spoilers_angle);
+		xf::FlapsAngle flaps_angle (*io.flaps_angle);
+		xf::SpoilersAngle spoilers_angle (*io.spoilers_angle);
+		auto const& envelope = _airframe->performance_envelope (flaps_angle, spoilers_angle);
 		si::Acceleration load = 1_g / si::cos (max_bank_angle);
 
-		auto tas = aoa_to_tas_now (max_safe_aoa, load);
+		auto tas = cl_to_tas_now (envelope.max_safe_cl, load);
 
 		if (tas)
 			return tas_to_ias (*tas);
@@ -382,7 +364,7 @@ PerformanceComputer::compute_critical_aoa()
 		xf::FlapsAngle flaps_angle (io.flaps_angle.value_or (0_deg));
 		xf::SpoilersAngle spoilers_angle (io.spoilers_angle.value_or (0_deg));
 
-		io.critical_aoa = _airframe->get_critical_aoa (flaps_angle, spoilers_angle);
+		io.critical_aoa = _airframe->performance_envelope (flaps_angle, spoilers_angle).critical_aoa;
 
 		if (io.aoa_alpha)
 			io.stall = *io.aoa_alpha >= *io.critical_aoa;
@@ -494,14 +476,11 @@ PerformanceComputer::compute_slip_skid()
 
 
 inline std::optional<si::Velocity>
-PerformanceComputer::aoa_to_tas_now (si::Angle const aoa, std::optional<si::Acceleration> const load) const
+PerformanceComputer::cl_to_tas_now (xf::LiftCoefficient const cl, std::optional<si::Acceleration> const load) const
 {
-	if (_airframe && io.load && io.aircraft_mass && io.air_density_static && io.flaps_angle && io.spoilers_angle)
+	if (_airframe && io.load && io.aircraft_mass && io.air_density_static)
 	{
 		si::Area wings_area = _airframe->wings_area();
-		xf::FlapsAngle flaps_angle (*io.flaps_angle);
-		xf::SpoilersAngle spoilers_angle (*io.spoilers_angle);
-		xf::LiftCoefficient cl = _airframe->get_cl (aoa, flaps_angle, spoilers_angle);
 		si::Acceleration xload = load ? *load : *io.load;
 		si::Force lift = xload * *io.aircraft_mass;
 		// Result is TAS:
@@ -163,14 +163,12 @@ class PerformanceComputer: public xf::Module<PerformanceComputerIO>
 	compute_slip_skid();
 
 	/**
-	 * Convert AOA to IAS for current environment and configuration.
-	 * Automatically includes flaps/spoilers angle, so parameter @aoa
-	 * should only be wings AOA.
+	 * Convert C_L to TAS for current environment.
 	 *
 	 * May return empty result if it's not possible to compute TAS.
 	 */
 	std::optional<si::Velocity>
-	aoa_to_tas_now (si::Angle aoa, std::optional<si::Acceleration> load = {}) const;
+	cl_to_tas_now (xf::LiftCoefficient, std::optional<si::Acceleration> load = {}) const;
 
   private:
 	xf::Airframe*					_airframe;
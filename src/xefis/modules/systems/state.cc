@@ -13,12 +13,14 @@
 
 // Standard:
 #include <cstddef>
-#include <algorithm>
-#include <functional>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <optional>
 
 // Qt:
 #include <QtCore/QDir>
-#include <QtCore/QTextStream>
+#include <QtCore/QFile>
 
 // Neutrino:
 #include <neutrino/numeric.h>
@@ -56,77 +58,30 @@ State::State (std::unique_ptr<StateIO> module_io, xf::Logger const& logger, std:
 State::~State()
 {
 	save_state();
-	_save_future.wait();
 }
 
 
 void
 State::process (xf::Cycle const&)
 {
-	for (auto& rp: io._registered_properties)
-	{
-		if (rp.second.changed())
-		{
-			if (_save_future.valid())
-			{
-				if (_save_future.wait_for (std::chrono::seconds (0)) == std::future_status::ready)
-				{
-					try {
-						_save_future.get();
-					}
-					catch (xf::Exception const& e)
-					{
-						_logger << "Encountered error when saving state: " << e.message() << std::endl;
-					}
-
-					save_state();
-				}
-				// TODO else enqueue again
-			}
-			else
-				save_state();
-		}
-	}
+	save_state();
 }
 
 
 void
 State::load_state()
 {
-	try {
-		QDir cwd;
-		QString file_name = cwd.absolutePath() + '/' + QString::fromStdString (*io.file_name);
-		QString content = do_load_state (file_name);
-
-		QDomDocument doc;
-
-		if (!doc.setContent (content, true))
-			throw xf::BadConfiguration ("state file XML parse error" + file_name);
+	QDir cwd;
+	QString file_name = cwd.absolutePath() + '/' + QString::fromStdString (*io.file_name);
 
-		if (doc.documentElement() == "xefis-mod-systems-state")
+	try {
+		try {
+			_journal = std::make_unique<xf::StateJournal> (file_name.toStdString(), _logger);
+			apply (_journal->loaded_values());
+		}
+		catch (xf::StateJournal::InvalidFormat const&)
 		{
-			for (QDomElement const& e: xf::iterate_sub_elements (doc.documentElement()))
-			{
-				if (e == "state-variable")
-				{
-					auto id = e.attribute ("id").toStdString();
-
-					if (auto rp = io._registered_properties.find (id); rp != io._registered_properties.end())
-					{
-						try {
-							rp->second.property.from_blob (xf::parse_hex_string (e.attribute ("value")));
-						}
-						catch (xf::Exception const& e)
-						{
-							_logger << "Failed to load setting '" << id << "': " << e.message() << std::endl;
-						}
-					}
-					else
-						_logger << "Ignoring not configured setting '" << id << "'" << std::endl;
-				}
-				else
-					_logger << "Unknown element <" << e.tagName().toStdString() << ">";
-			}
+			import_legacy_state (file_name);
 		}
 	}
 	catch (xf::Exception const& e)
@@ -137,74 +92,113 @@ State::load_state()
 
 
 void
-State::save_state()
+State::import_legacy_state (QString const& file_name)
 {
+	std::optional<xf::StateJournal::Values> legacy_values;
+
 	try {
-		QDomDocument doc;
-		QDomElement root = doc.createElement ("xefis-mod-systems-state");
-		doc.appendChild (root);
+		legacy_values = load_legacy_state (file_name);
+		apply (*legacy_values);
+	}
+	catch (xf::Exception const& e)
+	{
+		_logger << "State file is neither a journal nor a valid XML file: " << e.message() << std::endl;
+	}
 
-		for (auto const& rp: io._registered_properties)
-		{
-			QDomElement rp_element = doc.createElement ("state-variable");
-			rp_element.setAttribute ("id", QString::fromStdString (rp.first));
-			rp_element.setAttribute ("value", QString::fromStdString (xf::to_hex_string (rp.second.property.to_blob())));
-			root.appendChild (rp_element);
-		}
+	// Write the new journal next to the old file first:
+	QString const new_file_name = file_name + ".new";
+	QFile::remove (new_file_name);
+
+	{
+		xf::StateJournal new_journal (new_file_name.toStdString(), _logger);
 
-		// Wait for previous std::async to finish:
-		if (_save_future.valid())
-			_save_future.wait();
+		if (legacy_values)
+			for (auto const& [id, value]: *legacy_values)
+				new_journal.record (id, value);
 
-		_save_future = std::async (std::launch::async, do_save_state, doc.toString(), QString::fromStdString (*io.file_name));
+		new_journal.flush();
+	}
+
+	// Writer thread only logs errors, so check that the journal was written correctly:
+	if (xf::StateJournal (new_file_name.toStdString(), _logger).loaded_values() != legacy_values.value_or (xf::StateJournal::Values()))
+		throw xf::IOError ("couldn't write state journal '" + new_file_name + "'");
+
+	QString const backup_file_name = file_name + (legacy_values ? ".xml" : ".corrupted");
+	_logger << "Replacing old state file with a journal; old file is kept as " << backup_file_name.toStdString() << std::endl;
+	QFile::remove (backup_file_name);
+
+	if (!QFile::copy (file_name, backup_file_name))
+		throw xf::IOError ("couldn't copy '" + file_name + "' to '" + backup_file_name + "'");
+
+	// Atomically replace the old file (QFile::rename() doesn't overwrite files):
+	if (::rename (new_file_name.toStdString().c_str(), file_name.toStdString().c_str()) < 0)
+		throw xf::IOError ("couldn't rename '" + new_file_name + "' to '" + file_name + "': " + strerror (errno));
+
+	_journal = std::make_unique<xf::StateJournal> (file_name.toStdString(), _logger);
+}
+
+
+void
+State::save_state()
+{
+	if (!_journal)
+		return;
+
+	try {
+		for (auto& rp: io._registered_properties)
+			if (rp.second.changed())
+				_journal->record (rp.first, rp.second.property.to_blob());
 	}
 	catch (xf::Exception const& e)
 	{
 		_logger << "Error when saving state: " << e.message() << std::endl;
 	}
-	catch (std::exception const& e)
+}
+
+
+void
+State::apply (xf::StateJournal::Values const& values)
+{
+	for (auto const& [id, value]: values)
 	{
-		_logger << "System error: " << e.what() << std::endl;
+		if (auto rp = io._registered_properties.find (id); rp != io._registered_properties.end())
+		{
+			try {
+				rp->second.property.from_blob (value);
+				// Don't record loaded value again:
+				rp->second.changed();
+			}
+			catch (xf::Exception const& e)
+			{
+				_logger << "Failed to load setting '" << id << "': " << e.message() << std::endl;
+			}
+		}
+		else
+			_logger << "Ignoring not configured setting '" << id << "'" << std::endl;
 	}
 }
 
 
-QString
-State::do_load_state (QString file_name)
+xf::StateJournal::Values
+State::load_legacy_state (QString const& file_name)
 {
 	QFile file (file_name);
 
-	if (!file.exists())
-		throw xf::BadConfiguration ("file '" + file.fileName() + "' not found");
-
 	if (!file.open (QFile::ReadOnly))
 		throw xf::IOError ("couldn't open '" + file.fileName() + "' for read: " + file.errorString());
 
-	return file.readAll();
-}
+	QDomDocument doc;
 
+	if (!doc.setContent (file.readAll(), true))
+		throw xf::BadConfiguration ("state file XML parse error" + file_name);
 
-void
-State::do_save_state (QString content, QString file_name)
-{
-	QDir cwd;
-	QString target_file_name = cwd.absolutePath() + '/' + file_name;
-	QString temp_file_name = target_file_name + '~';
+	xf::StateJournal::Values values;
 
-	QFile file (temp_file_name);
+	if (doc.documentElement() == "xefis-mod-systems-state")
+		for (QDomElement const& e: xf::iterate_sub_elements (doc.documentElement()))
+			if (e == "state-variable")
+				values[e.attribute ("id").toStdString()] = xf::parse_hex_string (e.attribute ("value"));
 
-	if (!file.open (QFile::WriteOnly))
-		throw xf::IOError ("couldn't open '" + file.fileName() + "' for save: " + file.errorString());
-
-	QTextStream ts (&file);
-	ts << content;
-	file.flush();
-	file.close();
-	if (::rename (temp_file_name.toUtf8(), target_file_name.toUtf8()) == -1)
-	{
-		char buf[256];
-		static_cast<void> (strerror_r (errno, buf, std::size (buf)));
-		throw xf::IOError (QString ("couldn't save settings file: %1").arg (buf));
-	}
+	return values;
 }
 
@@ -16,8 +16,8 @@
 
 // Standard:
 #include <cstddef>
-#include <future>
 #include <map>
+#include <memory>
 
 // Neutrino:
 #include <neutrino/logger.h>
@@ -27,6 +27,7 @@
 #include <xefis/core/module.h>
 #include <xefis/core/property.h>
 #include <xefis/core/setting.h>
+#include <xefis/support/persistence/state_journal.h>
 #include <xefis/utility/actions.h>
 
 
@@ -91,27 +92,42 @@ class State: public xf::Module<StateIO>
 
   private:
 	/**
-	 * Load data from the file.
+	 * Open the journal and load registered properties from it.
 	 */
 	void
 	load_state();
 
 	/**
-	 * Save data to the file.
-	 * Runs saving code in a separate thread.
+	 * Record changed properties in the journal.
+	 * Writing to disk happens in journal's thread.
 	 */
 	void
 	save_state();
 
-	static QString
-	do_load_state (QString file_name);
+	/**
+	 * Set registered properties to given values.
+	 */
+	void
+	apply (xf::StateJournal::Values const&);
 
-	static void
-	do_save_state (QString content, QString file_name);
+	/**
+	 * Replace file that is not a journal with a journal. Values from XML state file written by previous
+	 * versions of this module are applied and imported; the file is kept as a backup with ".xml" suffix.
+	 * Unreadable file is kept with ".corrupted" suffix. Original file is replaced only after the new
+	 * journal is written, so that import is retried on next start if it fails.
+	 */
+	void
+	import_legacy_state (QString const& file_name);
+
+	/**
+	 * Load XML state file written by previous versions of this module.
+	 */
+	static xf::StateJournal::Values
+	load_legacy_state (QString const& file_name);
 
   private:
-	xf::Logger				_logger;
-	std::future<void>		_save_future;
+	xf::Logger							_logger;
+	std::unique_ptr<xf::StateJournal>	_journal;
 };
 
 #endif
@@ -40,6 +40,9 @@ TrimControl::TrimControl (std::unique_ptr<TrimControlIO> module_io, xf::SoundMan
 		&io.down_trim_button,
 	});
 
+	if (_sound_manager)
+		_sound_manager->preload (XEFIS_SHARED_DIRECTORY "/sounds/trim-bip.wav");
+
 	update_trim_without_sound();
 }
 
@@ -16,7 +16,6 @@
 
 // System:
 #include <sys/unistd.h>
-#include <sys/fcntl.h>
 
 // Xefis:
 #include <xefis/config/all.h>
@@ -51,23 +50,32 @@ Watchdog::Watchdog (xf::Xefis* xefis, xf::Logger const& logger, std::string_view
 	_watchdog_read_fd = *watchdog_read_fd;
 
 	if (_enabled)
-	{
-		_notifier = std::make_unique<QSocketNotifier> (_watchdog_read_fd, QSocketNotifier::Read);
-		_notifier->setEnabled (true);
-		QObject::connect (_notifier.get(), &QSocketNotifier::activated, std::bind (&Watchdog::ping, this));
-		// Read should be non-blocking:
-		::fcntl (_watchdog_read_fd, F_SETFL, O_NONBLOCK);
-	}
+		_source = xefis->io_reactor().add (_watchdog_read_fd);
+}
+
+
+void
+Watchdog::communicate (xf::Cycle const&)
+{
+	if (!_source)
+		return;
+
+	_source->take (_pings);
+
+	for (auto const& chunk: _pings)
+		pong (chunk.data);
+
+	if (!_pings.empty())
+		::fsync (_watchdog_write_fd);
 }
 
 
 void
-Watchdog::ping()
+Watchdog::pong (xf::Blob const& pings)
 {
-	uint8_t c;
 	int n = 0;
 
-	while ((n = ::read (_watchdog_read_fd, &c, 1)) > 0)
+	for (uint8_t c: pings)
 	{
 		c ^= 0x55;
 
@@ -87,7 +95,5 @@ Watchdog::ping()
 			}
 		}
 	}
-
-	::fsync (_watchdog_write_fd);
 }
 
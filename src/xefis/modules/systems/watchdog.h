@@ -16,15 +16,14 @@
 
 // Standard:
 #include <cstddef>
-
-// Qt:
-#include <QtCore/QSocketNotifier>
+#include <memory>
 
 // Neutrino:
 #include <neutrino/logger.h>
 
 // Xefis:
 #include <xefis/config/all.h>
+#include <xefis/core/io_reactor.h>
 #include <xefis/core/module.h>
 #include <xefis/core/module_io.h>
 
@@ -39,19 +38,25 @@ class Watchdog: public xf::Module<>
 	explicit
 	Watchdog (xf::Xefis*, xf::Logger const&, std::string_view const& instance = {});
 
+	// Module API
+	void
+	communicate (xf::Cycle const&) override;
+
   private:
 	/**
-	 * Ping arrived.
+	 * Answer pings received since last cycle. Pongs are sent from the processing loop,
+	 * so that the watchdog notices when the loop hangs.
 	 */
 	void
-	ping();
+	pong (xf::Blob const& pings);
 
   private:
-	xf::Logger							_logger;
-	std::unique_ptr<QSocketNotifier>	_notifier;
-	bool								_enabled			= false;
-	int									_watchdog_write_fd	= 0;
-	int									_watchdog_read_fd	= 0;
+	xf::Logger								_logger;
+	std::unique_ptr<xf::IOReactor::Source>	_source;
+	xf::IOReactor::Chunks					_pings;
+	bool									_enabled			= false;
+	int										_watchdog_write_fd	= 0;
+	int										_watchdog_read_fd	= 0;
 };
 
 #endif
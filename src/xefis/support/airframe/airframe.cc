@@ -13,6 +13,7 @@
 
 // Standard:
 #include <cstddef>
+#include <limits>
 
 // Neutrino:
 #include <neutrino/qt/qdom.h>
@@ -84,5 +85,50 @@ Airframe::get_max_safe_aoa (FlapsAngle const flaps_angle, SpoilersAngle const sp
 	return get_critical_aoa (flaps_angle, spoilers_angle) + safe_aoa_correction();
 }
 
+
+PerformanceEnvelope const&
+Airframe::performance_envelope (FlapsAngle const flaps_angle, SpoilersAngle const spoilers_angle) const
+{
+	auto const& flaps_setting = flaps().find_setting (flaps_angle);
+	auto const& spoilers_setting = spoilers().find_setting (spoilers_angle);
+	auto const key = EnvelopeKey (&flaps_setting, &spoilers_setting);
+
+	if (auto found = _performance_envelopes.find (key); found != _performance_envelopes.end())
+		return found->second;
+
+	return _performance_envelopes.emplace (key, compute_performance_envelope (flaps_setting, spoilers_setting)).first->second;
+}
+
+
+PerformanceEnvelope
+Airframe::compute_performance_envelope (LiftMod::Setting const& flaps_setting, LiftMod::Setting const& spoilers_setting) const
+{
+	FlapsAngle const flaps_angle (flaps_setting.angle());
+	SpoilersAngle const spoilers_angle (spoilers_setting.angle());
+	PerformanceEnvelope envelope;
+
+	// Best glide is where lift/drag ratio is at maximum:
+	double best_ratio = std::numeric_limits<double>::lowest();
+
+	for (si::Angle aoa = _defined_aoa_range.min(); aoa < _defined_aoa_range.max(); aoa += kEnvelopeAoaStep)
+	{
+		LiftCoefficient const cl = get_cl (aoa, flaps_angle, spoilers_angle);
+		double const ratio = cl / get_cd (aoa, flaps_angle, spoilers_angle);
+
+		if (ratio > best_ratio)
+		{
+			best_ratio = ratio;
+			envelope.best_lift_to_drag_aoa = aoa;
+			envelope.best_lift_to_drag_cl = cl;
+		}
+	}
+
+	envelope.critical_aoa = get_critical_aoa (flaps_angle, spoilers_angle);
+	envelope.max_safe_aoa = envelope.critical_aoa + safe_aoa_correction();
+	envelope.max_safe_cl = get_cl (envelope.max_safe_aoa, flaps_angle, spoilers_angle);
+
+	return envelope;
+}
+
 } // namespace xf
 
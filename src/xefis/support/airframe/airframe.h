@@ -16,7 +16,9 @@
 
 // Standard:
 #include <cstddef>
+#include <map>
 #include <optional>
+#include <utility>
 
 // Neutrino:
 #include <neutrino/stdexcept.h>
@@ -52,11 +54,31 @@ struct AirframeDefinition
 };
 
 
+/**
+ * Aerodynamic characteristics of the airframe precomputed for one flaps/spoilers configuration.
+ * Speeds depend on current mass and air density, so only lift coefficients are stored;
+ * a speed for given C_L is a single square root away.
+ */
+struct PerformanceEnvelope
+{
+	// AOA and C_L for best lift/drag ratio (best glide), if lift and drag are defined:
+	std::optional<si::Angle>	best_lift_to_drag_aoa;
+	LiftCoefficient				best_lift_to_drag_cl	{ 0.0 };
+	si::Angle					critical_aoa;
+	si::Angle					max_safe_aoa;
+	// C_L at max safe AOA, for computing stall speeds:
+	LiftCoefficient				max_safe_cl				{ 0.0 };
+};
+
+
 /**
  * Contains submodules that describe an airframe.
  */
 class Airframe
 {
+	// Step used when searching for best lift/drag ratio:
+	static constexpr si::Angle kEnvelopeAoaStep = 0.25_deg;
+
   public:
 	// Ctor
 	explicit
@@ -147,9 +169,26 @@ class Airframe
 	Range<double>
 	load_factor_limits() const;
 
+	/**
+	 * Return performance envelope for the flaps and spoilers settings nearest to given angles.
+	 * Envelopes are computed on first use and cached; since the airframe definition can't change,
+	 * they're valid for the lifetime of the Airframe object.
+	 *
+	 * Not thread-safe.
+	 */
+	PerformanceEnvelope const&
+	performance_envelope (FlapsAngle, SpoilersAngle) const;
+
   private:
-	AirframeDefinition	_definition;
-	Range<si::Angle>	_defined_aoa_range;
+	PerformanceEnvelope
+	compute_performance_envelope (LiftMod::Setting const& flaps_setting, LiftMod::Setting const& spoilers_setting) const;
+
+  private:
+	using EnvelopeKey = std::pair<LiftMod::Setting const*, LiftMod::Setting const*>;
+
+	AirframeDefinition									_definition;
+	Range<si::Angle>									_defined_aoa_range;
+	mutable std::map<EnvelopeKey, PerformanceEnvelope>	_performance_envelopes;
 };
 
 
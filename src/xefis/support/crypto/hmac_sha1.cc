@@ -0,0 +1,169 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <algorithm>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Local:
+#include "hmac_sha1.h"
+
+
+namespace xf {
+namespace {
+
+constexpr HMACSHA1::State kSHA1InitialState { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+
+
+constexpr uint32_t
+rotate_left (uint32_t const value, int const bits) noexcept
+{
+	return (value << bits) | (value >> (32 - bits));
+}
+
+
+/**
+ * Process single 64-byte block.
+ */
+void
+sha1_compress (HMACSHA1::State& state, uint8_t const* block) noexcept
+{
+	std::array<uint32_t, 80> w;
+
+	for (std::size_t i = 0; i < 16; ++i)
+		w[i] = (uint32_t (block[4 * i]) << 24) | (uint32_t (block[4 * i + 1]) << 16) | (uint32_t (block[4 * i + 2]) << 8) | block[4 * i + 3];
+
+	for (std::size_t i = 16; i < 80; ++i)
+		w[i] = rotate_left (w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+	auto [a, b, c, d, e] = state;
+
+	for (std::size_t i = 0; i < 80; ++i)
+	{
+		uint32_t f, k;
+
+		if (i < 20)
+		{
+			f = (b & c) | (~b & d);
+			k = 0x5a827999;
+		}
+		else if (i < 40)
+		{
+			f = b ^ c ^ d;
+			k = 0x6ed9eba1;
+		}
+		else if (i < 60)
+		{
+			f = (b & c) | (b & d) | (c & d);
+			k = 0x8f1bbcdc;
+		}
+		else
+		{
+			f = b ^ c ^ d;
+			k = 0xca62c1d6;
+		}
+
+		uint32_t const temp = rotate_left (a, 5) + f + e + k + w[i];
+		e = d;
+		d = c;
+		c = rotate_left (b, 30);
+		b = a;
+		a = temp;
+	}
+
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+}
+
+
+/**
+ * Finish SHA-1 hash started with state that has already processed prefix_size bytes (a multiple of the block size).
+ */
+HMACSHA1::Result
+sha1_finish (HMACSHA1::State state, std::size_t const prefix_size, uint8_t const* data, std::size_t const size) noexcept
+{
+	constexpr auto kBlockSize = HMACSHA1::kBlockSize;
+
+	// Full blocks are hashed directly from the input:
+	std::size_t const full_blocks_size = size - size % kBlockSize;
+
+	for (std::size_t offset = 0; offset < full_blocks_size; offset += kBlockSize)
+		sha1_compress (state, data + offset);
+
+	// Remaining bytes, 0x80 and big-endian length in bits need one or two more blocks:
+	std::array<uint8_t, 2 * kBlockSize> tail {};
+	std::size_t const rest = size - full_blocks_size;
+	std::size_t const tail_size = rest + 9 <= kBlockSize ? kBlockSize : 2 * kBlockSize;
+	uint64_t const bits = 8 * static_cast<uint64_t> (prefix_size + size);
+
+	std::copy (data + full_blocks_size, data + size, tail.begin());
+	tail[rest] = 0x80;
+
+	for (std::size_t i = 0; i < 8; ++i)
+		tail[tail_size - 1 - i] = (bits >> (8 * i)) & 0xff;
+
+	for (std::size_t offset = 0; offset < tail_size; offset += kBlockSize)
+		sha1_compress (state, tail.data() + offset);
+
+	HMACSHA1::Result result;
+
+	for (std::size_t i = 0; i < state.size(); ++i)
+		for (std::size_t j = 0; j < 4; ++j)
+			result[4 * i + j] = (state[i] >> (24 - 8 * j)) & 0xff;
+
+	return result;
+}
+
+} // namespace
+
+
+HMACSHA1::HMACSHA1 (uint8_t const* key, std::size_t const key_size) noexcept:
+	_inner_state (kSHA1InitialState),
+	_outer_state (kSHA1InitialState)
+{
+	std::array<uint8_t, kBlockSize> key_block {};
+
+	// Keys longer than a block are hashed first:
+	if (key_size > kBlockSize)
+	{
+		auto const key_hash = sha1_finish (kSHA1InitialState, 0, key, key_size);
+		std::copy (key_hash.begin(), key_hash.end(), key_block.begin());
+	}
+	else
+		std::copy (key, key + key_size, key_block.begin());
+
+	std::array<uint8_t, kBlockSize> pad;
+
+	std::transform (key_block.begin(), key_block.end(), pad.begin(), [](uint8_t byte) { return byte ^ 0x36; });
+	sha1_compress (_inner_state, pad.data());
+
+	std::transform (key_block.begin(), key_block.end(), pad.begin(), [](uint8_t byte) { return byte ^ 0x5c; });
+	sha1_compress (_outer_state, pad.data());
+}
+
+
+HMACSHA1::Result
+HMACSHA1::operator() (uint8_t const* data, std::size_t const size) const noexcept
+{
+	auto const inner_hash = sha1_finish (_inner_state, kBlockSize, data, size);
+	return sha1_finish (_outer_state, kBlockSize, inner_hash.data(), inner_hash.size());
+}
+
+} // namespace xf
+
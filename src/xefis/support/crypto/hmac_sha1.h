@@ -0,0 +1,63 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__CRYPTO__HMAC_SHA1_H__INCLUDED
+#define XEFIS__SUPPORT__CRYPTO__HMAC_SHA1_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <array>
+#include <cstdint>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+
+namespace xf {
+
+/**
+ * HMAC-SHA1 (RFC 2104) with a fixed key.
+ * SHA-1 states after hashing the inner and outer padded key blocks are computed once in the constructor,
+ * so that computing a MAC costs only hashing of the message and the inner digest. Message is hashed
+ * in place, without copying.
+ */
+class HMACSHA1
+{
+  public:
+	static constexpr std::size_t kBlockSize		= 64;
+	static constexpr std::size_t kResultSize	= 20;
+
+	using Result	= std::array<uint8_t, kResultSize>;
+	using State		= std::array<uint32_t, 5>;
+
+  public:
+	// Ctor
+	explicit
+	HMACSHA1 (uint8_t const* key, std::size_t key_size) noexcept;
+
+	/**
+	 * Compute MAC of data.
+	 */
+	[[nodiscard]]
+	Result
+	operator() (uint8_t const* data, std::size_t size) const noexcept;
+
+  private:
+	State	_inner_state;
+	State	_outer_state;
+};
+
+} // namespace xf
+
+#endif
+
@@ -0,0 +1,128 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Local:
+#include "siphash.h"
+
+
+namespace xf {
+namespace {
+
+constexpr uint64_t
+rotate_left (uint64_t const value, int const bits) noexcept
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+
+constexpr uint64_t
+load_little_endian (uint8_t const* data, std::size_t const size = 8) noexcept
+{
+	uint64_t result = 0;
+
+	for (std::size_t i = 0; i < size; ++i)
+		result |= static_cast<uint64_t> (data[i]) << (8 * i);
+
+	return result;
+}
+
+
+struct State
+{
+	uint64_t v0, v1, v2, v3;
+
+	constexpr void
+	round() noexcept
+	{
+		v0 += v1;
+		v1 = rotate_left (v1, 13);
+		v1 ^= v0;
+		v0 = rotate_left (v0, 32);
+		v2 += v3;
+		v3 = rotate_left (v3, 16);
+		v3 ^= v2;
+		v0 += v3;
+		v3 = rotate_left (v3, 21);
+		v3 ^= v0;
+		v2 += v1;
+		v1 = rotate_left (v1, 17);
+		v1 ^= v2;
+		v2 = rotate_left (v2, 32);
+	}
+
+	constexpr void
+	compress (uint64_t const message) noexcept
+	{
+		v3 ^= message;
+		round();
+		round();
+		v0 ^= message;
+	}
+};
+
+} // namespace
+
+
+SipHash::SipHash (Key const& key) noexcept:
+	_k0 (load_little_endian (key.data())),
+	_k1 (load_little_endian (key.data() + 8))
+{ }
+
+
+uint64_t
+SipHash::hash (uint8_t const* data, std::size_t const size) const noexcept
+{
+	State state {
+		_k0 ^ 0x736f6d6570736575ULL,
+		_k1 ^ 0x646f72616e646f6dULL,
+		_k0 ^ 0x6c7967656e657261ULL,
+		_k1 ^ 0x7465646279746573ULL,
+	};
+
+	std::size_t const full_blocks_size = size - size % 8;
+
+	for (std::size_t i = 0; i < full_blocks_size; i += 8)
+		state.compress (load_little_endian (data + i));
+
+	// Last block contains remaining bytes and message length:
+	state.compress (load_little_endian (data + full_blocks_size, size % 8) | (static_cast<uint64_t> (size) << 56));
+
+	state.v2 ^= 0xff;
+
+	for (int i = 0; i < 4; ++i)
+		state.round();
+
+	return state.v0 ^ state.v1 ^ state.v2 ^ state.v3;
+}
+
+
+SipHash::Result
+SipHash::operator() (uint8_t const* data, std::size_t const size) const noexcept
+{
+	auto const value = hash (data, size);
+	Result result;
+
+	for (std::size_t i = 0; i < result.size(); ++i)
+		result[i] = static_cast<uint8_t> (value >> (8 * i));
+
+	return result;
+}
+
+} // namespace xf
+
@@ -0,0 +1,68 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__CRYPTO__SIPHASH_H__INCLUDED
+#define XEFIS__SUPPORT__CRYPTO__SIPHASH_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <array>
+#include <cstdint>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+
+namespace xf {
+
+/**
+ * SipHash-2-4 keyed hash function (a fast MAC for short messages).
+ * The key is converted to internal form once in the constructor.
+ */
+class SipHash
+{
+  public:
+	static constexpr std::size_t kKeySize		= 16;
+	static constexpr std::size_t kResultSize	= 8;
+
+	using Key		= std::array<uint8_t, kKeySize>;
+	using Result	= std::array<uint8_t, kResultSize>;
+
+  public:
+	// Ctor
+	explicit
+	SipHash (Key const&) noexcept;
+
+	/**
+	 * Compute 64-bit hash of data.
+	 */
+	[[nodiscard]]
+	uint64_t
+	hash (uint8_t const* data, std::size_t size) const noexcept;
+
+	/**
+	 * Compute hash of data and return it as little-endian bytes.
+	 */
+	[[nodiscard]]
+	Result
+	operator() (uint8_t const* data, std::size_t size) const noexcept;
+
+  private:
+	uint64_t	_k0;
+	uint64_t	_k1;
+};
+
+} // namespace xf
+
+#endif
+
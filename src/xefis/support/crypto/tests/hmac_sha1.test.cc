@@ -0,0 +1,62 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Neutrino:
+#include <neutrino/test/auto_test.h>
+
+// Xefis:
+#include <xefis/support/crypto/hmac_sha1.h>
+
+
+namespace xf::test {
+namespace {
+
+bool
+hmac_equals (std::vector<uint8_t> const& key, std::string const& message, HMACSHA1::Result const& expected)
+{
+	HMACSHA1 const hmac (key.data(), key.size());
+	return hmac (reinterpret_cast<uint8_t const*> (message.data()), message.size()) == expected;
+}
+
+
+AutoTest t1 ("HMAC-SHA1 reference vectors", []{
+	// Vectors from RFC 2202:
+	test_asserts::verify ("short key and message", hmac_equals (std::vector<uint8_t> (20, 0x0b), "Hi There", {
+		0xb6, 0x17, 0x31, 0x86, 0x55, 0x05, 0x72, 0x64, 0xe2, 0x8b, 0xc0, 0xb6, 0xfb, 0x37, 0x8c, 0x8e, 0xf1, 0x46, 0xbe, 0x00,
+	}));
+
+	test_asserts::verify ("key shorter than digest", hmac_equals ({ 'J', 'e', 'f', 'e' }, "what do ya want for nothing?", {
+		0xef, 0xfc, 0xdf, 0x6a, 0xe5, 0xeb, 0x2f, 0xa2, 0xd2, 0x74, 0x16, 0xd5, 0xf1, 0x84, 0xdf, 0x9c, 0x25, 0x9a, 0x7c, 0x79,
+	}));
+
+	test_asserts::verify ("50-byte message", hmac_equals (std::vector<uint8_t> (20, 0xaa), std::string (50, '\xdd'), {
+		0x12, 0x5d, 0x73, 0x42, 0xb9, 0xac, 0x11, 0xcd, 0x91, 0xa3, 0x9a, 0xf4, 0x8a, 0xa1, 0x7b, 0x4f, 0x63, 0xf1, 0x75, 0xd3,
+	}));
+
+	test_asserts::verify ("key longer than block", hmac_equals (std::vector<uint8_t> (80, 0xaa), "Test Using Larger Than Block-Size Key - Hash Key First", {
+		0xaa, 0x4a, 0xe5, 0xe1, 0x52, 0x72, 0xd0, 0x0e, 0x95, 0x70, 0x56, 0x37, 0xce, 0x8a, 0x3b, 0x55, 0xed, 0x40, 0x21, 0x12,
+	}));
+
+	test_asserts::verify ("message longer than block", hmac_equals (std::vector<uint8_t> (80, 0xaa), "Test Using Larger Than Block-Size Key and Larger Than One Block-Size Data", {
+		0xe8, 0xe9, 0x9d, 0x0f, 0x45, 0x23, 0x7d, 0x78, 0x6d, 0x6b, 0xba, 0xa7, 0x96, 0x5c, 0x78, 0x08, 0xbb, 0xff, 0x1a, 0x91,
+	}));
+});
+
+} // namespace
+} // namespace xf::test
+
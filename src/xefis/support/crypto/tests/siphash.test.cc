@@ -0,0 +1,50 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <vector>
+
+// Neutrino:
+#include <neutrino/test/auto_test.h>
+
+// Xefis:
+#include <xefis/support/crypto/siphash.h>
+
+
+namespace xf::test {
+namespace {
+
+AutoTest t1 ("SipHash-2-4 reference vectors", []{
+	SipHash::Key key;
+	std::vector<uint8_t> message;
+
+	for (std::size_t i = 0; i < key.size(); ++i)
+		key[i] = i;
+
+	for (uint8_t i = 0; i < 15; ++i)
+		message.push_back (i);
+
+	SipHash const siphash (key);
+
+	// Vectors from the SipHash paper and reference implementation:
+	test_asserts::verify ("hash of empty message is correct", siphash.hash (message.data(), 0) == 0x726fdb47dd0e0e31ULL);
+	test_asserts::verify ("hash of 15-byte message is correct", siphash.hash (message.data(), message.size()) == 0xa129ca6149be45e5ULL);
+
+	auto const result = siphash (message.data(), message.size());
+	test_asserts::verify ("result bytes are little-endian", result[0] == 0xe5 && result[7] == 0xa1);
+});
+
+} // namespace
+} // namespace xf::test
+
@@ -13,8 +13,10 @@
 
 // Standard:
 #include <cstddef>
+#include <algorithm>
 #include <iomanip>
 #include <map>
+#include <type_traits>
 
 // Lib:
 #include <boost/endian/conversion.hpp>
@@ -104,41 +106,73 @@ CHRUM6::CHRUM6 (SerialPort* serial_port, Logger const& logger):
 }
 
 
+CHRUM6::CHRUM6 (Output output, Logger const& logger):
+	_output (output)
+{
+	_packet_reader = std::make_unique<PacketReader> (Blob { 's', 'n', 'p' }, std::bind (&CHRUM6::parse_packet, this));
+	_packet_reader->set_minimum_packet_size (7);
+	_packet_reader->set_buffer_capacity (4096);
+
+	set_logger (logger);
+}
+
+
 void
 CHRUM6::set_logger (Logger const& logger)
 {
 	_logger = logger.with_scope (kLoggerScope);
-	_serial_port->set_logger (_logger);
+
+	if (_serial_port)
+		_serial_port->set_logger (_logger);
 }
 
 
 CHRUM6::Read
 CHRUM6::read (ConfigurationAddress address, ReadCallback callback)
 {
-	_requests.push (std::make_unique<Read> (address, callback));
-	Read ret = *dynamic_cast<Read*> (_requests.back().get());
-	process_queue();
-	return ret;
+	return enqueue (Read (address, callback));
 }
 
 
 CHRUM6::Read
 CHRUM6::read (DataAddress address, ReadCallback callback)
 {
-	_requests.push (std::make_unique<Read> (address, callback));
-	Read ret = *dynamic_cast<Read*> (_requests.back().get());
-	process_queue();
-	return ret;
+	return enqueue (Read (address, callback));
+}
+
+
+std::vector<CHRUM6::Read>
+CHRUM6::read_batch (ConfigurationAddress first, std::size_t count, ReadCallback callback)
+{
+	return read_batch (static_cast<uint32_t> (first), count, callback);
+}
+
+
+std::vector<CHRUM6::Read>
+CHRUM6::read_batch (DataAddress first, std::size_t count, ReadCallback callback)
+{
+	return read_batch (static_cast<uint32_t> (first), count, callback);
 }
 
 
 CHRUM6::Write
 CHRUM6::write (ConfigurationAddress address, uint32_t value, WriteCallback callback)
 {
-	_requests.push (std::make_unique<Write> (address, value, callback));
-	Write ret = *dynamic_cast<Write*> (_requests.back().get());
-	process_queue();
-	return ret;
+	if (!callback)
+	{
+		// Coalesce with a write that's not sent yet (eg. frequently updated AccelRef registers):
+		for (auto& request: _pending)
+		{
+			if (auto* write = dynamic_cast<Write*> (request.get()); write && write->address() == static_cast<uint32_t> (address) && !(*write)->write_callback)
+			{
+				write->setup (static_cast<uint32_t> (address), true, value);
+				(*write)->value = value;
+				return *write;
+			}
+		}
+	}
+
+	return enqueue (Write (address, value, callback));
 }
 
 
@@ -153,10 +187,47 @@ CHRUM6::write (ConfigurationAddress address, float value, WriteCallback callback
 CHRUM6::Command
 CHRUM6::command (CommandAddress address, CommandCallback callback)
 {
-	_requests.push (std::make_unique<Command> (address, callback));
-	Command ret = *dynamic_cast<Command*> (_requests.back().get());
+	return enqueue (Command (address, callback));
+}
+
+
+void
+CHRUM6::feed (Blob const& data)
+{
+	_packet_reader->feed (data);
+}
+
+
+void
+CHRUM6::process_timeouts()
+{
+	si::Time const now = TimeHelper::now();
+	std::vector<std::unique_ptr<Request>> timed_out;
+
+	for (std::size_t i = 0; i < _in_flight.size(); )
+	{
+		auto* data = _in_flight[i]->data();
+
+		if (now - data->start_timestamp >= data->timeout)
+			timed_out.push_back (take_in_flight (_in_flight.begin() + i));
+		else
+			++i;
+	}
+
+	// Callbacks may issue new requests, so call them after _in_flight is updated:
+	for (auto& request: timed_out)
+		finish_request (*request, now, false, ProtocolError::Timeout);
+
 	process_queue();
-	return ret;
+}
+
+
+void
+CHRUM6::reset()
+{
+	_pending.clear();
+	_in_flight.clear();
+	_in_flight_packets = 0;
 }
 
 
@@ -196,7 +267,7 @@ CHRUM6::bits_for_baud_rate (unsigned int baud_rate)
 void
 CHRUM6::serial_ready()
 {
-	_packet_reader->feed (_serial_port->input_buffer());
+	feed (_serial_port->input_buffer());
 	_serial_port->input_buffer().clear();
 }
 
@@ -209,16 +280,125 @@ CHRUM6::serial_failure()
 }
 
 
+template<class pRequest>
+	pRequest
+	CHRUM6::enqueue (pRequest request)
+	{
+		request->timeout = std::is_same_v<pRequest, Command> ? _command_timeout : _request_timeout;
+		_pending.push_back (std::make_unique<pRequest> (request));
+		process_queue();
+		return request;
+	}
+
+
+std::vector<CHRUM6::Read>
+CHRUM6::read_batch (uint32_t first, std::size_t count, ReadCallback callback)
+{
+	if (count < 1 || count > kMaxBatchSize)
+		throw InvalidArgument ("CHRUM6::read_batch(): count must be in range 1…kMaxBatchSize");
+
+	std::vector<Read> reads;
+	reads.reserve (count);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		Read read (static_cast<DataAddress> (first + i), callback);
+		read->timeout = _request_timeout;
+
+		if (i == 0)
+			read.setup_batch_read (count);
+		else
+			read.setup_batch_follower();
+
+		reads.push_back (read);
+	}
+
+	// Push all at once, so that process_queue() doesn't see incomplete batch:
+	for (auto const& read: reads)
+		_pending.push_back (std::make_unique<Read> (read));
+
+	process_queue();
+	return reads;
+}
+
+
 void
 CHRUM6::process_queue()
 {
-	if (!_requests.empty())
+	while (!_pending.empty() && _in_flight_packets < _max_in_flight)
+	{
+		si::Time const now = TimeHelper::now();
+		auto const batch_size = std::min (_pending.front()->data()->batch_size, _pending.size());
+		auto const& packet = _pending.front()->packet_data();
+
+		if (!packet.empty())
+			++_in_flight_packets;
+
+		// Batch followers go in-flight together with the leader:
+		for (std::size_t i = 0; i < batch_size; ++i)
+		{
+			_pending.front()->data()->start_timestamp = now;
+			_in_flight.push_back (std::move (_pending.front()));
+			_pending.pop_front();
+		}
+
+		send_packet (_in_flight[_in_flight.size() - batch_size]->packet_data());
+	}
+}
+
+
+std::unique_ptr<CHRUM6::Request>
+CHRUM6::take_in_flight (std::deque<std::unique_ptr<Request>>::iterator iterator)
+{
+	auto request = std::move (*iterator);
+	_in_flight.erase (iterator);
+
+	if (!request->packet_data().empty())
+		--_in_flight_packets;
+
+	return request;
+}
+
+
+std::vector<std::unique_ptr<CHRUM6::Request>>
+CHRUM6::take_oldest_in_flight()
+{
+	std::vector<std::unique_ptr<Request>> group;
+
+	if (!_in_flight.empty())
 	{
-		_current_req = std::move (_requests.front());
-		_requests.pop();
+		auto const batch_size = std::min (_in_flight.front()->data()->batch_size, _in_flight.size());
 
-		send_packet (_current_req->data()->packet_data);
+		for (std::size_t i = 0; i < batch_size; ++i)
+			group.push_back (take_in_flight (_in_flight.begin()));
 	}
+
+	return group;
+}
+
+
+bool
+CHRUM6::matches (Request const& request, uint32_t address, bool has_data)
+{
+	// Writes are confirmed with data-less COMMAND_COMPLETE; a packet with data for the same
+	// register is a broadcast (eg. GyroBiasXY sent after ZeroGyros):
+	return request.address() == address && !(has_data && dynamic_cast<Write const*> (&request));
+}
+
+
+void
+CHRUM6::finish_request (Request& request, si::Time const now, bool success, ProtocolError protocol_error, std::optional<uint32_t> value)
+{
+	auto* data = request.data();
+	data->finish_timestamp = now;
+	data->finished = true;
+	data->success = success;
+	data->protocol_error = protocol_error;
+
+	if (value)
+		data->value = *value;
+
+	request.make_callback();
 }
 
 
@@ -253,16 +433,36 @@ CHRUM6::make_packet (uint32_t address, bool write_operation, uint32_t data)
 		result.push_back ((data >> 0) & 0xff);
 	}
 
-	// Compute checksum:
+	append_checksum (result);
+	return result;
+}
+
+
+Blob
+CHRUM6::make_batch_read_packet (uint32_t address, std::size_t count)
+{
+	Blob result = { 's', 'n', 'p' };
+
+	// Bit 7: read (0); bit 6: batch operation; bits 5-2: size of batch operation:
+	uint8_t const packet_type = (1u << 6) | ((count & 0x0f) << 2);
+
+	result.push_back (packet_type);
+	result.push_back (static_cast<uint8_t> (address));
+	append_checksum (result);
+	return result;
+}
+
+
+void
+CHRUM6::append_checksum (Blob& packet)
+{
 	uint16_t checksum = 0;
-	for (uint8_t c: result)
+	for (uint8_t c: packet)
 		checksum += c;
 	boost::endian::native_to_little (checksum);
 
-	result.push_back ((checksum >> 8) & 0xff);
-	result.push_back ((checksum >> 0) & 0xff);
-
-	return result;
+	packet.push_back ((checksum >> 8) & 0xff);
+	packet.push_back ((checksum >> 0) & 0xff);
 }
 
 
@@ -330,12 +530,15 @@ CHRUM6::parse_packet()
 void
 CHRUM6::send_packet (Blob const& packet)
 {
-	_serial_port->write (packet);
+	if (_serial_port)
+		_serial_port->write (packet);
+	else if (_output)
+		_output (packet);
 }
 
 
 void
-CHRUM6::process_packet (uint32_t address, bool failed, bool, uint32_t data)
+CHRUM6::process_packet (uint32_t address, bool failed, bool has_data, uint32_t data)
 {
 	if (_alive_check_callback)
 		_alive_check_callback();
@@ -353,37 +556,35 @@ CHRUM6::process_packet (uint32_t address, bool failed, bool, uint32_t data)
 		address == static_cast<uint32_t> (ProtocolError::UnknownAddress) ||
 		address == static_cast<uint32_t> (ProtocolError::InvalidBatchSize))
 	{
-		if (_current_req)
+		// UM6 handles packets in order, so the error refers to the oldest request in flight:
+		auto failed_requests = take_oldest_in_flight();
+
+		if (failed_requests.empty())
 		{
-			if (_auto_retry && address == static_cast<uint32_t> (ProtocolError::BadChecksum))
-			{
-				_current_req->data()->retries++;
-				_requests.push (std::move (_current_req));
-				process_queue();
-			}
-			else
+			// Spurious event?
+			_logger << "Got spurious protocol error packet (" << packet_name (address) << ")." << std::endl;
+		}
+		else if (_auto_retry && address == static_cast<uint32_t> (ProtocolError::BadChecksum))
+		{
+			for (auto r = failed_requests.rbegin(); r != failed_requests.rend(); ++r)
 			{
-				// Handle last request as failed with given protocol error.
-				_current_req->data()->finish_timestamp = now;
-				_current_req->data()->finished = true;
-				_current_req->data()->success = false;
-				_current_req->data()->protocol_error = static_cast<ProtocolError> (address);
-				_current_req->make_callback();
+				(*r)->data()->retries++;
+				_pending.push_front (std::move (*r));
 			}
 		}
 		else
 		{
-			// Spurious event?
-			_logger << "Got spurious protocol error packet (" << packet_name (address) << ")." << std::endl;
+			// Handle requests as failed with given protocol error.
+			for (auto& request: failed_requests)
+				finish_request (*request, now, false, static_cast<ProtocolError> (address));
 		}
 	}
-	else if (_current_req && _current_req->address() == address)
+	else if (auto found = std::find_if (_in_flight.begin(), _in_flight.end(), [&] (auto const& r) { return matches (*r, address, has_data); });
+			 found != _in_flight.end())
 	{
-		_current_req->data()->finish_timestamp = now;
-		_current_req->data()->finished = true;
-		_current_req->data()->success = !failed;
-		_current_req->data()->value = data;
-		_current_req->make_callback();
+		// Remove from _in_flight before calling callback, which may issue new requests:
+		auto request = take_in_flight (found);
+		finish_request (*request, now, !failed, ProtocolError::None, has_data ? std::optional (data) : std::nullopt);
 	}
 	else if (_incoming_messages_callback)
 	{
@@ -397,6 +598,8 @@ CHRUM6::process_packet (uint32_t address, bool failed, bool, uint32_t data)
 
 		_incoming_messages_callback (req);
 	}
+
+	process_queue();
 }
 
 
@@ -16,8 +16,12 @@
 
 // Standard:
 #include <cstddef>
+#include <algorithm>
+#include <deque>
 #include <functional>
-#include <queue>
+#include <memory>
+#include <optional>
+#include <vector>
 
 // Neutrino:
 #include <neutrino/bus/serial_port.h>
@@ -35,12 +39,24 @@ namespace xf {
  * Encapsulates protocol used by CHR-UM6 sensor.
  * Uses provided SerialPort to communicate with UM6.
  * The port must be opened before using this API.
+ *
+ * Requests are pipelined: up to max_in_flight() packets are sent without waiting for responses,
+ * and responses are matched with requests by register address. Requests that don't get
+ * a response in time are finished with ProtocolError::Timeout by process_timeouts().
  */
 class CHRUM6
 {
   private:
 	static constexpr char kLoggerScope[] = "xf::CHRUM6";
 
+  public:
+	// Max number of registers in a batch operation (4-bit field in the packet type byte):
+	static constexpr std::size_t	kMaxBatchSize			= 15;
+	static constexpr std::size_t	kDefaultMaxInFlight		= 4;
+	static constexpr si::Time		kDefaultRequestTimeout	= 250_ms;
+	// Commands like ZeroGyros take a few seconds to complete:
+	static constexpr si::Time		kDefaultCommandTimeout	= 5_s;
+
   public:
 	// Fwd
 	class Request;
@@ -252,6 +268,7 @@ class CHRUM6
 	typedef std::function<void (Command)>	CommandCallback;
 	typedef std::function<void (Read)>		ReadCallback;
 	typedef std::function<void (Write)>		WriteCallback;
+	typedef std::function<void (Blob const&)>	Output;
 
   private:
 	/**
@@ -275,6 +292,10 @@ class CHRUM6
 		uint32_t		value			= 0;
 		CommandCallback	command_callback;
 		uint32_t		retries			= 0;
+		si::Time		timeout;
+		// Number of requests (this one and following ones) handled by the packet_data of this request.
+		// Followers of a batch operation have empty packet_data:
+		std::size_t		batch_size		= 1;
 	};
 
 	/**
@@ -282,6 +303,7 @@ class CHRUM6
 	 */
 	class ReadData: public CommandData
 	{
+		friend class CHRUM6;
 		friend class Read;
 
 		ReadCallback	read_callback;
@@ -292,6 +314,7 @@ class CHRUM6
 	 */
 	class WriteData: public CommandData
 	{
+		friend class CHRUM6;
 		friend class Write;
 
 		WriteCallback	write_callback;
@@ -312,6 +335,18 @@ class CHRUM6
 		void
 		setup (uint32_t generic_address, bool write_operation, uint32_t data);
 
+		/**
+		 * Make this request a leader of a batch read of given size.
+		 */
+		void
+		setup_batch_read (std::size_t batch_size);
+
+		/**
+		 * Make this request a follower in a batch operation, which doesn't send its own packet.
+		 */
+		void
+		setup_batch_follower();
+
 	  public:
 		/**
 		 * Return register address.
@@ -505,12 +540,59 @@ class CHRUM6
 	explicit
 	CHRUM6 (SerialPort* serial_port, Logger const&);
 
+	/**
+	 * Ctor for use without SerialPort (eg. with simulated device).
+	 * Packets are sent to the output function, responses must be passed to feed().
+	 */
+	explicit
+	CHRUM6 (Output, Logger const&);
+
 	/**
 	 * Set logger.
 	 */
 	void
 	set_logger (Logger const&);
 
+	/**
+	 * Set max number of packets sent to UM6 without getting a response.
+	 * Batch operations count as one packet.
+	 */
+	void
+	set_max_in_flight (std::size_t);
+
+	/**
+	 * Return max number of packets sent without getting a response.
+	 */
+	[[nodiscard]]
+	std::size_t
+	max_in_flight() const noexcept;
+
+	/**
+	 * Set response timeout for read and write requests.
+	 */
+	void
+	set_request_timeout (si::Time);
+
+	/**
+	 * Set response timeout for commands.
+	 */
+	void
+	set_command_timeout (si::Time);
+
+	/**
+	 * Return number of requests waiting to be sent.
+	 */
+	[[nodiscard]]
+	std::size_t
+	pending_requests() const noexcept;
+
+	/**
+	 * Return number of requests sent that didn't get a response yet.
+	 */
+	[[nodiscard]]
+	std::size_t
+	requests_in_flight() const noexcept;
+
 	/**
 	 * Set callback indicating serial port failure.
 	 */
@@ -547,8 +629,32 @@ class CHRUM6
 	Read
 	read (DataAddress, ReadCallback = nullptr);
 
+	/**
+	 * Read consecutive config registers with a single batch packet.
+	 * The callback is called once for each register.
+	 * \param	count
+	 *			Number of registers, 1…kMaxBatchSize.
+	 * \throw	InvalidArgument
+	 *			When count is out of range.
+	 */
+	std::vector<Read>
+	read_batch (ConfigurationAddress first, std::size_t count, ReadCallback = nullptr);
+
+	/**
+	 * Read consecutive data registers with a single batch packet.
+	 * The callback is called once for each register.
+	 * \param	count
+	 *			Number of registers, 1…kMaxBatchSize.
+	 * \throw	InvalidArgument
+	 *			When count is out of range.
+	 */
+	std::vector<Read>
+	read_batch (DataAddress first, std::size_t count, ReadCallback = nullptr);
+
 	/**
 	 * Write uint32_t to a config register.
+	 * If there's another write to the same register without a callback waiting to be sent,
+	 * it's updated instead of queueing a new request.
 	 */
 	Write
 	write (ConfigurationAddress, uint32_t value, WriteCallback = nullptr);
@@ -565,6 +671,27 @@ class CHRUM6
 	Command
 	command (CommandAddress, CommandCallback = nullptr);
 
+	/**
+	 * Pass data received from UM6.
+	 * Called automatically when using SerialPort.
+	 */
+	void
+	feed (Blob const&);
+
+	/**
+	 * Finish requests that didn't get response in time with ProtocolError::Timeout
+	 * and send waiting requests in their place. Should be called periodically.
+	 */
+	void
+	process_timeouts();
+
+	/**
+	 * Drop all pending and in-flight requests without calling their callbacks.
+	 * Use when communication with the device is restarted.
+	 */
+	void
+	reset();
+
 	/**
 	 * For given sampling rate return UM6 setting ready
 	 * to be written to the Communication register.
@@ -589,17 +716,67 @@ class CHRUM6
 	serial_failure();
 
 	/**
-	 * Process next request from queue if possible.
+	 * Add request to the queue and send it if possible.
+	 * Return the request.
+	 */
+	template<class pRequest>
+		pRequest
+		enqueue (pRequest);
+
+	/**
+	 * Common code for read_batch() overloads.
+	 */
+	std::vector<Read>
+	read_batch (uint32_t first, std::size_t count, ReadCallback);
+
+	/**
+	 * Send queued requests while there are free in-flight slots.
 	 */
 	void
 	process_queue();
 
+	/**
+	 * Remove request from the in-flight list and return it.
+	 */
+	std::unique_ptr<Request>
+	take_in_flight (std::deque<std::unique_ptr<Request>>::iterator);
+
+	/**
+	 * Remove the oldest in-flight request together with its batch followers and return them.
+	 */
+	std::vector<std::unique_ptr<Request>>
+	take_oldest_in_flight();
+
+	/**
+	 * Return true if packet received from UM6 is a response to given request.
+	 */
+	static bool
+	matches (Request const&, uint32_t address, bool has_data);
+
+	/**
+	 * Mark request as finished and call its callback.
+	 */
+	static void
+	finish_request (Request&, si::Time now, bool success, ProtocolError, std::optional<uint32_t> value = {});
+
 	/**
 	 * Create packet for UM6 for single (non-batch) operation.
 	 */
 	static Blob
 	make_packet (uint32_t address, bool write, uint32_t data = 0);
 
+	/**
+	 * Create packet for UM6 for batch read operation.
+	 */
+	static Blob
+	make_batch_read_packet (uint32_t address, std::size_t count);
+
+	/**
+	 * Append checksum to the packet.
+	 */
+	static void
+	append_checksum (Blob& packet);
+
 	/**
 	 * Parse incoming packet from _packet_reader.
 	 * Call various processing functions.
@@ -626,14 +803,22 @@ class CHRUM6
 	packet_name (uint32_t address) noexcept;
 
   private:
-	SerialPort*								_serial_port	{ nullptr };
+	SerialPort*								_serial_port		{ nullptr };
+	Output									_output;
 	std::unique_ptr<PacketReader>			_packet_reader;
 	std::function<void()>					_communication_failure_callback;
 	std::function<void()>					_alive_check_callback;
 	std::function<void (Read)>				_incoming_messages_callback;
-	bool									_auto_retry		{ false };
-	std::queue<std::unique_ptr<Request>>	_requests;
-	std::unique_ptr<Request>				_current_req;
+	bool									_auto_retry			{ false };
+	std::size_t								_max_in_flight		{ kDefaultMaxInFlight };
+	si::Time								_request_timeout	{ kDefaultRequestTimeout };
+	si::Time								_command_timeout	{ kDefaultCommandTimeout };
+	// Requests not sent yet:
+	std::deque<std::unique_ptr<Request>>	_pending;
+	// Requests sent, in order of sending:
+	std::deque<std::unique_ptr<Request>>	_in_flight;
+	// Number of packets sent (batch followers excluded):
+	std::size_t								_in_flight_packets	{ 0 };
 	Logger									_logger;
 };
 
@@ -646,6 +831,22 @@ CHRUM6::Request::setup (uint32_t generic_address, bool write_operation, uint32_t
 }
 
 
+inline void
+CHRUM6::Request::setup_batch_read (std::size_t batch_size)
+{
+	data()->packet_data = CHRUM6::make_batch_read_packet (data()->address, batch_size);
+	data()->batch_size = batch_size;
+}
+
+
+inline void
+CHRUM6::Request::setup_batch_follower()
+{
+	data()->packet_data.clear();
+	data()->batch_size = 1;
+}
+
+
 inline uint32_t
 CHRUM6::Request::address() const noexcept
 {
@@ -816,6 +1017,49 @@ CHRUM6::Write::make_callback()
 }
 
 
+inline void
+CHRUM6::set_max_in_flight (std::size_t max_in_flight)
+{
+	_max_in_flight = std::max<std::size_t> (max_in_flight, 1);
+	process_queue();
+}
+
+
+inline std::size_t
+CHRUM6::max_in_flight() const noexcept
+{
+	return _max_in_flight;
+}
+
+
+inline void
+CHRUM6::set_request_timeout (si::Time timeout)
+{
+	_request_timeout = timeout;
+}
+
+
+inline void
+CHRUM6::set_command_timeout (si::Time timeout)
+{
+	_command_timeout = timeout;
+}
+
+
+inline std::size_t
+CHRUM6::pending_requests() const noexcept
+{
+	return _pending.size();
+}
+
+
+inline std::size_t
+CHRUM6::requests_in_flight() const noexcept
+{
+	return _in_flight.size();
+}
+
+
 inline void
 CHRUM6::set_communication_failure_callback (std::function<void()> callback)
 {
@@ -14,6 +14,7 @@
 // Standard:
 #include <cstddef>
 #include <memory>
+#include <tuple>
 
 // Neutrino:
 #include <neutrino/numeric.h>
@@ -145,14 +146,17 @@ HT16K33::SingleSwitch::invalidate()
 }
 
 
-HT16K33::HT16K33 (i2c::Device&& i2c_device, Logger const& logger):
-	_i2c_device (std::move (i2c_device)),
+HT16K33::HT16K33 (I2CScheduler& scheduler, i2c::Device&& i2c_device, Logger const& logger):
+	_scheduler (scheduler),
 	_logger (logger)
 {
-	_reinitialize_timer = new QTimer (this);
-	_reinitialize_timer->setInterval (250);
-	_reinitialize_timer->setSingleShot (true);
-	QObject::connect (_reinitialize_timer, SIGNAL (timeout()), this, SLOT (initialize()));
+	I2CScheduler::DeviceLayout layout;
+	layout.first_register = kLEDMatrixRegister;
+	layout.registers = std::tuple_size_v<LEDMatrix::DataArray>;
+	layout.command_slots = 2;
+	layout.initializer = &HT16K33::initialize;
+
+	_device_id = _scheduler.add_device (std::make_unique<I2CScheduler::BusDevice> (std::move (i2c_device)), layout);
 
 	_scan_timer = new QTimer (this);
 	_scan_timer->setTimerType (Qt::PreciseTimer);
@@ -160,118 +164,107 @@ HT16K33::HT16K33 (i2c::Device&& i2c_device, Logger const& logger):
 	QObject::connect (_scan_timer, SIGNAL (timeout()), this, SLOT (pool_keys()));
 
 	update_timers();
+}
 
-	guard ([&] {
-		initialize();
-	});
+
+HT16K33::~HT16K33()
+{
+	_scheduler.remove_device (_device_id);
 }
 
 
 void
 HT16K33::update()
 {
-	guard ([&] {
-		uint8_t display_bits = 0;
+	uint8_t display_bits = 0;
 
-		if (_displays_enabled)
-			display_bits |= kDisplayOn;
-		else
-			display_bits |= kDisplayOff;
+	if (_displays_enabled)
+		display_bits |= kDisplayOn;
+	else
+		display_bits |= kDisplayOff;
 
-		if (_blinking_enabled)
+	if (_blinking_enabled)
+	{
+		switch (_blinking_mode)
 		{
-			switch (_blinking_mode)
-			{
-				case BlinkingMode::Fast:
-					display_bits |= kDisplayBlinkFast;
-					break;
-
-				case BlinkingMode::Medium:
-					display_bits |= kDisplayBlinkMedium;
-					break;
-
-				case BlinkingMode::Slow:
-					display_bits |= kDisplayBlinkSlow;
-					break;
-			}
+			case BlinkingMode::Fast:
+				display_bits |= kDisplayBlinkFast;
+				break;
+
+			case BlinkingMode::Medium:
+				display_bits |= kDisplayBlinkMedium;
+				break;
+
+			case BlinkingMode::Slow:
+				display_bits |= kDisplayBlinkSlow;
+				break;
 		}
-		else
-			display_bits |= kDisplayBlinkOff;
+	}
+	else
+		display_bits |= kDisplayBlinkOff;
 
-		_i2c_device.write (kDisplayRegister | display_bits);
+	_scheduler.set_command (_device_id, kDisplayCommandSlot, kDisplayRegister | display_bits);
 
-		uint8_t brightness = xf::clamped<uint8_t> (_brightness, 0, kMaxBrightness);
+	uint8_t brightness = xf::clamped<uint8_t> (_brightness, 0, kMaxBrightness);
 
-		_i2c_device.write (kBrightnessRegister | brightness);
+	_scheduler.set_command (_device_id, kBrightnessCommandSlot, kBrightnessRegister | brightness);
 
-		_led_matrix.clear();
-		for (auto& display: _displays)
-			display->update_led_matrix (_led_matrix);
+	_led_matrix.clear();
+	for (auto& display: _displays)
+		display->update_led_matrix (_led_matrix);
 
-		_i2c_device.write_register (kLEDMatrixRegister, _led_matrix.array());
-	});
+	_scheduler.set_registers (_device_id, kLEDMatrixRegister, _led_matrix.array());
 }
 
 
 void
-HT16K33::initialize()
+HT16K33::pool_keys()
 {
-	guard ([&] {
-		_i2c_device.write (kSetupRegister | kSetupOn);
-		_i2c_device.write (kRowIntRegister | kRowIntRow);
-	});
-}
+	while (auto keys = _scanned_keys.pop())
+	{
+		_key_matrix.array() = *keys;
 
+		for (auto& sw: _switches)
+			sw->key_matrix_updated (_key_matrix);
+	}
 
-void
-HT16K33::reinitialize()
-{
-	for (auto& sw: _switches)
-		sw->invalidate();
+	if (!_scheduler.serviceable (_device_id))
+		for (auto& sw: _switches)
+			sw->invalidate();
 
-	_reinitialize_timer->start();
+	// If the queue is full, just skip this scan:
+	[[maybe_unused]] bool const submitted = _scheduler.submit (_device_id, [this, reliable_mode = _reliable_mode] (I2CScheduler::Device& device) {
+		scan_keys (device, reliable_mode);
+	});
 }
 
 
 void
-HT16K33::pool_keys()
+HT16K33::initialize (I2CScheduler::Device& device)
 {
-	guard ([&] {
-		// Check for interrupt flag:
-		uint8_t interrupt_flag = _i2c_device.read_register (kInterruptRegister);
-
-		if (_reliable_mode && !interrupt_flag)
-		{
-			// In reliable-mode we expect at least one key to be hardwired to be pressed,
-			// and therefore interrupt flag should always be != 0. If it's not,
-			// then we should skip this reading, since it's invalid.
-			return;
-		}
-
-		// Read key RAM:
-		_i2c_device.read_register (kKeyMatrixRegister, _key_matrix.array());
-
-		for (auto& sw: _switches)
-			sw->key_matrix_updated (_key_matrix);
-	});
+	device.write (kSetupRegister | kSetupOn);
+	device.write (kRowIntRegister | kRowIntRow);
 }
 
 
 void
-HT16K33::guard (std::function<void()> guarded_code)
+HT16K33::scan_keys (I2CScheduler::Device& device, bool reliable_mode)
 {
-	try {
-		guarded_code();
-	}
-	catch (xf::IOError& e)
-	{
-		_logger << "I/O error: " << e.message() << std::endl;
-		reinitialize();
-	}
-	catch (...)
+	// Check for interrupt flag:
+	uint8_t interrupt_flag = device.read_register (kInterruptRegister);
+
+	if (reliable_mode && !interrupt_flag)
 	{
-		reinitialize();
+		// In reliable-mode we expect at least one key to be hardwired to be pressed,
+		// and therefore interrupt flag should always be != 0. If it's not,
+		// then we should skip this reading, since it's invalid.
+		return;
 	}
+
+	// Read key RAM:
+	KeyMatrix::DataArray keys;
+	device.read_registers (kKeyMatrixRegister, keys.data(), keys.size());
+	[[maybe_unused]] bool const pushed = _scanned_keys.push (keys);
 }
 
 
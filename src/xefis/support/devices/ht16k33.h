@@ -32,12 +32,16 @@
 // Xefis:
 #include <xefis/config/all.h>
 #include <xefis/core/property.h>
+#include <xefis/support/devices/i2c_scheduler.h>
+#include <xefis/utility/spsc_queue.h>
 
 
 namespace xf {
 
 /**
  * This module interfaces Holtek's HT16K33 chip, for controlling LED displays and scanning keys/switches.
+ * I²C transfers are done by I2CScheduler in its thread: new display values are sent to the chip
+ * on I2CScheduler::flush(), and only for registers that have changed.
  */
 class HT16K33: public QObject
 {
@@ -63,6 +67,9 @@ class HT16K33: public QObject
 	static constexpr uint8_t kLEDMatrixRegister		= 0x00;
 	static constexpr uint8_t kInterruptRegister		= 0x60;
 	static constexpr uint8_t kKeyMatrixRegister		= 0x40;
+	// I2CScheduler command slots:
+	static constexpr std::size_t kDisplayCommandSlot	= 0;
+	static constexpr std::size_t kBrightnessCommandSlot	= 1;
 
   public:
 	typedef uint8_t	Row;
@@ -289,7 +296,10 @@ class HT16K33: public QObject
   public:
 	// Ctor
 	explicit
-	HT16K33 (i2c::Device&&, Logger const&);
+	HT16K33 (I2CScheduler&, i2c::Device&&, Logger const&);
+
+	// Dtor
+	~HT16K33();
 
 	/**
 	 * Turn on/off displays and LEDs.
@@ -357,24 +367,31 @@ class HT16K33: public QObject
 
 	// TODO options for API user: manual synchronization or automatic synchronization
 	/**
-	 * Synchronize with the chip - send new values to the chip and read key states from it.
+	 * Stage new values for the chip. They're sent on next I2CScheduler::flush(), which is done once per cycle
+	 * by the owner of the scheduler, for all devices on the bus.
 	 */
 	void
 	update();
 
   private slots:
-	void
-	initialize();
-
-	void
-	reinitialize();
-
+	/**
+	 * Update switches with key states read so far and request next key scan.
+	 */
 	void
 	pool_keys();
 
   private:
+	/**
+	 * Initialize the chip. Called by I2CScheduler in its thread.
+	 */
+	static void
+	initialize (I2CScheduler::Device&);
+
+	/**
+	 * Read key RAM. Called by I2CScheduler in its thread.
+	 */
 	void
-	guard (std::function<void()> guarded_code);
+	scan_keys (I2CScheduler::Device&, bool reliable_mode);
 
 	void
 	update_timers();
@@ -403,7 +420,10 @@ class HT16K33: public QObject
 	static constexpr size_t kMinusSignIndex	= 10;
 	static constexpr size_t kDotIndex		= 11;
 
-	i2c::Device						_i2c_device;
+	I2CScheduler&					_scheduler;
+	I2CScheduler::DeviceID			_device_id;
+	// Key RAM read by the scheduler thread:
+	SPSCQueue<KeyMatrix::DataArray>	_scanned_keys		{ 4 };
 	Logger							_logger;
 	bool							_displays_enabled	= true;
 	uint8_t							_brightness			= 16;
@@ -415,7 +435,6 @@ class HT16K33: public QObject
 	KeyMatrix						_key_matrix;
 	Displays						_displays;
 	Switches						_switches;
-	QTimer*							_reinitialize_timer	= nullptr;
 	QTimer*							_scan_timer			= nullptr;
 };
 
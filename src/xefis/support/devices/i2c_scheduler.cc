@@ -0,0 +1,376 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <algorithm>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Local:
+#include "i2c_scheduler.h"
+
+
+namespace xf {
+
+I2CScheduler::BusDevice::BusDevice (i2c::Device&& device):
+	_device (std::move (device))
+{ }
+
+
+void
+I2CScheduler::BusDevice::open()
+{
+	_device.open();
+}
+
+
+void
+I2CScheduler::BusDevice::close()
+{
+	_device.close();
+}
+
+
+void
+I2CScheduler::BusDevice::write (uint8_t byte)
+{
+	_device.write (byte);
+}
+
+
+void
+I2CScheduler::BusDevice::write_register (uint8_t reg, uint8_t value)
+{
+	_device.write_register (reg, value);
+}
+
+
+void
+I2CScheduler::BusDevice::write_registers (uint8_t first_register, uint8_t const* data, std::size_t size)
+{
+	_device.write_register (first_register, data, size);
+}
+
+
+uint8_t
+I2CScheduler::BusDevice::read_register (uint8_t reg)
+{
+	return _device.read_register (reg);
+}
+
+
+void
+I2CScheduler::BusDevice::read_registers (uint8_t first_register, uint8_t* data, std::size_t size)
+{
+	_device.read_register (first_register, data, size);
+}
+
+
+I2CScheduler::I2CScheduler():
+	_thread (&I2CScheduler::run, this)
+{ }
+
+
+I2CScheduler::~I2CScheduler()
+{
+	_stop.store (true, std::memory_order_release);
+	_wakeup.release();
+	_thread.join();
+}
+
+
+I2CScheduler::DeviceID
+I2CScheduler::add_device (std::unique_ptr<Device> device, DeviceLayout layout)
+{
+	auto& state = *_devices.emplace_back (std::make_unique<DeviceState>());
+	Image const zeros { std::vector<uint8_t> (layout.registers, 0), std::vector<uint8_t> (layout.command_slots, 0) };
+
+	state.layout = std::move (layout);
+	state.device = std::move (device);
+	state.staged = zeros;
+	state.flushed = zeros;
+	state.target = zeros;
+	state.written = zeros;
+
+	return _devices.size() - 1;
+}
+
+
+void
+I2CScheduler::remove_device (DeviceID id)
+{
+	sync();
+
+	auto& state = *_devices[id];
+	state.device.reset();
+	state.layout.initializer = nullptr;
+	state.deferred_jobs.clear();
+}
+
+
+void
+I2CScheduler::set_register (DeviceID id, uint8_t reg, uint8_t value)
+{
+	auto& state = *_devices[id];
+	state.staged.registers.at (reg - state.layout.first_register) = value;
+}
+
+
+void
+I2CScheduler::set_command (DeviceID id, std::size_t slot, uint8_t command)
+{
+	_devices[id]->staged.commands.at (slot) = command;
+}
+
+
+void
+I2CScheduler::flush()
+{
+	for (auto& state: _devices)
+	{
+		if (!state->device)
+			continue;
+
+		if (!state->flushed_once || state->staged != state->flushed)
+		{
+			if (push ({ state.get(), state->staged, nullptr }))
+			{
+				state->flushed = state->staged;
+				state->flushed_once = true;
+			}
+		}
+		else if (!state->serviceable.load (std::memory_order_relaxed))
+		{
+			// Let the scheduler thread retry initialization and rewrite the image:
+			push ({ state.get(), std::nullopt, nullptr });
+		}
+	}
+}
+
+
+bool
+I2CScheduler::submit (DeviceID id, Job job)
+{
+	if (!_devices[id]->device)
+		return false;
+
+	return push ({ _devices[id].get(), std::nullopt, std::move (job) });
+}
+
+
+void
+I2CScheduler::sync()
+{
+	auto const submitted = _submitted.load (std::memory_order_relaxed);
+
+	for (auto completed = _completed.load (std::memory_order_acquire); completed < submitted; completed = _completed.load (std::memory_order_acquire))
+		_completed.wait (completed, std::memory_order_acquire);
+}
+
+
+I2CScheduler::Statistics
+I2CScheduler::statistics() const noexcept
+{
+	Statistics result;
+	result.transfers = _transfers.load (std::memory_order_relaxed);
+	result.bytes_written = _bytes_written.load (std::memory_order_relaxed);
+	result.bytes_skipped = _bytes_skipped.load (std::memory_order_relaxed);
+	result.errors = _errors.load (std::memory_order_relaxed);
+	result.dropped = _dropped.load (std::memory_order_relaxed);
+	result.utilization = _utilization.load (std::memory_order_relaxed);
+	return result;
+}
+
+
+bool
+I2CScheduler::push (Transaction&& transaction)
+{
+	if (!_transactions.push (std::move (transaction)))
+	{
+		_dropped.fetch_add (1, std::memory_order_relaxed);
+		return false;
+	}
+
+	_submitted.fetch_add (1, std::memory_order_relaxed);
+	_wakeup.release();
+	return true;
+}
+
+
+void
+I2CScheduler::run()
+{
+	while (!_stop.load (std::memory_order_acquire))
+	{
+		// Wake up at least once per statistics period, so that utilization drops to 0 when idle:
+		[[maybe_unused]] bool const woken = _wakeup.try_acquire_for (kStatisticsPeriod);
+
+		while (auto transaction = _transactions.pop())
+		{
+			execute (*transaction);
+			_completed.fetch_add (1, std::memory_order_release);
+			_completed.notify_all();
+		}
+
+		update_utilization (std::chrono::steady_clock::now());
+	}
+}
+
+
+void
+I2CScheduler::execute (Transaction& transaction)
+{
+	auto& state = *transaction.device;
+	auto const start = std::chrono::steady_clock::now();
+
+	if (transaction.image)
+		state.target = std::move (*transaction.image);
+
+	try {
+		if (!state.initialized)
+		{
+			// Don't hammer the bus with a failing device:
+			if (start < state.retry_time)
+			{
+				defer (state, std::move (transaction.job));
+				return;
+			}
+
+			state.device->open();
+
+			if (state.layout.initializer)
+				state.layout.initializer (*state.device);
+
+			state.initialized = true;
+			state.written_valid = false;
+			state.serviceable.store (true, std::memory_order_relaxed);
+		}
+
+		while (!state.deferred_jobs.empty())
+		{
+			auto job = std::move (state.deferred_jobs.front());
+			state.deferred_jobs.pop_front();
+			job (*state.device);
+		}
+
+		if (transaction.job)
+			transaction.job (*state.device);
+
+		write_changes (state);
+	}
+	catch (...)
+	{
+		state.initialized = false;
+		state.written_valid = false;
+		state.retry_time = start + kRetryDelay;
+		state.serviceable.store (false, std::memory_order_relaxed);
+		state.errors.fetch_add (1, std::memory_order_relaxed);
+		_errors.fetch_add (1, std::memory_order_relaxed);
+
+		try {
+			state.device->close();
+		}
+		catch (...)
+		{ }
+	}
+
+	_busy_time += std::chrono::steady_clock::now() - start;
+}
+
+
+void
+I2CScheduler::defer (DeviceState& state, Job&& job)
+{
+	if (!job)
+		return;
+
+	if (state.deferred_jobs.size() >= kQueueCapacity)
+	{
+		state.deferred_jobs.pop_front();
+		_dropped.fetch_add (1, std::memory_order_relaxed);
+	}
+
+	state.deferred_jobs.push_back (std::move (job));
+}
+
+
+void
+I2CScheduler::write_changes (DeviceState& state)
+{
+	auto& device = *state.device;
+	auto const& target = state.target;
+	auto& written = state.written;
+	auto const changed = [&] (std::size_t i) {
+		return !state.written_valid || target.registers[i] != written.registers[i];
+	};
+
+	std::size_t const size = target.registers.size();
+	std::size_t bytes = 0;
+
+	for (std::size_t i = 0; i < size; )
+	{
+		if (!changed (i))
+		{
+			++i;
+			continue;
+		}
+
+		// Extend the burst as long as the next change is within kMaxGap:
+		std::size_t last = i;
+
+		for (std::size_t j = i + 1; j < size && j <= last + kMaxGap + 1; ++j)
+			if (changed (j))
+				last = j;
+
+		std::size_t const burst_size = last - i + 1;
+		device.write_registers (state.layout.first_register + i, target.registers.data() + i, burst_size);
+		std::copy_n (target.registers.begin() + i, burst_size, written.registers.begin() + i);
+		_transfers.fetch_add (1, std::memory_order_relaxed);
+		bytes += burst_size;
+		i = last + 1;
+	}
+
+	for (std::size_t i = 0; i < target.commands.size(); ++i)
+	{
+		if (!state.written_valid || target.commands[i] != written.commands[i])
+		{
+			device.write (target.commands[i]);
+			written.commands[i] = target.commands[i];
+			_transfers.fetch_add (1, std::memory_order_relaxed);
+			++bytes;
+		}
+	}
+
+	state.written_valid = true;
+	_bytes_written.fetch_add (bytes, std::memory_order_relaxed);
+	_bytes_skipped.fetch_add (size + target.commands.size() - bytes, std::memory_order_relaxed);
+}
+
+
+void
+I2CScheduler::update_utilization (std::chrono::steady_clock::time_point const now)
+{
+	auto const elapsed = now - _period_start;
+
+	if (elapsed >= kStatisticsPeriod)
+	{
+		_utilization.store (std::chrono::duration<float> (_busy_time) / std::chrono::duration<float> (elapsed), std::memory_order_relaxed);
+		_busy_time = std::chrono::nanoseconds::zero();
+		_period_start = now;
+	}
+}
+
+} // namespace xf
+
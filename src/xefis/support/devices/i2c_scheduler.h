@@ -0,0 +1,371 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__DEVICES__I2C_SCHEDULER_H__INCLUDED
+#define XEFIS__SUPPORT__DEVICES__I2C_SCHEDULER_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+// Neutrino:
+#include <neutrino/bus/i2c.h>
+#include <neutrino/noncopyable.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/utility/spsc_queue.h>
+
+
+namespace xf {
+
+/**
+ * Performs I²C transfers for devices on a single bus in a dedicated thread, so that the processing
+ * loop never blocks on the bus.
+ *
+ * Each device has an image of a range of its registers and a number of command slots (single-byte
+ * commands written without register address, like the ones used by HT16K33). Values are staged with
+ * set_register() and set_command() and sent on flush(). Only registers that differ from what
+ * was last written to the chip are sent, and nearby changed registers are joined into a single
+ * auto-increment burst write.
+ *
+ * On I/O error the device is closed and after kRetryDelay it's reopened, its initializer is run
+ * and the whole image is written again. Jobs submitted in the meantime are executed after that.
+ *
+ * All methods except statistics() must be called from one thread at a time.
+ */
+class I2CScheduler: private Noncopyable
+{
+  public:
+	// Joining two bursts by also writing up to this many unchanged registers between them is cheaper
+	// than a new transfer with its start condition, device address and register address:
+	static constexpr std::size_t				kMaxGap				= 2;
+	static constexpr std::size_t				kQueueCapacity		= 64;
+	static constexpr std::chrono::nanoseconds	kRetryDelay			= std::chrono::milliseconds (250);
+	static constexpr std::chrono::nanoseconds	kStatisticsPeriod	= std::chrono::seconds (1);
+
+	/**
+	 * I²C device used by the scheduler. Methods are called only from the scheduler thread
+	 * and should throw on I/O errors.
+	 */
+	class Device
+	{
+	  public:
+		// Dtor
+		virtual
+		~Device() = default;
+
+		virtual void
+		open() = 0;
+
+		virtual void
+		close() = 0;
+
+		/**
+		 * Write a single byte without register address.
+		 */
+		virtual void
+		write (uint8_t byte) = 0;
+
+		virtual void
+		write_register (uint8_t reg, uint8_t value) = 0;
+
+		/**
+		 * Write consecutive registers in a single transfer. Requires auto-increment mode of the chip.
+		 */
+		virtual void
+		write_registers (uint8_t first_register, uint8_t const* data, std::size_t size) = 0;
+
+		virtual uint8_t
+		read_register (uint8_t reg) = 0;
+
+		virtual void
+		read_registers (uint8_t first_register, uint8_t* data, std::size_t size) = 0;
+	};
+
+	/**
+	 * Device adaptor for i2c::Device.
+	 */
+	class BusDevice: public Device
+	{
+	  public:
+		// Ctor
+		explicit
+		BusDevice (i2c::Device&&);
+
+		void
+		open() override;
+
+		void
+		close() override;
+
+		void
+		write (uint8_t byte) override;
+
+		void
+		write_register (uint8_t reg, uint8_t value) override;
+
+		void
+		write_registers (uint8_t first_register, uint8_t const* data, std::size_t size) override;
+
+		uint8_t
+		read_register (uint8_t reg) override;
+
+		void
+		read_registers (uint8_t first_register, uint8_t* data, std::size_t size) override;
+
+	  private:
+		i2c::Device	_device;
+	};
+
+	/**
+	 * Sequence of transfers executed in the scheduler thread.
+	 */
+	using Job = std::function<void (Device&)>;
+
+	using DeviceID = std::size_t;
+
+	/**
+	 * Layout of device's image.
+	 */
+	struct DeviceLayout
+	{
+		uint8_t		first_register	{ 0 };
+		std::size_t	registers		{ 0 };
+		std::size_t	command_slots	{ 0 };
+		// Run after (re)opening the device, before writing the image:
+		Job			initializer;
+	};
+
+	struct Statistics
+	{
+		uint64_t	transfers		{ 0 };
+		uint64_t	bytes_written	{ 0 };
+		// Bytes not written because the chip already had these values:
+		uint64_t	bytes_skipped	{ 0 };
+		uint64_t	errors			{ 0 };
+		// Transactions dropped because the queue was full or too many jobs were waiting for device reinitialization:
+		uint64_t	dropped			{ 0 };
+		// Fraction of time the scheduler thread spent on transfers in the last kStatisticsPeriod:
+		float		utilization		{ 0.0f };
+	};
+
+  private:
+	/**
+	 * Image of device registers and command slots.
+	 */
+	struct Image
+	{
+		std::vector<uint8_t>	registers;
+		std::vector<uint8_t>	commands;
+
+		bool
+		operator== (Image const&) const = default;
+	};
+
+	struct DeviceState
+	{
+		DeviceLayout				layout;
+		std::unique_ptr<Device>		device;
+		// Producer side:
+		Image						staged;
+		Image						flushed;
+		bool						flushed_once	{ false };
+		// Scheduler thread side:
+		Image						target;
+		Image						written;
+		bool						written_valid	{ false };
+		bool						initialized		{ false };
+		std::chrono::steady_clock::time_point	retry_time;
+		// Jobs submitted while the device was waiting for reinitialization:
+		std::deque<Job>				deferred_jobs;
+		// Shared:
+		std::atomic<bool>			serviceable		{ false };
+		std::atomic<uint64_t>		errors			{ 0 };
+	};
+
+	struct Transaction
+	{
+		DeviceState*			device	{ nullptr };
+		std::optional<Image>	image;
+		Job						job;
+	};
+
+  public:
+	// Ctor
+	I2CScheduler();
+
+	// Dtor
+	~I2CScheduler();
+
+	/**
+	 * Register device. Must not be called after flush() or submit().
+	 * Device image is initially zeroed.
+	 */
+	DeviceID
+	add_device (std::unique_ptr<Device>, DeviceLayout);
+
+	/**
+	 * Wait for pending transfers and destroy the device. Its initializer and jobs (including the ones
+	 * deferred until device reinitialization) are not called anymore.
+	 */
+	void
+	remove_device (DeviceID);
+
+	/**
+	 * Stage register value. Register must be within device's layout.
+	 */
+	void
+	set_register (DeviceID, uint8_t reg, uint8_t value);
+
+	/**
+	 * Stage values of consecutive registers.
+	 */
+	template<std::size_t N>
+		void
+		set_registers (DeviceID, uint8_t first_register, std::array<uint8_t, N> const& values);
+
+	/**
+	 * Stage command byte.
+	 */
+	void
+	set_command (DeviceID, std::size_t slot, uint8_t command);
+
+	/**
+	 * Send staged values that changed since last flush to the scheduler thread. Never blocks.
+	 * If the queue is full, the values are sent on next flush().
+	 */
+	void
+	flush();
+
+	/**
+	 * Execute job in the scheduler thread, after the transfers already queued.
+	 * Return false if the queue is full.
+	 */
+	[[nodiscard]]
+	bool
+	submit (DeviceID, Job);
+
+	/**
+	 * Wait until all queued transactions are executed.
+	 */
+	void
+	sync();
+
+	/**
+	 * Return true if device has been initialized and there were no errors since.
+	 */
+	[[nodiscard]]
+	bool
+	serviceable (DeviceID) const noexcept;
+
+	/**
+	 * Return number of I/O errors of given device.
+	 * Changes of this value indicate that the device was reinitialized.
+	 */
+	[[nodiscard]]
+	uint64_t
+	errors (DeviceID) const noexcept;
+
+	[[nodiscard]]
+	Statistics
+	statistics() const noexcept;
+
+  private:
+	/**
+	 * Push transaction to the queue and wake up the scheduler thread.
+	 */
+	bool
+	push (Transaction&&);
+
+	/**
+	 * Scheduler thread loop.
+	 */
+	void
+	run();
+
+	void
+	execute (Transaction&);
+
+	/**
+	 * Keep job until the device is reinitialized. Drop the oldest deferred job if there are too many.
+	 */
+	void
+	defer (DeviceState&, Job&&);
+
+	/**
+	 * Write changed parts of the target image.
+	 */
+	void
+	write_changes (DeviceState&);
+
+	void
+	update_utilization (std::chrono::steady_clock::time_point now);
+
+  private:
+	std::vector<std::unique_ptr<DeviceState>>	_devices;
+	SPSCQueue<Transaction>						_transactions	{ kQueueCapacity };
+	std::counting_semaphore<>					_wakeup			{ 0 };
+	std::atomic<bool>							_stop			{ false };
+	std::atomic<uint64_t>						_submitted		{ 0 };
+	std::atomic<uint64_t>						_completed		{ 0 };
+	// Statistics:
+	std::atomic<uint64_t>						_transfers		{ 0 };
+	std::atomic<uint64_t>						_bytes_written	{ 0 };
+	std::atomic<uint64_t>						_bytes_skipped	{ 0 };
+	std::atomic<uint64_t>						_errors			{ 0 };
+	std::atomic<uint64_t>						_dropped		{ 0 };
+	std::atomic<float>							_utilization	{ 0.0f };
+	// Used only by the scheduler thread:
+	std::chrono::nanoseconds					_busy_time		{ 0 };
+	std::chrono::steady_clock::time_point		_period_start	{ std::chrono::steady_clock::now() };
+	std::thread									_thread;
+};
+
+
+template<std::size_t N>
+	inline void
+	I2CScheduler::set_registers (DeviceID id, uint8_t first_register, std::array<uint8_t, N> const& values)
+	{
+		for (std::size_t i = 0; i < N; ++i)
+			set_register (id, first_register + i, values[i]);
+	}
+
+
+inline bool
+I2CScheduler::serviceable (DeviceID id) const noexcept
+{
+	return _devices[id]->serviceable.load (std::memory_order_relaxed);
+}
+
+
+inline uint64_t
+I2CScheduler::errors (DeviceID id) const noexcept
+{
+	return _devices[id]->errors.load (std::memory_order_relaxed);
+}
+
+} // namespace xf
+
+#endif
+
@@ -20,13 +20,8 @@
 // Lib:
 #include <boost/endian/conversion.hpp>
 
-// Qt:
-#include <QTimer>
-
 // Neutrino:
 #include <neutrino/numeric.h>
-#include <neutrino/qt/qdom.h>
-#include <neutrino/time_helper.h>
 #include <neutrino/stdexcept.h>
 
 // Xefis:
@@ -38,82 +33,55 @@
 
 namespace xf {
 
-PCA9685::PCA9685 (i2c::Device&& device, si::Time output_period, Logger const& logger):
-	_i2c_device (std::move (device)),
+PCA9685::PCA9685 (I2CScheduler& scheduler, i2c::Device&& device, si::Time output_period, Logger const& logger):
+	_scheduler (scheduler),
 	_output_period (output_period),
 	_logger (logger)
 {
-	std::fill (_duty_cycles.begin(), _duty_cycles.end(), 0_ms);
+	I2CScheduler::DeviceLayout layout;
+	layout.first_register = Register_PWM0OnL;
+	layout.registers = 4 * kChannels;
+	layout.initializer = [this] (I2CScheduler::Device& device) { initialize (device); };
 
-	_initialization_timer = new QTimer (this);
-	_initialization_timer->setInterval (kInitializationDelay.in<si::Millisecond>());
-	_initialization_timer->setSingleShot (true);
-	QObject::connect (_initialization_timer, SIGNAL (timeout()), this, SLOT (initialize()));
-	_initialization_timer->start();
+	// Initial zeroed image means 0 duty cycle on all channels:
+	_device_id = _scheduler.add_device (std::make_unique<I2CScheduler::BusDevice> (std::move (device)), layout);
 }
 
 
-void
-PCA9685::set_duty_cycle (std::size_t channel_id, si::Time duty_cycle)
+PCA9685::~PCA9685()
 {
-	if (channel_id >= kChannels)
-		throw std::out_of_range ("channel_id should be between 0 and kChannels");
-
-	_duty_cycles[channel_id] = duty_cycle;
-	update_chip();
+	_scheduler.remove_device (_device_id);
 }
 
 
 void
-PCA9685::initialize()
+PCA9685::set_duty_cycle (std::size_t channel_id, si::Time duty_cycle)
 {
-	guard ([&] {
-		_i2c_device.open();
-
-		_logger << "Resetting PCA9685." << std::endl;
-
-		_i2c_device.write_register (Register_Mode1, 0x00);
-		_i2c_device.write_register (Register_Mode2, Mode2_OutTotemPole | Mode2_UpdateOnAck);
-
-		// Set pre-scale value and thus set period time.
-		// Need to go to sleep to change prescale value.
-		uint8_t mode1_orig = _i2c_device.read_register (Register_Mode1) & ~Mode1_RestartEnabled;
-		_i2c_device.write_register (Register_Mode1, mode1_orig | Mode1_Sleep);
-		_i2c_device.write_register (Register_Prescale, calculate_prescale_register (1.0 / _output_period));
-		_i2c_device.write_register (Register_Mode1, mode1_orig & ~Mode1_Sleep);
-		// Need to sleep for max 500 µs while waiting for osc to restart.
-		usleep (500);
-		_i2c_device.write_register (Register_Mode1, mode1_orig | Mode1_RestartEnabled);
-
-		_serviceable = true;
+	if (channel_id >= kChannels)
+		throw std::out_of_range ("channel_id should be between 0 and kChannels");
 
-		update_chip();
-	});
+	_scheduler.set_registers (_device_id, get_pwm_register (channel_id, PWMRegister_First), get_config_for_pwm (duty_cycle));
 }
 
 
 void
-PCA9685::reinitialize()
+PCA9685::initialize (I2CScheduler::Device& device)
 {
-	_serviceable = false;
-	_i2c_device.close();
-	_initialization_timer->start();
-}
-
-
-void
-PCA9685::update_chip()
-{
-	guard ([&] {
-		for (std::size_t ch = 0; ch < _duty_cycles.size(); ++ch)
-		{
-			// Fill in all 4 PWM registers:
-			auto ary = get_config_for_pwm (_duty_cycles[ch]);
-
-			for (uint8_t i = 0; i < ary.size(); ++i)
-				_i2c_device.write_register (get_pwm_register (ch, static_cast<PWMRegister> (PWMRegister_First + i)), ary[i]);
-		}
-	});
+	_logger << "Resetting PCA9685." << std::endl;
+
+	// Auto-increment is needed by I2CScheduler burst writes:
+	device.write_register (Register_Mode1, Mode1_AutoIncrement);
+	device.write_register (Register_Mode2, Mode2_OutTotemPole | Mode2_UpdateOnAck);
+
+	// Set pre-scale value and thus set period time.
+	// Need to go to sleep to change prescale value.
+	uint8_t mode1_orig = device.read_register (Register_Mode1) & ~Mode1_RestartEnabled;
+	device.write_register (Register_Mode1, mode1_orig | Mode1_Sleep);
+	device.write_register (Register_Prescale, calculate_prescale_register (1.0 / _output_period));
+	device.write_register (Register_Mode1, mode1_orig & ~Mode1_Sleep);
+	// Need to sleep for max 500 µs while waiting for osc to restart.
+	usleep (500);
+	device.write_register (Register_Mode1, mode1_orig | Mode1_RestartEnabled);
 }
 
 
@@ -155,22 +123,5 @@ PCA9685::calculate_prescale_register (si::Frequency frequency)
 }
 
 
-void
-PCA9685::guard (std::function<void()> guarded_code)
-{
-	try {
-		guarded_code();
-	}
-	catch (xf::IOError& e)
-	{
-		_logger << "I/O error: " << e.message() << std::endl;
-		reinitialize();
-	}
-	catch (...)
-	{
-		reinitialize();
-	}
-}
-
 } // namespace xf
 
@@ -21,26 +21,24 @@
 // Neutrino:
 #include <neutrino/bus/i2c.h>
 #include <neutrino/logger.h>
+#include <neutrino/noncopyable.h>
 
 // Xefis:
 #include <xefis/config/all.h>
-#include <xefis/core/property.h>
-#include <xefis/utility/smoother.h>
+#include <xefis/support/devices/i2c_scheduler.h>
 
 
 namespace xf {
 
 /**
- * Warning: this module uses I2C I/O in main thread, which may block.
- *
  * Handles PCA9685-based Adafruit's 16-channel 12-bit PWM controller.
+ *
+ * I²C transfers are done by I2CScheduler in its thread: new duty cycles are sent to the chip
+ * on I2CScheduler::flush(), and only for channels that have changed.
  */
-class PCA9685: public QObject
+class PCA9685: private Noncopyable
 {
-	Q_OBJECT
-
   private:
-	static constexpr si::Time		kInitializationDelay	= 0.1_s;
 	static constexpr unsigned int	kChannels				= 16;
 	static constexpr si::Frequency	kInternalFrequency		= 25_MHz;
 
@@ -91,11 +89,15 @@ class PCA9685: public QObject
   public:
 	// Ctor
 	explicit
-	PCA9685 (i2c::Device&&, si::Time output_period, Logger const&);
+	PCA9685 (I2CScheduler&, i2c::Device&&, si::Time output_period, Logger const&);
+
+	// Dtor
+	~PCA9685();
 
 	/**
 	 * Return true if chip is serviceable.
 	 */
+	[[nodiscard]]
 	bool
 	serviceable() const;
 
@@ -109,25 +111,12 @@ class PCA9685: public QObject
 	void
 	set_duty_cycle (std::size_t channel_id, si::Time duty_cycle);
 
-  private slots:
-	/**
-	 * Initialize module.
-	 */
-	void
-	initialize();
-
   private:
 	/**
-	 * Reinitialize after a failure.
+	 * Initialize the chip. Called by I2CScheduler in its thread.
 	 */
 	void
-	reinitialize();
-
-	/**
-	 * Send updated PWM values and config to the chip.
-	 */
-	void
-	update_chip();
+	initialize (I2CScheduler::Device&);
 
 	/**
 	 * Get register number for given channel and offset.
@@ -148,18 +137,10 @@ class PCA9685: public QObject
 	static uint8_t
 	calculate_prescale_register (si::Frequency frequency);
 
-	/**
-	 * Guard and reinitialize on I2C error.
-	 */
-	void
-	guard (std::function<void()> guarded_code);
-
   private:
-	i2c::Device						_i2c_device;
-	QTimer*							_initialization_timer;
-	bool							_serviceable	{ false };
+	I2CScheduler&					_scheduler;
+	I2CScheduler::DeviceID			_device_id;
 	si::Time						_output_period;
-	std::array<si::Time, kChannels>	_duty_cycles;
 	Logger							_logger;
 };
 
@@ -167,7 +148,7 @@ class PCA9685: public QObject
 inline bool
 PCA9685::serviceable() const
 {
-	return _serviceable;
+	return _scheduler.serviceable (_device_id);
 }
 
 } // namespace xf
@@ -0,0 +1,269 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <map>
+#include <vector>
+
+// Neutrino:
+#include <neutrino/logger.h>
+#include <neutrino/test/auto_test.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/devices/chr_um6.h>
+
+
+namespace xf::test {
+namespace {
+
+xf::LoggerOutput g_logger_output (std::clog);
+xf::Logger g_logger (g_logger_output);
+
+using ConfigurationAddress = CHRUM6::ConfigurationAddress;
+using DataAddress = CHRUM6::DataAddress;
+using CommandAddress = CHRUM6::CommandAddress;
+using ProtocolError = CHRUM6::ProtocolError;
+
+
+/**
+ * Simulates UM6 register map and its serial protocol.
+ * Packets are collected by receive() and answered by respond(), so that tests can control
+ * how many requests are in flight.
+ */
+class SimulatedUM6
+{
+  public:
+	void
+	receive (Blob const& packet)
+	{
+		_received.push_back (packet);
+	}
+
+	/**
+	 * Return responses to all packets received so far.
+	 */
+	Blob
+	respond()
+	{
+		Blob responses;
+
+		for (auto const& packet: _received)
+		{
+			if (corrupt_next_response)
+			{
+				corrupt_next_response = false;
+				append_packet (responses, 0x00, static_cast<uint8_t> (ProtocolError::BadChecksum), {});
+			}
+			else if (!mute)
+				respond_to (responses, packet);
+		}
+
+		_received.clear();
+		return responses;
+	}
+
+	[[nodiscard]]
+	std::size_t
+	received() const noexcept
+	{
+		return _received.size();
+	}
+
+  public:
+	std::map<uint8_t, uint32_t>	registers;
+	// Device doesn't respond at all:
+	bool						mute					{ false };
+	// Respond with BadChecksum error to the next packet:
+	bool						corrupt_next_response	{ false };
+
+  private:
+	void
+	respond_to (Blob& responses, Blob const& packet)
+	{
+		uint8_t const packet_type = packet[3];
+		uint8_t const address = packet[4];
+		bool const has_data = packet_type & 0x80;
+		bool const is_batch = packet_type & 0x40;
+		std::size_t const batch_size = (packet_type >> 2) & 0x0f;
+		std::size_t const data_size = has_data ? 4 * (is_batch ? batch_size : 1) : 0;
+
+		uint16_t checksum = 0;
+		for (std::size_t i = 0; i < 5 + data_size; ++i)
+			checksum += packet[i];
+
+		if (checksum != ((packet[5 + data_size] << 8) | packet[6 + data_size]))
+			append_packet (responses, 0x00, static_cast<uint8_t> (ProtocolError::BadChecksum), {});
+		else if (address == static_cast<uint8_t> (CommandAddress::GetFWVersion))
+			append_packet (responses, 0x80, address, { 0x55'4d'32'42 }); // "UM2B"
+		else if (address >= static_cast<uint8_t> (CommandAddress::GetFWVersion))
+			append_packet (responses, 0x00, address, {});
+		else if (has_data)
+		{
+			registers[address] = (packet[5] << 24) | (packet[6] << 16) | (packet[7] << 8) | packet[8];
+			append_packet (responses, 0x00, address, {});
+		}
+		else
+		{
+			std::vector<uint32_t> words;
+
+			for (std::size_t i = 0; i < (is_batch ? batch_size : 1); ++i)
+				words.push_back (registers[address + i]);
+
+			append_packet (responses, 0x80 | (is_batch ? 0x40 | (batch_size << 2) : 0x00), address, words);
+		}
+	}
+
+	static void
+	append_packet (Blob& output, uint8_t packet_type, uint8_t address, std::vector<uint32_t> const& words)
+	{
+		Blob packet { 's', 'n', 'p', packet_type, address };
+
+		for (uint32_t word: words)
+			for (int shift: { 24, 16, 8, 0 })
+				packet.push_back ((word >> shift) & 0xff);
+
+		uint16_t checksum = 0;
+		for (uint8_t c: packet)
+			checksum += c;
+
+		packet.push_back (checksum >> 8);
+		packet.push_back (checksum & 0xff);
+		output.insert (output.end(), packet.begin(), packet.end());
+	}
+
+  private:
+	std::vector<Blob>	_received;
+};
+
+
+AutoTest t1 ("CHR-UM6: pipelined requests", []{
+	SimulatedUM6 device;
+	CHRUM6 um6 ([&] (Blob const& packet) { device.receive (packet); }, g_logger);
+	um6.set_max_in_flight (2);
+
+	device.registers[static_cast<uint8_t> (DataAddress::Temperature)] = 0x41c80000; // 25.0f
+	device.registers[static_cast<uint8_t> (DataAddress::Status)] = 0x1;
+
+	std::vector<uint32_t> callback_order;
+	auto const note = [&] (auto req) { callback_order.push_back (req.address()); };
+
+	auto temperature = um6.read (DataAddress::Temperature, note);
+	auto status = um6.read (DataAddress::Status, note);
+	auto write = um6.write (ConfigurationAddress::EKFProcessVariance, 0.5f, note);
+	auto version = um6.command (CommandAddress::GetFWVersion, note);
+
+	test_asserts::verify ("requests are sent without waiting for responses", device.received() == 2);
+	test_asserts::verify ("requests over the limit wait in queue", um6.pending_requests() == 2 && um6.requests_in_flight() == 2);
+
+	um6.feed (device.respond());
+	test_asserts::verify ("queued requests are sent after responses", device.received() == 2);
+	um6.feed (device.respond());
+
+	test_asserts::verify ("all requests finished", temperature.finished() && status.finished() && write.finished() && version.finished());
+	test_asserts::verify ("all requests succeeded", temperature.success() && status.success() && write.success() && version.success());
+	test_asserts::verify ("callbacks are called in order", callback_order == std::vector<uint32_t> {
+		static_cast<uint32_t> (DataAddress::Temperature),
+		static_cast<uint32_t> (DataAddress::Status),
+		static_cast<uint32_t> (ConfigurationAddress::EKFProcessVariance),
+		static_cast<uint32_t> (CommandAddress::GetFWVersion),
+	});
+	test_asserts::verify ("read value is correct", temperature.value_as_float() == 25.0f);
+	test_asserts::verify ("register got written", device.registers[static_cast<uint8_t> (ConfigurationAddress::EKFProcessVariance)] == 0x3f000000);
+	test_asserts::verify ("firmware version is correct", version.firmware_version() == "UM2B");
+	test_asserts::verify ("nothing left", um6.pending_requests() == 0 && um6.requests_in_flight() == 0);
+});
+
+
+AutoTest t2 ("CHR-UM6: batch read", []{
+	SimulatedUM6 device;
+	CHRUM6 um6 ([&] (Blob const& packet) { device.receive (packet); }, g_logger);
+
+	for (uint8_t a = 0x5c; a <= 0x61; ++a)
+		device.registers[a] = 0x1000 * a;
+
+	std::size_t callbacks = 0;
+	auto reads = um6.read_batch (DataAddress::GyroProcXY, 6, [&] (CHRUM6::Read) { ++callbacks; });
+
+	test_asserts::verify ("batch is sent as a single packet", device.received() == 1);
+	um6.feed (device.respond());
+
+	test_asserts::verify ("callback is called for each register", callbacks == 6);
+
+	for (std::size_t i = 0; i < reads.size(); ++i)
+	{
+		test_asserts::verify ("batch read succeeded", reads[i].finished() && reads[i].success());
+		test_asserts::verify ("batch read value is correct", reads[i].value() == 0x1000 * (0x5c + i));
+	}
+
+	bool thrown = false;
+
+	try {
+		um6.read_batch (DataAddress::GyroProcXY, CHRUM6::kMaxBatchSize + 1);
+	}
+	catch (InvalidArgument const&)
+	{
+		thrown = true;
+	}
+
+	test_asserts::verify ("too large batch is rejected", thrown);
+});
+
+
+AutoTest t3 ("CHR-UM6: protocol errors and timeouts", []{
+	SimulatedUM6 device;
+	CHRUM6 um6 ([&] (Blob const& packet) { device.receive (packet); }, g_logger);
+	um6.set_auto_retry (true);
+
+	// BadChecksum response causes retry of the oldest request:
+	device.corrupt_next_response = true;
+	auto status = um6.read (DataAddress::Status);
+	auto temperature = um6.read (DataAddress::Temperature);
+	um6.feed (device.respond());
+	test_asserts::verify ("request with bad checksum is not finished", !status.finished() && status.retries() == 1);
+	test_asserts::verify ("other requests are not affected", temperature.finished() && temperature.success());
+	um6.feed (device.respond());
+	test_asserts::verify ("request succeeded after retry", status.finished() && status.success());
+
+	// Requests without response time out:
+	um6.set_request_timeout (0_s);
+	device.mute = true;
+	bool timed_out = false;
+	um6.read (DataAddress::Status, [&] (CHRUM6::Read req) { timed_out = req.protocol_error() == ProtocolError::Timeout; });
+	um6.feed (device.respond());
+	um6.process_timeouts();
+	test_asserts::verify ("request timed out", timed_out);
+	test_asserts::verify ("timed out request is removed", um6.requests_in_flight() == 0);
+});
+
+
+AutoTest t4 ("CHR-UM6: coalescing writes", []{
+	SimulatedUM6 device;
+	CHRUM6 um6 ([&] (Blob const& packet) { device.receive (packet); }, g_logger);
+	um6.set_max_in_flight (1);
+
+	um6.read (DataAddress::Status);
+	um6.write (ConfigurationAddress::AccelRefX, 0.1f);
+	um6.write (ConfigurationAddress::AccelRefX, 0.2f);
+	auto last = um6.write (ConfigurationAddress::AccelRefX, 0.3f);
+	test_asserts::verify ("unsent writes to the same register are coalesced", um6.pending_requests() == 1);
+
+	um6.feed (device.respond());
+	um6.feed (device.respond());
+	test_asserts::verify ("last value is written", last.success() && device.registers[static_cast<uint8_t> (ConfigurationAddress::AccelRefX)] == 0x3e99999a);
+});
+
+} // namespace
+} // namespace xf::test
+
@@ -0,0 +1,212 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Neutrino:
+#include <neutrino/test/auto_test.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/devices/i2c_scheduler.h>
+
+
+namespace xf::test {
+namespace {
+
+/**
+ * Records transfers instead of doing them. Can simulate I/O errors.
+ */
+class MockDevice: public I2CScheduler::Device
+{
+  public:
+	struct Transfer
+	{
+		uint8_t		reg;
+		Blob		data;
+
+		bool
+		operator== (Transfer const&) const = default;
+	};
+
+	// Command byte written with write() is recorded with reg = 0xff:
+	static constexpr uint8_t kCommand = 0xff;
+
+  public:
+	void
+	open() override
+	{
+		++opens;
+	}
+
+	void
+	close() override
+	{ }
+
+	void
+	write (uint8_t byte) override
+	{
+		check();
+		transfers.push_back ({ kCommand, { byte } });
+	}
+
+	void
+	write_register (uint8_t reg, uint8_t value) override
+	{
+		check();
+		transfers.push_back ({ reg, { value } });
+	}
+
+	void
+	write_registers (uint8_t first_register, uint8_t const* data, std::size_t size) override
+	{
+		check();
+		transfers.push_back ({ first_register, Blob (data, data + size) });
+	}
+
+	uint8_t
+	read_register (uint8_t) override
+	{
+		check();
+		return 0;
+	}
+
+	void
+	read_registers (uint8_t, uint8_t* data, std::size_t size) override
+	{
+		check();
+		std::fill (data, data + size, 0);
+	}
+
+  private:
+	void
+	check()
+	{
+		if (fail_next)
+		{
+			fail_next = false;
+			throw std::runtime_error ("simulated I/O error");
+		}
+	}
+
+  public:
+	std::vector<Transfer>	transfers;
+	unsigned int			opens		{ 0 };
+	bool					fail_next	{ false };
+};
+
+
+struct Fixture
+{
+	Fixture()
+	{
+		auto device = std::make_unique<MockDevice>();
+		mock = device.get();
+
+		I2CScheduler::DeviceLayout layout;
+		layout.first_register = 0x06;
+		layout.registers = 16;
+		layout.command_slots = 1;
+		layout.initializer = [] (I2CScheduler::Device& device) { device.write_register (0x00, 0x20); };
+
+		id = scheduler.add_device (std::move (device), layout);
+	}
+
+	I2CScheduler			scheduler;
+	MockDevice*				mock;
+	I2CScheduler::DeviceID	id;
+};
+
+
+AutoTest t1 ("I2CScheduler: burst writes of changed registers", []{
+	Fixture f;
+
+	f.scheduler.flush();
+	f.scheduler.sync();
+	test_asserts::verify ("device is serviceable after initialization", f.scheduler.serviceable (f.id));
+	test_asserts::verify ("initializer is called and whole image is written", f.mock->transfers == std::vector<MockDevice::Transfer> {
+		{ 0x00, { 0x20 } },
+		{ 0x06, Blob (16, 0) },
+		{ MockDevice::kCommand, { 0x00 } },
+	});
+
+	f.mock->transfers.clear();
+	f.scheduler.set_register (f.id, 0x08, 1);
+	f.scheduler.set_register (f.id, 0x09, 2);
+	f.scheduler.set_register (f.id, 0x0c, 5);
+	f.scheduler.set_register (f.id, 0x14, 7);
+	f.scheduler.set_command (f.id, 0, 0x81);
+	f.scheduler.flush();
+	f.scheduler.sync();
+	test_asserts::verify ("changes within kMaxGap are joined, unchanged registers are skipped", f.mock->transfers == std::vector<MockDevice::Transfer> {
+		{ 0x08, { 1, 2, 0, 0, 5 } },
+		{ 0x14, { 7 } },
+		{ MockDevice::kCommand, { 0x81 } },
+	});
+
+	f.mock->transfers.clear();
+	f.scheduler.set_register (f.id, 0x08, 1);
+	f.scheduler.set_command (f.id, 0, 0x81);
+	f.scheduler.flush();
+	f.scheduler.sync();
+	test_asserts::verify ("unchanged values are not sent", f.mock->transfers.empty());
+
+	auto const statistics = f.scheduler.statistics();
+	test_asserts::verify ("statistics count transfers", statistics.transfers == 5 && statistics.bytes_written == 24);
+	test_asserts::verify ("statistics count skipped bytes", statistics.bytes_skipped == 17 - 7);
+	test_asserts::verify ("no errors", statistics.errors == 0 && statistics.dropped == 0);
+});
+
+
+AutoTest t2 ("I2CScheduler: recovery after I/O error", []{
+	Fixture f;
+	std::vector<std::string> jobs_called;
+
+	f.scheduler.set_register (f.id, 0x07, 3);
+	f.scheduler.flush();
+	f.scheduler.sync();
+
+	f.mock->fail_next = true;
+	f.scheduler.set_register (f.id, 0x07, 4);
+	f.scheduler.flush();
+	f.scheduler.sync();
+	test_asserts::verify ("error is detected", f.scheduler.errors (f.id) == 1 && !f.scheduler.serviceable (f.id));
+
+	// Retries are delayed:
+	f.mock->transfers.clear();
+	f.scheduler.flush();
+	f.scheduler.sync();
+	test_asserts::verify ("job is queued during retry delay", f.scheduler.submit (f.id, [&] (I2CScheduler::Device&) { jobs_called.push_back ("deferred"); }));
+	f.scheduler.sync();
+	test_asserts::verify ("no transfers before retry delay", f.mock->transfers.empty());
+	test_asserts::verify ("job is not executed before retry delay", jobs_called.empty());
+
+	std::this_thread::sleep_for (I2CScheduler::kRetryDelay);
+	f.scheduler.flush();
+	test_asserts::verify ("job is queued", f.scheduler.submit (f.id, [&] (I2CScheduler::Device&) { jobs_called.push_back ("next"); }));
+	f.scheduler.sync();
+	test_asserts::verify ("device is reinitialized", f.scheduler.serviceable (f.id) && f.mock->opens == 2);
+	test_asserts::verify ("whole image is rewritten", f.mock->transfers.size() == 3 && f.mock->transfers[1].data[1] == 4);
+	test_asserts::verify ("deferred job is executed first", jobs_called == std::vector<std::string> { "deferred", "next" });
+	test_asserts::verify ("nothing is dropped", f.scheduler.statistics().dropped == 0);
+});
+
+} // namespace
+} // namespace xf::test
+
@@ -0,0 +1,188 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <cmath>
+#include <limits>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/earth/air/air.h>
+#include <xefis/support/earth/air/standard_atmosphere.h>
+#include <xefis/support/nature/constants.h>
+#include <xefis/utility/convergence.h>
+
+// Local:
+#include "air_data.h"
+
+
+namespace xf {
+namespace {
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+
+template<class Quantity>
+	inline double
+	to_raw (std::optional<Quantity> const& value, Quantity const unit)
+	{
+		return value ? *value / unit : kNaN;
+	}
+
+
+template<class Quantity>
+	inline std::optional<Quantity>
+	from_raw (double const value, Quantity const unit)
+	{
+		if (std::isfinite (value))
+			return value * unit;
+		else
+			return std::nullopt;
+	}
+
+
+inline std::optional<double>
+from_raw (double const value)
+{
+	if (std::isfinite (value))
+		return value;
+	else
+		return std::nullopt;
+}
+
+} // namespace
+
+
+void
+AirDataBatch::compute (AirDataParameters const& params, std::vector<AirDataInput> const& inputs, std::vector<AirDataResult>& results)
+{
+	// Pressure altitude formula constants, good for heights below tropopause (36 kft):
+	double const kA = 6.8755856e-6;
+	double const kB = 5.2558797;
+	double const kFootInMeters = 1_ft / 1_m;
+	double const kStdP0 = kStdAirPressure / 1_Pa;
+	double const kStdRho0 = kStdAirDensity / 1_kgpm3;
+	double const kStdA0 = kStdSpeedOfSound / 1_mps;
+	double const kR = kDryAirSpecificConstant * 1_kg * 1_K / 1_J;
+	double const kSpeedOfSoundFactor = speed_of_sound (1_K) / 1_mps;
+	double const p0 = to_raw (params.pressure_setting, 1_Pa);
+	double const ram_rise_factor = params.ram_rise_factor;
+	double const ias_min = params.ias_valid_minimum / 1_mps;
+	double const ias_max = params.ias_valid_maximum / 1_mps;
+	double const reference_length = to_raw (params.reference_length, 1_m);
+	std::size_t const n = inputs.size();
+
+	resize (n);
+
+	// Gather:
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		_p[i] = to_raw (inputs[i].pressure_static, 1_Pa);
+		_pt[i] = to_raw (inputs[i].pressure_total, 1_Pa);
+		_tat[i] = to_raw (inputs[i].total_air_temperature, 1_K);
+	}
+
+	// Impact pressure and pressure altitudes:
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		_qc[i] = _pt[i] - _p[i];
+		_altitude[i] = kFootInMeters * -(std::pow (_p[i] / p0, 1.0 / kB) - 1.0) / kA;
+		_altitude_std[i] = kFootInMeters * -(std::pow (_p[i] / kStdP0, 1.0 / kB) - 1.0) / kA;
+	}
+
+	// Sub-sonic Mach from pitot pressure
+	// <http://en.wikipedia.org/wiki/Mach_number#Calculating_Mach_Number_from_Pitot_Tube_Pressure>:
+	for (std::size_t i = 0; i < n; ++i)
+		_mach[i] = std::sqrt (5.0 * (std::pow (_qc[i] / _p[i] + 1.0, 2.0 / 7.0) - 1.0));
+
+	// Rare case of super-sonic Mach is converged channel by channel:
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		if (_mach[i] >= 1.0)
+		{
+			double const qc_p = _qc[i] / _p[i];
+			auto const converged = converge<double> (_mach[i], 1e-9, 100, [&](double M_it) {
+				return 0.88128485 * std::sqrt ((qc_p + 1.0) * std::pow (1.0 - 1 / (7.0 * M_it * M_it), 2.5));
+			});
+
+			_mach[i] = converged.value_or (kNaN);
+		}
+	}
+
+	// SAT, density, airspeeds:
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		_sat[i] = _tat[i] / (1.0 + ram_rise_factor * _mach[i] * _mach[i]);
+		_density[i] = _p[i] / (kR * _sat[i]);
+		_ias[i] = std::sqrt (2.0 * _qc[i] / _density[i]);
+		_cas[i] = kStdA0 * std::sqrt (5.0 * (std::pow (_qc[i] / kStdP0 + 1.0, 2.0 / 7.0) - 1.0));
+		_speed_of_sound[i] = kSpeedOfSoundFactor * std::sqrt (_sat[i]);
+	}
+
+	// Density altitude, TAS and EAS:
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		double const altitude_ft = _altitude[i] / kFootInMeters;
+		double const t_s = 273.15 + (15.0 - (0.0019812 * altitude_ft));
+		double const density_altitude_ft = altitude_ft + (t_s / 0.0019812) * (1.0 - std::pow (t_s / _sat[i], 0.2349690));
+		bool const ias_valid = ias_min <= _ias[i] && _ias[i] <= ias_max;
+
+		_density_altitude[i] = density_altitude_ft * kFootInMeters;
+		_tas[i] = ias_valid ? _ias[i] / std::pow (1.0 - kA * density_altitude_ft, 2.127940) : kNaN;
+		_eas[i] = _tas[i] * std::sqrt (_density[i] / kStdRho0);
+	}
+
+	// Viscosity comes from tabulated data:
+	for (std::size_t i = 0; i < n; ++i)
+		_viscosity[i] = std::isfinite (_sat[i]) ? dynamic_air_viscosity (_sat[i] * 1_K) / 1_Pas : kNaN;
+
+	for (std::size_t i = 0; i < n; ++i)
+		_reynolds[i] = _density[i] * _tas[i] * reference_length / _viscosity[i];
+
+	// Scatter:
+	results.resize (n);
+
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		auto& result = results[i];
+		result.pressure_dynamic = from_raw (_qc[i], 1_Pa);
+		result.altitude_amsl = from_raw (_altitude[i], 1_m);
+		result.altitude_amsl_std = from_raw (_altitude_std[i], 1_m);
+		result.density_altitude = from_raw (_density_altitude[i], 1_m);
+		result.air_density = from_raw (_density[i], 1_kgpm3);
+		result.speed_ias = from_raw (_ias[i], 1_mps);
+		result.speed_cas = from_raw (_cas[i], 1_mps);
+		result.speed_tas = from_raw (_tas[i], 1_mps);
+		result.speed_eas = from_raw (_eas[i], 1_mps);
+		result.speed_mach = from_raw (_mach[i]);
+		result.speed_sound = from_raw (_speed_of_sound[i], 1_mps);
+		result.static_air_temperature = from_raw (_sat[i], 1_K);
+		result.dynamic_viscosity = from_raw (_viscosity[i], 1_Pas);
+		result.reynolds_number = from_raw (_reynolds[i]);
+	}
+}
+
+
+void
+AirDataBatch::resize (std::size_t const channels)
+{
+	for (auto* buffer: { &_p, &_pt, &_tat, &_qc, &_altitude, &_altitude_std, &_mach, &_sat, &_density, &_ias, &_cas,
+						 &_density_altitude, &_tas, &_eas, &_speed_of_sound, &_viscosity, &_reynolds })
+	{
+		buffer->resize (channels);
+	}
+}
+
+} // namespace xf
+
@@ -0,0 +1,135 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__EARTH__AIR__AIR_DATA_H__INCLUDED
+#define XEFIS__SUPPORT__EARTH__AIR__AIR_DATA_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+
+namespace xf {
+
+/**
+ * Sensor data of a single air data channel.
+ */
+struct AirDataInput
+{
+	std::optional<si::Pressure>		pressure_static;
+	std::optional<si::Pressure>		pressure_total;
+	std::optional<si::Temperature>	total_air_temperature;
+};
+
+
+/**
+ * Parameters common to all channels computed in one batch.
+ */
+struct AirDataParameters
+{
+	// Pressure setting (QNH or STD) used to compute altitude_amsl:
+	std::optional<si::Pressure>		pressure_setting;
+	double							ram_rise_factor			{ 0.2 };
+	// TAS is computed only when IAS is within these limits:
+	si::Velocity					ias_valid_minimum		{ 0_mps };
+	si::Velocity					ias_valid_maximum		{ 1'000_mps };
+	// Characteristic length used to compute Reynolds number:
+	std::optional<si::Length>		reference_length;
+};
+
+
+/**
+ * Computed air data for a single channel.
+ */
+struct AirDataResult
+{
+	std::optional<si::Pressure>			pressure_dynamic;
+	std::optional<si::Length>			altitude_amsl;
+	std::optional<si::Length>			altitude_amsl_std;
+	std::optional<si::Length>			density_altitude;
+	std::optional<si::Density>			air_density;
+	std::optional<si::Velocity>			speed_ias;
+	std::optional<si::Velocity>			speed_cas;
+	std::optional<si::Velocity>			speed_tas;
+	std::optional<si::Velocity>			speed_eas;
+	std::optional<double>				speed_mach;
+	std::optional<si::Velocity>			speed_sound;
+	std::optional<si::Temperature>		static_air_temperature;
+	std::optional<si::DynamicViscosity>	dynamic_viscosity;
+	std::optional<double>				reynolds_number;
+};
+
+
+/**
+ * Computes all derived air data values for many channels at once.
+ *
+ * Inputs are first gathered into per-quantity arrays of plain doubles (NaN means nil), then each quantity is computed
+ * for all channels in a single branch-free loop, so that the compiler can vectorize the arithmetic. Nil inputs
+ * propagate as NaNs and end up as nil results.
+ *
+ * Pressure altitude, Mach, CAS, IAS, density altitude and TAS use the same formulas as the AirDataComputer module, but
+ * values are not smoothed. Air density comes from the ideal gas law and speed of sound is computed from SAT; only dynamic
+ * viscosity is looked up in the standard atmosphere tables. TAS is computed only when IAS is within the valid range given
+ * in AirDataParameters, and there's no fallback approximation when density altitude is nil. Computations are reliable
+ * up to 36,000 ft of altitude and up to about speed of Mach 0.3.
+ *
+ * Object keeps its scratch buffers between calls, so that no allocations are made once the number of channels stabilizes.
+ * Not thread-safe.
+ */
+class AirDataBatch
+{
+  public:
+	/**
+	 * Compute results for all inputs.
+	 * The results vector is resized to match the inputs vector.
+	 */
+	void
+	compute (AirDataParameters const&, std::vector<AirDataInput> const&, std::vector<AirDataResult>& results);
+
+  private:
+	/**
+	 * Resize all scratch buffers.
+	 */
+	void
+	resize (std::size_t channels);
+
+  private:
+	// Input values in SI units:
+	std::vector<double>	_p;
+	std::vector<double>	_pt;
+	std::vector<double>	_tat;
+	// Computed values in SI units:
+	std::vector<double>	_qc;
+	std::vector<double>	_altitude;
+	std::vector<double>	_altitude_std;
+	std::vector<double>	_mach;
+	std::vector<double>	_sat;
+	std::vector<double>	_density;
+	std::vector<double>	_ias;
+	std::vector<double>	_cas;
+	std::vector<double>	_density_altitude;
+	std::vector<double>	_tas;
+	std::vector<double>	_eas;
+	std::vector<double>	_speed_of_sound;
+	std::vector<double>	_viscosity;
+	std::vector<double>	_reynolds;
+};
+
+} // namespace xf
+
+#endif
+
@@ -13,6 +13,10 @@
 
 // Standard:
 #include <cstddef>
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
 
 // Neutrino:
 #include <neutrino/math/field.h>
@@ -125,6 +129,86 @@ standard_temperature_gradient (std::map<si::Length, InternationalStandardAtmosph
 	return delta_temperature / delta_altitude;
 }
 
+
+/**
+ * Atmosphere layer with precomputed coefficients of the barometric formula.
+ */
+struct AtmosphereLayer
+{
+	si::Length				base_altitude;
+	si::Temperature			base_temperature;
+	si::Pressure			base_pressure;
+	si::Density				base_density;
+	si::TemperatureGradient	temperature_gradient;
+	bool					isothermal;
+	// Exponents used when temperature gradient is non-zero:
+	double					pressure_exponent;
+	double					density_exponent;
+	// Exponential coefficient per meter, used when temperature gradient is zero:
+	double					isothermal_coefficient;
+};
+
+
+/**
+ * Layers between consecutive points of international_standard_atmosphere_map(),
+ * sorted by base altitude.
+ */
+std::vector<AtmosphereLayer> const&
+atmosphere_layers()
+{
+	static std::vector<AtmosphereLayer> const kAtmosphereLayers = []{
+		auto const& atmmap = international_standard_atmosphere_map();
+		auto const gM = kStdGravitationalAcceleration * kAirMolarMass;
+		std::vector<AtmosphereLayer> layers;
+
+		for (auto upper_layer_it = std::next (atmmap.begin()); upper_layer_it != atmmap.end(); ++upper_layer_it)
+		{
+			auto const lower_layer_it = std::prev (upper_layer_it);
+			auto const& lower_layer = lower_layer_it->second;
+			auto const Lb = standard_temperature_gradient (lower_layer_it, upper_layer_it);
+			auto const Tb = lower_layer.temperature;
+
+			AtmosphereLayer layer;
+			layer.base_altitude = lower_layer_it->first;
+			layer.base_temperature = Tb;
+			layer.base_pressure = lower_layer.pressure;
+			layer.base_density = lower_layer.density;
+			layer.temperature_gradient = Lb;
+			layer.isothermal = !(abs (Lb) > 0.0_K / 1_m);
+			layer.pressure_exponent = layer.isothermal ? 0.0 : gM / (kUniversalGasConstant * Lb);
+			layer.density_exponent = 1.0 + layer.pressure_exponent;
+			layer.isothermal_coefficient = gM * 1_m / (kUniversalGasConstant * Tb);
+			layers.push_back (layer);
+		}
+
+		return layers;
+	}();
+
+	return kAtmosphereLayers;
+}
+
+
+/**
+ * Return layer for given altitude and the altitude clamped to the defined range.
+ */
+inline std::pair<AtmosphereLayer const&, si::Length>
+atmosphere_layer_at (si::Length geometric_altitude_amsl)
+{
+	auto const& atmmap = international_standard_atmosphere_map();
+	auto const& layers = atmosphere_layers();
+
+	geometric_altitude_amsl = std::clamp (geometric_altitude_amsl, atmmap.begin()->first, atmmap.rbegin()->first);
+
+	auto upper_layer_it = std::upper_bound (layers.begin(), layers.end(), geometric_altitude_amsl, [](si::Length altitude, AtmosphereLayer const& layer) {
+		return altitude < layer.base_altitude;
+	});
+
+	if (upper_layer_it == layers.begin())
+		++upper_layer_it;
+
+	return { *std::prev (upper_layer_it), geometric_altitude_amsl };
+}
+
 } // namespace
 
 Air
@@ -172,39 +256,35 @@ StandardAtmosphere::state_at (SpaceVector<si::Length, ECEFSpace> const& position
 }
 
 
-si::Density
-standard_density (si::Length geometric_altitude_amsl)
+std::vector<si::Length> const&
+standard_atmosphere_layer_boundaries()
 {
-	// Using formulas from <https://en.wikipedia.org/wiki/Barometric_formula>
+	static std::vector<si::Length> const kLayerBoundaries = []{
+		std::vector<si::Length> boundaries;
 
-	auto const& atmmap = international_standard_atmosphere_map();
+		for (auto const& point: international_standard_atmosphere_map())
+			boundaries.push_back (point.first);
 
-	geometric_altitude_amsl = std::clamp (geometric_altitude_amsl, atmmap.begin()->first, atmmap.rbegin()->first);
+		return boundaries;
+	}();
 
-	auto upper_layer_it = atmmap.upper_bound (geometric_altitude_amsl);
+	return kLayerBoundaries;
+}
 
-	if (upper_layer_it == atmmap.begin())
-		upper_layer_it = std::next (atmmap.begin());
-	else if (upper_layer_it == atmmap.end())
-		--upper_layer_it;
 
-	auto const lower_layer_it = std::prev (upper_layer_it);
-	auto const& lower_layer = lower_layer_it->second;
-	auto const h = geometric_altitude_amsl;
-	auto const hb = lower_layer_it->first;
-	auto const Lb = standard_temperature_gradient (lower_layer_it, upper_layer_it);
-	auto const Tb = lower_layer.temperature;
-	auto const rb = lower_layer.density;
+si::Density
+standard_density (si::Length geometric_altitude_amsl)
+{
+	// Using formulas from <https://en.wikipedia.org/wiki/Barometric_formula>
 
-	if (abs (Lb) > 0.0_K / 1_m)
-	{
-		auto const p = Tb / (Tb + Lb * (h - hb));
-		auto const e = 1 + (kStdGravitationalAcceleration * kAirMolarMass / (kUniversalGasConstant * Lb));
+	auto const [layer, h] = atmosphere_layer_at (geometric_altitude_amsl);
+	auto const hb = layer.base_altitude;
+	auto const Tb = layer.base_temperature;
 
-		return rb * std::pow (p, e);
-	}
+	if (!layer.isothermal)
+		return layer.base_density * std::pow (Tb / (Tb + layer.temperature_gradient * (h - hb)), layer.density_exponent);
 	else
-		return rb * std::exp (-kStdGravitationalAcceleration * kAirMolarMass * (h - hb) / (kUniversalGasConstant * Tb));
+		return layer.base_density * std::exp (-layer.isothermal_coefficient * ((h - hb) / 1_m));
 }
 
 
@@ -213,34 +293,14 @@ standard_pressure (si::Length geometric_altitude_amsl)
 {
 	// Using formulas from <https://en.wikipedia.org/wiki/Barometric_formula>
 
-	auto const& atmmap = international_standard_atmosphere_map();
-
-	geometric_altitude_amsl = std::clamp (geometric_altitude_amsl, atmmap.begin()->first, atmmap.rbegin()->first);
-
-	auto upper_layer_it = atmmap.upper_bound (geometric_altitude_amsl);
+	auto const [layer, h] = atmosphere_layer_at (geometric_altitude_amsl);
+	auto const hb = layer.base_altitude;
+	auto const Tb = layer.base_temperature;
 
-	if (upper_layer_it == atmmap.begin())
-		upper_layer_it = std::next (atmmap.begin());
-	else if (upper_layer_it == atmmap.end())
-		--upper_layer_it;
-
-	auto const lower_layer_it = std::prev (upper_layer_it);
-	auto const& lower_layer = lower_layer_it->second;
-	auto const h = geometric_altitude_amsl;
-	auto const hb = lower_layer_it->first;
-	auto const Lb = standard_temperature_gradient (lower_layer_it, upper_layer_it);
-	auto const Tb = lower_layer.temperature;
-	auto const Pb = lower_layer.pressure;
-
-	if (abs (Lb) > 0.0_K / 1_m)
-	{
-		auto const p = Tb / (Tb + Lb * (h - hb));
-		auto const e = kStdGravitationalAcceleration * kAirMolarMass / (kUniversalGasConstant * Lb);
-
-		return Pb * std::pow (p, e);
-	}
+	if (!layer.isothermal)
+		return layer.base_pressure * std::pow (Tb / (Tb + layer.temperature_gradient * (h - hb)), layer.pressure_exponent);
 	else
-		return Pb * std::exp (-kStdGravitationalAcceleration * kAirMolarMass * (h - hb) / (kUniversalGasConstant * Tb));
+		return layer.base_pressure * std::exp (-layer.isothermal_coefficient * ((h - hb) / 1_m));
 }
 
 
@@ -16,6 +16,7 @@
 
 // Standard:
 #include <cstddef>
+#include <vector>
 
 // Xefis:
 #include <xefis/config/all.h>
@@ -82,6 +83,15 @@ class StandardAtmosphere
  */
 
 
+/**
+ * Sorted list of altitudes of the standard atmosphere layer boundaries.
+ * First and last elements define the range covered by the standard atmosphere data: density and pressure
+ * are constant outside of this range, temperature is extrapolated.
+ * Values aren't continuous at layer boundaries.
+ */
+std::vector<si::Length> const&
+standard_atmosphere_layer_boundaries();
+
 si::Density
 standard_density (si::Length geometric_altitude_amsl);
 
@@ -0,0 +1,189 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <algorithm>
+#include <cmath>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/nature/constants.h>
+
+// Local:
+#include "tabulated_atmosphere.h"
+
+
+namespace xf {
+namespace {
+
+inline Air
+interpolate (Air const& a, Air const& b, double const f)
+{
+	Air air;
+	air.density = a.density + f * (b.density - a.density);
+	air.pressure = a.pressure + f * (b.pressure - a.pressure);
+	air.temperature = a.temperature + f * (b.temperature - a.temperature);
+	air.dynamic_viscosity = a.dynamic_viscosity + f * (b.dynamic_viscosity - a.dynamic_viscosity);
+	air.speed_of_sound = a.speed_of_sound + f * (b.speed_of_sound - a.speed_of_sound);
+	return air;
+}
+
+
+template<class Value>
+	inline double
+	relative_error (Value const tabulated, Value const analytic)
+	{
+		return std::abs ((tabulated - analytic) / analytic);
+	}
+
+} // namespace
+
+
+TabulatedAtmosphere::TabulatedAtmosphere (si::Length const step):
+	_step (step)
+{
+	auto const& boundaries = standard_atmosphere_layer_boundaries();
+
+	_minimum_altitude = boundaries.front();
+	_maximum_altitude = boundaries.back();
+
+	for (std::size_t b = 0; b + 1 < boundaries.size(); ++b)
+	{
+		auto const extent = boundaries[b + 1] - boundaries[b];
+		double const requested_intervals = extent / step;
+
+		Layer layer;
+		layer.base_altitude = boundaries[b];
+		layer.intervals = std::max<std::size_t> (1, static_cast<std::size_t> (std::ceil (requested_intervals)));
+		layer.step = extent / static_cast<double> (layer.intervals);
+		layer.inv_step_m = 1_m / layer.step;
+		layer.first_index = _table.size();
+		_layers.push_back (layer);
+
+		for (std::size_t i = 0; i < layer.intervals; ++i)
+			_table.push_back (_analytic.air_at_amsl (layer.base_altitude + layer.step * static_cast<double> (i)));
+
+		// The analytic model uses the upper layer exactly at the boundary, so sample the last point
+		// just below it to get the value from this layer:
+		_table.push_back (_analytic.air_at_amsl (boundaries[b + 1] - 1e-6 * layer.step));
+	}
+
+	compute_error_bounds();
+}
+
+
+Air
+TabulatedAtmosphere::air_at (SpaceVector<si::Length, ECEFSpace> const& position) const
+{
+	return air_at_radius (abs (position));
+}
+
+
+Air
+TabulatedAtmosphere::air_at_radius (si::Length radius) const
+{
+	return air_at_amsl (radius - kEarthMeanRadius);
+}
+
+
+Air
+TabulatedAtmosphere::air_at_amsl (si::Length const amsl_height) const
+{
+	if (amsl_height < _minimum_altitude || amsl_height > _maximum_altitude)
+		return _analytic.air_at_amsl (amsl_height);
+
+	auto layer_it = std::upper_bound (_layers.begin(), _layers.end(), amsl_height, [](si::Length altitude, Layer const& layer) {
+		return altitude < layer.base_altitude;
+	});
+
+	auto const& layer = *std::prev (layer_it);
+	double const position = layer.inv_step_m * ((amsl_height - layer.base_altitude) / 1_m);
+	auto const index = std::min (static_cast<std::size_t> (position), layer.intervals - 1);
+	auto const table_index = layer.first_index + index;
+
+	return interpolate (_table[table_index], _table[table_index + 1], position - index);
+}
+
+
+SpaceVector<si::Velocity, ECEFSpace>
+TabulatedAtmosphere::wind_at (SpaceVector<si::Length, ECEFSpace> const& position) const
+{
+	return _analytic.wind_at (position);
+}
+
+
+AtmosphereState<ECEFSpace>
+TabulatedAtmosphere::state_at (SpaceVector<si::Length, ECEFSpace> const& position) const
+{
+	return {
+		air_at (position),
+		wind_at (position),
+	};
+}
+
+
+void
+TabulatedAtmosphere::air_at (std::vector<SpaceVector<si::Length, ECEFSpace>> const& positions, std::vector<Air>& results) const
+{
+	results.resize (positions.size());
+
+	for (std::size_t i = 0; i < positions.size(); ++i)
+		results[i] = air_at (positions[i]);
+}
+
+
+void
+TabulatedAtmosphere::air_at_amsl (std::vector<si::Length> const& amsl_heights, std::vector<Air>& results) const
+{
+	results.resize (amsl_heights.size());
+
+	for (std::size_t i = 0; i < amsl_heights.size(); ++i)
+		results[i] = air_at_amsl (amsl_heights[i]);
+}
+
+
+void
+TabulatedAtmosphere::compute_error_bounds()
+{
+	// Linear interpolation error is largest somewhere between table points, so check a few points in each interval:
+	for (auto const& layer: _layers)
+	{
+		for (std::size_t i = 0; i < layer.intervals; ++i)
+		{
+			for (double const f: { 0.25, 0.5, 0.75 })
+			{
+				auto const altitude = layer.base_altitude + (i + f) * layer.step;
+				auto const tabulated = air_at_amsl (altitude);
+				auto const analytic = _analytic.air_at_amsl (altitude);
+
+				_error_bounds.density = std::max (_error_bounds.density, relative_error (tabulated.density, analytic.density));
+				_error_bounds.pressure = std::max (_error_bounds.pressure, relative_error (tabulated.pressure, analytic.pressure));
+				_error_bounds.temperature = std::max (_error_bounds.temperature, relative_error (tabulated.temperature, analytic.temperature));
+				_error_bounds.dynamic_viscosity = std::max (_error_bounds.dynamic_viscosity, relative_error (tabulated.dynamic_viscosity, analytic.dynamic_viscosity));
+				_error_bounds.speed_of_sound = std::max (_error_bounds.speed_of_sound, relative_error (tabulated.speed_of_sound, analytic.speed_of_sound));
+			}
+		}
+	}
+}
+
+
+TabulatedAtmosphere const&
+tabulated_standard_atmosphere()
+{
+	static TabulatedAtmosphere const kTabulatedStandardAtmosphere;
+	return kTabulatedStandardAtmosphere;
+}
+
+} // namespace xf
+
@@ -0,0 +1,169 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__EARTH__AIR__TABULATED_ATMOSPHERE_H__INCLUDED
+#define XEFIS__SUPPORT__EARTH__AIR__TABULATED_ATMOSPHERE_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <vector>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/earth/air/standard_atmosphere.h>
+#include <xefis/support/math/geometry.h>
+
+
+namespace xf {
+
+/**
+ * Standard atmosphere model precomputed into a table.
+ * Each atmosphere layer is tabulated separately with uniform altitude steps, so that table points fall exactly
+ * on layer boundaries (where values are not continuous). Values between table points are linearly interpolated,
+ * so lookups don't need any pow() or exp() calls.
+ * Outside of the tabulated altitude range the analytic StandardAtmosphere is used.
+ *
+ * Object is immutable after construction and can be shared between threads.
+ */
+class TabulatedAtmosphere
+{
+  public:
+	/**
+	 * Maximum relative errors of interpolated values against the analytic model,
+	 * measured over the whole tabulated range when the table is built.
+	 */
+	struct ErrorBounds
+	{
+		double	density				{ 0.0 };
+		double	pressure			{ 0.0 };
+		double	temperature			{ 0.0 };
+		double	dynamic_viscosity	{ 0.0 };
+		double	speed_of_sound		{ 0.0 };
+	};
+
+  public:
+	// Ctor
+	explicit
+	TabulatedAtmosphere (si::Length step = 10_m);
+
+	/**
+	 * Lowest tabulated altitude.
+	 */
+	[[nodiscard]]
+	si::Length
+	minimum_altitude() const noexcept
+		{ return _minimum_altitude; }
+
+	/**
+	 * Highest tabulated altitude.
+	 */
+	[[nodiscard]]
+	si::Length
+	maximum_altitude() const noexcept
+		{ return _maximum_altitude; }
+
+	/**
+	 * Maximum step between table points.
+	 * Actual steps are a bit smaller, so that table points fall on layer boundaries.
+	 */
+	[[nodiscard]]
+	si::Length
+	step() const noexcept
+		{ return _step; }
+
+	/**
+	 * Error bounds against the analytic model.
+	 */
+	[[nodiscard]]
+	ErrorBounds const&
+	error_bounds() const noexcept
+		{ return _error_bounds; }
+
+	[[nodiscard]]
+	Air
+	air_at (SpaceVector<si::Length, ECEFSpace> const& position) const;
+
+	[[nodiscard]]
+	Air
+	air_at_radius (si::Length radius) const;
+
+	[[nodiscard]]
+	Air
+	air_at_amsl (si::Length amsl_height) const;
+
+	[[nodiscard]]
+	SpaceVector<si::Velocity, ECEFSpace>
+	wind_at (SpaceVector<si::Length, ECEFSpace> const& position) const;
+
+	[[nodiscard]]
+	AtmosphereState<ECEFSpace>
+	state_at (SpaceVector<si::Length, ECEFSpace> const& position) const;
+
+	/**
+	 * Batched version of air_at().
+	 * Results vector is resized to match positions vector.
+	 */
+	void
+	air_at (std::vector<SpaceVector<si::Length, ECEFSpace>> const& positions, std::vector<Air>& results) const;
+
+	/**
+	 * Batched version of air_at_amsl().
+	 * Results vector is resized to match heights vector.
+	 */
+	void
+	air_at_amsl (std::vector<si::Length> const& amsl_heights, std::vector<Air>& results) const;
+
+  private:
+	/**
+	 * Part of the table that covers one atmosphere layer.
+	 */
+	struct Layer
+	{
+		si::Length	base_altitude;
+		si::Length	step;
+		double		inv_step_m;
+		// Index of the first table point of this layer:
+		std::size_t	first_index;
+		std::size_t	intervals;
+	};
+
+  private:
+	/**
+	 * Compute error bounds by comparing interpolated values with the analytic model
+	 * at points between table points.
+	 */
+	void
+	compute_error_bounds();
+
+  private:
+	StandardAtmosphere	_analytic;
+	si::Length			_minimum_altitude;
+	si::Length			_maximum_altitude;
+	si::Length			_step;
+	std::vector<Layer>	_layers;
+	std::vector<Air>	_table;
+	ErrorBounds			_error_bounds;
+};
+
+
+/**
+ * Return shared default instance of TabulatedAtmosphere.
+ * It's built on first use.
+ */
+TabulatedAtmosphere const&
+tabulated_standard_atmosphere();
+
+} // namespace xf
+
+#endif
+
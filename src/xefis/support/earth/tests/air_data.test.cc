@@ -0,0 +1,91 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <cmath>
+#include <vector>
+
+// Neutrino:
+#include <neutrino/test/auto_test.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/earth/air/air_data.h>
+#include <xefis/support/nature/constants.h>
+
+
+namespace xf::test {
+namespace {
+
+// Total pressure at sea level for given CAS (inverse of the CAS formula):
+si::Pressure
+total_pressure_for_cas (si::Velocity cas)
+{
+	double const ia0 = cas / kStdSpeedOfSound;
+	return kStdAirPressure + kStdAirPressure * (std::pow (ia0 * ia0 / 5.0 + 1.0, 7.0 / 2.0) - 1.0);
+}
+
+
+AutoTest t_1 ("AirDataBatch: sea-level standard conditions", []{
+	AirDataParameters params;
+	params.pressure_setting = kStdAirPressure;
+
+	std::vector<AirDataInput> inputs (3, AirDataInput { kStdAirPressure, total_pressure_for_cas (100_kt), 288.15_K });
+	std::vector<AirDataResult> results;
+
+	AirDataBatch batch;
+	batch.compute (params, inputs, results);
+
+	test_asserts::verify ("results count matches inputs count", results.size() == inputs.size());
+
+	for (auto const& result: results)
+	{
+		test_asserts::verify ("all values are computed",
+							  result.altitude_amsl && result.altitude_amsl_std && result.speed_cas && result.speed_ias &&
+							  result.speed_tas && result.speed_mach && result.static_air_temperature && result.air_density);
+		test_asserts::verify_equal_with_epsilon ("altitude is 0 ft", *result.altitude_amsl, 0_ft, 1_ft);
+		test_asserts::verify_equal_with_epsilon ("CAS is 100 kt", *result.speed_cas, 100_kt, 0.01_kt);
+		test_asserts::verify_equal_with_epsilon ("IAS is close to CAS", *result.speed_ias, 100_kt, 1_kt);
+		test_asserts::verify_equal_with_epsilon ("air density is standard", *result.air_density, kStdAirDensity, 0.01 * kStdAirDensity);
+	}
+});
+
+
+AutoTest t_2 ("AirDataBatch: nil inputs give nil results only for affected channels", []{
+	AirDataParameters params;
+	params.pressure_setting = kStdAirPressure;
+
+	std::vector<AirDataInput> inputs {
+		{ kStdAirPressure, total_pressure_for_cas (80_kt), 288.15_K },
+		{ std::nullopt, total_pressure_for_cas (80_kt), 288.15_K },
+		{ kStdAirPressure, total_pressure_for_cas (80_kt), std::nullopt },
+	};
+	std::vector<AirDataResult> results;
+
+	AirDataBatch batch;
+	batch.compute (params, inputs, results);
+
+	test_asserts::verify ("valid channel has CAS", !!results[0].speed_cas);
+	test_asserts::verify ("valid channel has TAS", !!results[0].speed_tas);
+	test_asserts::verify ("channel without static pressure has no altitude", !results[1].altitude_amsl);
+	test_asserts::verify ("channel without static pressure has no CAS", !results[1].speed_cas);
+	test_asserts::verify ("channel without TAT has altitude", !!results[2].altitude_amsl);
+	test_asserts::verify ("channel without TAT has CAS", !!results[2].speed_cas);
+	test_asserts::verify ("channel without TAT has no SAT", !results[2].static_air_temperature);
+	test_asserts::verify ("channel without TAT has no TAS", !results[2].speed_tas);
+});
+
+} // namespace
+} // namespace xf::test
+
@@ -14,12 +14,14 @@
 // Standard:
 #include <cstddef>
 #include <cmath>
+#include <vector>
 
 // Neutrino:
 #include <neutrino/test/auto_test.h>
 
 // Xefis:
 #include <xefis/support/earth/air/standard_atmosphere.h>
+#include <xefis/support/earth/air/tabulated_atmosphere.h>
 
 
 namespace xf::test {
@@ -63,6 +65,42 @@ AutoTest t_standard_temperature_gradient ("xf::standard_temperature_gradient() d
 });
 
 
+AutoTest t_tabulated_atmosphere_error_bounds ("xf::TabulatedAtmosphere error bounds are small", []{
+	auto const& atmosphere = tabulated_standard_atmosphere();
+	auto const& bounds = atmosphere.error_bounds();
+
+	test_asserts::verify ("density error is small", bounds.density < 1e-4);
+	test_asserts::verify ("pressure error is small", bounds.pressure < 1e-4);
+	test_asserts::verify ("temperature error is small", bounds.temperature < 1e-4);
+	test_asserts::verify ("dynamic viscosity error is small", bounds.dynamic_viscosity < 1e-4);
+	test_asserts::verify ("speed of sound error is small", bounds.speed_of_sound < 1e-4);
+});
+
+
+AutoTest t_tabulated_atmosphere ("xf::TabulatedAtmosphere matches StandardAtmosphere", []{
+	auto const& tabulated = tabulated_standard_atmosphere();
+	StandardAtmosphere analytic;
+	std::vector<si::Length> heights;
+
+	for (si::Length altitude = -1_km; altitude < 100_km; altitude += 777_m)
+		heights.push_back (altitude);
+
+	std::vector<Air> results;
+	tabulated.air_at_amsl (heights, results);
+
+	test_asserts::verify ("results count matches heights count", results.size() == heights.size());
+
+	for (std::size_t i = 0; i < heights.size(); ++i)
+	{
+		auto const expected = analytic.air_at_amsl (heights[i]);
+
+		test_asserts::verify_equal_with_epsilon ("pressure at " + to_string (heights[i]), results[i].pressure, expected.pressure, 1e-4 * expected.pressure);
+		test_asserts::verify_equal_with_epsilon ("density at " + to_string (heights[i]), results[i].density, expected.density, 1e-4 * expected.density);
+		test_asserts::verify_equal_with_epsilon ("temperature at " + to_string (heights[i]), results[i].temperature, expected.temperature, 0.01_K);
+	}
+});
+
+
 // TODO Make tests for:
 // TODO   dynamic_air_viscosity (si::Temperature);
 // TODO   speed_of_sound (si::Temperature static_air_temperature)
@@ -0,0 +1,92 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <cmath>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Local:
+#include "cached_layers.h"
+
+
+namespace xf {
+
+void
+CachedLayers::paint (InstrumentPainter& painter, PaintRequest::Metric const& metric, std::size_t const layer_id, QRectF const& bounds, std::size_t const key, PaintFunction const& paint_function) const
+{
+	auto data = _data.lock();
+
+	if (!data->metric || *data->metric != metric)
+	{
+		data->layers.clear();
+		data->metric = metric;
+	}
+
+	auto const transform = painter.transform();
+	bool const translation_only = transform.type() <= QTransform::TxTranslate;
+	QPointF subpixel_offset (0.0, 0.0);
+
+	if (translation_only)
+	{
+		QPointF const device_position = transform.map (bounds.topLeft());
+		subpixel_offset = device_position - QPointF (std::floor (device_position.x()), std::floor (device_position.y()));
+	}
+
+	auto layer_it = data->layers.find (layer_id);
+
+	if (layer_it == data->layers.end() || layer_it->second.bounds != bounds || layer_it->second.key != key)
+	{
+		Layer layer { bounds, key, subpixel_offset, QImage() };
+		render (layer, painter.cache(), paint_function);
+		layer_it = data->layers.insert_or_assign (layer_id, std::move (layer)).first;
+	}
+
+	auto const& layer = layer_it->second;
+
+	// If layer was rendered with the same sub-pixel offset, it's drawn exactly at device pixels and no
+	// interpolation is needed. Otherwise (rotation, moving layers) let Qt interpolate:
+	bool const pixel_aligned = translation_only && layer.subpixel_offset == subpixel_offset;
+	bool const smooth = painter.testRenderHint (QPainter::SmoothPixmapTransform);
+
+	painter.setRenderHint (QPainter::SmoothPixmapTransform, !pixel_aligned);
+	painter.drawImage (layer.bounds.topLeft() - layer.subpixel_offset, layer.image);
+	painter.setRenderHint (QPainter::SmoothPixmapTransform, smooth);
+}
+
+
+void
+CachedLayers::clear()
+{
+	_data.lock()->layers.clear();
+}
+
+
+void
+CachedLayers::render (Layer& layer, TextPainter::Cache& text_painter_cache, PaintFunction const& paint_function)
+{
+	// One more pixel for the sub-pixel offset:
+	QSize const size (std::ceil (layer.bounds.width()) + 1, std::ceil (layer.bounds.height()) + 1);
+
+	layer.image = QImage (size, QImage::Format_ARGB32_Premultiplied);
+	layer.image.fill (Qt::transparent);
+
+	InstrumentPainter layer_painter (layer.image, text_painter_cache);
+	layer_painter.translate (layer.subpixel_offset - layer.bounds.topLeft());
+	paint_function (layer_painter);
+}
+
+} // namespace xf
+
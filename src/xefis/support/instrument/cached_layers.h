@@ -0,0 +1,99 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__INSTRUMENT__CACHED_LAYERS_H__INCLUDED
+#define XEFIS__SUPPORT__INSTRUMENT__CACHED_LAYERS_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <optional>
+
+// Qt:
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+
+// Neutrino:
+#include <neutrino/synchronized.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/core/paint_request.h>
+#include <xefis/support/instrument/instrument_painter.h>
+#include <xefis/support/instrument/text_painter.h>
+
+
+namespace xf {
+
+/**
+ * Cache of pre-rendered instrument layers.
+ * Static or slowly changing parts of an instrument are painted once into an image and then each frame only the image
+ * is drawn with the current painter transform (which can include translation and rotation).
+ *
+ * Each layer is identified by the layer ID and is repainted when its key changes (key should be computed from all
+ * parameters that affect the look of the layer). All layers are dropped when canvas metric changes.
+ */
+class CachedLayers
+{
+  public:
+	/**
+	 * Function that paints layer contents in layer coordinates
+	 * (the same that are used to draw the layer).
+	 */
+	using PaintFunction = std::function<void (InstrumentPainter&)>;
+
+  private:
+	struct Layer
+	{
+		QRectF		bounds;
+		std::size_t	key;
+		QPointF		subpixel_offset;
+		QImage		image;
+	};
+
+	struct Data
+	{
+		std::optional<PaintRequest::Metric>	metric;
+		std::map<std::size_t, Layer>		layers;
+	};
+
+  public:
+	/**
+	 * Draw layer with the painter's current transform. If the layer isn't cached yet or its bounds or key have changed,
+	 * paint it first with given function. Text in layers is rendered with the glyph cache of the painter.
+	 *
+	 * \param	bounds
+	 *			Rectangle in layer coordinates that contains everything painted by paint_function.
+	 */
+	void
+	paint (InstrumentPainter&, PaintRequest::Metric const&, std::size_t layer_id, QRectF const& bounds, std::size_t key, PaintFunction const&) const;
+
+	/**
+	 * Drop all cached layers.
+	 */
+	void
+	clear();
+
+  private:
+	static void
+	render (Layer&, TextPainter::Cache&, PaintFunction const&);
+
+  private:
+	xf::Synchronized<Data> mutable	_data;
+};
+
+} // namespace xf
+
+#endif
+
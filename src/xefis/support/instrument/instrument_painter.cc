@@ -35,6 +35,13 @@ InstrumentPainter::InstrumentPainter (QPaintDevice& device, TextPainter::Cache&
 }
 
 
+InstrumentPainter::InstrumentPainter (QPaintDevice& device, TextPainter::Cache& cache, ShadowPainter::Scratch& scratch):
+	InstrumentPainter (device, cache)
+{
+	set_scratch (scratch);
+}
+
+
 void
 InstrumentPainter::save_context (std::function<void()> paint_callback)
 {
@@ -38,6 +38,10 @@ class InstrumentPainter:
 	explicit
 	InstrumentPainter (QPaintDevice&, TextPainter::Cache&);
 
+	// Ctor
+	explicit
+	InstrumentPainter (QPaintDevice&, TextPainter::Cache&, ShadowPainter::Scratch&);
+
 	/**
 	 * Calls save(), then the provided callback and then restore().
 	 * It's exception-safe meaning that restore() will be called
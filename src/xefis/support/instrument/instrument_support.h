@@ -69,7 +69,10 @@ class InstrumentSupport
   private:
 	Graphics const&									_graphics;
 	xf::Synchronized<Data> mutable					_data;
-	static inline thread_local TextPainter::Cache	_text_painter_cache;
+	// Instrument is painted by one thread at a time:
+	ShadowPainter::Scratch mutable					_shadow_scratch;
+	// Shared by all instruments and painting threads:
+	static inline TextPainter::Cache				_text_painter_cache;
 };
 
 
@@ -99,7 +102,7 @@ InstrumentSupport::get_painter (PaintRequest const& paint_request) const
 	if (!data->cached_canvas_metric || *data->cached_canvas_metric != paint_request.metric())
 		update_cache (paint_request, *data);
 
-	return InstrumentPainter (paint_request.canvas(), _text_painter_cache);
+	return InstrumentPainter (paint_request.canvas(), _text_painter_cache, _shadow_scratch);
 }
 
 
@@ -13,6 +13,9 @@
 
 // Standard:
 #include <cstddef>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
 // Neutrino:
 #include <neutrino/responsibility.h>
@@ -29,6 +32,13 @@ namespace xf {
 void
 ShadowPainter::paint (Shadow const& shadow, PaintFunction paint_function)
 {
+	// Shadow will be computed for the whole layer at once:
+	if (_layer)
+	{
+		paint_function (false);
+		return;
+	}
+
 	{
 		auto saved_pen = pen();
 		Responsibility pen_restore ([&] { setPen (saved_pen); });
@@ -56,5 +66,201 @@ ShadowPainter::paint (Shadow const& shadow, PaintFunction paint_function)
 	paint_function (false);
 }
 
+
+void
+ShadowPainter::begin_shadowed_layer()
+{
+	if (_layer)
+		throw std::logic_error ("ShadowPainter::begin_shadowed_layer(): already painting a layer");
+
+	auto* const device = this->device();
+	auto const pixel_ratio = device->devicePixelRatioF();
+	QSize const size (std::round (device->width() * pixel_ratio), std::round (device->height() * pixel_ratio));
+	auto& image = scratch().layer;
+
+	if (image.size() != size)
+		image = QImage (size, QImage::Format_ARGB32_Premultiplied);
+
+	image.setDevicePixelRatio (pixel_ratio);
+	image.fill (Qt::transparent);
+
+	auto const state = get_state();
+	end();
+	_layer = Layer { device };
+	begin (&image);
+	set_state (state);
+}
+
+
+void
+ShadowPainter::end_shadowed_layer (Shadow const& shadow)
+{
+	if (!_layer)
+		throw std::logic_error ("ShadowPainter::end_shadowed_layer(): not painting a layer");
+
+	auto const state = get_state();
+	end();
+
+	auto* const device = _layer->device;
+	_layer.reset();
+
+	auto& buffers = scratch();
+	auto const radius = std::max (1, static_cast<int> (std::ceil (shadow.width() * buffers.layer.devicePixelRatioF())));
+	make_shadow (buffers, radius, shadow.color());
+
+	begin (device);
+	setRenderHint (QPainter::SmoothPixmapTransform, false);
+	drawImage (QPointF (0.0, 0.0), buffers.shadow);
+	drawImage (QPointF (0.0, 0.0), buffers.layer);
+	set_state (state);
+}
+
+
+ShadowPainter::Scratch&
+ShadowPainter::scratch()
+{
+	if (!_scratch)
+	{
+		_own_scratch = std::make_unique<Scratch>();
+		_scratch = _own_scratch.get();
+	}
+
+	return *_scratch;
+}
+
+
+ShadowPainter::State
+ShadowPainter::get_state() const
+{
+	State state;
+	state.transform = transform();
+	state.pen = pen();
+	state.brush = brush();
+	state.font = font();
+	state.render_hints = renderHints();
+	state.composition_mode = compositionMode();
+	state.opacity = opacity();
+
+	if (hasClipping())
+		state.clip_path = clipPath();
+
+	return state;
+}
+
+
+void
+ShadowPainter::set_state (State const& state)
+{
+	setTransform (state.transform);
+	setPen (state.pen);
+	setBrush (state.brush);
+	setFont (state.font);
+	setRenderHints (state.render_hints, true);
+	setRenderHints (~state.render_hints, false);
+	setCompositionMode (state.composition_mode);
+	setOpacity (state.opacity);
+
+	if (state.clip_path)
+		setClipPath (*state.clip_path);
+	else
+		setClipping (false);
+}
+
+
+void
+ShadowPainter::make_shadow (Scratch& scratch, int const radius, QColor const color)
+{
+	QImage const& source = scratch.layer;
+	auto& alpha = scratch.alpha;
+	auto& temporary = scratch.temporary;
+	int const width = source.width();
+	int const height = source.height();
+	// Every element is overwritten below, so there's no need to clear them:
+	alpha.resize (static_cast<std::size_t> (width) * height);
+	temporary.resize (alpha.size());
+
+	for (int y = 0; y < height; ++y)
+	{
+		auto const* const line = reinterpret_cast<QRgb const*> (source.constScanLine (y));
+		auto* const alpha_line = alpha.data() + static_cast<std::size_t> (y) * width;
+
+		for (int x = 0; x < width; ++x)
+			alpha_line[x] = qAlpha (line[x]);
+	}
+
+	dilate_horizontally (alpha, temporary, width, height, radius);
+	dilate_vertically (temporary, alpha, width, height, radius);
+
+	auto& result = scratch.shadow;
+
+	if (result.size() != source.size())
+		result = QImage (source.size(), QImage::Format_ARGB32_Premultiplied);
+
+	result.setDevicePixelRatio (source.devicePixelRatioF());
+
+	int const r = color.red();
+	int const g = color.green();
+	int const b = color.blue();
+	int const a = color.alpha();
+
+	for (int y = 0; y < height; ++y)
+	{
+		auto* const line = reinterpret_cast<QRgb*> (result.scanLine (y));
+		auto const* const alpha_line = alpha.data() + static_cast<std::size_t> (y) * width;
+
+		for (int x = 0; x < width; ++x)
+		{
+			int const pixel_alpha = alpha_line[x] * a / 255;
+			line[x] = qRgba (r * pixel_alpha / 255, g * pixel_alpha / 255, b * pixel_alpha / 255, pixel_alpha);
+		}
+	}
+}
+
+
+void
+ShadowPainter::dilate_horizontally (std::vector<uint8_t> const& source, std::vector<uint8_t>& target, int const width, int const height, int const radius)
+{
+	for (int y = 0; y < height; ++y)
+	{
+		auto const* const in = source.data() + static_cast<std::size_t> (y) * width;
+		auto* const out = target.data() + static_cast<std::size_t> (y) * width;
+
+		std::copy (in, in + width, out);
+
+		for (int k = 1; k <= radius && k < width; ++k)
+		{
+			// Neighbours on the right:
+			for (int x = 0; x < width - k; ++x)
+				out[x] = std::max (out[x], in[x + k]);
+
+			// Neighbours on the left:
+			for (int x = k; x < width; ++x)
+				out[x] = std::max (out[x], in[x - k]);
+		}
+	}
+}
+
+
+void
+ShadowPainter::dilate_vertically (std::vector<uint8_t> const& source, std::vector<uint8_t>& target, int const width, int const height, int const radius)
+{
+	for (int y = 0; y < height; ++y)
+	{
+		auto* const out = target.data() + static_cast<std::size_t> (y) * width;
+		int const first = std::max (0, y - radius);
+		int const last = std::min (height - 1, y + radius);
+
+		std::copy_n (source.data() + static_cast<std::size_t> (first) * width, width, out);
+
+		for (int row = first + 1; row <= last; ++row)
+		{
+			auto const* const in = source.data() + static_cast<std::size_t> (row) * width;
+
+			for (int x = 0; x < width; ++x)
+				out[x] = std::max (out[x], in[x]);
+		}
+	}
+}
+
 } // namespace xf
 
@@ -16,9 +16,19 @@
 
 // Standard:
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
 
 // Qt:
+#include <QtGui/QImage>
 #include <QtGui/QPainter>
+#include <QtGui/QPainterPath>
+
+// Neutrino:
+#include <neutrino/noncopyable.h>
 
 // Xefis:
 #include <xefis/config/all.h>
@@ -33,6 +43,21 @@ class ShadowPainter: virtual public QPainter
 	using DefaultPaintFunction	= std::function<void()>;
 	using PaintFunction			= std::function<void (bool painting_shadow)>;
 
+	/**
+	 * Buffers used by shadowed layers, kept between paintings so that they're reallocated only
+	 * when the size of the paint device changes. Can be used by only one painter at a time.
+	 */
+	class Scratch: private Noncopyable
+	{
+		friend class ShadowPainter;
+
+	  private:
+		QImage					layer;
+		QImage					shadow;
+		std::vector<uint8_t>	alpha;
+		std::vector<uint8_t>	temporary;
+	};
+
   public:
 	// Ctor
 	ShadowPainter() = default;
@@ -41,6 +66,14 @@ class ShadowPainter: virtual public QPainter
 	explicit
 	ShadowPainter (QPaintDevice&);
 
+	/**
+	 * Use given scratch buffers for shadowed layers. Scratch must outlive the painter.
+	 * If not set, painter allocates its own buffers.
+	 */
+	void
+	set_scratch (Scratch& scratch) noexcept
+		{ _scratch = &scratch; }
+
 	/**
 	 * Add a shadow under painted primitives.
 	 * The PaintFunction will be called twice with different state of the
@@ -54,6 +87,89 @@ class ShadowPainter: virtual public QPainter
 	 */
 	void
 	paint (Shadow const&, DefaultPaintFunction);
+
+	/**
+	 * Redirect painting to a transparent layer of the size of the paint device.
+	 * Until end_shadowed_layer() is called, paint() calls the paint function only once, without
+	 * painting the shadow. Painter state is preserved.
+	 */
+	void
+	begin_shadowed_layer();
+
+	/**
+	 * Compute shadow for everything painted in the layer by dilating layer's alpha channel,
+	 * then paint the shadow and the layer on top of it onto the original paint device.
+	 * All primitives in the layer get the same shadow color (the one from given Shadow object).
+	 */
+	void
+	end_shadowed_layer (Shadow const&);
+
+	/**
+	 * Return true if painting into a shadowed layer.
+	 */
+	[[nodiscard]]
+	bool
+	painting_shadowed_layer() const noexcept
+		{ return _layer.has_value(); }
+
+  private:
+	struct State
+	{
+		QTransform					transform;
+		QPen						pen;
+		QBrush						brush;
+		QFont						font;
+		QPainter::RenderHints		render_hints;
+		QPainter::CompositionMode	composition_mode;
+		qreal						opacity;
+		std::optional<QPainterPath>	clip_path;
+	};
+
+	struct Layer
+	{
+		QPaintDevice*	device;
+	};
+
+  private:
+	/**
+	 * Return scratch buffers set with set_scratch() or painter's own ones.
+	 */
+	[[nodiscard]]
+	Scratch&
+	scratch();
+
+	[[nodiscard]]
+	State
+	get_state() const;
+
+	void
+	set_state (State const&);
+
+	/**
+	 * Set scratch.shadow to image with shadow color and alpha channel computed as alpha channel
+	 * of scratch.layer dilated by given radius (in pixels).
+	 */
+	static void
+	make_shadow (Scratch&, int radius, QColor color);
+
+	/**
+	 * Set each target value to the maximum of source values in the range [x - radius, x + radius] in the same row.
+	 * Inner loops run over contiguous memory, so that the compiler can vectorize them.
+	 */
+	static void
+	dilate_horizontally (std::vector<uint8_t> const& source, std::vector<uint8_t>& target, int width, int height, int radius);
+
+	/**
+	 * Set each target value to the maximum of source values in the range [y - radius, y + radius] in the same column.
+	 * Inner loops run over contiguous memory, so that the compiler can vectorize them.
+	 */
+	static void
+	dilate_vertically (std::vector<uint8_t> const& source, std::vector<uint8_t>& target, int width, int height, int radius);
+
+  private:
+	std::optional<Layer>		_layer;
+	Scratch*					_scratch	{ nullptr };
+	std::unique_ptr<Scratch>	_own_scratch;
 };
 
 
@@ -13,6 +13,7 @@
 
 // Standard:
 #include <cstddef>
+#include <algorithm>
 #include <cmath>
 
 // Neutrino:
@@ -27,66 +28,200 @@
 
 namespace xf {
 
-TextPainter::Cache::Glyph::Glyph (QFont const& font, QColor color, QChar character, QPointF position_correction, std::optional<Shadow> shadow):
-	data (std::make_shared<Data>())
+TextPainter::Cache::Cache (std::size_t const max_bytes):
+	_max_bytes (max_bytes)
+{ }
+
+
+std::size_t
+TextPainter::Cache::bytes() const
+{
+	std::lock_guard lock (_mutex);
+	return _bytes;
+}
+
+
+void
+TextPainter::Cache::clear()
 {
-	QFontMetricsF metrics (font);
-	position_correction.setX (position_correction.x() * metrics.width("0"));
-	position_correction.setY (position_correction.y() * metrics.height());
-	QSize size (std::ceil (metrics.width (character)) + 1, std::ceil (metrics.height()) + 1);
-	QImage image (size, QImage::Format_ARGB32_Premultiplied);
-	QColor alpha = color;
-	alpha.setAlpha (0);
-	QPainter painter (&image);
+	std::lock_guard lock (_mutex);
+	_last.reset();
+	_fonts.clear();
+	_pages.clear();
+	_bytes = 0;
+	_evicted = false;
+}
+
+
+TextPainter::Cache::Slot
+TextPainter::Cache::get_slot (Font const& font, Glyph& glyph, QChar character, int x, int y, std::optional<Shadow> const& shadow)
+{
+	auto& cached_slot = glyph.positions[x * Glyph::Rank + y];
+
+	if (cached_slot)
+	{
+		if (auto page = _pages.find (cached_slot->page_id); page != _pages.end())
+		{
+			page->second.last_use = _use_counter;
+			return *cached_slot;
+		}
+	}
+
+	QFontMetricsF metrics (font.font);
+	QPointF position_correction (font.position_correction.x() * metrics.width ("0"),
+								 font.position_correction.y() * metrics.height());
+
+	if (glyph.size.isEmpty())
+		glyph.size = QSize (std::ceil (metrics.width (character)) + 1, std::ceil (metrics.height()) + 1);
+
+	Slot const slot = allocate (glyph.size);
+	QRect const glyph_rect (QPoint (0, 0), glyph.size);
+	QPainter painter (&_pages.at (slot.page_id).image);
+	painter.translate (slot.position);
+	painter.setClipRect (glyph_rect);
+	painter.setCompositionMode (QPainter::CompositionMode_Source);
+	painter.fillRect (glyph_rect, Qt::transparent);
+	painter.setCompositionMode (QPainter::CompositionMode_SourceOver);
 	painter.setRenderHint (QPainter::Antialiasing, true);
 	painter.setRenderHint (QPainter::TextAntialiasing, true);
 	painter.setRenderHint (QPainter::SmoothPixmapTransform, true);
 
-	QPen shadow_pen = painter.pen();
+	QPointF position (1.f * x / Glyph::Rank, 1.f * y / Glyph::Rank + metrics.ascent());
+	position += position_correction;
+	QPainterPath glyph_path;
+	glyph_path.addText (position, font.font, character);
 
 	if (shadow)
 	{
-		QColor shadow_color = color.darker (800);
+		QPen shadow_pen = painter.pen();
+		QColor shadow_color = font.color.darker (800);
 		shadow_color.setAlpha (100);
 		shadow_pen.setColor (shadow_color);
 		shadow_pen.setWidthF (shadow->width_for_pen (shadow_pen));
+
+		QPainterPath clip_path;
+		clip_path.addRect (glyph_rect);
+		clip_path -= glyph_path;
+
+		painter.setClipPath (clip_path);
+		painter.setPen (shadow_pen);
+		painter.setBrush (Qt::NoBrush);
+		painter.drawPath (glyph_path);
+		painter.setClipRect (glyph_rect);
 	}
 
-	for (int x = 0; x < Rank; ++x)
+	painter.setPen (Qt::NoPen);
+	painter.setBrush (font.color);
+	painter.drawPath (glyph_path);
+
+	cached_slot = slot;
+	return slot;
+}
+
+
+TextPainter::Cache::Slot
+TextPainter::Cache::allocate (QSize const size)
+{
+	// Leave a pixel between glyphs, so that they don't bleed into each other when drawn with transform:
+	QSize const padded_size = size + QSize (1, 1);
+
+	for (auto& [page_id, page]: _pages)
 	{
-		float const fx = 1.f * x / Rank;
+		if (auto const position = allocate_in (page, padded_size))
+		{
+			page.last_use = _use_counter;
+			return { page_id, *position };
+		}
+	}
+
+	QSize const page_size (std::max (kPageSize, padded_size.width()), std::max (kPageSize, padded_size.height()));
+	std::size_t const page_bytes = 4u * page_size.width() * page_size.height();
+
+	// Limit may be exceeded if a single text needs more pages:
+	while (_bytes + page_bytes > _max_bytes && evict_least_recently_used_page())
+		continue;
+
+	auto const page_id = ++_last_page_id;
+	auto& page = _pages[page_id];
+	page.image = QImage (page_size, QImage::Format_ARGB32_Premultiplied);
+	page.image.fill (Qt::transparent);
+	page.last_use = _use_counter;
+	_bytes += page_bytes;
 
-		for (int y = 0; y < Rank; ++y)
+	return { page_id, *allocate_in (page, padded_size) };
+}
+
+
+std::optional<QPoint>
+TextPainter::Cache::allocate_in (Page& page, QSize const size)
+{
+	// Simple shelf packing: glyphs of similar height are put next to each other in rows:
+	for (auto& shelf: page.shelves)
+	{
+		if (size.height() <= shelf.height && 4 * size.height() >= 3 * shelf.height && shelf.next_x + size.width() <= page.image.width())
 		{
-			float const fy = 1.f * y / Rank;
+			QPoint const position (shelf.next_x, shelf.y);
+			shelf.next_x += size.width();
+			return position;
+		}
+	}
+
+	if (page.next_shelf_y + size.height() <= page.image.height() && size.width() <= page.image.width())
+	{
+		page.shelves.push_back ({ page.next_shelf_y, size.height(), size.width() });
+		page.next_shelf_y += size.height();
+		return QPoint (0, page.shelves.back().y);
+	}
 
-			QPointF position (fx, fy + metrics.ascent());
-			position += position_correction;
-			QPainterPath glyph_path;
-			glyph_path.addText (position, font, character);
+	return std::nullopt;
+}
 
-			QPainterPath clip_path;
-			clip_path.addRect (image.rect());
-			clip_path -= glyph_path;
 
-			image.fill (alpha);
-			painter.setClipPath (clip_path);
+bool
+TextPainter::Cache::evict_least_recently_used_page()
+{
+	auto const lru = std::min_element (_pages.begin(), _pages.end(), [](auto const& a, auto const& b) {
+		return a.second.last_use < b.second.last_use;
+	});
+
+	// Pages used by the current text are pinned, since their slots are yet to be drawn:
+	if (lru == _pages.end() || lru->second.last_use == _use_counter)
+		return false;
+
+	_bytes -= 4u * lru->second.image.width() * lru->second.image.height();
+	_pages.erase (lru);
+	_evicted = true;
+	return true;
+}
 
-			if (shadow)
-			{
-				painter.setPen (shadow_pen);
-				painter.setBrush (Qt::NoBrush);
-				painter.drawPath (glyph_path);
-			}
 
-			painter.setClipping (false);
-			painter.setPen (Qt::NoPen);
-			painter.setBrush (color);
-			painter.drawPath (glyph_path);
+void
+TextPainter::Cache::forget_evicted_glyphs()
+{
+	for (auto font = _fonts.begin(); font != _fonts.end(); )
+	{
+		auto& glyphs = font->second;
 
-			data->positions[x][y] = image;
+		for (auto glyph = glyphs.begin(); glyph != glyphs.end(); )
+		{
+			for (auto& slot: glyph->second.positions)
+				if (slot && _pages.find (slot->page_id) == _pages.end())
+					slot.reset();
+
+			if (glyph->second.has_slots())
+				++glyph;
+			else
+				glyph = glyphs.erase (glyph);
 		}
+
+		if (glyphs.empty())
+			font = _fonts.erase (font);
+		else
+			++font;
 	}
+
+	_last.reset();
+	_evicted = false;
 }
 
 
@@ -190,38 +325,52 @@ TextPainter::fast_draw_text (QRectF const& target, Qt::Alignment flags, QString
 
 	float const shadow_width = shadow ? shadow->width_for_pen (pen()) : 0.0f;
 
-	// Find/insert to font cache:
-	Cache::Font const required_font { font(), color, shadow_width };
-	Cache::Glyphs* glyphs_cache { nullptr };
+	Cache::Font const required_font { font(), color, shadow_width, _position_correction };
+	_glyph_draws.clear();
 
-	if (!_cache.last || _cache.last->font != required_font)
 	{
-		if (auto it = _cache.fonts.find (required_font); it != _cache.fonts.end())
-			_cache.last = Cache::Last { required_font, &it->second };
-		else
+		std::lock_guard lock (_cache._mutex);
+
+		// Glyphs and fonts are forgotten here, not during eviction, so that references to them
+		// are not invalidated in the middle of looking up a text:
+		if (_cache._evicted)
+			_cache.forget_evicted_glyphs();
+
+		++_cache._use_counter;
+
+		// Find/insert to font cache:
+		if (!_cache._last || _cache._last->font != required_font)
 		{
-			it = _cache.fonts.emplace (required_font, Cache::Glyphs()).first;
-			_cache.last = Cache::Last { required_font, &it->second };
+			auto it = _cache._fonts.try_emplace (required_font).first;
+			_cache._last = Cache::Last { required_font, &it->second };
 		}
-	}
-
-	glyphs_cache = _cache.last->glyphs;
 
-	for (QString::ConstIterator c = text.begin(); c != text.end(); ++c)
-	{
-		auto glyph = glyphs_cache->find (*c);
+		Cache::Glyphs& glyphs_cache = *_cache._last->glyphs;
 
-		if (glyph == glyphs_cache->end())
-			glyph = glyphs_cache->insert ({ *c, Cache::Glyph (font(), color, *c, _position_correction, shadow) }).first;
+		for (QString::ConstIterator c = text.begin(); c != text.end(); ++c)
+		{
+			auto& glyph = glyphs_cache[*c];
+			float fx = floored_mod<float> (offset.x(), 1.f);
+			float fy = floored_mod<float> (offset.y(), 1.f);
+			int dx = clamped<int> (fx * Cache::Glyph::Rank, 0, Cache::Glyph::Rank - 1);
+			int dy = clamped<int> (fy * Cache::Glyph::Rank, 0, Cache::Glyph::Rank - 1);
+			auto const slot = _cache.get_slot (required_font, glyph, *c, dx, dy, shadow);
+			_glyph_draws.push_back ({ slot.page_id, QRect (slot.position, glyph.size), QPoint (offset.x(), offset.y()), QImage() });
+			offset.rx() += metrics.width (*c);
+		}
 
-		float fx = floored_mod<float> (offset.x(), 1.f);
-		float fy = floored_mod<float> (offset.y(), 1.f);
-		int dx = clamped<int> (fx * Cache::Glyph::Rank, 0, Cache::Glyph::Rank - 1);
-		int dy = clamped<int> (fy * Cache::Glyph::Rank, 0, Cache::Glyph::Rank - 1);
-		drawImage (QPoint (offset.x(), offset.y()), glyph->second.data->positions[dx][dy]);
-		offset.rx() += metrics.width (*c);
+		// Take page copies only after all glyphs are rendered, so that rendering doesn't detach pages.
+		// Copies stay valid even if the pages are evicted or get new glyphs before they're drawn:
+		for (auto& draw: _glyph_draws)
+			draw.page = _cache._pages.at (draw.page_id).image;
 	}
 
+	for (auto const& draw: _glyph_draws)
+		drawImage (draw.target, draw.page, draw.source);
+
+	// Release page copies, so that rendering new glyphs into them doesn't need to detach them:
+	_glyph_draws.clear();
+
 	if (saved_transform)
 		setTransform (painter_transform);
 }
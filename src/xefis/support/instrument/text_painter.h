@@ -16,15 +16,22 @@
 
 // Standard:
 #include <cstddef>
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <map>
-#include <memory>
+#include <mutex>
 #include <optional>
 #include <tuple>
+#include <vector>
 
 // Qt:
 #include <QtGui/QImage>
 #include <QtGui/QPainter>
 
+// Neutrino:
+#include <neutrino/noncopyable.h>
+
 // Xefis:
 #include <xefis/config/all.h>
 #include <xefis/support/instrument/shadow.h>
@@ -40,37 +47,67 @@ class TextPainter: virtual public QPainter
 {
   public:
 	/**
-	 * Stores drawn glyphs.
+	 * Stores drawn glyphs in an atlas: a few big images (pages), each containing many glyphs.
+	 * Each glyph is rendered only for sub-pixel positions that are actually used.
+	 * When memory used by pages would exceed the limit, the least recently used page is dropped
+	 * and glyphs that were stored in it get rendered again when needed.
+	 *
+	 * Thread-safe, can be shared by painters working in different threads. The cache is locked only
+	 * to find glyphs; painters draw them from implicitly shared copies of pages without the lock.
 	 */
-	class Cache
+	class Cache: private Noncopyable
 	{
 		friend class TextPainter;
 
+	  public:
+		// Default size of atlas pages:
+		static constexpr int			kPageSize			= 512;
+		// Default memory limit for all pages:
+		static constexpr std::size_t	kDefaultMaxBytes	= 16 * kPageSize * kPageSize * 4;
+
+	  private:
+		/**
+		 * Location of a rendered glyph image in the atlas.
+		 */
+		struct Slot
+		{
+			std::uint64_t	page_id;
+			QPoint			position;
+		};
+
 		class Glyph
 		{
 		  public:
 			static constexpr int Rank = 8;
 
-		  private:
-			struct Data
-			{
-				QImage positions[Rank][Rank];
-			};
-
 		  public:
 			/**
-			 * Generate all images for given character and font.
+			 * Return true if there's at least one sub-pixel position rendered.
 			 */
-			explicit
-			Glyph (QFont const&, QColor, QChar, QPointF position_correction, std::optional<Shadow> shadow);
+			[[nodiscard]]
+			bool
+			has_slots() const noexcept;
 
-			Glyph (Glyph const& other);
+		  public:
+			QSize								size;
+			// Sub-pixel positions, indexed by [x * Rank + y], rendered on demand:
+			std::array<std::optional<Slot>, Rank * Rank>
+												positions;
+		};
 
-			Glyph&
-			operator= (Glyph const& other);
+		struct Shelf
+		{
+			int	y;
+			int	height;
+			int	next_x;
+		};
 
-		  public:
-			std::shared_ptr<Data> data;
+		struct Page
+		{
+			QImage				image;
+			std::vector<Shelf>	shelves;
+			int					next_shelf_y	{ 0 };
+			std::uint64_t		last_use		{ 0 };
 		};
 
 		struct Font
@@ -78,6 +115,7 @@ class TextPainter: virtual public QPainter
 			QFont	font;
 			QColor	color;
 			float	shadow_width;
+			QPointF	position_correction;
 
 			bool
 			operator< (Font const&) const;
@@ -100,8 +138,66 @@ class TextPainter: virtual public QPainter
 			Glyphs*	glyphs;
 		};
 
-		Fonts				fonts;
-		std::optional<Last>	last;
+	  public:
+		// Ctor
+		explicit
+		Cache (std::size_t max_bytes = kDefaultMaxBytes);
+
+		/**
+		 * Return memory used by atlas pages.
+		 */
+		[[nodiscard]]
+		std::size_t
+		bytes() const;
+
+		/**
+		 * Drop all glyphs and pages.
+		 */
+		void
+		clear();
+
+	  private:
+		/**
+		 * Return slot with given glyph rendered at given sub-pixel position.
+		 * Render it if necessary.
+		 */
+		Slot
+		get_slot (Font const&, Glyph&, QChar, int x, int y, std::optional<Shadow> const&);
+
+		/**
+		 * Reserve space for an image of given size in one of the pages.
+		 * May evict least recently used pages.
+		 */
+		Slot
+		allocate (QSize);
+
+		static std::optional<QPoint>
+		allocate_in (Page&, QSize);
+
+		/**
+		 * Evict least recently used page, but not one used by the text that's currently being drawn.
+		 * Return false if there was no such page.
+		 */
+		bool
+		evict_least_recently_used_page();
+
+		/**
+		 * Forget glyphs positions that were stored in evicted pages
+		 * and glyphs and fonts that have nothing rendered anymore.
+		 */
+		void
+		forget_evicted_glyphs();
+
+	  private:
+		std::mutex mutable						_mutex;
+		std::size_t								_max_bytes;
+		std::size_t								_bytes				{ 0 };
+		std::map<std::uint64_t, Page>			_pages;
+		std::uint64_t							_last_page_id		{ 0 };
+		std::uint64_t							_use_counter		{ 0 };
+		bool									_evicted			{ false };
+		Fonts									_fonts;
+		std::optional<Last>						_last;
 	};
 
   public:
@@ -113,6 +209,14 @@ class TextPainter: virtual public QPainter
 	explicit
 	TextPainter (QPaintDevice& device, Cache& cache);
 
+	/**
+	 * Return glyph cache used by this painter.
+	 */
+	[[nodiscard]]
+	Cache&
+	cache() const noexcept
+		{ return _cache; }
+
 	/**
 	 * Set font position correction (value is relative to font's size, it's not represented in pixels).
 	 */
@@ -137,6 +241,18 @@ class TextPainter: virtual public QPainter
 	void
 	fast_draw_vertical_text (QPointF const& position, Qt::Alignment flags, QString const& text, std::optional<Shadow> = {});
 
+  private:
+	/**
+	 * Glyph image to draw, found in the cache.
+	 */
+	struct GlyphDraw
+	{
+		std::uint64_t	page_id;
+		QRect			source;
+		QPoint			target;
+		QImage			page;
+	};
+
   private:
 	/**
 	 * Apply alignment flags to given rectangle.
@@ -145,29 +261,24 @@ class TextPainter: virtual public QPainter
 	apply_alignment (QRectF& rect, Qt::Alignment flags);
 
   private:
-	Cache&	_cache;
-	QPointF	_position_correction;
+	Cache&					_cache;
+	QPointF					_position_correction;
+	std::vector<GlyphDraw>	_glyph_draws;
 };
 
 
-inline
-TextPainter::Cache::Glyph::Glyph (Glyph const& other):
-	data (other.data)
-{ }
-
-
-inline TextPainter::Cache::Glyph&
-TextPainter::Cache::Glyph::operator= (Glyph const& other)
+inline bool
+TextPainter::Cache::Glyph::has_slots() const noexcept
 {
-	data = other.data;
-	return *this;
+	return std::any_of (positions.begin(), positions.end(), [](auto const& slot) { return slot.has_value(); });
 }
 
 
 inline bool
 TextPainter::Cache::Font::operator< (Font const& other) const
 {
-	return std::tuple (font, color.rgba(), shadow_width) < std::tuple (other.font, other.color.rgba(), other.shadow_width);
+	return std::tuple (font, color.rgba(), shadow_width, position_correction.x(), position_correction.y())
+		 < std::tuple (other.font, other.color.rgba(), other.shadow_width, other.position_correction.x(), other.position_correction.y());
 }
 
 
@@ -176,7 +287,8 @@ TextPainter::Cache::Font::operator== (Font const& other) const
 {
 	return font == other.font
 		&& color == other.color
-		&& shadow_width == other.shadow_width;
+		&& shadow_width == other.shadow_width
+		&& position_correction == other.position_correction;
 }
 
 
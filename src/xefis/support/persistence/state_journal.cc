@@ -0,0 +1,422 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <array>
+#include <cstring>
+
+// System:
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Local:
+#include "state_journal.h"
+
+
+namespace xf {
+namespace {
+
+constexpr std::array<uint32_t, 256>
+make_crc32_table()
+{
+	std::array<uint32_t, 256> table {};
+
+	for (uint32_t i = 0; i < table.size(); ++i)
+	{
+		uint32_t c = i;
+
+		for (int k = 0; k < 8; ++k)
+			c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+
+		table[i] = c;
+	}
+
+	return table;
+}
+
+
+constexpr auto kCRC32Table = make_crc32_table();
+
+
+uint32_t
+crc32 (uint8_t const* data, std::size_t size)
+{
+	uint32_t crc = 0xffffffff;
+
+	for (std::size_t i = 0; i < size; ++i)
+		crc = kCRC32Table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+
+	return crc ^ 0xffffffff;
+}
+
+
+void
+append_le (Blob& output, uint32_t value, std::size_t bytes)
+{
+	for (std::size_t i = 0; i < bytes; ++i)
+		output.push_back ((value >> (8 * i)) & 0xff);
+}
+
+
+uint32_t
+read_le (uint8_t const* data, std::size_t bytes)
+{
+	uint32_t result = 0;
+
+	for (std::size_t i = 0; i < bytes; ++i)
+		result |= static_cast<uint32_t> (data[i]) << (8 * i);
+
+	return result;
+}
+
+
+std::size_t
+record_size (std::string const& name, Blob const& value)
+{
+	return StateJournal::kRecordHeaderSize + 2 + name.size() + value.size();
+}
+
+
+std::string
+error_string (std::string const& what, std::string const& path)
+{
+	return what + " '" + path + "': " + strerror (errno);
+}
+
+
+void
+write_all (int fd, Blob const& data, std::string const& path)
+{
+	std::size_t written = 0;
+
+	while (written < data.size())
+	{
+		auto const n = ::write (fd, data.data() + written, data.size() - written);
+
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			throw Exception (error_string ("could not write", path));
+		}
+
+		written += n;
+	}
+}
+
+
+/**
+ * Sync directory containing the file, so that rename() is durable.
+ */
+void
+sync_directory (std::string const& path)
+{
+	auto const slash = path.rfind ('/');
+	std::string const directory = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr (0, slash);
+	int const fd = ::open (directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+	if (fd < 0)
+		throw Exception (error_string ("could not open directory", directory));
+
+	::fsync (fd);
+	::close (fd);
+}
+
+} // namespace
+
+
+StateJournal::StateJournal (std::string const& path, Logger const& logger):
+	_logger (logger.with_scope ("<state-journal>")),
+	_path (path)
+{
+	auto const valid_size = replay();
+
+	_values = _loaded_values;
+
+	for (auto const& [name, value]: _values)
+		_live_size += record_size (name, value);
+
+	// Rewrite the file if it's new, has a torn record at the end or is too large:
+	if (valid_size == 0 || valid_size != _size.load() || needs_compaction())
+		compact();
+	else
+		open_for_append();
+
+	_thread = std::thread (&StateJournal::run, this);
+}
+
+
+StateJournal::~StateJournal()
+{
+	{
+		std::lock_guard lock (_mutex);
+		_stop = true;
+	}
+
+	_queue_changed.notify_all();
+	_thread.join();
+
+	if (_fd >= 0)
+		::close (_fd);
+}
+
+
+void
+StateJournal::record (std::string const& name, Blob value)
+{
+	if (name.size() > 0xffff)
+		throw InvalidArgument ("state journal: name too long");
+
+	{
+		std::lock_guard lock (_mutex);
+		_queue[name] = std::move (value);
+		++_recorded;
+	}
+
+	_queue_changed.notify_one();
+}
+
+
+void
+StateJournal::flush()
+{
+	std::unique_lock lock (_mutex);
+	auto const recorded = _recorded;
+	_queue_changed.wait (lock, [&] { return _written >= recorded; });
+}
+
+
+std::size_t
+StateJournal::replay()
+{
+	int const fd = ::open (_path.c_str(), O_RDONLY | O_CLOEXEC);
+
+	if (fd < 0)
+	{
+		if (errno == ENOENT)
+			return 0;
+
+		throw Exception (error_string ("could not open", _path));
+	}
+
+	Blob data;
+	std::array<uint8_t, 4096> buffer;
+
+	for (;;)
+	{
+		auto const n = ::read (fd, buffer.data(), buffer.size());
+
+		if (n > 0)
+			data.insert (data.end(), buffer.begin(), buffer.begin() + n);
+		else if (n < 0 && errno == EINTR)
+			continue;
+		else if (n < 0)
+		{
+			::close (fd);
+			throw Exception (error_string ("could not read", _path));
+		}
+		else
+			break;
+	}
+
+	::close (fd);
+	_size = data.size();
+
+	if (data.empty())
+		return 0;
+
+	if (data.size() < kMagicSize || std::memcmp (data.data(), kMagic, kMagicSize) != 0)
+		throw InvalidFormat (_path);
+
+	std::size_t offset = kMagicSize;
+
+	while (offset + kRecordHeaderSize <= data.size())
+	{
+		auto const payload_size = read_le (data.data() + offset, 4);
+		auto const crc = read_le (data.data() + offset + 4, 4);
+		auto const payload = data.data() + offset + kRecordHeaderSize;
+
+		if (payload_size < 2 || payload_size > data.size() - offset - kRecordHeaderSize || crc32 (payload, payload_size) != crc)
+			break;
+
+		auto const name_size = read_le (payload, 2);
+
+		if (2 + name_size > payload_size)
+			break;
+
+		std::string name (payload + 2, payload + 2 + name_size);
+		_loaded_values[name] = Blob (payload + 2 + name_size, payload + payload_size);
+		offset += kRecordHeaderSize + payload_size;
+	}
+
+	if (offset != data.size())
+		_logger << "Discarding " << data.size() - offset << " bytes of incomplete or corrupted records at the end of " << _path << std::endl;
+
+	return offset;
+}
+
+
+void
+StateJournal::run()
+{
+	std::unique_lock lock (_mutex);
+
+	for (;;)
+	{
+		_queue_changed.wait (lock, [&] { return _stop || !_queue.empty(); });
+
+		if (_queue.empty())
+			return;
+
+		Values batch;
+		std::swap (batch, _queue);
+		auto const recorded = _recorded;
+		lock.unlock();
+
+		try {
+			append (batch);
+		}
+		catch (Exception const& e)
+		{
+			// Next batch will rewrite the whole journal:
+			_write_failed = true;
+			_logger << "Error when writing state journal: " << e.message() << std::endl;
+		}
+
+		lock.lock();
+		_written = recorded;
+		_queue_changed.notify_all();
+	}
+}
+
+
+void
+StateJournal::append (Values const& batch)
+{
+	Blob data;
+
+	for (auto const& [name, value]: batch)
+	{
+		serialize_record (data, name, value);
+
+		if (auto v = _values.find (name); v != _values.end())
+			_live_size -= record_size (v->first, v->second);
+
+		_live_size += record_size (name, value);
+		_values[name] = value;
+	}
+
+	if (_write_failed || _fd < 0)
+		compact();
+	else
+	{
+		write_all (_fd, data, _path);
+
+		if (::fdatasync (_fd) < 0)
+			throw Exception (error_string ("could not sync", _path));
+
+		_size += data.size();
+
+		if (needs_compaction())
+			compact();
+	}
+}
+
+
+void
+StateJournal::compact()
+{
+	std::string const temp_path = _path + "~";
+	Blob data (kMagic, kMagic + kMagicSize);
+
+	for (auto const& [name, value]: _values)
+		serialize_record (data, name, value);
+
+	int const fd = ::open (temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+	if (fd < 0)
+		throw Exception (error_string ("could not create", temp_path));
+
+	try {
+		write_all (fd, data, temp_path);
+
+		if (::fsync (fd) < 0)
+			throw Exception (error_string ("could not sync", temp_path));
+	}
+	catch (...)
+	{
+		::close (fd);
+		throw;
+	}
+
+	::close (fd);
+
+	if (::rename (temp_path.c_str(), _path.c_str()) < 0)
+		throw Exception (error_string ("could not rename journal to", _path));
+
+	sync_directory (_path);
+
+	if (_fd >= 0)
+	{
+		::close (_fd);
+		_fd = -1;
+	}
+
+	open_for_append();
+	_size = data.size();
+	_write_failed = false;
+	++_compactions;
+}
+
+
+void
+StateJournal::open_for_append()
+{
+	_fd = ::open (_path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+
+	if (_fd < 0)
+		throw Exception (error_string ("could not open for writing", _path));
+}
+
+
+bool
+StateJournal::needs_compaction() const noexcept
+{
+	auto const size = _size.load (std::memory_order_relaxed);
+	return size > kMinCompactionSize && size > kCompactionFactor * (kMagicSize + _live_size);
+}
+
+
+void
+StateJournal::serialize_record (Blob& output, std::string const& name, Blob const& value)
+{
+	Blob payload;
+	payload.reserve (2 + name.size() + value.size());
+	append_le (payload, name.size(), 2);
+	payload.insert (payload.end(), name.begin(), name.end());
+	payload.insert (payload.end(), value.begin(), value.end());
+
+	append_le (output, payload.size(), 4);
+	append_le (output, crc32 (payload.data(), payload.size()), 4);
+	output.insert (output.end(), payload.begin(), payload.end());
+}
+
+} // namespace xf
+
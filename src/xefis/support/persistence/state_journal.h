@@ -0,0 +1,206 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__PERSISTENCE__STATE_JOURNAL_H__INCLUDED
+#define XEFIS__SUPPORT__PERSISTENCE__STATE_JOURNAL_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Neutrino:
+#include <neutrino/logger.h>
+#include <neutrino/noncopyable.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+
+namespace xf {
+
+/**
+ * Append-only binary journal of named values (usually property blobs).
+ *
+ * Each recorded value is appended to the file as a separate record protected with CRC-32,
+ * by a writer thread which calls fdatasync() after each batch. On load the journal is replayed
+ * and the last value of each name wins. A torn record at the end (eg. after power loss)
+ * is detected and discarded.
+ *
+ * When the journal grows much larger than its live contents, it's compacted: latest values
+ * are written to a temporary file, which is synced and renamed over the journal, so that
+ * at any time there's a complete journal on disk.
+ *
+ * File format: magic "XSJ1", then records: u32 payload size, u32 CRC-32 of payload, payload.
+ * Payload: u16 name size, name, value. All integers are little-endian.
+ */
+class StateJournal: private Noncopyable
+{
+  public:
+	using Values = std::map<std::string, Blob>;
+
+	static constexpr char			kMagic[]				= "XSJ1";
+	static constexpr std::size_t	kMagicSize				= 4;
+	static constexpr std::size_t	kRecordHeaderSize		= 8;
+	// Journal is compacted when it's this many times larger than its live contents:
+	static constexpr std::size_t	kCompactionFactor		= 4;
+	// … but not before it reaches this size:
+	static constexpr std::size_t	kMinCompactionSize		= 64 * 1024;
+
+	/**
+	 * Thrown when file exists but isn't a state journal.
+	 */
+	class InvalidFormat: public Exception
+	{
+	  public:
+		explicit
+		InvalidFormat (std::string const& path);
+	};
+
+  public:
+	/**
+	 * Open or create journal and replay it. Throws InvalidFormat if the file exists
+	 * and is not a journal; the file is not modified in such case.
+	 */
+	explicit
+	StateJournal (std::string const& path, Logger const&);
+
+	// Dtor
+	~StateJournal();
+
+	/**
+	 * Values read from the journal when it was opened.
+	 */
+	[[nodiscard]]
+	Values const&
+	loaded_values() const noexcept;
+
+	/**
+	 * Queue value for writing. Cheap, doesn't do any I/O.
+	 */
+	void
+	record (std::string const& name, Blob value);
+
+	/**
+	 * Wait until all recorded values are written and synced to disk.
+	 */
+	void
+	flush();
+
+	/**
+	 * Current size of the journal file.
+	 */
+	[[nodiscard]]
+	std::size_t
+	size() const noexcept;
+
+	/**
+	 * Number of compactions done since the journal was opened.
+	 */
+	[[nodiscard]]
+	std::size_t
+	compactions() const noexcept;
+
+  private:
+	/**
+	 * Read journal and fill _loaded_values. Return offset of the end of the last valid record.
+	 */
+	std::size_t
+	replay();
+
+	/**
+	 * Writer thread loop.
+	 */
+	void
+	run();
+
+	/**
+	 * Append values to the journal and sync. Compact if needed.
+	 */
+	void
+	append (Values const&);
+
+	/**
+	 * Rewrite journal with only the latest values.
+	 */
+	void
+	compact();
+
+	void
+	open_for_append();
+
+	[[nodiscard]]
+	bool
+	needs_compaction() const noexcept;
+
+	static void
+	serialize_record (Blob& output, std::string const& name, Blob const& value);
+
+  private:
+	Logger						_logger;
+	std::string					_path;
+	Values						_loaded_values;
+	// Shared with writer thread:
+	std::mutex					_mutex;
+	std::condition_variable		_queue_changed;
+	Values						_queue;
+	uint64_t					_recorded		{ 0 };
+	uint64_t					_written		{ 0 };
+	bool						_stop			{ false };
+	std::atomic<std::size_t>	_size			{ 0 };
+	std::atomic<std::size_t>	_compactions	{ 0 };
+	// Used only by the writer thread (and the ctor before it's started):
+	int							_fd				{ -1 };
+	Values						_values;
+	std::size_t					_live_size		{ 0 };
+	bool						_write_failed	{ false };
+	std::thread					_thread;
+};
+
+
+inline
+StateJournal::InvalidFormat::InvalidFormat (std::string const& path):
+	Exception ("file '" + path + "' is not a state journal")
+{ }
+
+
+inline StateJournal::Values const&
+StateJournal::loaded_values() const noexcept
+{
+	return _loaded_values;
+}
+
+
+inline std::size_t
+StateJournal::size() const noexcept
+{
+	return _size.load (std::memory_order_relaxed);
+}
+
+
+inline std::size_t
+StateJournal::compactions() const noexcept
+{
+	return _compactions.load (std::memory_order_relaxed);
+}
+
+} // namespace xf
+
+#endif
+
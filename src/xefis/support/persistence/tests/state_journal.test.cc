@@ -0,0 +1,179 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+// System:
+#include <stdlib.h>
+
+// Neutrino:
+#include <neutrino/logger.h>
+#include <neutrino/test/auto_test.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/persistence/state_journal.h>
+
+
+namespace xf::test {
+namespace {
+
+xf::LoggerOutput g_logger_output (std::clog);
+xf::Logger g_logger (g_logger_output);
+
+
+/**
+ * Temporary directory removed in dtor.
+ */
+struct TemporaryDirectory
+{
+	TemporaryDirectory()
+	{
+		std::string name_template = std::filesystem::temp_directory_path() / "xefis-state-journal-XXXXXX";
+
+		if (!::mkdtemp (name_template.data()))
+			throw Exception ("could not create temporary directory");
+
+		path = name_template;
+	}
+
+	~TemporaryDirectory()
+	{
+		std::filesystem::remove_all (path);
+	}
+
+	std::filesystem::path path;
+};
+
+
+std::string
+read_file (std::filesystem::path const& path)
+{
+	std::ifstream file (path, std::ios::binary);
+	return { std::istreambuf_iterator<char> (file), std::istreambuf_iterator<char>() };
+}
+
+
+AutoTest t1 ("StateJournal: replay", []{
+	TemporaryDirectory directory;
+	auto const path = directory.path / "state";
+
+	{
+		StateJournal journal (path, g_logger);
+		test_asserts::verify ("new journal is empty", journal.loaded_values().empty());
+
+		journal.record ("a", { 1, 2, 3 });
+		journal.record ("b", { 4 });
+		journal.flush();
+		journal.record ("a", { 5, 6 });
+		journal.record ("c", {});
+	}
+
+	StateJournal journal (path, g_logger);
+	test_asserts::verify ("last values are loaded", journal.loaded_values() == StateJournal::Values {
+		{ "a", { 5, 6 } },
+		{ "b", { 4 } },
+		{ "c", {} },
+	});
+});
+
+
+AutoTest t2 ("StateJournal: torn record is discarded", []{
+	TemporaryDirectory directory;
+	auto const path = directory.path / "state";
+
+	{
+		StateJournal journal (path, g_logger);
+		journal.record ("a", { 1 });
+		journal.flush();
+		journal.record ("b", { 2, 2, 2, 2 });
+	}
+
+	// Simulate power loss during append:
+	auto const full_size = std::filesystem::file_size (path);
+	std::filesystem::resize_file (path, full_size - 3);
+
+	{
+		StateJournal journal (path, g_logger);
+		test_asserts::verify ("complete records are loaded", journal.loaded_values() == StateJournal::Values { { "a", { 1 } } });
+		test_asserts::verify ("torn record is removed from the file", journal.size() == std::filesystem::file_size (path));
+
+		journal.record ("b", { 3 });
+	}
+
+	StateJournal journal (path, g_logger);
+	test_asserts::verify ("journal is usable after recovery", journal.loaded_values() == StateJournal::Values {
+		{ "a", { 1 } },
+		{ "b", { 3 } },
+	});
+});
+
+
+AutoTest t3 ("StateJournal: compaction", []{
+	TemporaryDirectory directory;
+	auto const path = directory.path / "state";
+	Blob value (1000, 0);
+
+	{
+		StateJournal journal (path, g_logger);
+		auto const initial_compactions = journal.compactions();
+
+		for (std::size_t i = 0; i < 2 * StateJournal::kMinCompactionSize / value.size(); ++i)
+		{
+			value[0] = i;
+			journal.record ("value", value);
+			journal.record ("other", { 7 });
+			journal.flush();
+		}
+
+		test_asserts::verify ("journal got compacted", journal.compactions() > initial_compactions);
+		test_asserts::verify ("journal size is limited", journal.size() <= StateJournal::kMinCompactionSize + 2 * value.size());
+		test_asserts::verify ("size is correct", journal.size() == std::filesystem::file_size (path));
+	}
+
+	StateJournal journal (path, g_logger);
+	test_asserts::verify ("latest values survive compaction", journal.loaded_values() == StateJournal::Values {
+		{ "other", { 7 } },
+		{ "value", value },
+	});
+});
+
+
+AutoTest t4 ("StateJournal: foreign file is not touched", []{
+	TemporaryDirectory directory;
+	auto const path = directory.path / "state";
+	std::string const content = "<xefis-mod-systems-state/>";
+	std::ofstream (path) << content;
+
+	bool thrown = false;
+
+	try {
+		StateJournal journal (path, g_logger);
+	}
+	catch (StateJournal::InvalidFormat const&)
+	{
+		thrown = true;
+	}
+
+	test_asserts::verify ("InvalidFormat is thrown", thrown);
+	test_asserts::verify ("file is not modified", read_file (path) == content);
+});
+
+} // namespace
+} // namespace xf::test
+
@@ -13,13 +13,13 @@
 
 // Standard:
 #include <cstddef>
+#include <ctime>
 #include <string>
 
-// Boost:
-#include <boost/lexical_cast.hpp>
+// Lib:
+#include <boost/format.hpp>
 
 // Neutrino:
-#include <neutrino/numeric.h>
 #include <neutrino/stdexcept.h>
 
 // Xefis:
@@ -36,70 +36,65 @@ namespace xf::nmea {
 using std::to_string;
 
 
-static inline unsigned int
-mknum (uint8_t c10, uint8_t c01)
-{
-	return digit_from_ascii (c10) * 10
-		 + digit_from_ascii (c01);
-}
-
-
 BadDateTime::BadDateTime (xf::nmea::GPSDate const& date, xf::nmea::GPSTimeOfDay const& time):
 	Exception ("invalid GPS date '" + to_string (date) + "' or time '" + to_string (time) + "'")
 { }
 
 
-UnsupportedSentenceType::UnsupportedSentenceType (std::string const& sentence):
-	Exception ("unsupported sentence: '" + sentence + "'")
-{ }
-
-
-GPSTimeOfDay::GPSTimeOfDay (std::string const& gps_time)
+std::optional<GPSTimeOfDay>
+GPSTimeOfDay::parse (std::string_view const gps_time) noexcept
 {
 	if (gps_time.size() < 6)
-		throw InvalidFormat ("invalid format of GPS time-of-day: '" + gps_time + "'");
-
-	try {
-		hours = mknum (gps_time[0], gps_time[1]);
-		minutes = mknum (gps_time[2], gps_time[3]);
-		seconds = mknum (gps_time[4], gps_time[5]);
-		seconds_fraction = boost::lexical_cast<double> ("0" + gps_time.substr (6));
-	}
-	catch (InvalidFormat& e)
-	{
-		std::throw_with_nested (InvalidFormat ("invalid format of GPS time-of-day"));
-	}
+		return std::nullopt;
+
+	auto const hours = parse_number<uint8_t> (gps_time.substr (0, 2));
+	auto const minutes = parse_number<uint8_t> (gps_time.substr (2, 2));
+	auto const seconds = parse_number<uint8_t> (gps_time.substr (4, 2));
+	auto const fraction = gps_time.size() > 6 ? parse_number<double> (gps_time.substr (6)) : 0.0;
+
+	if (!hours || !minutes || !seconds || !fraction)
+		return std::nullopt;
+
+	GPSTimeOfDay result;
+	result.hours = *hours;
+	result.minutes = *minutes;
+	result.seconds = *seconds;
+	result.seconds_fraction = *fraction;
+	return result;
 }
 
 
-GPSDate::GPSDate (std::string const& gps_date)
+std::optional<GPSDate>
+GPSDate::parse (std::string_view const gps_date) noexcept
 {
 	if (gps_date.size() != 6)
-		throw InvalidFormat ("invalid format of GPS date: '" + gps_date + "'");
+		return std::nullopt;
 
-	try {
-		day = mknum (gps_date[0], gps_date[1]);
-		month = mknum (gps_date[2], gps_date[3]);
-		year = 2000 + mknum (gps_date[4], gps_date[5]);
-	}
-	catch (InvalidFormat& e)
-	{
-		std::throw_with_nested (InvalidFormat ("invalid format of GPS date"));
-	}
+	auto const day = parse_number<uint8_t> (gps_date.substr (0, 2));
+	auto const month = parse_number<uint8_t> (gps_date.substr (2, 2));
+	auto const year = parse_number<uint16_t> (gps_date.substr (4, 2));
+
+	if (!day || !month || !year)
+		return std::nullopt;
+
+	GPSDate result;
+	result.day = *day;
+	result.month = *month;
+	result.year = 2000 + *year;
+	return result;
 }
 
 
-GPGGA::GPGGA (std::string const& sentence):
+GPGGA::GPGGA (std::string_view const sentence):
 	Sentence (sentence)
 {
-	if (!read_next() || val() != "GPGGA")
-		throw InvalidType ("GPGGA", val());
+	if (!read_next() || !is_gps_header (val(), "GGA"))
+		throw InvalidType ("GPGGA", std::string (val()));
 
 	// Fix time (UTC):
 	if (!read_next())
 		return;
-	if (!val().empty())
-		this->fix_time = GPSTimeOfDay (val());
+	this->fix_time = GPSTimeOfDay::parse (val());
 
 	// Latitude:
 	if (!read_latitude (this->latitude))
@@ -112,88 +107,62 @@ GPGGA::GPGGA (std::string const& sentence):
 	// Fix quality:
 	if (!read_next())
 		return;
-	if (val().size() == 1 && std::isdigit (val()[0]))
+	if (auto const fq = parse_number<int> (val()))
 	{
-		int fq = digit_from_ascii (val()[0]);
 		// Integer range check:
-		if (fq <= static_cast<int> (GPSFixQuality::Simulated) &&
-			fq >= static_cast<int> (GPSFixQuality::Invalid))
+		if (*fq <= static_cast<int> (GPSFixQuality::Simulated) &&
+			*fq >= static_cast<int> (GPSFixQuality::Invalid))
 		{
-			this->fix_quality = static_cast<GPSFixQuality> (fq);
+			this->fix_quality = static_cast<GPSFixQuality> (*fq);
 		}
 	}
 
 	// Number of tracked satellites:
-	if (!read_next())
+	if (!read_number (this->tracked_satellites))
 		return;
-	try {
-		this->tracked_satellites = boost::lexical_cast<unsigned int> (val());
-	}
-	catch (boost::bad_lexical_cast&)
-	{ }
 
 	// Horizontal dilution of position:
-	if (!read_next())
+	if (!read_number (this->hdop))
 		return;
-	try {
-		this->hdop = boost::lexical_cast<double> (val());
-	}
-	catch (boost::bad_lexical_cast&)
-	{ }
 
 	// Altitude above mean sea level (in meters):
-	if (!read_next())
+	std::optional<double> altitude_amsl_m;
+
+	if (!read_number (altitude_amsl_m))
 		return;
-	try {
-		this->altitude_amsl = 1_m * boost::lexical_cast<double> (val());
-	}
-	catch (boost::bad_lexical_cast&)
-	{ }
+
 	// Ensure that unit is 'M' (meters):
 	if (!read_next())
-	{
-		this->altitude_amsl.reset();
 		return;
-	}
 
-	if (val() != "M")
-		this->altitude_amsl.reset();
+	if (altitude_amsl_m && val() == "M")
+		this->altitude_amsl = 1_m * *altitude_amsl_m;
 
 	// Height above WGS84 geoid (in meters):
-	if (!read_next())
+	std::optional<double> geoid_height_m;
+
+	if (!read_number (geoid_height_m))
 		return;
-	try {
-		this->geoid_height = 1_m * boost::lexical_cast<double> (val());
-	}
-	catch (boost::bad_lexical_cast&)
-	{ }
+
 	// Ensure that unit is 'M' (meters):
 	if (!read_next())
-	{
-		this->geoid_height.reset();
 		return;
-	}
 
-	if (val() != "M")
-		this->geoid_height.reset();
+	if (geoid_height_m && val() == "M")
+		this->geoid_height = 1_m * *geoid_height_m;
 
 	// Time since last DGPS update (in seconds):
-	if (!read_next())
+	std::optional<double> dgps_last_update_time_s;
+
+	if (!read_number (dgps_last_update_time_s))
 		return;
-	try {
-		this->dgps_last_update_time = 1_s * boost::lexical_cast<double> (val());
-	}
-	catch (boost::bad_lexical_cast&)
-	{ }
+
+	if (dgps_last_update_time_s)
+		this->dgps_last_update_time = 1_s * *dgps_last_update_time_s;
 
 	// DGPS station identifier:
-	if (!read_next())
+	if (!read_number (this->dgps_station_id))
 		return;
-	try {
-		this->dgps_station_id = boost::lexical_cast<std::decay_t<decltype (*this->dgps_station_id)>> (val());
-	}
-	catch (boost::bad_lexical_cast&)
-	{ }
 }
 
 
@@ -220,11 +189,11 @@ GPGGA::reliable_fix_quality() const noexcept
 }
 
 
-GPGSA::GPGSA (std::string const& sentence):
+GPGSA::GPGSA (std::string_view const sentence):
 	Sentence (sentence)
 {
-	if (!read_next() || val() != "GPGSA")
-		throw InvalidType ("GPGSA", val());
+	if (!read_next() || !is_gps_header (val(), "GSA"))
+		throw InvalidType ("GPGSA", std::string (val()));
 
 	// Fix selection (auto/manual):
 	if (!read_next())
@@ -247,58 +216,34 @@ GPGSA::GPGSA (std::string const& sentence):
 		this->fix_mode = GPSFixMode::Fix3D;
 
 	// PRNs of satellites used for the fix:
-	for (int i = 0; i < 12; ++i)
-	{
-		if (!read_next())
+	for (auto& satellite: this->satellites)
+		if (!read_number (satellite))
 			return;
-		try {
-			if (!val().empty())
-				this->satellites[i] = boost::lexical_cast<unsigned int> (val());
-		}
-		catch (boost::bad_lexical_cast&)
-		{ }
-	}
 
 	// PDOP:
-	if (!read_next())
+	if (!read_number (this->pdop))
 		return;
-	try {
-		this->pdop = boost::lexical_cast<double> (val());
-	}
-	catch (boost::bad_lexical_cast&)
-	{ }
 
 	// HDOP:
-	if (!read_next())
+	if (!read_number (this->hdop))
 		return;
-	try {
-		this->hdop = boost::lexical_cast<double> (val());
-	}
-	catch (boost::bad_lexical_cast&)
-	{ }
 
 	// VDOP:
-	if (!read_next())
+	if (!read_number (this->vdop))
 		return;
-	try {
-		this->vdop = boost::lexical_cast<double> (val());
-	}
-	catch (boost::bad_lexical_cast&)
-	{ }
 }
 
 
-GPRMC::GPRMC (std::string const& sentence):
+GPRMC::GPRMC (std::string_view const sentence):
 	Sentence (sentence)
 {
-	if (!read_next() || val() != "GPRMC")
-		throw InvalidType ("GPRMC", val());
+	if (!read_next() || !is_gps_header (val(), "RMC"))
+		throw InvalidType ("GPRMC", std::string (val()));
 
 	// Fix time (UTC):
 	if (!read_next())
 		return;
-	if (!val().empty())
-		this->fix_time = GPSTimeOfDay (val());
+	this->fix_time = GPSTimeOfDay::parse (val());
 
 	// Receiver status:
 	if (!read_next())
@@ -306,7 +251,7 @@ GPRMC::GPRMC (std::string const& sentence):
 
 	if (val() == "A")
 		this->receiver_status = GPSReceiverStatus::Active;
-	else if (val() == "v")
+	else if (val() == "V")
 		this->receiver_status = GPSReceiverStatus::Void;
 
 	// Latitude:
@@ -318,48 +263,189 @@ GPRMC::GPRMC (std::string const& sentence):
 		return;
 
 	// Ground-speed:
-	if (!read_next())
+	std::optional<double> ground_speed_kt;
+
+	if (!read_number (ground_speed_kt))
 		return;
-	try {
-		this->ground_speed = 1_kt * boost::lexical_cast<double> (val());
-	}
-	catch (boost::bad_lexical_cast&)
-	{ }
+
+	if (ground_speed_kt)
+		this->ground_speed = 1_kt * *ground_speed_kt;
 
 	// Track angle in degrees True:
-	if (!read_next())
+	std::optional<double> track_true_deg;
+
+	if (!read_number (track_true_deg))
 		return;
-	try {
-		this->track_true = 1_deg * boost::lexical_cast<double> (val());
-	}
-	catch (boost::bad_lexical_cast&)
-	{ }
+
+	if (track_true_deg)
+		this->track_true = 1_deg * *track_true_deg;
 
 	// Fix date:
 	if (!read_next())
 		return;
-	if (!val().empty())
-		this->fix_date = GPSDate (val());
+	this->fix_date = GPSDate::parse (val());
 
 	// Magnetic variation:
+	std::optional<double> magnetic_variation_deg;
+
+	if (!read_number (magnetic_variation_deg))
+		return;
+
+	// East/West:
 	if (!read_next())
 		return;
-	try {
-		this->magnetic_variation = 1_deg * boost::lexical_cast<double> (val());
+
+	if (magnetic_variation_deg)
+	{
+		if (val() == "W")
+			this->magnetic_variation = -1_deg * *magnetic_variation_deg;
+		else if (val() == "E")
+			this->magnetic_variation = 1_deg * *magnetic_variation_deg;
 	}
-	catch (boost::bad_lexical_cast&)
-	{ }
-	// East/West:
+}
+
+
+GPVTG::GPVTG (std::string_view const sentence):
+	Sentence (sentence)
+{
+	if (!read_next() || !is_gps_header (val(), "VTG"))
+		throw InvalidType ("GPVTG", std::string (val()));
+
+	// Reads a value followed by a unit field; accepts the value only if the unit matches:
+	auto const read_with_unit = [this] (std::optional<double>& value, std::string_view const unit) -> bool
+	{
+		if (!read_number (value))
+			return false;
+
+		if (!read_next())
+		{
+			value.reset();
+			return false;
+		}
+
+		if (val() != unit)
+			value.reset();
+
+		return true;
+	};
+
+	std::optional<double> track_true_deg;
+	std::optional<double> track_magnetic_deg;
+	std::optional<double> ground_speed_kt;
+	std::optional<double> ground_speed_kph;
+
+	bool const complete = read_with_unit (track_true_deg, "T")
+		&& read_with_unit (track_magnetic_deg, "M")
+		&& read_with_unit (ground_speed_kt, "N")
+		&& read_with_unit (ground_speed_kph, "K");
+
+	if (track_true_deg)
+		this->track_true = 1_deg * *track_true_deg;
+
+	if (track_magnetic_deg)
+		this->track_magnetic = 1_deg * *track_magnetic_deg;
+
+	if (ground_speed_kt)
+		this->ground_speed = 1_kt * *ground_speed_kt;
+	else if (ground_speed_kph)
+		this->ground_speed = 1_kph * *ground_speed_kph;
+
+	// NMEA 2.3 mode indicator; 'N' means data is not valid:
+	if (complete && read_next() && val() == "N")
+	{
+		this->track_true.reset();
+		this->track_magnetic.reset();
+		this->ground_speed.reset();
+	}
+}
+
+
+GPGST::GPGST (std::string_view const sentence):
+	Sentence (sentence)
+{
+	if (!read_next() || !is_gps_header (val(), "GST"))
+		throw InvalidType ("GPGST", std::string (val()));
+
+	// Fix time (UTC):
 	if (!read_next())
+		return;
+	this->fix_time = GPSTimeOfDay::parse (val());
+
+	auto const read_length = [this] (std::optional<si::Length>& length) -> bool
+	{
+		std::optional<double> meters;
+
+		if (!read_number (meters))
+			return false;
+
+		if (meters)
+			length = 1_m * *meters;
+
+		return true;
+	};
+
+	if (!read_length (this->range_rms) ||
+		!read_length (this->semi_major_stddev) ||
+		!read_length (this->semi_minor_stddev))
+	{
+		return;
+	}
+
+	// Orientation of semi-major axis:
+	std::optional<double> orientation_deg;
+
+	if (!read_number (orientation_deg))
+		return;
+
+	if (orientation_deg)
+		this->semi_major_orientation = 1_deg * *orientation_deg;
+
+	if (!read_length (this->latitude_stddev) ||
+		!read_length (this->longitude_stddev) ||
+		!read_length (this->altitude_stddev))
 	{
-		this->magnetic_variation.reset();
 		return;
 	}
+}
+
+
+GPZDA::GPZDA (std::string_view const sentence):
+	Sentence (sentence)
+{
+	if (!read_next() || !is_gps_header (val(), "ZDA"))
+		throw InvalidType ("GPZDA", std::string (val()));
+
+	// Time (UTC):
+	if (!read_next())
+		return;
+	this->time = GPSTimeOfDay::parse (val());
+
+	// Date (UTC), day, month and 4-digit year in separate fields:
+	std::optional<uint8_t> day;
+	std::optional<uint8_t> month;
+	std::optional<uint16_t> year;
+
+	if (!read_number (day) || !read_number (month) || !read_number (year))
+		return;
+
+	if (day && month && year)
+	{
+		GPSDate date;
+		date.day = *day;
+		date.month = *month;
+		date.year = *year;
+		this->date = date;
+	}
+
+	// Local zone; minutes have the same sign as hours:
+	std::optional<int> zone_hours;
+	std::optional<int> zone_minutes;
+
+	if (!read_number (zone_hours) || !read_number (zone_minutes))
+		return;
 
-	if (val() == "W")
-		this->magnetic_variation = -1 * *this->magnetic_variation;
-	else if (val() != "E")
-		this->magnetic_variation.reset();
+	if (zone_hours && zone_minutes)
+		this->local_zone_offset = 3600_s * *zone_hours + 60_s * (*zone_hours < 0 ? -*zone_minutes : *zone_minutes);
 }
 
 
@@ -14,6 +14,13 @@
 #ifndef XEFIS__SUPPORT__PROTOCOLS__NMEA__GPS_H__INCLUDED
 #define XEFIS__SUPPORT__PROTOCOLS__NMEA__GPS_H__INCLUDED
 
+// Standard:
+#include <cstddef>
+#include <array>
+#include <optional>
+#include <string>
+#include <string_view>
+
 // Xefis:
 #include <xefis/config/all.h>
 
@@ -92,19 +99,17 @@ class GPSTimeOfDay
 {
   public:
 	/**
-	 * Ctor
-	 * \param	gps_time
-	 *			String taken from NMEA message,
-	 *			formatted: HHMMSS.
+	 * Parse time taken from NMEA message, formatted: HHMMSS[.SS].
+	 * Return std::nullopt if format is invalid.
 	 */
-	explicit
-	GPSTimeOfDay (std::string const& gps_time);
+	static std::optional<GPSTimeOfDay>
+	parse (std::string_view gps_time) noexcept;
 
   public:
-	uint8_t		hours;
-	uint8_t		minutes;
-	uint8_t		seconds;
-	double		seconds_fraction;
+	uint8_t		hours				{ 0 };
+	uint8_t		minutes				{ 0 };
+	uint8_t		seconds				{ 0 };
+	double		seconds_fraction	{ 0.0 };
 };
 
 
@@ -115,18 +120,16 @@ class GPSDate
 {
   public:
 	/**
-	 * Ctor
-	 * \param	gps_date
-	 *			String taken from NMEA message,
-	 *			formatted: DDMMYY.
+	 * Parse date taken from NMEA message, formatted: DDMMYY.
+	 * Return std::nullopt if format is invalid.
 	 */
-	explicit
-	GPSDate (std::string const& gps_date);
+	static std::optional<GPSDate>
+	parse (std::string_view gps_date) noexcept;
 
   public:
-	uint8_t		day;
-	uint8_t		month;
-	uint16_t	year;
+	uint8_t		day		{ 1 };
+	uint8_t		month	{ 1 };
+	uint16_t	year	{ 2000 };
 };
 
 
@@ -139,10 +142,10 @@ class GPGGA: public Sentence
 	/**
 	 * Ctor
 	 * Parse NMEA sentence between '$' and '*'.
-	 * \throws	InvalidType if message header isn't 'GPGGA'.
+	 * \throws	InvalidType if message header isn't 'GPGGA' or 'GNGGA'.
 	 */
 	explicit
-	GPGGA (std::string const&);
+	GPGGA (std::string_view);
 
   public:
 	// UTC time when fix was obtained:
@@ -202,10 +205,10 @@ class GPGSA: public Sentence
 	/**
 	 * Ctor
 	 * Parse NMEA sentence between '$' and '*'.
-	 * \throws	InvalidType if message header isn't 'GPGSA'.
+	 * \throws	InvalidType if message header isn't 'GPGSA' or 'GNGSA'.
 	 */
 	explicit
-	GPGSA (std::string const&);
+	GPGSA (std::string_view);
 
   public:
 	// Fix mode:
@@ -237,10 +240,10 @@ class GPRMC: public Sentence
 	/**
 	 * Ctor
 	 * Parse NMEA sentence between '$' and '*'.
-	 * \throws	InvalidType if message header isn't 'GPRMC'.
+	 * \throws	InvalidType if message header isn't 'GPRMC' or 'GNRMC'.
 	 */
 	explicit
-	GPRMC (std::string const&);
+	GPRMC (std::string_view);
 
   public:
 	// UTC time when fix was obtained:
@@ -269,6 +272,99 @@ class GPRMC: public Sentence
 };
 
 
+/**
+ * Track made good and ground speed.
+ */
+class GPVTG: public Sentence
+{
+  public:
+	/**
+	 * Ctor
+	 * Parse NMEA sentence between '$' and '*'.
+	 * \throws	InvalidType if message header isn't 'GPVTG' or 'GNVTG'.
+	 */
+	explicit
+	GPVTG (std::string_view);
+
+  public:
+	// Track angle, True direction:
+	std::optional<si::Angle>			track_true;
+
+	// Track angle, Magnetic direction:
+	std::optional<si::Angle>			track_magnetic;
+
+	// Ground-speed:
+	std::optional<si::Speed>			ground_speed;
+};
+
+
+/**
+ * GPS pseudorange error statistics: standard deviations of position components.
+ */
+class GPGST: public Sentence
+{
+  public:
+	/**
+	 * Ctor
+	 * Parse NMEA sentence between '$' and '*'.
+	 * \throws	InvalidType if message header isn't 'GPGST' or 'GNGST'.
+	 */
+	explicit
+	GPGST (std::string_view);
+
+  public:
+	// UTC time of the associated fix:
+	std::optional<GPSTimeOfDay>			fix_time;
+
+	// RMS value of standard deviation of the range inputs to the navigation process:
+	std::optional<si::Length>			range_rms;
+
+	// Standard deviation of semi-major axis of error ellipse:
+	std::optional<si::Length>			semi_major_stddev;
+
+	// Standard deviation of semi-minor axis of error ellipse:
+	std::optional<si::Length>			semi_minor_stddev;
+
+	// Orientation of semi-major axis of error ellipse, from True North:
+	std::optional<si::Angle>			semi_major_orientation;
+
+	// Standard deviation of latitude error:
+	std::optional<si::Length>			latitude_stddev;
+
+	// Standard deviation of longitude error:
+	std::optional<si::Length>			longitude_stddev;
+
+	// Standard deviation of altitude error:
+	std::optional<si::Length>			altitude_stddev;
+};
+
+
+/**
+ * UTC date and time.
+ */
+class GPZDA: public Sentence
+{
+  public:
+	/**
+	 * Ctor
+	 * Parse NMEA sentence between '$' and '*'.
+	 * \throws	InvalidType if message header isn't 'GPZDA' or 'GNZDA'.
+	 */
+	explicit
+	GPZDA (std::string_view);
+
+  public:
+	// UTC time:
+	std::optional<GPSTimeOfDay>			time;
+
+	// UTC date:
+	std::optional<GPSDate>				date;
+
+	// Local time zone offset from UTC:
+	std::optional<si::Time>				local_zone_offset;
+};
+
+
 /**
  * Return string name of the fix quality information,
  * returned by the GPS module.
@@ -13,6 +13,7 @@
 
 // Standard:
 #include <cstddef>
+#include <map>
 #include <string>
 
 // Xefis:
@@ -26,17 +27,17 @@
 
 namespace xf::nmea {
 
-PMTKACK::PMTKACK (std::string const& sentence):
+PMTKACK::PMTKACK (std::string_view const sentence):
 	Sentence (sentence)
 {
 	if (!read_next() || val() != "PMTK001")
-		throw InvalidType ("PMTK001", val());
+		throw InvalidType ("PMTK001", std::string (val()));
 
 	// Command info:
 	if (!read_next())
 		return;
 
-	this->command = val();
+	this->command = std::string (val());
 
 	if (!read_next())
 		return;
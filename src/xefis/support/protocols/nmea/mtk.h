@@ -14,6 +14,12 @@
 #ifndef XEFIS__SUPPORT__PROTOCOLS__NMEA__MTK_H__INCLUDED
 #define XEFIS__SUPPORT__PROTOCOLS__NMEA__MTK_H__INCLUDED
 
+// Standard:
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
 // Xefis:
 #include <xefis/config/all.h>
 
@@ -44,7 +50,7 @@ class PMTKACK: public Sentence
 	 * \throws	InvalidType if message header isn't 'PMTK001'.
 	 */
 	explicit
-	PMTKACK (std::string const&);
+	PMTKACK (std::string_view);
 
   public:
 	// Command to which this ACK responds to:
@@ -17,52 +17,50 @@
 
 // Lib:
 #include <boost/format.hpp>
-#include <boost/lexical_cast.hpp>
-
-// Neutrino:
-#include <neutrino/numeric.h>
-#include <neutrino/stdexcept.h>
 
 // Xefis:
 #include <xefis/config/all.h>
 
 // Local:
 #include "nmea.h"
-#include "exceptions.h"
 
 
 namespace xf::nmea {
 
-Sentence::Sentence (std::string const& sentence)
+Sentence::Sentence (std::string_view const sentence):
+	_sentence (sentence)
+{ }
+
+
+std::string_view
+Sentence::talker_id() const noexcept
 {
-	// Copy sentence last, when passed all tests:
-	_sentence = sentence;
+	if (_sentence.size() >= 2 && _sentence[0] != 'P')
+		return _sentence.substr (0, 2);
+	else
+		return {};
 }
 
 
 bool
 Sentence::read_next()
 {
-	if (_pos == std::string::npos)
+	if (_pos == std::string_view::npos)
 	{
-		_val.clear();
+		_val = {};
 		return false;
 	}
 
-	auto start_pos = _pos;
-
-	std::string::size_type comma = _sentence.find (',', start_pos);
+	auto const comma = _sentence.find (',', _pos);
 
-	if (comma == std::string::npos)
+	if (comma == std::string_view::npos)
 	{
-		_val.resize (_sentence.size() - start_pos);
-		std::copy (_sentence.begin() + start_pos, _sentence.end(), _val.begin());
-		_pos = std::string::npos;
+		_val = _sentence.substr (_pos);
+		_pos = std::string_view::npos;
 	}
 	else
 	{
-		_val.resize (comma - start_pos);
-		std::copy (_sentence.begin() + start_pos, _sentence.begin() + comma, _val.begin());
+		_val = _sentence.substr (_pos, comma - _pos);
 		_pos = comma + 1;
 	}
 
@@ -76,15 +74,15 @@ Sentence::read_latitude (std::optional<si::Angle>& latitude)
 	if (!read_next())
 		return false;
 
+	latitude.reset();
+
 	if (val().size() >= 3)
 	{
-		auto lat = 1_deg * (digit_from_ascii (val()[0]) * 10 +
-							digit_from_ascii (val()[1]));
-		try {
-			latitude = lat + 1_deg * boost::lexical_cast<double> (val().substr (2)) / 60.0;
-		}
-		catch (boost::bad_lexical_cast&)
-		{ }
+		auto const degrees = parse_number<unsigned int> (val().substr (0, 2));
+		auto const minutes = parse_number<double> (val().substr (2));
+
+		if (degrees && minutes)
+			latitude = 1_deg * (*degrees + *minutes / 60.0);
 	}
 
 	// North/South:
@@ -94,7 +92,7 @@ Sentence::read_latitude (std::optional<si::Angle>& latitude)
 		return false;
 	}
 
-	if (val() == "S")
+	if (latitude && val() == "S")
 		latitude = -1 * *latitude;
 	else if (val() != "N")
 		latitude.reset();
@@ -109,16 +107,15 @@ Sentence::read_longitude (std::optional<si::Angle>& longitude)
 	if (!read_next())
 		return false;
 
+	longitude.reset();
+
 	if (val().size() >= 4)
 	{
-		auto lon = 1_deg * (digit_from_ascii (val()[0]) * 100 +
-							digit_from_ascii (val()[1]) * 10 +
-							digit_from_ascii (val()[2]));
-		try {
-			longitude = lon + 1_deg * boost::lexical_cast<double> (val().substr (3)) / 60.0;
-		}
-		catch (boost::bad_lexical_cast&)
-		{ }
+		auto const degrees = parse_number<unsigned int> (val().substr (0, 3));
+		auto const minutes = parse_number<double> (val().substr (3));
+
+		if (degrees && minutes)
+			longitude = 1_deg * (*degrees + *minutes / 60.0);
 	}
 
 	// East/West:
@@ -128,7 +125,7 @@ Sentence::read_longitude (std::optional<si::Angle>& longitude)
 		return false;
 	}
 
-	if (val() == "W")
+	if (longitude && val() == "W")
 		longitude = -1 * *longitude;
 	else if (val() != "E")
 		longitude.reset();
@@ -137,6 +134,15 @@ Sentence::read_longitude (std::optional<si::Angle>& longitude)
 }
 
 
+bool
+Sentence::is_gps_header (std::string_view const header, std::string_view const name) noexcept
+{
+	return header.size() == name.size() + 2
+		&& (header.substr (0, 2) == "GP" || header.substr (0, 2) == "GN")
+		&& header.substr (2) == name;
+}
+
+
 std::string
 make_checksum (std::string const& data)
 {
@@ -147,19 +153,35 @@ make_checksum (std::string const& data)
 }
 
 
-SentenceType
-get_sentence_type (std::string const& sentence)
+std::optional<SentenceType>
+get_sentence_type (std::string_view sentence) noexcept
 {
-	if (sentence.compare (0, 7, "$GPGGA,") == 0)
+	if (!sentence.empty() && sentence[0] == '$')
+		sentence.remove_prefix (1);
+
+	if (sentence.substr (0, 8) == "PMTK001,")
+		return SentenceType::PMTKACK;
+
+	// Accept GPS (GP) and multi-constellation (GN) talker IDs:
+	if (sentence.size() < 6 || sentence[5] != ',' || (sentence.substr (0, 2) != "GP" && sentence.substr (0, 2) != "GN"))
+		return std::nullopt;
+
+	auto const name = sentence.substr (2, 3);
+
+	if (name == "GGA")
 		return SentenceType::GPGGA;
-	else if (sentence.compare (0, 7, "$GPGSA,") == 0)
+	else if (name == "GSA")
 		return SentenceType::GPGSA;
-	else if (sentence.compare (0, 7, "$GPRMC,") == 0)
+	else if (name == "RMC")
 		return SentenceType::GPRMC;
-	else if (sentence.compare (0, 9, "$PMTK001,") == 0)
-		return SentenceType::PMTKACK;
+	else if (name == "VTG")
+		return SentenceType::GPVTG;
+	else if (name == "GST")
+		return SentenceType::GPGST;
+	else if (name == "ZDA")
+		return SentenceType::GPZDA;
 	else
-		throw UnsupportedSentenceType (sentence);
+		return std::nullopt;
 }
 
 } // namespace xf::nmea
@@ -16,7 +16,10 @@
 
 // Standard:
 #include <cstddef>
+#include <charconv>
+#include <optional>
 #include <string>
+#include <string_view>
 
 // Xefis:
 #include <xefis/config/all.h>
@@ -24,31 +27,25 @@
 
 namespace xf::nmea {
 
-/**
- * Thrown when NMEA or PMTK sentence type can't be resolved.
- */
-class UnsupportedSentenceType: public Exception
-{
-  public:
-	explicit
-	UnsupportedSentenceType (std::string const& sentence);
-};
-
-
 /**
  * Sentence type.
+ * Sentences named GPxxx are also recognized with the GN (multi-constellation) talker ID.
  */
 enum class SentenceType
 {
 	GPGGA,		// GPS fix information
 	GPGSA,		// GPS overall satellite data
 	GPRMC,		// GPS recommended minimum data
+	GPVTG,		// Track made good and ground speed
+	GPGST,		// Pseudorange error statistics
+	GPZDA,		// Date and time
 	PMTKACK,	// MTK ACK
 };
 
 
 /**
  * Common base for all NMEA sentences.
+ * Sentence objects refer to the parsed string and are valid only as long as that string.
  */
 class Sentence
 {
@@ -59,15 +56,22 @@ class Sentence
 	 *			String between the '$' and '*'.
 	 */
 	explicit
-	Sentence (std::string const&);
+	Sentence (std::string_view sentence);
 
   public:
 	/**
 	 * Return sentence contents (without prolog and checksum).
 	 */
-	std::string const&
+	std::string_view
 	contents() const noexcept;
 
+	/**
+	 * Return talker ID, eg. "GP" for GPS or "GN" for multi-constellation receivers.
+	 * Empty for proprietary sentences.
+	 */
+	std::string_view
+	talker_id() const noexcept;
+
   protected:
 	/**
 	 * Get next substring up to next comma or end of string.
@@ -80,11 +84,21 @@ class Sentence
 	read_next();
 
 	/**
-	 * \return	substring extraced with read_to_comma().
+	 * \return	substring extraced with read_next().
 	 */
-	std::string const&
+	std::string_view
 	val() const noexcept;
 
+	/**
+	 * Read field and parse it as a number.
+	 *
+	 * \return	false if read_next() returned false internally,
+	 *			so it's time to finish.
+	 */
+	template<class Value>
+		bool
+		read_number (std::optional<Value>& out_value);
+
 	/**
 	 * Read latitude (using standard read_next()).
 	 *
@@ -103,27 +117,65 @@ class Sentence
 	bool
 	read_longitude (std::optional<si::Angle>& out_longitude);
 
+	/**
+	 * Return true if sentence's header is given sentence name (without talker ID)
+	 * prefixed with GP or GN talker ID.
+	 */
+	static bool
+	is_gps_header (std::string_view header, std::string_view name) noexcept;
+
   private:
-	std::string				_sentence;
-	std::string				_val;
-	std::string::size_type	_pos	= 0;
+	std::string_view			_sentence;
+	std::string_view			_val;
+	std::string_view::size_type	_pos	= 0;
 };
 
 
-inline std::string const&
+inline std::string_view
 Sentence::contents() const noexcept
 {
 	return _sentence;
 }
 
 
-inline std::string const&
+inline std::string_view
 Sentence::val() const noexcept
 {
 	return _val;
 }
 
 
+/**
+ * Parse decimal number from a NMEA field. Doesn't throw and doesn't allocate.
+ * Return std::nullopt if the field is empty or isn't a valid number in its entirety.
+ */
+template<class Value>
+	inline std::optional<Value>
+	parse_number (std::string_view const string) noexcept
+	{
+		Value value;
+		auto const end = string.data() + string.size();
+		auto const [ptr, ec] = std::from_chars (string.data(), end, value);
+
+		if (ec == std::errc() && ptr == end)
+			return value;
+		else
+			return std::nullopt;
+	}
+
+
+template<class Value>
+	inline bool
+	Sentence::read_number (std::optional<Value>& value)
+	{
+		if (!read_next())
+			return false;
+
+		value = parse_number<Value> (val());
+		return true;
+	}
+
+
 /**
  * Make NMEA checksum from the input string.
  * \param	data
@@ -135,11 +187,11 @@ make_checksum (std::string const& data);
 
 
 /**
- * Parse header of the sentence and return sentence type.
+ * Parse header of the sentence and return sentence type or std::nullopt if sentence is not supported.
  * String may include the first '$' character of NMEA sentence.
  */
-extern SentenceType
-get_sentence_type (std::string const& sentence);
+extern std::optional<SentenceType>
+get_sentence_type (std::string_view sentence) noexcept;
 
 } // namespace xf::nmea
 
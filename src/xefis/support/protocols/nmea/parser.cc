@@ -14,129 +14,190 @@
 // Standard:
 #include <cstddef>
 
-// Neutrino:
-#include <neutrino/responsibility.h>
-
 // Xefis:
 #include <xefis/config/all.h>
-#include <xefis/utility/hextable.h>
 
 // Local:
 #include "parser.h"
-#include "exceptions.h"
 
 
 namespace xf::nmea {
+namespace {
+
+constexpr std::size_t kInputMask = Parser::kInputBufferSize - 1;
+
 
-static HexTable	$hextable;
+inline std::optional<uint8_t>
+hex_digit_value (char const c) noexcept
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	else if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	else if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	else
+		return std::nullopt;
+}
+
+} // namespace
 
 
 void
 Parser::feed (Blob const& data)
 {
-	_input_buffer.insert (_input_buffer.end(), data.begin(), data.end());
+	for (auto const byte: data)
+	{
+		// Drop everything buffered so far, it's better to lose older data than to corrupt
+		// sentences by cutting out their middle parts:
+		if (_input_size == _input.size())
+		{
+			_input_size = 0;
+			_input_overflow = true;
+		}
+
+		_input[(_input_head + _input_size) & kInputMask] = byte;
+		++_input_size;
+	}
 }
 
 
-std::variant<std::monostate, GPGGA, GPGSA, GPRMC, PMTKACK>
+Parser::Result
 Parser::process_next()
 {
-	// Skip cut-in-half messages, wait for '$' if not yet synchronized:
-	if (!_synchronized)
+	if (_input_overflow)
 	{
-		auto pos = _input_buffer.find ("$");
+		_input_overflow = false;
+		_state = State::WaitForStart;
+		return ParseError::InputOverflow;
+	}
 
-		if (pos == std::string::npos)
-			return std::monostate();
-		else
+	while (_input_size > 0)
+	{
+		char const c = static_cast<char> (_input[_input_head]);
+		_input_head = (_input_head + 1) & kInputMask;
+		--_input_size;
+
+		// '$' always starts a new sentence, which also skips cut-in-half sentences:
+		if (c == '$')
 		{
-			_input_buffer.erase (0, pos);
-			_synchronized = true;
+			start_sentence();
+			continue;
 		}
-	}
 
-	// Process all sentences terminated with "\r\n".
-	constexpr std::string::size_type start = 0;
-	std::string::size_type crlf = 0;
-	std::string::size_type parsed = 0;
+		switch (_state)
+		{
+			case State::WaitForStart:
+				break;
+
+			case State::Contents:
+				if (c == '*')
+				{
+					_has_checksum = true;
+					_state = State::Checksum;
+				}
+				else if (c == '\r' || c == '\n')
+				{
+					_state = State::WaitForStart;
+
+					if (auto result = finish_sentence())
+						return std::move (*result);
+				}
+				else if (c < 0x20 || c > 0x7e || _sentence_size == _sentence.size())
+				{
+					// Binary data or missing sentence end:
+					_state = State::WaitForStart;
+					return ParseError::InvalidSentence;
+				}
+				else
+				{
+					_sentence[_sentence_size++] = c;
+					_computed_checksum ^= static_cast<uint8_t> (c);
+				}
+				break;
+
+			case State::Checksum:
+				if (auto const digit = hex_digit_value (c))
+				{
+					_received_checksum = (_received_checksum << 4) | *digit;
+
+					if (++_checksum_digits == 2)
+						_state = State::WaitForEnd;
+				}
+				else
+				{
+					_state = State::WaitForStart;
+					return ParseError::InvalidSentence;
+				}
+				break;
+
+			case State::WaitForEnd:
+				_state = State::WaitForStart;
+
+				if (c == '\r' || c == '\n')
+				{
+					if (auto result = finish_sentence())
+						return std::move (*result);
+				}
+				else
+					return ParseError::InvalidSentence;
+				break;
+		}
+	}
 
-	// Make sure to remove parsed data from the input buffer:
-	Responsibility remove_parsed_properties ([&] {
-		_input_buffer.erase (0, parsed);
-	});
+	return std::monostate();
+}
 
-	crlf = _input_buffer.find ("\r\n", start);
 
-	if (crlf == std::string::npos)
-		return std::monostate();
+inline void
+Parser::start_sentence() noexcept
+{
+	_state = State::Contents;
+	_sentence_size = 0;
+	_computed_checksum = 0;
+	_received_checksum = 0;
+	_checksum_digits = 0;
+	_has_checksum = false;
+}
 
-	parsed = crlf + 2;
 
-	std::string sentence_str = _input_buffer.substr (start, crlf - start);
-	verify_sentence (sentence_str);
+std::optional<Parser::Result>
+Parser::finish_sentence()
+{
+	if (_has_checksum && _computed_checksum != _received_checksum)
+		return ParseError::InvalidChecksum;
 
-	// Extract sentence contents (strip '$' and checksum).
-	std::string sentence_meat;
-	// Check if we have checksum (this assumes that normal messages never contain
-	// an asterisk and it's a reserved character):
-	if (sentence_str[sentence_str.size() - 3] == '*')
-		sentence_meat = sentence_str.substr (1, sentence_str.size() - 4);
-	else
-		sentence_meat = sentence_str.substr (1);
+	std::string_view const sentence (_sentence.data(), _sentence_size);
 
-	try {
-		switch (get_sentence_type (sentence_str))
+	if (auto const type = get_sentence_type (sentence))
+	{
+		switch (*type)
 		{
 			case SentenceType::GPGGA:
-				return GPGGA (sentence_meat);
+				return GPGGA (sentence);
 
 			case SentenceType::GPGSA:
-				return GPGSA (sentence_meat);
+				return GPGSA (sentence);
 
 			case SentenceType::GPRMC:
-				return GPRMC (sentence_meat);
-
-			case SentenceType::PMTKACK:
-				return PMTKACK (sentence_meat);
-		}
-	}
-	catch (UnsupportedSentenceType const&)
-	{
-		// Ignore unsupported sentences.
-	}
+				return GPRMC (sentence);
 
-	return std::monostate();
-}
+			case SentenceType::GPVTG:
+				return GPVTG (sentence);
 
+			case SentenceType::GPGST:
+				return GPGST (sentence);
 
-void
-Parser::verify_sentence (std::string const& sentence)
-{
-	// Verify checksum:
-	if (sentence.size() < 5)
-		throw nmea::InvalidSentence ("NMEA sentence too short");
-
-	// Prologue:
-	if (sentence[0] != '$')
-		throw nmea::InvalidSentence ("NMEA sentence should start with '$'");
+			case SentenceType::GPZDA:
+				return GPZDA (sentence);
 
-	// Parse checksum if present:
-	if (sentence[sentence.size() - 3] == '*')
-	{
-		char c1 = sentence[sentence.size() - 2];
-		char c2 = sentence[sentence.size() - 1];
-		if (!std::isxdigit (c1) || !std::isxdigit (c2))
-			throw nmea::InvalidSentence ("checksum characters are not valid hex digits");
-		uint8_t parsed_checksum = $hextable[c1] * 16 + $hextable[c2];
-
-		// Verify checksum:
-		uint8_t expected_checksum = 0;
-		for (auto c = sentence.begin() + 1; c != sentence.end() - 3; ++c)
-			expected_checksum ^= *c;
-
-		if (expected_checksum != parsed_checksum)
-			throw nmea::InvalidChecksum (expected_checksum, parsed_checksum);
+			case SentenceType::PMTKACK:
+				return PMTKACK (sentence);
+		}
 	}
+
+	// Ignore unsupported sentences:
+	return std::nullopt;
 }
 
 } // namespace xf::nmea
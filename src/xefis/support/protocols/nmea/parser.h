@@ -16,6 +16,8 @@
 
 // Standard:
 #include <cstddef>
+#include <array>
+#include <optional>
 #include <variant>
 
 // Neutrino:
@@ -24,6 +26,7 @@
 // Xefis:
 #include <xefis/config/all.h>
 #include <xefis/support/protocols/nmea/nmea.h>
+#include <xefis/utility/blob.h>
 
 // Local:
 #include "gps.h"
@@ -33,38 +36,93 @@
 namespace xf::nmea {
 
 /**
- * Parser for NMEA protocol for GPS devices.
+ * Problem with input data detected by the Parser.
+ */
+enum class ParseError
+{
+	InvalidChecksum,	// Sentence with mismatched checksum was dropped.
+	InvalidSentence,	// Malformed or too long sentence was dropped.
+	InputOverflow,		// Data was fed faster than it was processed; buffered data was dropped.
+};
+
+
+/**
+ * Streaming parser for NMEA protocol for GPS devices.
+ *
+ * Input is kept in a fixed-size ring buffer and assembled byte by byte into a fixed-size sentence
+ * buffer, computing the checksum on the way. Sentence fields are tokenized in place. The parser
+ * never throws on invalid input and allocates memory only for the rare PMTK ACK sentence.
  */
 class Parser: private Noncopyable
 {
+  public:
+	// Max size of sentence contents (between '$' and '*'). Standard sentences are at most 82 characters
+	// long including '$', checksum and CR-LF, but proprietary ones may be longer:
+	static constexpr std::size_t	kMaxSentenceSize	= 256;
+	// Must be a power of two:
+	static constexpr std::size_t	kInputBufferSize	= 4096;
+
+	using Result = std::variant<std::monostate, GPGGA, GPGSA, GPRMC, GPVTG, GPGST, GPZDA, PMTKACK, ParseError>;
+
+	static_assert ((kInputBufferSize & (kInputBufferSize - 1)) == 0);
+
   public:
 	/**
 	 * Feed the parser with data received from GPS module.
 	 * Don't parse it and don't call any listeners. For that,
-	 * use the process_one() method.
+	 * use the process_next() method.
+	 * If the input buffer overflows, previously buffered data is dropped.
 	 */
 	void
 	feed (Blob const& gps_data);
 
 	/**
-	 * Parse single sentence from the input buffer.
-	 * \throws	Any exception thrown by sentence constructor.
-	 * \return	True if there was any sentence processed.
+	 * Parse input buffer up to and including the next supported sentence.
+	 * Unsupported sentences are skipped.
+	 *
+	 * Returned sentence refers to the parser's internal buffer and is valid only until the next
+	 * call to process_next().
+	 *
+	 * \return	std::monostate if more data is needed, parsed sentence, or ParseError if invalid
+	 *			data was dropped (parsing can continue after that).
 	 */
-	std::variant<std::monostate, GPGGA, GPGSA, GPRMC, PMTKACK>
+	Result
 	process_next();
 
-  public:
+  private:
+	enum class State
+	{
+		WaitForStart,	// Skip everything until '$'.
+		Contents,		// Between '$' and '*'.
+		Checksum,		// Two hex digits after '*'.
+		WaitForEnd,		// Expect CR or LF after the checksum.
+	};
+
 	/**
-	 * Verify that NMEA sentence is valid and has proper checksum.
-	 * \throws	NMEA exceptions: InvalidType, InvalidChecksum, InvalidMessage.
+	 * Start collecting a new sentence after '$'.
 	 */
 	void
-	verify_sentence (std::string const& sentence);
+	start_sentence() noexcept;
+
+	/**
+	 * Verify the collected sentence and construct its object.
+	 * Return std::nullopt for unsupported sentences.
+	 */
+	std::optional<Result>
+	finish_sentence();
 
   private:
-	std::string		_input_buffer;
-	bool			_synchronized	= false;
+	std::array<uint8_t, kInputBufferSize>	_input;
+	std::size_t								_input_head				{ 0 };
+	std::size_t								_input_size				{ 0 };
+	bool									_input_overflow			{ false };
+	State									_state					{ State::WaitForStart };
+	std::array<char, kMaxSentenceSize>		_sentence;
+	std::size_t								_sentence_size			{ 0 };
+	uint8_t									_computed_checksum		{ 0 };
+	uint8_t									_received_checksum		{ 0 };
+	uint8_t									_checksum_digits		{ 0 };
+	bool									_has_checksum			{ false };
 };
 
 } // namespace xf::nmea
@@ -0,0 +1,172 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Neutrino:
+#include <neutrino/test/auto_test.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/protocols/nmea/parser.h>
+
+
+namespace xf::test {
+namespace {
+
+void
+feed (nmea::Parser& parser, std::string_view const data)
+{
+	parser.feed (Blob (data.begin(), data.end()));
+}
+
+
+template<class Sentence>
+	bool
+	is (nmea::Parser::Result const& result)
+	{
+		return std::holds_alternative<Sentence> (result);
+	}
+
+
+AutoTest t1 ("NMEA: parse GGA and RMC split across feeds", []{
+	nmea::Parser parser;
+
+	feed (parser, "garbage,N*00\r\n$GPGGA,123519.50,4807.038,N,01131.000,E,1,08,0.9,5");
+	test_asserts::verify ("incomplete sentence needs more data", is<std::monostate> (parser.process_next()));
+
+	feed (parser, "45.4,M,46.9,M,,*6C\r\n$GPRMC,123519,A,4807.038,N,01131.000,W,022.4,084.4,230394,003.1,W*78\r\n");
+
+	{
+		auto const result = parser.process_next();
+		test_asserts::verify ("GGA parsed", is<nmea::GPGGA> (result));
+
+		auto const& gga = std::get<nmea::GPGGA> (result);
+		test_asserts::verify ("GGA fix time parsed", gga.fix_time && gga.fix_time->hours == 12 && gga.fix_time->minutes == 35 && gga.fix_time->seconds == 19);
+		test_asserts::verify_equal_with_epsilon ("GGA fix time fraction parsed", gga.fix_time->seconds_fraction, 0.5, 1e-9);
+		test_asserts::verify_equal_with_epsilon ("GGA latitude parsed", *gga.latitude, 48.1173_deg, 0.0001_deg);
+		test_asserts::verify_equal_with_epsilon ("GGA longitude parsed", *gga.longitude, 11.516667_deg, 0.0001_deg);
+		test_asserts::verify ("GGA fix quality parsed", gga.fix_quality == nmea::GPSFixQuality::GPS);
+		test_asserts::verify ("GGA tracked satellites parsed", gga.tracked_satellites == 8u);
+		test_asserts::verify_equal_with_epsilon ("GGA altitude parsed", *gga.altitude_amsl, 545.4_m, 0.01_m);
+		test_asserts::verify ("GGA missing DGPS fields are nil", !gga.dgps_last_update_time && !gga.dgps_station_id);
+	}
+
+	{
+		auto const result = parser.process_next();
+		test_asserts::verify ("RMC parsed", is<nmea::GPRMC> (result));
+
+		auto const& rmc = std::get<nmea::GPRMC> (result);
+		test_asserts::verify ("RMC receiver status parsed", rmc.receiver_status == nmea::GPSReceiverStatus::Active);
+		test_asserts::verify_equal_with_epsilon ("RMC western longitude is negative", *rmc.longitude, -11.516667_deg, 0.0001_deg);
+		test_asserts::verify_equal_with_epsilon ("RMC ground speed parsed", *rmc.ground_speed, 22.4_kt, 0.01_kt);
+		test_asserts::verify ("RMC date parsed", rmc.fix_date && rmc.fix_date->day == 23 && rmc.fix_date->month == 3 && rmc.fix_date->year == 2094);
+		test_asserts::verify_equal_with_epsilon ("RMC western magnetic variation is negative", *rmc.magnetic_variation, -3.1_deg, 0.01_deg);
+	}
+
+	test_asserts::verify ("input is exhausted", is<std::monostate> (parser.process_next()));
+});
+
+
+AutoTest t2 ("NMEA: GN variants, VTG, GST and ZDA; unsupported sentences are skipped", []{
+	nmea::Parser parser;
+
+	feed (parser,
+		  "$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74\r\n"
+		  "$GNGSA,A,3,80,71,73,79,69,,,,,,,,1.83,1.09,1.47*17\r\n"
+		  "$GNVTG,054.7,T,034.4,M,005.5,N,010.2,K,A*3B\r\n"
+		  "$GNGST,172814.0,0.006,0.023,0.020,273.6,0.023,0.020,0.031*74\r\n"
+		  "$GPZDA,201530.00,04,07,2002,-05,30*4B\r\n"
+		  "$PMTK001,314,3*36\r\n");
+
+	{
+		auto const result = parser.process_next();
+		test_asserts::verify ("GSV is skipped and GNGSA parsed", is<nmea::GPGSA> (result));
+
+		auto const& gsa = std::get<nmea::GPGSA> (result);
+		test_asserts::verify ("GSA talker ID is GN", gsa.talker_id() == "GN");
+		test_asserts::verify ("GSA fix mode parsed", gsa.fix_mode == nmea::GPSFixMode::Fix3D);
+		test_asserts::verify ("GSA satellites parsed", gsa.satellites[0] == 80u && gsa.satellites[4] == 69u && !gsa.satellites[5]);
+		test_asserts::verify_equal_with_epsilon ("GSA VDOP parsed", *gsa.vdop, 1.47f, 0.001f);
+	}
+
+	{
+		auto const result = parser.process_next();
+		test_asserts::verify ("VTG parsed", is<nmea::GPVTG> (result));
+
+		auto const& vtg = std::get<nmea::GPVTG> (result);
+		test_asserts::verify_equal_with_epsilon ("VTG true track parsed", *vtg.track_true, 54.7_deg, 0.01_deg);
+		test_asserts::verify_equal_with_epsilon ("VTG magnetic track parsed", *vtg.track_magnetic, 34.4_deg, 0.01_deg);
+		test_asserts::verify_equal_with_epsilon ("VTG ground speed parsed", *vtg.ground_speed, 5.5_kt, 0.01_kt);
+	}
+
+	{
+		auto const result = parser.process_next();
+		test_asserts::verify ("GST parsed", is<nmea::GPGST> (result));
+
+		auto const& gst = std::get<nmea::GPGST> (result);
+		test_asserts::verify_equal_with_epsilon ("GST semi-major orientation parsed", *gst.semi_major_orientation, 273.6_deg, 0.01_deg);
+		test_asserts::verify_equal_with_epsilon ("GST latitude stddev parsed", *gst.latitude_stddev, 0.023_m, 0.0001_m);
+		test_asserts::verify_equal_with_epsilon ("GST altitude stddev parsed", *gst.altitude_stddev, 0.031_m, 0.0001_m);
+	}
+
+	{
+		auto const result = parser.process_next();
+		test_asserts::verify ("ZDA parsed", is<nmea::GPZDA> (result));
+
+		auto const& zda = std::get<nmea::GPZDA> (result);
+		test_asserts::verify ("ZDA time parsed", zda.time && zda.time->hours == 20 && zda.time->minutes == 15 && zda.time->seconds == 30);
+		test_asserts::verify ("ZDA date parsed", zda.date && zda.date->day == 4 && zda.date->month == 7 && zda.date->year == 2002);
+		test_asserts::verify_equal_with_epsilon ("ZDA local zone parsed", *zda.local_zone_offset, -19800_s, 0.1_s);
+	}
+
+	{
+		auto const result = parser.process_next();
+		test_asserts::verify ("PMTK ACK parsed", is<nmea::PMTKACK> (result));
+
+		auto const& ack = std::get<nmea::PMTKACK> (result);
+		test_asserts::verify ("PMTK ACK parsed correctly", ack.command == "314" && ack.result == nmea::MTKResult::Success);
+	}
+});
+
+
+AutoTest t3 ("NMEA: invalid data is reported and parser resynchronizes", []{
+	nmea::Parser parser;
+
+	// Checksum error (6D instead of 6C):
+	feed (parser, "$GPGGA,123519.50,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*6D\r\n");
+	auto const checksum = parser.process_next();
+	test_asserts::verify ("invalid checksum is reported", std::get_if<nmea::ParseError> (&checksum) && *std::get_if<nmea::ParseError> (&checksum) == nmea::ParseError::InvalidChecksum);
+
+	// Binary data inside of a sentence, then a valid sentence:
+	feed (parser, "$GPGGA,\x01\x02\xb5\x62\r\n$PMTK001,314,3*36\r\n");
+	auto const binary = parser.process_next();
+	test_asserts::verify ("binary data is reported", std::get_if<nmea::ParseError> (&binary) && *std::get_if<nmea::ParseError> (&binary) == nmea::ParseError::InvalidSentence);
+	test_asserts::verify ("parser resynchronizes after binary data", is<nmea::PMTKACK> (parser.process_next()));
+
+	// Overflow drops buffered data:
+	feed (parser, "$GPZDA,201530.00,04,07,2002,-05,30*4B\r\n");
+	feed (parser, std::string (nmea::Parser::kInputBufferSize, 'x'));
+	feed (parser, "$PMTK001,314,3*36\r\n");
+	auto const overflow = parser.process_next();
+	test_asserts::verify ("overflow is reported", std::get_if<nmea::ParseError> (&overflow) && *std::get_if<nmea::ParseError> (&overflow) == nmea::ParseError::InputOverflow);
+	test_asserts::verify ("parser resynchronizes after overflow", is<nmea::PMTKACK> (parser.process_next()));
+	test_asserts::verify ("input is exhausted", is<std::monostate> (parser.process_next()));
+});
+
+} // namespace
+} // namespace xf::test
+
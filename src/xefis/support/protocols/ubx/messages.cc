@@ -0,0 +1,133 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+
+// Lib:
+#include <boost/endian/conversion.hpp>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Local:
+#include "messages.h"
+
+
+namespace xf::ubx {
+namespace {
+
+template<class Value>
+	inline Value
+	read_le (uint8_t const* const payload, std::size_t const offset) noexcept
+	{
+		Value value;
+		std::memcpy (&value, payload + offset, sizeof (value));
+		boost::endian::little_to_native_inplace (value);
+		return value;
+	}
+
+} // namespace
+
+
+std::optional<NavPVT>
+NavPVT::parse (Frame const& frame)
+{
+	if (frame.message != Message::NavPVT || frame.payload_size < kMinPayloadSize)
+		return std::nullopt;
+
+	auto const* const p = frame.payload;
+	NavPVT pvt;
+
+	pvt.gps_time_of_week = 1_ms * read_le<uint32_t> (p, 0);
+
+	// Validity flags:
+	auto const valid = p[11];
+	bool const valid_date = valid & 0x01;
+	bool const valid_time = valid & 0x02;
+	bool const fully_resolved = valid & 0x04;
+	bool const valid_magnetic_declination = valid & 0x08;
+
+	if (valid_date && valid_time && fully_resolved)
+	{
+		struct tm timeinfo {};
+		timeinfo.tm_year = read_le<uint16_t> (p, 4) - 1900;
+		timeinfo.tm_mon = p[6] - 1;
+		timeinfo.tm_mday = p[7];
+		timeinfo.tm_hour = p[8];
+		timeinfo.tm_min = p[9];
+		timeinfo.tm_sec = p[10];
+		time_t const seconds = ::timegm (&timeinfo);
+
+		if (seconds > 0)
+			pvt.unix_time = 1_s * seconds + 1e-9_s * read_le<int32_t> (p, 16);
+	}
+
+	pvt.fix_type = static_cast<FixType> (p[20]);
+	pvt.gnss_fix_ok = p[21] & 0x01;
+	pvt.differential = p[21] & 0x02;
+	pvt.satellites = p[23];
+	pvt.longitude = 1e-7_deg * read_le<int32_t> (p, 24);
+	pvt.latitude = 1e-7_deg * read_le<int32_t> (p, 28);
+	pvt.height_above_ellipsoid = 0.001_m * read_le<int32_t> (p, 32);
+	pvt.altitude_amsl = 0.001_m * read_le<int32_t> (p, 36);
+	pvt.horizontal_accuracy = 0.001_m * read_le<uint32_t> (p, 40);
+	pvt.vertical_accuracy = 0.001_m * read_le<uint32_t> (p, 44);
+	pvt.velocity_north = 0.001_mps * read_le<int32_t> (p, 48);
+	pvt.velocity_east = 0.001_mps * read_le<int32_t> (p, 52);
+	pvt.velocity_down = 0.001_mps * read_le<int32_t> (p, 56);
+	pvt.ground_speed = 0.001_mps * read_le<int32_t> (p, 60);
+	pvt.heading_of_motion = 1e-5_deg * read_le<int32_t> (p, 64);
+	pvt.speed_accuracy = 0.001_mps * read_le<uint32_t> (p, 68);
+	pvt.heading_accuracy = 1e-5_deg * read_le<uint32_t> (p, 72);
+	pvt.pdop = 0.01 * read_le<uint16_t> (p, 76);
+
+	if (valid_magnetic_declination && frame.payload_size >= kPayloadSize)
+		pvt.magnetic_declination = 0.01_deg * read_le<int16_t> (p, 88);
+
+	return pvt;
+}
+
+
+bool
+NavPVT::reliable_fix() const noexcept
+{
+	switch (fix_type)
+	{
+		case FixType::Fix2D:
+		case FixType::Fix3D:
+		case FixType::GNSSAndDeadReckoning:
+			return gnss_fix_ok;
+
+		default:
+			return false;
+	}
+}
+
+
+std::optional<Ack>
+Ack::parse (Frame const& frame)
+{
+	if ((frame.message != Message::AckAck && frame.message != Message::AckNak) || frame.payload_size != 2)
+		return std::nullopt;
+
+	Ack ack;
+	ack.acknowledged = frame.message == Message::AckAck;
+	ack.message = static_cast<Message> ((frame.payload[0] << 8) | frame.payload[1]);
+	return ack;
+}
+
+} // namespace xf::ubx
+
@@ -0,0 +1,126 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__PROTOCOLS__UBX__MESSAGES_H__INCLUDED
+#define XEFIS__SUPPORT__PROTOCOLS__UBX__MESSAGES_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Local:
+#include "parser.h"
+#include "ubx.h"
+
+
+namespace xf::ubx {
+
+/**
+ * GNSS fix type reported in NAV-PVT.
+ */
+enum class FixType: uint8_t
+{
+	NoFix					= 0,
+	DeadReckoning			= 1,
+	Fix2D					= 2,
+	Fix3D					= 3,
+	GNSSAndDeadReckoning	= 4,
+	TimeOnly				= 5,
+};
+
+
+/**
+ * NAV-PVT: navigation position, velocity and time solution.
+ * Positions are full-precision (1e-7°, 1 mm), unlike in NMEA sentences.
+ */
+class NavPVT
+{
+  public:
+	// Size of NAV-PVT payload in protocol versions 14…; version 13 lacks the last 8 bytes:
+	static constexpr std::size_t	kPayloadSize	= 92;
+	static constexpr std::size_t	kMinPayloadSize	= 84;
+
+  public:
+	/**
+	 * Decode NAV-PVT frame.
+	 * Return std::nullopt if it's not a NAV-PVT frame or it's too short.
+	 */
+	static std::optional<NavPVT>
+	parse (Frame const&);
+
+	/**
+	 * Return true if the receiver reports a valid 2D or 3D fix.
+	 */
+	[[nodiscard]]
+	bool
+	reliable_fix() const noexcept;
+
+  public:
+	// GPS time of week of the navigation epoch:
+	si::Time					gps_time_of_week;
+	// UTC time of the solution, if date and time are valid and fully resolved:
+	std::optional<si::Time>		unix_time;
+	FixType						fix_type				{ FixType::NoFix };
+	// Fix is within DOP and accuracy masks:
+	bool						gnss_fix_ok				{ false };
+	// Differential corrections were applied:
+	bool						differential			{ false };
+	unsigned int				satellites				{ 0 };
+	si::Angle					latitude;
+	si::Angle					longitude;
+	si::Length					height_above_ellipsoid;
+	si::Length					altitude_amsl;
+	// Estimated standard deviations:
+	si::Length					horizontal_accuracy;
+	si::Length					vertical_accuracy;
+	// NED velocity:
+	si::Velocity				velocity_north;
+	si::Velocity				velocity_east;
+	si::Velocity				velocity_down;
+	si::Velocity				ground_speed;
+	si::Angle					heading_of_motion;
+	si::Velocity				speed_accuracy;
+	si::Angle					heading_accuracy;
+	double						pdop					{ 0.0 };
+	std::optional<si::Angle>	magnetic_declination;
+};
+
+
+/**
+ * ACK-ACK or ACK-NAK: response to a CFG message.
+ */
+class Ack
+{
+  public:
+	/**
+	 * Decode ACK-ACK or ACK-NAK frame.
+	 * Return std::nullopt if it's not an ACK frame or it's malformed.
+	 */
+	static std::optional<Ack>
+	parse (Frame const&);
+
+  public:
+	// False for ACK-NAK:
+	bool	acknowledged	{ false };
+	// Acknowledged message:
+	Message	message;
+};
+
+} // namespace xf::ubx
+
+#endif
+
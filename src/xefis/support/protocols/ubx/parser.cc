@@ -0,0 +1,123 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <algorithm>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Local:
+#include "parser.h"
+
+
+namespace xf::ubx {
+
+Parser::Parser()
+{
+	_input.reserve (kInputBufferSize);
+}
+
+
+void
+Parser::feed (Blob const& data)
+{
+	// Drop already processed data only once in a while or when it's needed to make space for new data,
+	// so that most calls don't move the unprocessed part of the buffer:
+	if (_position == _input.size())
+	{
+		_input.clear();
+		_position = 0;
+	}
+	else if (_position >= kCompactionThreshold || _input.size() + data.size() > kInputBufferSize)
+	{
+		_input.erase (_input.begin(), _input.begin() + _position);
+		_position = 0;
+	}
+
+	if (_input.size() + data.size() > kInputBufferSize)
+	{
+		// It's better to lose older data than to corrupt frames by cutting out their middle parts:
+		_input.clear();
+		_input_overflow = true;
+	}
+
+	auto const to_copy = std::min (data.size(), kInputBufferSize);
+	_input.insert (_input.end(), data.end() - to_copy, data.end());
+}
+
+
+Parser::Result
+Parser::process_next()
+{
+	if (_input_overflow)
+	{
+		_input_overflow = false;
+		return ParseError::InputOverflow;
+	}
+
+	while (true)
+	{
+		auto const sync = std::find (_input.begin() + _position, _input.end(), kSyncChar1);
+		_position = sync - _input.begin();
+
+		auto const available = _input.size() - _position;
+		uint8_t const* const frame = _input.data() + _position;
+
+		if (available < 2)
+			return std::monostate();
+
+		if (frame[1] != kSyncChar2)
+		{
+			++_position;
+			continue;
+		}
+
+		if (available < kHeaderSize)
+			return std::monostate();
+
+		std::size_t const payload_size = frame[4] | (frame[5] << 8);
+
+		if (payload_size > kMaxPayloadSize)
+		{
+			// Could be a false sync sequence; search for the next one:
+			++_position;
+			return ParseError::InvalidLength;
+		}
+
+		std::size_t const frame_size = kHeaderSize + payload_size + kChecksumSize;
+
+		if (available < frame_size)
+			return std::monostate();
+
+		auto const checksum = compute_checksum (frame + 2, kHeaderSize - 2 + payload_size);
+
+		if (checksum.a != frame[kHeaderSize + payload_size] || checksum.b != frame[kHeaderSize + payload_size + 1])
+		{
+			++_position;
+			return ParseError::InvalidChecksum;
+		}
+
+		_position += frame_size;
+
+		return Frame {
+			static_cast<Message> ((frame[2] << 8) | frame[3]),
+			frame + kHeaderSize,
+			payload_size,
+		};
+	}
+}
+
+} // namespace xf::ubx
+
@@ -0,0 +1,107 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__PROTOCOLS__UBX__PARSER_H__INCLUDED
+#define XEFIS__SUPPORT__PROTOCOLS__UBX__PARSER_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <variant>
+
+// Neutrino:
+#include <neutrino/noncopyable.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/utility/blob.h>
+
+// Local:
+#include "ubx.h"
+
+
+namespace xf::ubx {
+
+/**
+ * Problem with input data detected by the Parser.
+ */
+enum class ParseError
+{
+	InvalidChecksum,	// Frame with mismatched checksum was dropped.
+	InvalidLength,		// Frame declaring too long payload was dropped.
+	InputOverflow,		// Data was fed faster than it was processed; buffered data was dropped.
+};
+
+
+/**
+ * Single UBX frame.
+ */
+struct Frame
+{
+	Message			message;
+	// Refers to the Parser's input buffer:
+	uint8_t const*	payload;
+	std::size_t		payload_size;
+};
+
+
+/**
+ * Streaming UBX frame decoder.
+ *
+ * Payloads aren't copied: returned frames refer to the parser's input buffer, which has fixed
+ * capacity and is never reallocated. Data between frames (eg. NMEA sentences) is skipped.
+ */
+class Parser: private Noncopyable
+{
+  public:
+	// Largest payload of supported messages is well below this:
+	static constexpr std::size_t	kMaxPayloadSize			= 1024;
+	static constexpr std::size_t	kInputBufferSize		= 8192;
+	// Processed data is removed from the input buffer once it takes this many bytes:
+	static constexpr std::size_t	kCompactionThreshold	= kInputBufferSize / 2;
+
+	using Result = std::variant<std::monostate, Frame, ParseError>;
+
+  public:
+	// Ctor
+	Parser();
+
+	/**
+	 * Feed the parser with data received from the GPS device.
+	 * Invalidates frames returned earlier by process_next().
+	 * If the input buffer overflows, previously buffered data is dropped.
+	 */
+	void
+	feed (Blob const& gps_data);
+
+	/**
+	 * Decode next frame from the input buffer.
+	 *
+	 * Returned frame is valid only until the next call to feed() or process_next().
+	 *
+	 * \returns	std::monostate if more data is needed, a frame with valid checksum, or ParseError
+	 *			if invalid data was dropped (parsing can continue after that).
+	 */
+	Result
+	process_next();
+
+  private:
+	Blob		_input;
+	// Position of the first byte not processed yet:
+	std::size_t	_position		{ 0 };
+	bool		_input_overflow	{ false };
+};
+
+} // namespace xf::ubx
+
+#endif
+
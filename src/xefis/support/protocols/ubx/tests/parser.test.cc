@@ -0,0 +1,248 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+// Neutrino:
+#include <neutrino/test/auto_test.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/protocols/ubx/messages.h>
+#include <xefis/support/protocols/ubx/parser.h>
+#include <xefis/support/protocols/ubx/ubx.h>
+
+
+namespace xf::test {
+namespace {
+
+template<class Integer>
+	void
+	put_le (Blob& blob, std::size_t const offset, Integer const value)
+	{
+		for (std::size_t i = 0; i < sizeof (Integer); ++i)
+			blob[offset + i] = (value >> (8 * i)) & 0xff;
+	}
+
+
+/**
+ * NAV-PVT frame for 2019-07-04 12:30:15.25 UTC, 3D fix at N 52.2296756° E 21.0122287°.
+ */
+Blob
+make_nav_pvt()
+{
+	Blob payload (ubx::NavPVT::kPayloadSize, 0);
+	put_le<uint32_t> (payload, 0, 390633250);
+	put_le<uint16_t> (payload, 4, 2019);
+	payload[6] = 7;
+	payload[7] = 4;
+	payload[8] = 12;
+	payload[9] = 30;
+	payload[10] = 15;
+	payload[11] = 0x0f;
+	put_le<int32_t> (payload, 16, 250'000'000);
+	payload[20] = 3;
+	payload[21] = 0x01;
+	payload[23] = 14;
+	put_le<int32_t> (payload, 24, 210122287);
+	put_le<int32_t> (payload, 28, 522296756);
+	put_le<int32_t> (payload, 32, 147512);
+	put_le<int32_t> (payload, 36, 113987);
+	put_le<uint32_t> (payload, 40, 1250);
+	put_le<uint32_t> (payload, 44, 2100);
+	put_le<int32_t> (payload, 48, -3000);
+	put_le<int32_t> (payload, 52, 4000);
+	put_le<int32_t> (payload, 56, 120);
+	put_le<int32_t> (payload, 60, 5000);
+	put_le<int32_t> (payload, 64, 12686990);
+	put_le<uint16_t> (payload, 76, 154);
+	put_le<int16_t> (payload, 88, -512);
+	return ubx::make_frame (ubx::Message::NavPVT, payload);
+}
+
+
+/**
+ * Stands in for the serial device: replays recorded data in chunks of given size, like
+ * consecutive serial port reads, and collects everything the parser returns.
+ */
+class Replay
+{
+  public:
+	explicit
+	Replay (Blob const& recording, std::size_t chunk_size)
+	{
+		for (std::size_t pos = 0; pos < recording.size(); pos += chunk_size)
+		{
+			auto const end = std::min (pos + chunk_size, recording.size());
+			_parser.feed (Blob (recording.begin() + pos, recording.begin() + end));
+			drain();
+		}
+	}
+
+	std::vector<ubx::NavPVT>		pvts;
+	std::vector<ubx::Ack>			acks;
+	std::vector<ubx::ParseError>	errors;
+
+  private:
+	void
+	drain()
+	{
+		while (true)
+		{
+			auto const result = _parser.process_next();
+
+			if (auto const* frame = std::get_if<ubx::Frame> (&result))
+			{
+				if (auto pvt = ubx::NavPVT::parse (*frame))
+					pvts.push_back (*pvt);
+				else if (auto ack = ubx::Ack::parse (*frame))
+					acks.push_back (*ack);
+			}
+			else if (auto const* error = std::get_if<ubx::ParseError> (&result))
+				errors.push_back (*error);
+			else
+				break;
+		}
+	}
+
+  private:
+	ubx::Parser	_parser;
+};
+
+
+void
+append (Blob& blob, Blob const& data)
+{
+	blob.insert (blob.end(), data.begin(), data.end());
+}
+
+
+void
+append (Blob& blob, std::string_view const data)
+{
+	blob.insert (blob.end(), data.begin(), data.end());
+}
+
+
+AutoTest t1 ("UBX: frame checksums", []{
+	test_asserts::verify ("CFG-RATE frame is correct",
+						  ubx::make_cfg_rate (10_Hz) == Blob { 0xb5, 0x62, 0x06, 0x08, 0x06, 0x00, 0x64, 0x00, 0x01, 0x00, 0x01, 0x00, 0x7a, 0x12 });
+	test_asserts::verify ("CFG-MSG frame is correct",
+						  ubx::make_cfg_msg (ubx::Message::NavPVT, 1) == Blob { 0xb5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x07, 0x01, 0x13, 0x51 });
+
+	bool thrown = false;
+
+	try {
+		ubx::make_cfg_rate (0_Hz);
+	}
+	catch (InvalidArgument const&)
+	{
+		thrown = true;
+	}
+
+	test_asserts::verify ("zero navigation rate is rejected", thrown);
+});
+
+
+AutoTest t2 ("UBX: replay of mixed UBX/NMEA data", []{
+	Blob recording;
+	// Device still outputs NMEA just after the configuration change:
+	append (recording, "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n");
+	append (recording, ubx::make_frame (ubx::Message::AckAck, { 0x06, 0x00 }));
+	append (recording, make_nav_pvt());
+	// Corrupted frame:
+	auto corrupted = make_nav_pvt();
+	corrupted[30] ^= 0x10;
+	append (recording, corrupted);
+	append (recording, ubx::make_frame (ubx::Message::AckNak, { 0x06, 0x08 }));
+	append (recording, make_nav_pvt());
+
+	for (std::size_t chunk_size: { 1u, 7u, 64u, 4096u })
+	{
+		Replay const replay (recording, chunk_size);
+
+		test_asserts::verify ("all valid NAV-PVT frames decoded", replay.pvts.size() == 2);
+		test_asserts::verify ("corrupted frame detected", replay.errors.size() == 1 && replay.errors[0] == ubx::ParseError::InvalidChecksum);
+		test_asserts::verify ("ACKs decoded", replay.acks.size() == 2);
+		test_asserts::verify ("ACK-ACK decoded", replay.acks[0].acknowledged && replay.acks[0].message == ubx::Message::CfgPrt);
+		test_asserts::verify ("ACK-NAK decoded", !replay.acks[1].acknowledged && replay.acks[1].message == ubx::Message::CfgRate);
+
+		auto const& pvt = replay.pvts[1];
+		test_asserts::verify ("fix is reliable", pvt.reliable_fix() && pvt.fix_type == ubx::FixType::Fix3D);
+		test_asserts::verify ("satellites decoded", pvt.satellites == 14);
+		test_asserts::verify ("UTC time decoded", pvt.unix_time.has_value());
+		test_asserts::verify_equal_with_epsilon ("UTC time is correct", *pvt.unix_time, 1562243415.25_s, 1e-6_s);
+		test_asserts::verify_equal_with_epsilon ("latitude decoded", pvt.latitude, 52.2296756_deg, 1e-9_deg);
+		test_asserts::verify_equal_with_epsilon ("longitude decoded", pvt.longitude, 21.0122287_deg, 1e-9_deg);
+		test_asserts::verify_equal_with_epsilon ("altitude decoded", pvt.altitude_amsl, 113.987_m, 1e-6_m);
+		test_asserts::verify_equal_with_epsilon ("horizontal accuracy decoded", pvt.horizontal_accuracy, 1.25_m, 1e-6_m);
+		test_asserts::verify_equal_with_epsilon ("north velocity decoded", pvt.velocity_north, -3_mps, 1e-6_mps);
+		test_asserts::verify_equal_with_epsilon ("ground speed decoded", pvt.ground_speed, 5_mps, 1e-6_mps);
+		test_asserts::verify_equal_with_epsilon ("heading decoded", pvt.heading_of_motion, 126.8699_deg, 1e-4_deg);
+		test_asserts::verify_equal_with_epsilon ("PDOP decoded", pvt.pdop, 1.54, 1e-9);
+		test_asserts::verify ("magnetic declination decoded", pvt.magnetic_declination.has_value());
+		test_asserts::verify_equal_with_epsilon ("magnetic declination is correct", *pvt.magnetic_declination, -5.12_deg, 1e-6_deg);
+	}
+});
+
+
+AutoTest t3 ("UBX: invalid length and input overflow", []{
+	ubx::Parser parser;
+
+	// Frame declaring 0xffff bytes of payload:
+	parser.feed ({ 0xb5, 0x62, 0x01, 0x07, 0xff, 0xff, 0x00 });
+	auto const invalid_length = parser.process_next();
+	test_asserts::verify ("invalid length detected", std::get_if<ubx::ParseError> (&invalid_length) && *std::get_if<ubx::ParseError> (&invalid_length) == ubx::ParseError::InvalidLength);
+	test_asserts::verify ("parser resynchronizes after invalid length", std::holds_alternative<std::monostate> (parser.process_next()));
+
+	// Incomplete frame followed by too much data:
+	auto const frame = make_nav_pvt();
+	parser.feed (Blob (frame.begin(), frame.begin() + 50));
+	test_asserts::verify ("incomplete frame needs more data", std::holds_alternative<std::monostate> (parser.process_next()));
+	parser.feed (Blob (ubx::Parser::kInputBufferSize, 0x00));
+	parser.feed (frame);
+	auto const overflow = parser.process_next();
+	test_asserts::verify ("overflow detected", std::get_if<ubx::ParseError> (&overflow) && *std::get_if<ubx::ParseError> (&overflow) == ubx::ParseError::InputOverflow);
+
+	auto const next = parser.process_next();
+	test_asserts::verify ("parser resynchronizes after overflow", std::get_if<ubx::Frame> (&next) && ubx::NavPVT::parse (*std::get_if<ubx::Frame> (&next)));
+});
+
+
+AutoTest t4 ("UBX: long stream is parsed across input buffer compactions", []{
+	// Enough data to fill the input buffer a few times:
+	auto const frames = 3 * ubx::Parser::kInputBufferSize / make_nav_pvt().size();
+	Blob recording;
+
+	for (std::size_t i = 0; i < frames; ++i)
+	{
+		append (recording, make_nav_pvt());
+		append (recording, "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n");
+	}
+
+	for (std::size_t chunk_size: { 13u, 100u, 1000u })
+	{
+		Replay const replay (recording, chunk_size);
+
+		test_asserts::verify ("all NAV-PVT frames decoded", replay.pvts.size() == frames);
+		test_asserts::verify ("no errors", replay.errors.empty());
+	}
+});
+
+} // namespace
+} // namespace xf::test
+
@@ -0,0 +1,150 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <cmath>
+
+// Lib:
+#include <boost/format.hpp>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Local:
+#include "ubx.h"
+
+
+namespace xf::ubx {
+namespace {
+
+template<class Integer>
+	void
+	append_le (Blob& blob, Integer value)
+	{
+		for (std::size_t i = 0; i < sizeof (Integer); ++i)
+			blob.push_back ((value >> (8 * i)) & 0xff);
+	}
+
+} // namespace
+
+
+Checksum
+compute_checksum (uint8_t const* data, std::size_t const size) noexcept
+{
+	Checksum checksum;
+
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		checksum.a += data[i];
+		checksum.b += checksum.a;
+	}
+
+	return checksum;
+}
+
+
+Blob
+make_frame (Message const message, Blob const& payload)
+{
+	Blob frame;
+	frame.reserve (kHeaderSize + payload.size() + kChecksumSize);
+	frame.push_back (kSyncChar1);
+	frame.push_back (kSyncChar2);
+	frame.push_back (message_class (message));
+	frame.push_back (message_id (message));
+	append_le<uint16_t> (frame, payload.size());
+	frame.insert (frame.end(), payload.begin(), payload.end());
+
+	// Checksum doesn't include sync chars:
+	auto const checksum = compute_checksum (frame.data() + 2, frame.size() - 2);
+	frame.push_back (checksum.a);
+	frame.push_back (checksum.b);
+
+	return frame;
+}
+
+
+Blob
+make_cfg_prt_uart (unsigned int const baud_rate)
+{
+	Blob payload;
+	payload.reserve (20);
+	// Port ID (UART1), reserved, txReady:
+	append_le<uint8_t> (payload, 1);
+	append_le<uint8_t> (payload, 0);
+	append_le<uint16_t> (payload, 0);
+	// Mode: 8 data bits, no parity, 1 stop bit:
+	append_le<uint32_t> (payload, 0x000008d0);
+	append_le<uint32_t> (payload, baud_rate);
+	// Input protocols: UBX and NMEA; output protocols: UBX:
+	append_le<uint16_t> (payload, 0x0003);
+	append_le<uint16_t> (payload, 0x0001);
+	// Flags, reserved:
+	append_le<uint16_t> (payload, 0);
+	append_le<uint16_t> (payload, 0);
+
+	return make_frame (Message::CfgPrt, payload);
+}
+
+
+Blob
+make_cfg_rate (si::Frequency const navigation_rate)
+{
+	if (!(navigation_rate > 0_Hz))
+		throw InvalidArgument ("CFG-RATE: navigation rate must be positive");
+
+	auto const period_ms = std::lround ((1.0 / navigation_rate).in<si::Millisecond>());
+
+	if (period_ms < 1 || period_ms > 0xffff)
+		throw InvalidArgument ("CFG-RATE: navigation rate out of range");
+
+	auto const measurement_period_ms = static_cast<uint16_t> (period_ms);
+
+	Blob payload;
+	payload.reserve (6);
+	append_le<uint16_t> (payload, measurement_period_ms);
+	// One navigation solution per measurement:
+	append_le<uint16_t> (payload, 1);
+	// Align measurements to GPS time:
+	append_le<uint16_t> (payload, 1);
+
+	return make_frame (Message::CfgRate, payload);
+}
+
+
+Blob
+make_cfg_msg (Message const message, uint8_t const rate)
+{
+	return make_frame (Message::CfgMsg, { message_class (message), message_id (message), rate });
+}
+
+
+std::string
+to_string (Message const message)
+{
+	switch (message)
+	{
+		case Message::NavPVT:	return "NAV-PVT";
+		case Message::AckNak:	return "ACK-NAK";
+		case Message::AckAck:	return "ACK-ACK";
+		case Message::CfgPrt:	return "CFG-PRT";
+		case Message::CfgMsg:	return "CFG-MSG";
+		case Message::CfgRate:	return "CFG-RATE";
+	}
+
+	return (boost::format ("%02x-%02x") % static_cast<int> (message_class (message)) % static_cast<int> (message_id (message))).str();
+}
+
+} // namespace xf::ubx
+
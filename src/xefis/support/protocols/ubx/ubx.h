@@ -0,0 +1,133 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__PROTOCOLS__UBX__UBX_H__INCLUDED
+#define XEFIS__SUPPORT__PROTOCOLS__UBX__UBX_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/utility/blob.h>
+
+
+/**
+ * Support for the u-blox binary protocol (UBX).
+ *
+ * Frame format: 0xb5 0x62 <class> <id> <length:u16le> <payload> <ck_a> <ck_b>.
+ * Checksum is 8-bit Fletcher computed over class, id, length and payload.
+ */
+namespace xf::ubx {
+
+static constexpr uint8_t		kSyncChar1		= 0xb5;
+static constexpr uint8_t		kSyncChar2		= 0x62;
+// Sync chars, class, id and length:
+static constexpr std::size_t	kHeaderSize		= 6;
+static constexpr std::size_t	kChecksumSize	= 2;
+
+
+/**
+ * Message class and ID combined as (class << 8) | id.
+ */
+enum class Message: uint16_t
+{
+	NavPVT	= 0x0107,
+	AckNak	= 0x0500,
+	AckAck	= 0x0501,
+	CfgPrt	= 0x0600,
+	CfgMsg	= 0x0601,
+	CfgRate	= 0x0608,
+};
+
+
+struct Checksum
+{
+	uint8_t	a	{ 0 };
+	uint8_t	b	{ 0 };
+};
+
+
+/**
+ * Return message class byte.
+ */
+constexpr uint8_t
+message_class (Message message) noexcept
+{
+	return static_cast<uint16_t> (message) >> 8;
+}
+
+
+/**
+ * Return message ID byte.
+ */
+constexpr uint8_t
+message_id (Message message) noexcept
+{
+	return static_cast<uint16_t> (message) & 0xff;
+}
+
+
+/**
+ * Compute Fletcher checksum of given data (class, id, length and payload).
+ */
+Checksum
+compute_checksum (uint8_t const* data, std::size_t size) noexcept;
+
+
+/**
+ * Make complete frame with given payload.
+ */
+Blob
+make_frame (Message, Blob const& payload);
+
+
+/**
+ * Make CFG-PRT message that configures the UART1 port for 8N1 at given baud rate,
+ * accepting UBX and NMEA input and producing UBX output only.
+ */
+Blob
+make_cfg_prt_uart (unsigned int baud_rate);
+
+
+/**
+ * Make CFG-RATE message that sets navigation solution rate.
+ *
+ * \throws	InvalidArgument if the rate isn't positive or the measurement period doesn't fit in the message.
+ */
+Blob
+make_cfg_rate (si::Frequency navigation_rate);
+
+
+/**
+ * Make CFG-MSG message that sets output rate of a message on the current port.
+ *
+ * \param	rate
+ *			Output the message every rate navigation solutions, 0 disables it.
+ */
+Blob
+make_cfg_msg (Message, uint8_t rate);
+
+
+/**
+ * Return human-readable name of a message, eg. "NAV-PVT".
+ */
+std::string
+to_string (Message);
+
+} // namespace xf::ubx
+
+#endif
+
@@ -0,0 +1,103 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+
+// Qt:
+#include <QtCore/QEvent>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Local:
+#include "visibility_refresher.h"
+
+
+namespace xf {
+
+VisibilityRefresher::VisibilityRefresher (QWidget& widget, si::Frequency const rate, Callback callback):
+	QObject (&widget),
+	_widget (widget),
+	_callback (std::move (callback))
+{
+	_periodic_timer = new QTimer (this);
+	_periodic_timer->setSingleShot (false);
+	QObject::connect (_periodic_timer, &QTimer::timeout, this, &VisibilityRefresher::refresh);
+	set_rate (rate);
+
+	_request_timer = new QTimer (this);
+	_request_timer->setSingleShot (true);
+	_request_timer->setInterval (0);
+	QObject::connect (_request_timer, &QTimer::timeout, this, &VisibilityRefresher::refresh);
+
+	_widget.installEventFilter (this);
+
+	if (_widget.isVisible())
+	{
+		_periodic_timer->start();
+		request();
+	}
+}
+
+
+void
+VisibilityRefresher::set_rate (si::Frequency const rate)
+{
+	_periodic_timer->setInterval (1000_Hz / rate);
+}
+
+
+void
+VisibilityRefresher::request()
+{
+	if (_widget.isVisible() && !_request_timer->isActive())
+		_request_timer->start();
+}
+
+
+bool
+VisibilityRefresher::eventFilter (QObject* object, QEvent* event)
+{
+	if (object == &_widget)
+	{
+		switch (event->type())
+		{
+			case QEvent::Show:
+				_periodic_timer->start();
+				_request_timer->start();
+				break;
+
+			case QEvent::Hide:
+				_periodic_timer->stop();
+				_request_timer->stop();
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	return QObject::eventFilter (object, event);
+}
+
+
+void
+VisibilityRefresher::refresh()
+{
+	_request_timer->stop();
+	_callback();
+}
+
+} // namespace xf
+
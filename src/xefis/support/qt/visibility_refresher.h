@@ -0,0 +1,81 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__QT__VISIBILITY_REFRESHER_H__INCLUDED
+#define XEFIS__SUPPORT__QT__VISIBILITY_REFRESHER_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <functional>
+
+// Qt:
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+#include <QtWidgets/QWidget>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+
+namespace xf {
+
+/**
+ * Calls a refresh function periodically, but only while given widget is visible.
+ * Refreshes immediately when the widget is shown. Additional refreshes can be requested
+ * with request(); multiple requests made before returning to the event loop are coalesced
+ * into one refresh.
+ *
+ * The object is a child of the widget and is deleted with it.
+ */
+class VisibilityRefresher: public QObject
+{
+  public:
+	using Callback = std::function<void()>;
+
+  public:
+	// Ctor
+	explicit
+	VisibilityRefresher (QWidget& widget, si::Frequency rate, Callback);
+
+	/**
+	 * Change the rate of periodic refreshes.
+	 */
+	void
+	set_rate (si::Frequency);
+
+	/**
+	 * Refresh as soon as possible, if the widget is visible.
+	 */
+	void
+	request();
+
+  protected:
+	// QObject API
+	bool
+	eventFilter (QObject*, QEvent*) override;
+
+  private:
+	void
+	refresh();
+
+  private:
+	QWidget&	_widget;
+	Callback	_callback;
+	QTimer*		_periodic_timer;
+	QTimer*		_request_timer;
+};
+
+} // namespace xf
+
+#endif
+
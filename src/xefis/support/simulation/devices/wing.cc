@@ -16,6 +16,7 @@
 
 // Xefis:
 #include <xefis/config/all.h>
+#include <xefis/support/earth/air/tabulated_atmosphere.h>
 #include <xefis/support/math/geometry.h>
 #include <xefis/support/geometry/triangle.h>
 #include <xefis/support/geometry/triangulation.h>
@@ -44,7 +45,7 @@ Wing::Wing (Airfoil const& airfoil, si::Density const material_density):
 void
 Wing::update_external_forces()
 {
-	StandardAtmosphere _standard_atmosphere; // FIXME should be provided from outside.
+	auto const& atmosphere = tabulated_standard_atmosphere(); // FIXME should be provided from outside.
 	// TODO Create special UnitMatrix<TF, SF> which only changes the frame, and operator* that doesn't really compute anything
 	// Rotations:
 	auto const world_to_ecef = RotationMatrix<ECEFSpace, rigid_body::WorldSpace> (math::unit);
@@ -57,8 +58,8 @@ Wing::update_external_forces()
 	auto const body_velocity_in_ecef = world_to_ecef * velocity_moments<rigid_body::WorldSpace>().velocity();
 	// FIXME take velocity_moments().angular_velocity() into account
 
-	auto const air = _standard_atmosphere.air_at (body_position_in_ecef);
-	auto const ecef_wind = _standard_atmosphere.wind_at (body_position_in_ecef) - body_velocity_in_ecef;
+	auto const air = atmosphere.air_at (body_position_in_ecef);
+	auto const ecef_wind = atmosphere.wind_at (body_position_in_ecef) - body_velocity_in_ecef;
 	auto const spline_wind = ecef_to_spline * ecef_wind;
 	auto const atmosphere_state = AtmosphereState<AirfoilSplineSpace> { air, spline_wind };
 	AngleOfAttack aoa;
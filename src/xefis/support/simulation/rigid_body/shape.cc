@@ -23,6 +23,29 @@
 
 namespace xf::rigid_body {
 
+Shape::Shape (Shape&& other) noexcept:
+	_triangles (std::move (other._triangles)),
+	_triangle_strips (std::move (other._triangle_strips)),
+	_triangle_fans (std::move (other._triangle_fans)),
+	_generation (other._generation)
+{
+	// Moved-from shape has different contents now:
+	other.touch();
+}
+
+
+Shape&
+Shape::operator= (Shape&& other) noexcept
+{
+	_triangles = std::move (other._triangles);
+	_triangle_strips = std::move (other._triangle_strips);
+	_triangle_fans = std::move (other._triangle_fans);
+	_generation = other._generation;
+	other.touch();
+	return *this;
+}
+
+
 void
 Shape::rotate (RotationMatrix<BodySpace> const& rotation)
 {
@@ -44,6 +67,8 @@ Shape::translate (SpaceLength<BodySpace> const& translation)
 void
 Shape::for_all_vertices (std::function<void (ShapeVertex&)> const vertex_function)
 {
+	touch();
+
 	for (auto& geometry: _triangles)
 		for (auto& vertex: geometry)
 			vertex_function (vertex);
@@ -16,6 +16,8 @@
 
 // Standard:
 #include <cstddef>
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <vector>
 
@@ -39,12 +41,39 @@ class Shape
 	using TriangleFan	= std::vector<ShapeVertex>;
 
   public:
+	// Ctor
+	Shape() = default;
+
+	// Copy ctor
+	Shape (Shape const&) = default;
+
+	// Move ctor
+	Shape (Shape&&) noexcept;
+
+	// Copy operator
+	Shape&
+	operator= (Shape const&) = default;
+
+	// Move operator
+	Shape&
+	operator= (Shape&&) noexcept;
+
+	/**
+	 * Return number identifying contents of the shape. Shapes with equal generations have equal contents,
+	 * so it can be used as a cache key. It changes on every non-const access to the shape, so references
+	 * returned by non-const accessors must not be used to modify the shape after generation() was read.
+	 */
+	[[nodiscard]]
+	uint64_t
+	generation() const noexcept
+		{ return _generation; }
+
 	/**
 	 * Return vector of triangles.
 	 */
 	std::vector<Triangle>&
 	triangles() noexcept
-		{ return _triangles; }
+		{ touch(); return _triangles; }
 
 	/**
 	 * Return vector of triangles.
@@ -59,7 +88,7 @@ class Shape
 	 */
 	std::vector<TriangleStrip>&
 	triangle_strips() noexcept
-		{ return _triangle_strips; }
+		{ touch(); return _triangle_strips; }
 
 	/**
 	 * Return vector of triangle strips.
@@ -75,7 +104,7 @@ class Shape
 	 */
 	std::vector<TriangleFan>&
 	triangle_fans() noexcept
-		{ return _triangle_fans; }
+		{ touch(); return _triangle_fans; }
 
 	/**
 	 * Return vector of triangle fans.
@@ -103,9 +132,25 @@ class Shape
 	for_all_vertices (std::function<void (ShapeVertex&)>);
 
   private:
+	/**
+	 * Assign new generation number.
+	 */
+	void
+	touch() noexcept
+		{ _generation = next_generation(); }
+
+	[[nodiscard]]
+	static uint64_t
+	next_generation() noexcept
+		{ return _next_generation.fetch_add (1, std::memory_order_relaxed); }
+
+  private:
+	static inline std::atomic<uint64_t>	_next_generation	{ 1 };
+
 	std::vector<Triangle>		_triangles;
 	std::vector<TriangleStrip>	_triangle_strips;
 	std::vector<TriangleFan>	_triangle_fans;
+	uint64_t					_generation			{ next_generation() };
 };
 
 
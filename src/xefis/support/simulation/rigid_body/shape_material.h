@@ -121,6 +121,10 @@ class ShapeMaterial
 	set_fog_distance (float distance) noexcept
 		{ _fog_distance = distance; }
 
+	[[nodiscard]]
+	bool
+	operator== (ShapeMaterial const&) const = default;
+
   private:
 	QColor	_emission_color	{ 0x00, 0x00, 0x00, 0xff };
 	QColor	_ambient_color	{ 0xff, 0xff, 0xff, 0xff };
@@ -0,0 +1,130 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <algorithm>
+#include <utility>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/math/geometry.h>
+
+// Local:
+#include "system_snapshot.h"
+
+
+namespace xf::rigid_body {
+
+void
+SystemSnapshot::capture (System const& system, si::Time const simulation_time)
+{
+	auto const& bodies = system.bodies();
+
+	_simulation_time = simulation_time;
+	_bodies.resize (bodies.size());
+
+	for (std::size_t i = 0; i < bodies.size(); ++i)
+	{
+		auto const& body = *bodies[i];
+		auto& state = _bodies[i];
+
+		state.body = &body;
+		state.location = body.location();
+		state.mass = body.mass_moments<BodySpace>().mass();
+
+		if (body.shape_is_constant())
+			state.changing_shape.reset();
+		else
+			state.changing_shape = body.shape();
+	}
+}
+
+
+SystemSnapshot::BodyState const*
+SystemSnapshot::find (Body const* body) const noexcept
+{
+	auto const found = std::find_if (_bodies.begin(), _bodies.end(), [body] (BodyState const& state) {
+		return state.body == body;
+	});
+
+	return found != _bodies.end() ? &*found : nullptr;
+}
+
+
+void
+SystemSnapshot::interpolate (SystemSnapshot const& from, SystemSnapshot const& to, si::Time const time, SystemSnapshot& result)
+{
+	result = to;
+
+	auto const span = to._simulation_time - from._simulation_time;
+
+	if (from._bodies.size() != to._bodies.size() || span <= 0_s)
+		return;
+
+	auto const f = std::clamp ((time - from._simulation_time) / span, 0.0, 1.0);
+
+	if (f == 1.0)
+		return;
+
+	result._simulation_time = from._simulation_time + f * span;
+
+	for (std::size_t i = 0; i < to._bodies.size(); ++i)
+	{
+		auto const& a = from._bodies[i];
+		auto const& b = to._bodies[i];
+
+		if (a.body != b.body)
+			continue;
+
+		auto const& la = a.location;
+		auto const& lb = b.location;
+		auto const position = la.position() + f * (lb.position() - la.position());
+		// Rotate by a fraction of the rotation between snapshots:
+		auto const rotation_between = lb.body_to_base_rotation() * la.base_to_body_rotation();
+		auto const rotation = to_rotation_matrix (f * to_rotation_vector (rotation_between)) * la.body_to_base_rotation();
+
+		result._bodies[i].location = PositionRotation<WorldSpace, BodySpace> (position, rotation);
+	}
+}
+
+
+void
+SystemSnapshotBuffer::publish (System const& system, si::Time const simulation_time)
+{
+	_back.capture (system, simulation_time);
+
+	std::lock_guard lock (_mutex);
+	// Old _previous becomes the new back buffer, so its memory is reused:
+	std::swap (_previous, _latest);
+	std::swap (_latest, _back);
+	++_serial;
+}
+
+
+bool
+SystemSnapshotBuffer::read (SystemSnapshot& previous, SystemSnapshot& latest, std::uint64_t& serial) const
+{
+	std::lock_guard lock (_mutex);
+
+	if (serial == _serial)
+		return false;
+
+	previous = _previous;
+	latest = _latest;
+	serial = _serial;
+	return true;
+}
+
+} // namespace xf::rigid_body
+
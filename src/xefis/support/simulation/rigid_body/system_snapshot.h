@@ -0,0 +1,135 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__SIMULATION__RIGID_BODY__SYSTEM_SNAPSHOT_H__INCLUDED
+#define XEFIS__SUPPORT__SIMULATION__RIGID_BODY__SYSTEM_SNAPSHOT_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+// Neutrino:
+#include <neutrino/noncopyable.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/math/position_rotation.h>
+#include <xefis/support/simulation/rigid_body/body.h>
+#include <xefis/support/simulation/rigid_body/frames.h>
+#include <xefis/support/simulation/rigid_body/shape.h>
+#include <xefis/support/simulation/rigid_body/system.h>
+
+
+namespace xf::rigid_body {
+
+/**
+ * Copy of the state of System's bodies needed to display them, taken at some simulation time.
+ * Allows painting the system in a different thread than the one that evolves it.
+ */
+class SystemSnapshot
+{
+  public:
+	struct BodyState
+	{
+		// Used only as an identifier and to access immutable body properties (like constant shapes):
+		Body const*								body;
+		PositionRotation<WorldSpace, BodySpace>	location;
+		si::Mass								mass;
+		// Copy of the shape for bodies which shape changes (std::nullopt for constant shapes, which are
+		// taken from the body):
+		std::optional<Shape>					changing_shape;
+	};
+
+  public:
+	/**
+	 * Copy state of all bodies of the system.
+	 * Reuses already allocated memory.
+	 */
+	void
+	capture (System const&, si::Time simulation_time);
+
+	/**
+	 * Return simulation time at which the snapshot was taken.
+	 */
+	[[nodiscard]]
+	si::Time
+	simulation_time() const noexcept
+		{ return _simulation_time; }
+
+	/**
+	 * Return state of all bodies, in the order of System::bodies().
+	 */
+	[[nodiscard]]
+	std::vector<BodyState> const&
+	bodies() const noexcept
+		{ return _bodies; }
+
+	/**
+	 * Return state of given body or nullptr if the body isn't in the snapshot.
+	 */
+	[[nodiscard]]
+	BodyState const*
+	find (Body const*) const noexcept;
+
+	/**
+	 * Set result to a snapshot with body locations interpolated between two snapshots for given simulation time.
+	 * Time is clamped to the range between snapshots. If both snapshots don't contain the same bodies,
+	 * result is a copy of the later snapshot.
+	 */
+	static void
+	interpolate (SystemSnapshot const& from, SystemSnapshot const& to, si::Time time, SystemSnapshot& result);
+
+  private:
+	si::Time				_simulation_time	{ 0_s };
+	std::vector<BodyState>	_bodies;
+};
+
+
+/**
+ * Passes snapshots from the thread that evolves the system to the thread that paints it.
+ * Snapshot is captured into a back buffer without locking and then swapped with the front buffers,
+ * so neither thread waits for the other more than it takes to swap (or copy when reading) the buffers.
+ * Two latest snapshots are kept, so that reader can interpolate between them.
+ */
+class SystemSnapshotBuffer: private Noncopyable
+{
+  public:
+	/**
+	 * Capture and publish new snapshot of the system.
+	 * Must be called from one thread at a time (usually the simulation thread).
+	 */
+	void
+	publish (System const&, si::Time simulation_time);
+
+	/**
+	 * Copy two latest snapshots, if anything was published since the serial number passed in.
+	 * Update serial number and return true if snapshots were copied.
+	 */
+	bool
+	read (SystemSnapshot& previous, SystemSnapshot& latest, std::uint64_t& serial) const;
+
+  private:
+	SystemSnapshot		_back;
+	mutable std::mutex	_mutex;
+	SystemSnapshot		_previous;
+	SystemSnapshot		_latest;
+	std::uint64_t		_serial		{ 0 };
+};
+
+} // namespace xf::rigid_body
+
+#endif
+
@@ -0,0 +1,83 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <chrono>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Local:
+#include "simulation_thread.h"
+
+
+namespace xf {
+
+SimulationThread::SimulationThread (Simulation& simulation, si::Frequency const step_frequency, si::Time const real_time_limit, Published const published):
+	_simulation (simulation),
+	_step_period (1 / step_frequency),
+	_real_time_limit (real_time_limit),
+	_published (published),
+	_thread (&SimulationThread::run, this)
+{ }
+
+
+SimulationThread::~SimulationThread()
+{
+	_stop.store (true);
+	_thread.join();
+}
+
+
+void
+SimulationThread::run()
+{
+	using Clock = std::chrono::steady_clock;
+
+	auto const period = std::chrono::duration_cast<Clock::duration> (std::chrono::duration<double> (_step_period.in<si::Second>()));
+	auto next_step = Clock::now();
+
+	if (_published)
+		_published (_simulation.time());
+
+	while (!_stop.load())
+	{
+		bool evolved = true;
+
+		if (!_paused.load())
+			_simulation.evolve (_step_period, _real_time_limit);
+		else if (_pending_steps.load() > 0)
+		{
+			--_pending_steps;
+			_simulation.evolve (_step_period, _real_time_limit);
+		}
+		else
+			evolved = false;
+
+		if (evolved && _published)
+			_published (_simulation.time());
+
+		next_step += period;
+		auto const now = Clock::now();
+
+		// Don't try to catch up after being stalled for a long time:
+		if (now - next_step > 10 * period)
+			next_step = now;
+
+		std::this_thread::sleep_until (next_step);
+	}
+}
+
+} // namespace xf
+
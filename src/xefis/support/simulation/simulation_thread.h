@@ -0,0 +1,102 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__SIMULATION__SIMULATION_THREAD_H__INCLUDED
+#define XEFIS__SUPPORT__SIMULATION__SIMULATION_THREAD_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+// Neutrino:
+#include <neutrino/noncopyable.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/simulation/simulation.h>
+
+
+namespace xf {
+
+/**
+ * Runs Simulation in real time in a separate thread, independently of any UI refresh rate.
+ * After each step the Published function is called, eg. to publish a rigid_body::SystemSnapshot for display.
+ *
+ * Thread starts paused.
+ */
+class SimulationThread: private Noncopyable
+{
+  public:
+	// Called in the simulation thread after each step (and once at start):
+	using Published = std::function<void (si::Time simulation_time)>;
+
+  public:
+	/**
+	 * Ctor
+	 * Start the thread.
+	 *
+	 * \param	step_frequency
+	 *			How often to evolve the simulation and call published function. The simulation itself
+	 *			can use smaller Δt, which is configured in Simulation.
+	 * \param	real_time_limit
+	 *			Maximum time spent on a single step (see Simulation::evolve()).
+	 */
+	explicit
+	SimulationThread (Simulation&, si::Frequency step_frequency, si::Time real_time_limit, Published);
+
+	// Dtor
+	~SimulationThread();
+
+	/**
+	 * Return true if simulation is paused.
+	 */
+	[[nodiscard]]
+	bool
+	paused() const noexcept
+		{ return _paused.load(); }
+
+	/**
+	 * Pause or resume simulation. Real time that passes while paused is not simulated.
+	 */
+	void
+	set_paused (bool paused) noexcept
+		{ _paused.store (paused); }
+
+	/**
+	 * Evolve paused simulation by a single step.
+	 */
+	void
+	step() noexcept
+		{ ++_pending_steps; }
+
+  private:
+	void
+	run();
+
+  private:
+	Simulation&					_simulation;
+	si::Time					_step_period;
+	si::Time					_real_time_limit;
+	Published					_published;
+	std::atomic<bool>			_paused			{ true };
+	std::atomic<bool>			_stop			{ false };
+	std::atomic<unsigned int>	_pending_steps	{ 0 };
+	std::thread					_thread;
+};
+
+} // namespace xf
+
+#endif
+
@@ -0,0 +1,221 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Local:
+#include "audio_mixer.h"
+
+
+namespace xf {
+
+AudioMixer::Voice::Voice (std::shared_ptr<Samples const> samples, Priority const priority, Preemption const preemption):
+	_samples (std::move (samples)),
+	_priority (priority),
+	_preemption (preemption)
+{ }
+
+
+AudioMixer::AudioMixer (std::size_t const max_voices):
+	_max_voices (std::max<std::size_t> (max_voices, 1))
+{
+	_voices.reserve (_max_voices);
+}
+
+
+void
+AudioMixer::add (std::shared_ptr<Voice> voice)
+{
+	if (!voice->_samples || voice->_samples->empty() || voice->_stop_requested.load())
+	{
+		reject (*voice);
+		return;
+	}
+
+	auto const is_finished = [](auto const& v) { return v->finished(); };
+
+	if (voice->_preemption == Preemption::StopLowerPriority)
+	{
+		for (auto& v: _voices)
+			if (v->_priority < voice->_priority)
+				reject (*v);
+
+		std::erase_if (_voices, is_finished);
+	}
+
+	if (_voices.size() >= _max_voices)
+	{
+		// Preempt the oldest of the lowest-priority voices:
+		auto const lowest = std::min_element (_voices.begin(), _voices.end(), [](auto const& a, auto const& b) {
+			return a->_priority < b->_priority;
+		});
+
+		if ((*lowest)->_priority > voice->_priority)
+		{
+			reject (*voice);
+			return;
+		}
+
+		reject (**lowest);
+		_voices.erase (lowest);
+	}
+
+	_voices.push_back (std::move (voice));
+}
+
+
+void
+AudioMixer::mix (float* const output, std::size_t const frames)
+{
+	std::fill (output, output + frames, 0.0f);
+
+	for (auto& voice: _voices)
+	{
+		if (voice->_stop_requested.load())
+		{
+			reject (*voice);
+			continue;
+		}
+
+		auto const& samples = *voice->_samples;
+		auto const n = std::min (frames, samples.size() - voice->_position);
+		float const* const source = samples.data() + voice->_position;
+
+		for (std::size_t i = 0; i < n; ++i)
+			output[i] += source[i];
+
+		voice->_position += n;
+
+		if (voice->_position == samples.size())
+			reject (*voice);
+	}
+
+	std::erase_if (_voices, [](auto const& v) { return v->finished(); });
+}
+
+
+void
+AudioMixer::to_s16 (float const* const input, int16_t* const output, std::size_t const count) noexcept
+{
+	for (std::size_t i = 0; i < count; ++i)
+		output[i] = static_cast<int16_t> (std::lround (std::clamp (input[i], -1.0f, 1.0f) * 32767.0f));
+}
+
+
+AudioMixer::Samples
+AudioMixer::decode_wave (Blob const& wave)
+{
+	auto const read_u16 = [&wave] (std::size_t const pos) -> uint32_t {
+		return wave[pos] | (wave[pos + 1] << 8);
+	};
+
+	auto const read_u32 = [&] (std::size_t const pos) -> uint32_t {
+		return read_u16 (pos) | (read_u16 (pos + 2) << 16);
+	};
+
+	auto const tag_is = [&wave] (std::size_t const pos, std::string_view const tag) {
+		return std::equal (tag.begin(), tag.end(), wave.begin() + pos);
+	};
+
+	if (wave.size() < 12 || !tag_is (0, "RIFF") || !tag_is (8, "WAVE"))
+		throw Exception ("not a RIFF/WAVE file");
+
+	uint32_t channels = 0;
+	uint32_t sample_rate = 0;
+	uint32_t bits_per_sample = 0;
+	std::size_t data_begin = 0;
+	std::size_t data_size = 0;
+
+	for (std::size_t pos = 12; pos + 8 <= wave.size(); )
+	{
+		auto const chunk_size = std::min<std::size_t> (read_u32 (pos + 4), wave.size() - pos - 8);
+
+		if (tag_is (pos, "fmt "))
+		{
+			if (chunk_size < 16)
+				throw Exception ("invalid WAVE fmt chunk");
+
+			if (read_u16 (pos + 8) != 1)
+				throw Exception ("only PCM WAVE files are supported");
+
+			channels = read_u16 (pos + 10);
+			sample_rate = read_u32 (pos + 12);
+			bits_per_sample = read_u16 (pos + 22);
+		}
+		else if (tag_is (pos, "data"))
+		{
+			data_begin = pos + 8;
+			data_size = chunk_size;
+		}
+
+		// Chunks are padded to even sizes:
+		pos += 8 + chunk_size + (chunk_size & 1);
+	}
+
+	if (channels == 0 || sample_rate == 0 || (bits_per_sample != 8 && bits_per_sample != 16))
+		throw Exception ("unsupported WAVE format");
+
+	std::size_t const bytes_per_frame = channels * bits_per_sample / 8;
+	std::size_t const input_frames = data_size / bytes_per_frame;
+
+	// Downmix to mono:
+	Samples mono (input_frames);
+
+	for (std::size_t f = 0; f < input_frames; ++f)
+	{
+		float sum = 0.0f;
+
+		for (std::size_t c = 0; c < channels; ++c)
+		{
+			auto const pos = data_begin + f * bytes_per_frame + c * bits_per_sample / 8;
+
+			if (bits_per_sample == 8)
+				sum += (static_cast<float> (wave[pos]) - 128.0f) / 128.0f;
+			else
+				sum += static_cast<float> (static_cast<int16_t> (read_u16 (pos))) / 32768.0f;
+		}
+
+		mono[f] = sum / channels;
+	}
+
+	if (sample_rate == kSampleRate || mono.empty())
+		return mono;
+
+	// Resample with linear interpolation:
+	double const step = static_cast<double> (sample_rate) / kSampleRate;
+	auto const output_frames = static_cast<std::size_t> (std::floor ((mono.size() - 1) / step)) + 1;
+	Samples result (output_frames);
+
+	for (std::size_t i = 0; i < output_frames; ++i)
+	{
+		double const position = i * step;
+		auto const index = static_cast<std::size_t> (position);
+		auto const next = std::min (index + 1, mono.size() - 1);
+		auto const fraction = static_cast<float> (position - index);
+
+		result[i] = mono[index] + fraction * (mono[next] - mono[index]);
+	}
+
+	return result;
+}
+
+} // namespace xf
+
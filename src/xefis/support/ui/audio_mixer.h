@@ -0,0 +1,160 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__UI__AUDIO_MIXER_H__INCLUDED
+#define XEFIS__SUPPORT__UI__AUDIO_MIXER_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Neutrino:
+#include <neutrino/noncopyable.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/utility/blob.h>
+
+
+namespace xf {
+
+/**
+ * Mixes overlapping sounds into a single mono stream.
+ * Limits number of simultaneously playing voices; when the limit is reached, new voices preempt
+ * playing voices of lower or equal priority.
+ *
+ * add() and mix() must be called from the same thread (the audio thread). Voice::stop() and
+ * Voice::finished() can be called from any thread. Doesn't allocate memory in mix().
+ */
+class AudioMixer: private Noncopyable
+{
+  public:
+	static constexpr unsigned int	kSampleRate			= 48000;
+	static constexpr std::size_t	kDefaultMaxVoices	= 8;
+
+	// Mono samples at kSampleRate, normalized to [-1, 1]:
+	using Samples	= std::vector<float>;
+	// Higher values are more important:
+	using Priority	= int;
+
+	enum class Preemption
+	{
+		// Play along with other voices:
+		None,
+		// Stop all playing voices with lower priority:
+		StopLowerPriority,
+	};
+
+	/**
+	 * A single playing sound.
+	 */
+	class Voice: private Noncopyable
+	{
+		friend class AudioMixer;
+
+	  public:
+		// Ctor
+		explicit
+		Voice (std::shared_ptr<Samples const>, Priority = 0, Preemption = Preemption::None);
+
+		/**
+		 * Return true if sound has finished playing, was stopped or preempted.
+		 */
+		[[nodiscard]]
+		bool
+		finished() const noexcept
+			{ return _finished.load(); }
+
+		/**
+		 * Stop the sound.
+		 */
+		void
+		stop() noexcept
+			{ _stop_requested.store (true); }
+
+		/**
+		 * Return priority of the sound.
+		 */
+		[[nodiscard]]
+		Priority
+		priority() const noexcept
+			{ return _priority; }
+
+	  private:
+		std::shared_ptr<Samples const>	_samples;
+		Priority						_priority;
+		Preemption						_preemption;
+		// Used only by the audio thread:
+		std::size_t						_position		{ 0 };
+		std::atomic<bool>				_finished		{ false };
+		std::atomic<bool>				_stop_requested	{ false };
+	};
+
+  public:
+	// Ctor
+	explicit
+	AudioMixer (std::size_t max_voices = kDefaultMaxVoices);
+
+	/**
+	 * Start playing a voice. It might preempt other voices or be rejected itself if all voices
+	 * have higher priority.
+	 */
+	void
+	add (std::shared_ptr<Voice>);
+
+	/**
+	 * Mark a voice that couldn't be passed to the mixer as finished.
+	 */
+	static void
+	reject (Voice& voice) noexcept
+		{ voice._finished.store (true); }
+
+	/**
+	 * Mix next frames of all playing voices into output.
+	 */
+	void
+	mix (float* output, std::size_t frames);
+
+	/**
+	 * Return number of currently playing voices.
+	 */
+	[[nodiscard]]
+	std::size_t
+	playing() const noexcept
+		{ return _voices.size(); }
+
+	/**
+	 * Convert float samples to signed 16-bit samples with clipping.
+	 */
+	static void
+	to_s16 (float const* input, int16_t* output, std::size_t count) noexcept;
+
+	/**
+	 * Decode WAV file contents (8- or 16-bit PCM, any number of channels and any sample rate)
+	 * into Samples. Throws xf::Exception on unsupported or invalid data.
+	 */
+	static Samples
+	decode_wave (Blob const&);
+
+  private:
+	std::size_t							_max_voices;
+	std::vector<std::shared_ptr<Voice>>	_voices;
+};
+
+} // namespace xf
+
+#endif
+
@@ -74,6 +74,22 @@ GLAnimationWindow::set_refresh_rate (RefreshRate const refresh_rate)
 }
 
 
+void
+GLAnimationWindow::with_context (std::function<void()> const function)
+{
+	if (_open_gl_context)
+	{
+		if (_open_gl_context->makeCurrent (this))
+		{
+			function();
+			_open_gl_context->doneCurrent();
+		}
+		else
+			std::cerr << "Could not make OpenGL context current.\n";
+	}
+}
+
+
 void
 GLAnimationWindow::refresh()
 {
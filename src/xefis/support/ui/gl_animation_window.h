@@ -16,6 +16,7 @@
 
 // Standard:
 #include <cstddef>
+#include <functional>
 #include <variant>
 
 // Qt:
@@ -67,6 +68,14 @@ class GLAnimationWindow: public QWindow
 	void
 	set_refresh_rate (RefreshRate);
 
+  protected:
+	/**
+	 * Make the OpenGL context current and call given function, eg. to release OpenGL resources
+	 * before the context is destroyed. Function is not called if the context hasn't been created yet.
+	 */
+	void
+	with_context (std::function<void()>);
+
   private:
 	void
 	refresh();
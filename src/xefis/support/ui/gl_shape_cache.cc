@@ -0,0 +1,280 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+
+// Lib:
+#include <boost/functional/hash.hpp>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Local:
+#include "gl_shape_cache.h"
+
+
+namespace xf {
+
+std::size_t
+GLShapeBuffer::Geometry::hash() const noexcept
+{
+	std::size_t seed = 0;
+
+	for (auto const value: vertices)
+		boost::hash_combine (seed, value);
+
+	for (auto const& call: draw_calls)
+	{
+		boost::hash_combine (seed, call.mode);
+		boost::hash_combine (seed, call.first);
+		boost::hash_combine (seed, call.count);
+		boost::hash_combine (seed, call.material_index);
+	}
+
+	return seed;
+}
+
+
+GLShapeBuffer::GLShapeBuffer (Geometry&& geometry):
+	_context (QOpenGLContext::currentContext()),
+	_geometry (std::move (geometry))
+{
+	if (!_context)
+		throw InvalidCall ("GLShapeBuffer: no current OpenGL context");
+
+	gl().glGenBuffers (1, &_buffer);
+	gl().glBindBuffer (GL_ARRAY_BUFFER, _buffer);
+	gl().glBufferData (GL_ARRAY_BUFFER, _geometry.vertices.size() * sizeof (GLfloat), _geometry.vertices.data(), GL_STATIC_DRAW);
+	gl().glBindBuffer (GL_ARRAY_BUFFER, 0);
+}
+
+
+GLShapeBuffer::~GLShapeBuffer()
+{
+	// Deleting the buffer in another context (or without any) would delete some other buffer or fail:
+	if (_buffer && _context && QOpenGLContext::currentContext() == _context)
+		gl().glDeleteBuffers (1, &_buffer);
+}
+
+
+std::optional<GLShapeBuffer::Geometry>
+GLShapeBuffer::make_geometry (rigid_body::Shape const& shape, decltype (1 / 1_m) const position_scale)
+{
+	Geometry geometry;
+	// Like OpenGL, reuse last normal for vertices that don't have one:
+	SpaceVector<double, rigid_body::BodySpace> normal { 0.0, 0.0, 1.0 };
+
+	auto const material_index_for = [&geometry] (rigid_body::ShapeMaterial const& material) -> std::size_t
+	{
+		auto const found = std::find (geometry.materials.begin(), geometry.materials.end(), material);
+
+		if (found != geometry.materials.end())
+			return std::distance (geometry.materials.begin(), found);
+
+		geometry.materials.push_back (material);
+		return geometry.materials.size() - 1;
+	};
+
+	auto const add_primitive = [&] (GLenum const mode, std::vector<rigid_body::ShapeVertex> const& vertices, std::size_t const count) -> bool
+	{
+		if (count == 0)
+			return true;
+
+		auto const& material = vertices.front().material();
+		bool const uniform_material = std::all_of (vertices.begin(), vertices.begin() + count, [&material] (auto const& vertex) {
+			return vertex.material() == material;
+		});
+
+		if (!uniform_material)
+			return false;
+
+		auto const material_index = material_index_for (material);
+		auto const first = static_cast<GLint> (geometry.vertices.size() / kFloatsPerVertex);
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			auto const& vertex = vertices[i];
+
+			if (auto const& vertex_normal = vertex.normal())
+				normal = *vertex_normal;
+
+			SpaceVector<double, rigid_body::BodySpace> const position = vertex.position() * position_scale;
+
+			geometry.vertices.insert (geometry.vertices.end(), {
+				static_cast<GLfloat> (position[0]),
+				static_cast<GLfloat> (position[1]),
+				static_cast<GLfloat> (position[2]),
+				static_cast<GLfloat> (normal[0]),
+				static_cast<GLfloat> (normal[1]),
+				static_cast<GLfloat> (normal[2]),
+			});
+		}
+
+		// Consecutive triangles with the same material can be drawn with one call:
+		if (mode == GL_TRIANGLES && !geometry.draw_calls.empty())
+		{
+			auto& last = geometry.draw_calls.back();
+
+			if (last.mode == GL_TRIANGLES && last.material_index == material_index && last.first + last.count == first)
+			{
+				last.count += count;
+				return true;
+			}
+		}
+
+		geometry.draw_calls.push_back ({ mode, first, static_cast<GLsizei> (count), material_index });
+		return true;
+	};
+
+	// Incomplete triangles are skipped by OpenGL in immediate mode, skip them here too:
+	for (auto const& triangle: shape.triangles())
+		if (!add_primitive (GL_TRIANGLES, triangle, triangle.size() - triangle.size() % 3))
+			return std::nullopt;
+
+	for (auto const& strip: shape.triangle_strips())
+		if (!add_primitive (GL_TRIANGLE_STRIP, strip, strip.size() >= 3 ? strip.size() : 0))
+			return std::nullopt;
+
+	for (auto const& fan: shape.triangle_fans())
+		if (!add_primitive (GL_TRIANGLE_FAN, fan, fan.size() >= 3 ? fan.size() : 0))
+			return std::nullopt;
+
+	return geometry;
+}
+
+
+void
+GLShapeBuffer::bind() const
+{
+	constexpr GLsizei stride = kFloatsPerVertex * sizeof (GLfloat);
+
+	gl().glBindBuffer (GL_ARRAY_BUFFER, _buffer);
+	glEnableClientState (GL_VERTEX_ARRAY);
+	glEnableClientState (GL_NORMAL_ARRAY);
+	glVertexPointer (3, GL_FLOAT, stride, nullptr);
+	glNormalPointer (GL_FLOAT, stride, reinterpret_cast<GLvoid const*> (3 * sizeof (GLfloat)));
+	_material_set = false;
+}
+
+
+void
+GLShapeBuffer::unbind() const
+{
+	glDisableClientState (GL_NORMAL_ARRAY);
+	glDisableClientState (GL_VERTEX_ARRAY);
+	gl().glBindBuffer (GL_ARRAY_BUFFER, 0);
+}
+
+
+void
+GLShapeBuffer::draw() const
+{
+	for (auto const& call: _geometry.draw_calls)
+	{
+		if (!_material_set || call.material_index != _current_material_index)
+		{
+			GLSpace::set_material (_geometry.materials[call.material_index]);
+			_current_material_index = call.material_index;
+			_material_set = true;
+		}
+
+		glDrawArrays (call.mode, call.first, call.count);
+	}
+}
+
+
+GLShapeCache::GLShapeCache (decltype (1 / 1_m) const position_scale):
+	_position_scale (position_scale)
+{ }
+
+
+GLShapeBuffer const*
+GLShapeCache::get (rigid_body::Shape const& shape)
+{
+	auto entry_it = _entries.find (shape.generation());
+
+	if (entry_it == _entries.end())
+		entry_it = _entries.emplace (shape.generation(), make_entry (shape)).first;
+
+	entry_it->second.used = true;
+	return entry_it->second.buffer.get();
+}
+
+
+void
+GLShapeCache::collect_garbage()
+{
+	std::erase_if (_entries, [](auto const& pair) {
+		return !pair.second.used;
+	});
+
+	for (auto& pair: _entries)
+		pair.second.used = false;
+
+	std::erase_if (_buffers_by_hash, [](auto const& pair) {
+		return pair.second.expired();
+	});
+}
+
+
+void
+GLShapeCache::clear()
+{
+	_entries.clear();
+	_buffers_by_hash.clear();
+}
+
+
+std::size_t
+GLShapeCache::buffers_count() const
+{
+	return std::count_if (_buffers_by_hash.begin(), _buffers_by_hash.end(), [](auto const& pair) {
+		return !pair.second.expired();
+	});
+}
+
+
+GLShapeCache::Entry
+GLShapeCache::make_entry (rigid_body::Shape const& shape)
+{
+	Entry entry {
+		.buffer = nullptr,
+		.used = false,
+	};
+
+	if (auto geometry = GLShapeBuffer::make_geometry (shape, _position_scale))
+	{
+		auto const hash = geometry->hash();
+		auto const [begin, end] = _buffers_by_hash.equal_range (hash);
+
+		for (auto it = begin; it != end; ++it)
+		{
+			if (auto buffer = it->second.lock(); buffer && buffer->geometry() == *geometry)
+			{
+				entry.buffer = buffer;
+				return entry;
+			}
+		}
+
+		entry.buffer = std::make_shared<GLShapeBuffer> (std::move (*geometry));
+		_buffers_by_hash.emplace (hash, entry.buffer);
+	}
+
+	return entry;
+}
+
+} // namespace xf
+
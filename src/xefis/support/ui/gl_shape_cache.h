@@ -0,0 +1,228 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__UI__GL_SHAPE_CACHE_H__INCLUDED
+#define XEFIS__SUPPORT__UI__GL_SHAPE_CACHE_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Qt:
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+
+// Neutrino:
+#include <neutrino/noncopyable.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/simulation/rigid_body/shape.h>
+#include <xefis/support/simulation/rigid_body/shape_material.h>
+#include <xefis/support/ui/gl_space.h>
+
+
+namespace xf {
+
+/**
+ * Shape uploaded once to an OpenGL vertex buffer object, so that drawing it doesn't require
+ * pushing every vertex through immediate-mode calls.
+ *
+ * Materials are applied between draw calls, so only shapes that have constant material within each
+ * triangle, strip or fan can be buffered (see make_geometry()).
+ *
+ * OpenGL context used to create the buffer must be current when the buffer is used. If it's not current
+ * when the buffer is destroyed, the buffer is left to be released together with the context.
+ * Buffer functions (OpenGL 1.5) are called through the context's QOpenGLFunctions.
+ */
+class GLShapeBuffer: private Noncopyable
+{
+  public:
+	/**
+	 * Single glDrawArrays() call.
+	 */
+	struct DrawCall
+	{
+		GLenum		mode;
+		GLint		first;
+		GLsizei		count;
+		std::size_t	material_index;
+
+		[[nodiscard]]
+		bool
+		operator== (DrawCall const&) const = default;
+	};
+
+	/**
+	 * Shape converted to OpenGL vertex arrays, before being uploaded to the GPU.
+	 */
+	struct Geometry
+	{
+		// Interleaved vertex positions and normals, 6 floats per vertex:
+		std::vector<GLfloat>					vertices;
+		std::vector<DrawCall>					draw_calls;
+		std::vector<rigid_body::ShapeMaterial>	materials;
+
+		/**
+		 * Return hash of vertices and draw calls.
+		 * Used to find other shapes with the same geometry.
+		 */
+		[[nodiscard]]
+		std::size_t
+		hash() const noexcept;
+
+		[[nodiscard]]
+		bool
+		operator== (Geometry const&) const = default;
+	};
+
+	static constexpr std::size_t kFloatsPerVertex = 6;
+
+  public:
+	// Ctor
+	explicit
+	GLShapeBuffer (Geometry&&);
+
+	// Dtor
+	~GLShapeBuffer();
+
+	/**
+	 * Convert shape to vertex arrays. Positions are scaled by position_scale, same as in GLSpace.
+	 * Return std::nullopt if the shape can't be buffered, because its material changes within
+	 * a single triangle, strip or fan.
+	 */
+	[[nodiscard]]
+	static std::optional<Geometry>
+	make_geometry (rigid_body::Shape const&, decltype (1 / 1_m) position_scale);
+
+	/**
+	 * Return geometry stored in the buffer.
+	 */
+	[[nodiscard]]
+	Geometry const&
+	geometry() const noexcept
+		{ return _geometry; }
+
+	/**
+	 * Bind the buffer and set up vertex and normal arrays.
+	 * After binding, draw() can be called any number of times, eg. once for each body using the same shape.
+	 */
+	void
+	bind() const;
+
+	/**
+	 * Unbind any bound buffer and disable vertex arrays.
+	 */
+	void
+	unbind() const;
+
+	/**
+	 * Draw the shape with current OpenGL matrix. Buffer must be bound.
+	 */
+	void
+	draw() const;
+
+  private:
+	/**
+	 * Return OpenGL functions of the context used to create the buffer.
+	 */
+	[[nodiscard]]
+	QOpenGLFunctions&
+	gl() const
+		{ return *_context->functions(); }
+
+  private:
+	GLuint					_buffer					{ 0 };
+	QOpenGLContext*			_context				{ nullptr };
+	Geometry				_geometry;
+	// Index of the material set by last draw() since bind(), to avoid setting it again:
+	mutable std::size_t		_current_material_index	{ 0 };
+	mutable bool			_material_set			{ false };
+};
+
+
+/**
+ * Vertex buffers of shapes, keyed by shape generation (see rigid_body::Shape::generation()), so that
+ * a modified shape or another Shape object is never mistaken for a cached one.
+ * Shapes with identical geometry (eg. same wing segments used by many bodies) share one buffer,
+ * so that all of them can be drawn with a single bind and only the matrix changing in between.
+ *
+ * Best used for shapes that don't change (see rigid_body::Body::shape_is_constant()).
+ * OpenGL context used for painting must be current when calling any method except buffers_count().
+ */
+class GLShapeCache: private Noncopyable
+{
+  public:
+	// Ctor
+	explicit
+	GLShapeCache (decltype (1 / 1_m) position_scale);
+
+	/**
+	 * Return buffer for given shape, uploading the shape if necessary.
+	 * Return nullptr if the shape can't be buffered; in such case use GLSpace::draw().
+	 */
+	[[nodiscard]]
+	GLShapeBuffer const*
+	get (rigid_body::Shape const&);
+
+	/**
+	 * Drop buffers of shapes that weren't requested with get() since previous call to this function.
+	 * Should be called once per frame.
+	 */
+	void
+	collect_garbage();
+
+	/**
+	 * Drop all buffers. Should be called by the owner of the OpenGL context before the context is destroyed.
+	 */
+	void
+	clear();
+
+	/**
+	 * Return number of distinct buffers.
+	 */
+	[[nodiscard]]
+	std::size_t
+	buffers_count() const;
+
+  private:
+	struct Entry
+	{
+		// Nullptr if shape can't be buffered:
+		std::shared_ptr<GLShapeBuffer>	buffer;
+		bool							used;
+	};
+
+  private:
+	/**
+	 * Make new entry for given shape, reusing existing buffer if there's one with the same geometry.
+	 */
+	[[nodiscard]]
+	Entry
+	make_entry (rigid_body::Shape const&);
+
+  private:
+	decltype (1 / 1_m)														_position_scale;
+	std::map<uint64_t, Entry>												_entries;
+	std::unordered_multimap<std::size_t, std::weak_ptr<GLShapeBuffer>>	_buffers_by_hash;
+};
+
+} // namespace xf
+
+#endif
+
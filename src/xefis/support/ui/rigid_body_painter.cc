@@ -13,6 +13,8 @@
 
 // Standard:
 #include <cstddef>
+#include <algorithm>
+#include <functional>
 
 // System:
 #include <GL/gl.h>
@@ -45,14 +47,61 @@ namespace xf {
 
 RigidBodyPainter::RigidBodyPainter (si::PixelDensity const pixel_density):
 	_pixel_density (pixel_density),
-	_gl (pixel_density * kDefaultPositionScale)
+	_gl (pixel_density * kDefaultPositionScale),
+	_shape_cache (pixel_density * kDefaultPositionScale),
+	_unit_cube (rigid_body::make_cube_shape (1_m))
 { }
 
 
 void
 RigidBodyPainter::paint (rigid_body::System const& system, QOpenGLPaintDevice& canvas)
+{
+	_system = &system;
+	_body_views.clear();
+
+	for (auto const& body: system.bodies())
+	{
+		auto const& shape = body->shape();
+		auto const mass = body->mass_moments<rigid_body::BodySpace>().mass();
+
+		_body_views.push_back ({ body.get(), &body->location(), mass, shape ? &*shape : nullptr });
+	}
+
+	paint_scene (canvas);
+}
+
+
+void
+RigidBodyPainter::paint (rigid_body::SystemSnapshot const& snapshot, QOpenGLPaintDevice& canvas)
+{
+	_system = nullptr;
+	_body_views.clear();
+
+	for (auto const& state: snapshot.bodies())
+	{
+		rigid_body::Shape const* shape = nullptr;
+
+		// Constant shapes are never modified, so they can be read from the body:
+		if (state.body->shape_is_constant())
+		{
+			if (auto const& body_shape = state.body->shape())
+				shape = &*body_shape;
+		}
+		else if (state.changing_shape)
+			shape = &*state.changing_shape;
+
+		_body_views.push_back ({ state.body, &state.location, state.mass, shape });
+	}
+
+	paint_scene (canvas);
+}
+
+
+void
+RigidBodyPainter::paint_scene (QOpenGLPaintDevice& canvas)
 {
 	initializeOpenGLFunctions();
+	update_followed_body_position();
 
 	QPainter painter (&canvas);
 	QRectF rect (0, 0, canvas.width(), canvas.height());
@@ -66,7 +115,7 @@ RigidBodyPainter::paint (rigid_body::System const& system, QOpenGLPaintDevice& c
 	painter.translate (center);
 	painter.beginNativePainting();
 	setup (canvas);
-	paint_world (system, canvas);
+	paint_world (canvas);
 	paint_ecef_basis (canvas);
 	painter.endNativePainting();
 }
@@ -147,10 +196,10 @@ RigidBodyPainter::setup_light()
 
 
 void
-RigidBodyPainter::paint_world (rigid_body::System const& system, QOpenGLPaintDevice& canvas)
+RigidBodyPainter::paint_world (QOpenGLPaintDevice& canvas)
 {
 	paint_planet();
-	paint_system (system, canvas);
+	paint_system (canvas);
 }
 
 
@@ -304,7 +353,7 @@ RigidBodyPainter::paint_planet()
 
 
 void
-RigidBodyPainter::paint_system (rigid_body::System const& system, QOpenGLPaintDevice&)
+RigidBodyPainter::paint_system (QOpenGLPaintDevice&)
 {
 	glDisable (GL_FOG);
 
@@ -312,40 +361,108 @@ RigidBodyPainter::paint_system (rigid_body::System const& system, QOpenGLPaintDe
 		setup_camera();
 		setup_light();
 
-		for (auto const& body: system.bodies())
-			paint_body (*body);
+		paint_bodies();
 
-		if (constraints_visible())
-			for (auto const& constraint: system.constraints())
-				paint_constraint (*constraint);
+		// Constraints and forces are only available when painting the System itself:
+		if (_system)
+		{
+			if (constraints_visible())
+				for (auto const& constraint: _system->constraints())
+					paint_constraint (*constraint);
 
-		if (forces_visible())
-			for (auto const& body: system.bodies())
-				paint_forces (*body);
+			if (forces_visible())
+				for (auto const& body: _system->bodies())
+					paint_forces (*body);
+		}
 	});
+
+	_shape_cache.collect_garbage();
 }
 
 
 void
-RigidBodyPainter::paint_body (rigid_body::Body const& body)
+RigidBodyPainter::paint_bodies()
 {
-	_gl.save_matrix ([&] {
-		auto const translation = body.location().position() - followed_body_position();
+	_body_instances.clear();
 
-		_gl.translate (translation);
-		_gl.rotate (body.location().base_to_body_rotation());
+	for (auto const& view: _body_views)
+	{
+		if (view.shape)
+		{
+			if (view.body->shape_is_constant())
+			{
+				if (auto const* buffer = _shape_cache.get (*view.shape))
+				{
+					_body_instances.push_back ({ buffer, &view, 1.0f });
+					continue;
+				}
+			}
 
-		if (auto const& shape = body.shape())
-			_gl.draw (*shape);
+			paint_body (view);
+		}
+		else if (auto const* buffer = _shape_cache.get (_unit_cube))
+			_body_instances.push_back ({ buffer, &view, static_cast<float> (cube_edge_for (view.mass) / 1_m) });
 		else
+			paint_body (view);
+	}
+
+	std::sort (_body_instances.begin(), _body_instances.end(), [](auto const& a, auto const& b) {
+		return std::less<GLShapeBuffer const*>() (a.buffer, b.buffer);
+	});
+
+	for (auto instance = _body_instances.begin(); instance != _body_instances.end(); )
+	{
+		auto const* buffer = instance->buffer;
+		buffer->bind();
+
+		for (; instance != _body_instances.end() && instance->buffer == buffer; ++instance)
 		{
-			auto const edge = _mass_scale * 1_kg * std::pow (body.mass_moments<rigid_body::BodySpace>().mass() / 1_kg, 1.0 / 3);
-			_gl.draw (rigid_body::make_cube_shape (edge));
+			_gl.save_matrix ([&] {
+				transform_to_body (*instance->view->location);
+
+				if (instance->scale != 1.0f)
+					glScalef (instance->scale, instance->scale, instance->scale);
+
+				buffer->draw();
+			});
 		}
+
+		buffer->unbind();
+	}
+}
+
+
+void
+RigidBodyPainter::paint_body (BodyView const& view)
+{
+	_gl.save_matrix ([&] {
+		transform_to_body (*view.location);
+
+		if (view.shape)
+			_gl.draw (*view.shape);
+		else
+			_gl.draw (rigid_body::make_cube_shape (cube_edge_for (view.mass)));
 	});
 }
 
 
+void
+RigidBodyPainter::transform_to_body (Location const& location)
+{
+	auto const translation = location.position() - followed_body_position();
+
+	_gl.translate (translation);
+	_gl.rotate (location.base_to_body_rotation());
+}
+
+
+si::Length
+RigidBodyPainter::cube_edge_for (si::Mass const mass) const
+{
+	return _mass_scale * 1_kg * std::pow (mass / 1_kg, 1.0 / 3);
+}
+
+
 void
 RigidBodyPainter::paint_constraint (rigid_body::Constraint const& constraint)
 {
@@ -562,13 +679,20 @@ RigidBodyPainter::paint_ecef_basis (QOpenGLPaintDevice& canvas)
 }
 
 
-SpaceLength<rigid_body::WorldSpace>
-RigidBodyPainter::followed_body_position() const
+void
+RigidBodyPainter::update_followed_body_position()
 {
+	_followed_body_position = { 0_m, 0_m, 0_m };
+
 	if (_followed_body)
-		return _followed_body->location().position();
-	else
-		return { 0_m, 0_m, 0_m };
+	{
+		auto const found = std::find_if (_body_views.begin(), _body_views.end(), [&] (BodyView const& view) {
+			return view.body == _followed_body;
+		});
+
+		if (found != _body_views.end())
+			_followed_body_position = found->location->position();
+	}
 }
 
 } // namespace xf
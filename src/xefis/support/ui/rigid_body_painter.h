@@ -16,6 +16,7 @@
 
 // Standard:
 #include <cstddef>
+#include <vector>
 
 // Qt:
 #include <QOpenGLFunctions>
@@ -27,6 +28,8 @@
 #include <xefis/config/all.h>
 #include <xefis/support/math/euler_angles.h>
 #include <xefis/support/simulation/rigid_body/system.h>
+#include <xefis/support/simulation/rigid_body/system_snapshot.h>
+#include <xefis/support/ui/gl_shape_cache.h>
 #include <xefis/support/ui/gl_space.h>
 
 
@@ -47,6 +50,31 @@ class RigidBodyPainter: protected QOpenGLFunctions
 	static constexpr auto		kSunDistance				= 10_km;
 	static constexpr auto		kSunRadius					= 200_km;
 
+	using Location = PositionRotation<rigid_body::WorldSpace, rigid_body::BodySpace>;
+
+	/**
+	 * Body data used for painting, taken either from the System or from a SystemSnapshot.
+	 */
+	struct BodyView
+	{
+		rigid_body::Body const*		body;
+		Location const*				location;
+		si::Mass					mass;
+		// Nullptr if body has no shape:
+		rigid_body::Shape const*	shape;
+	};
+
+	/**
+	 * Body to be drawn from a vertex buffer.
+	 */
+	struct BodyInstance
+	{
+		GLShapeBuffer const*	buffer;
+		BodyView const*			view;
+		// Additional scale applied to the shape:
+		float					scale;
+	};
+
   public:
 	// Ctor
 	explicit
@@ -79,6 +107,14 @@ class RigidBodyPainter: protected QOpenGLFunctions
 	void
 	paint (rigid_body::System const& system, QOpenGLPaintDevice& canvas);
 
+	/**
+	 * Paint bodies from a snapshot of the system. Doesn't access the System, so it can be evolved
+	 * at the same time in another thread.
+	 * Constraints and forces are not painted, since snapshots don't contain them.
+	 */
+	void
+	paint (rigid_body::SystemSnapshot const& snapshot, QOpenGLPaintDevice& canvas);
+
 	/**
 	 * Set camera focus point.
 	 */
@@ -122,7 +158,21 @@ class RigidBodyPainter: protected QOpenGLFunctions
 	set_forces_visible (bool visible) noexcept
 		{ _forces_visible = visible; }
 
+	/**
+	 * Release OpenGL resources (cached vertex buffers).
+	 * OpenGL context used for painting must be current.
+	 */
+	void
+	release_gl_resources()
+		{ _shape_cache.clear(); }
+
   private:
+	/**
+	 * Paint bodies prepared in _body_views.
+	 */
+	void
+	paint_scene (QOpenGLPaintDevice&);
+
 	void
 	setup (QOpenGLPaintDevice&);
 
@@ -133,7 +183,7 @@ class RigidBodyPainter: protected QOpenGLFunctions
 	setup_light();
 
 	void
-	paint_world (rigid_body::System const&, QOpenGLPaintDevice&);
+	paint_world (QOpenGLPaintDevice&);
 
 	void
 	paint_ecef_basis (QOpenGLPaintDevice&);
@@ -142,10 +192,33 @@ class RigidBodyPainter: protected QOpenGLFunctions
 	paint_planet();
 
 	void
-	paint_system (rigid_body::System const&, QOpenGLPaintDevice&);
+	paint_system (QOpenGLPaintDevice&);
 
+	/**
+	 * Paint all bodies. Bodies with constant shapes are drawn from cached vertex buffers,
+	 * grouped by buffer, so that many bodies sharing a shape need only one buffer bind.
+	 */
+	void
+	paint_bodies();
+
+	/**
+	 * Paint body in immediate mode.
+	 */
+	void
+	paint_body (BodyView const&);
+
+	/**
+	 * Multiply current OpenGL matrix by body's position and orientation.
+	 */
 	void
-	paint_body (rigid_body::Body const&);
+	transform_to_body (Location const&);
+
+	/**
+	 * Return cube edge length used to represent a body without a shape.
+	 */
+	[[nodiscard]]
+	si::Length
+	cube_edge_for (si::Mass) const;
 
 	void
 	paint_constraint (rigid_body::Constraint const& constraint);
@@ -156,9 +229,16 @@ class RigidBodyPainter: protected QOpenGLFunctions
 	void
 	draw_arrow (SpaceLength<rigid_body::WorldSpace> const& origin, SpaceLength<rigid_body::WorldSpace> const& vector, rigid_body::ShapeMaterial const& material = {});
 
+	/**
+	 * Update followed body position for the current frame.
+	 */
+	void
+	update_followed_body_position();
+
 	[[nodiscard]]
-	SpaceLength<rigid_body::WorldSpace>
-	followed_body_position() const;
+	SpaceLength<rigid_body::WorldSpace> const&
+	followed_body_position() const noexcept
+		{ return _followed_body_position; }
 
   private:
 	si::PixelDensity					_pixel_density;
@@ -167,6 +247,14 @@ class RigidBodyPainter: protected QOpenGLFunctions
 	EulerAngles							_camera_angles;
 	LonLatRadius						_position_on_earth		{ 0_deg, 0_deg, 0_m };
 	GLSpace								_gl;
+	GLShapeCache						_shape_cache;
+	// Shape used for bodies without a shape, scaled as needed:
+	rigid_body::Shape					_unit_cube;
+	std::vector<BodyView>				_body_views;
+	std::vector<BodyInstance>			_body_instances;
+	// Set only when painting a System (not a SystemSnapshot):
+	rigid_body::System const*			_system					{ nullptr };
+	SpaceLength<rigid_body::WorldSpace>	_followed_body_position;
 	rigid_body::Body*					_followed_body			{ nullptr };
 	rigid_body::Body*					_planet_body			{ nullptr };
 	bool								_constraints_visible	{ false };
@@ -19,6 +19,9 @@
 #include <QMenu>
 #include <QScreen>
 
+// Neutrino:
+#include <neutrino/time_helper.h>
+
 // Xefis:
 #include <xefis/config/all.h>
 
@@ -33,7 +36,7 @@ RigidBodyViewer::RigidBodyViewer (rigid_body::System& system,
 								  RefreshRate const refresh_rate,
 								  Evolve const evolve):
 	GLAnimationWindow (window_size, refresh_rate, std::bind (&RigidBodyViewer::draw, this, std::placeholders::_1)),
-	_rigid_body_system (system),
+	_rigid_body_system (&system),
 	_rigid_body_painter (si::PixelDensity (screen()->physicalDotsPerInch())),
 	_evolve (evolve)
 {
@@ -41,6 +44,28 @@ RigidBodyViewer::RigidBodyViewer (rigid_body::System& system,
 }
 
 
+RigidBodyViewer::RigidBodyViewer (rigid_body::SystemSnapshotBuffer const& snapshot_buffer,
+								  QSize const window_size,
+								  RefreshRate const refresh_rate,
+								  SimulationThread* simulation_thread):
+	GLAnimationWindow (window_size, refresh_rate, std::bind (&RigidBodyViewer::draw, this, std::placeholders::_1)),
+	_snapshot_buffer (&snapshot_buffer),
+	_simulation_thread (simulation_thread),
+	_rigid_body_painter (si::PixelDensity (screen()->physicalDotsPerInch()))
+{
+	setTitle ("Xefis rigid body viewer");
+}
+
+
+RigidBodyViewer::~RigidBodyViewer()
+{
+	// Vertex buffers must be deleted while their OpenGL context is current:
+	with_context ([this] {
+		_rigid_body_painter.release_gl_resources();
+	});
+}
+
+
 void
 RigidBodyViewer::mousePressEvent (QMouseEvent* event)
 {
@@ -154,6 +179,8 @@ RigidBodyViewer::keyPressEvent (QKeyEvent* event)
 				_playback = Playback::Paused;
 				break;
 		}
+
+		playback_changed();
 	}
 	else if (event->key() == Qt::Key_Period)
 	{
@@ -168,6 +195,8 @@ RigidBodyViewer::keyPressEvent (QKeyEvent* event)
 				_playback = Playback::Paused;
 				break;
 		}
+
+		playback_changed();
 	}
 }
 
@@ -193,7 +222,52 @@ RigidBodyViewer::draw (QOpenGLPaintDevice& canvas)
 
 	_rigid_body_painter.set_camera_position (position());
 	_rigid_body_painter.set_camera_angles (x_angle(), -y_angle(), 0_deg);
-	_rigid_body_painter.paint (_rigid_body_system, canvas);
+
+	if (_snapshot_buffer)
+		paint_snapshot (canvas);
+	else
+		_rigid_body_painter.paint (*_rigid_body_system, canvas);
+}
+
+
+void
+RigidBodyViewer::paint_snapshot (QOpenGLPaintDevice& canvas)
+{
+	auto const now = TimeHelper::now();
+
+	if (_snapshot_buffer->read (_previous_snapshot, _latest_snapshot, _snapshot_serial))
+		_latest_snapshot_timestamp = now;
+
+	// Display the system one snapshot behind the latest one, so that there's always a snapshot to interpolate towards:
+	auto const display_time = _previous_snapshot.simulation_time() + (now - _latest_snapshot_timestamp);
+
+	rigid_body::SystemSnapshot::interpolate (_previous_snapshot, _latest_snapshot, display_time, _display_snapshot);
+	_rigid_body_painter.paint (_display_snapshot, canvas);
+}
+
+
+void
+RigidBodyViewer::playback_changed()
+{
+	if (!_simulation_thread)
+		return;
+
+	switch (_playback)
+	{
+		case Playback::Paused:
+			_simulation_thread->set_paused (true);
+			break;
+
+		case Playback::Stepping:
+			_simulation_thread->set_paused (true);
+			_simulation_thread->step();
+			_playback = Playback::Paused;
+			break;
+
+		case Playback::Running:
+			_simulation_thread->set_paused (false);
+			break;
+	}
 }
 
 
@@ -208,6 +282,8 @@ RigidBodyViewer::display_menu()
 	});
 	show_constraints_action->setCheckable (true);
 	show_constraints_action->setChecked (_rigid_body_painter.constraints_visible());
+	// Snapshots don't contain constraints nor forces:
+	show_constraints_action->setEnabled (!_snapshot_buffer);
 
 	// "Show forces"
 	auto* show_forces_action = menu.addAction ("Show &forces", [&] {
@@ -215,6 +291,7 @@ RigidBodyViewer::display_menu()
 	});
 	show_forces_action->setCheckable (true);
 	show_forces_action->setChecked (_rigid_body_painter.forces_visible());
+	show_forces_action->setEnabled (!_snapshot_buffer);
 
 	return !!menu.exec (QCursor::pos());
 }
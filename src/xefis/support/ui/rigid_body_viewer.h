@@ -16,6 +16,7 @@
 
 // Standard:
 #include <cstddef>
+#include <cstdint>
 
 // Qt:
 #include <QKeyEvent>
@@ -29,6 +30,8 @@
 // Xefis:
 #include <xefis/config/all.h>
 #include <xefis/support/simulation/rigid_body/system.h>
+#include <xefis/support/simulation/rigid_body/system_snapshot.h>
+#include <xefis/support/simulation/simulation_thread.h>
 #include <xefis/support/ui/gl_animation_window.h>
 #include <xefis/support/ui/rigid_body_painter.h>
 
@@ -38,6 +41,10 @@ namespace xf {
 /**
  * Window showing rigid_body::System state as animation (but the system must be evolved elsewhere).
  * Allows rotation/translation with mouse.
+ *
+ * The system can either be evolved by the Evolve function called before each display frame,
+ * or in another thread (see SimulationThread), in which case the viewer paints snapshots
+ * published by that thread.
  */
 class RigidBodyViewer: public GLAnimationWindow
 {
@@ -76,6 +83,20 @@ class RigidBodyViewer: public GLAnimationWindow
 	 */
 	RigidBodyViewer (rigid_body::System&, QSize window_size, RefreshRate, Evolve evolve);
 
+	/**
+	 * Display system evolved in another thread.
+	 * Bodies are painted from snapshots interpolated between two latest ones, so that the display
+	 * is smooth regardless of the simulation and display rates.
+	 *
+	 * \param	simulation_thread
+	 *			Thread that is paused/resumed/stepped with the playback keys.
+	 *			May be nullptr.
+	 */
+	RigidBodyViewer (rigid_body::SystemSnapshotBuffer const&, QSize window_size, RefreshRate, SimulationThread* simulation_thread);
+
+	// Dtor
+	~RigidBodyViewer();
+
 	/**
 	 * Calls set_followed() on internal RigidBodyPainter.
 	 */
@@ -143,6 +164,18 @@ class RigidBodyViewer: public GLAnimationWindow
 	void
 	draw (QOpenGLPaintDevice&);
 
+	/**
+	 * Paint latest snapshots from the snapshot buffer.
+	 */
+	void
+	paint_snapshot (QOpenGLPaintDevice&);
+
+	/**
+	 * Pass playback state to the simulation thread, if there's one.
+	 */
+	void
+	playback_changed();
+
 	/**
 	 * Return 1.0 normally or kHighPrecision value when Shift is pressed on the keyboard.
 	 */
@@ -157,7 +190,15 @@ class RigidBodyViewer: public GLAnimationWindow
 	display_menu();
 
   private:
-	rigid_body::System&					_rigid_body_system;
+	rigid_body::System*					_rigid_body_system				{ nullptr };
+	rigid_body::SystemSnapshotBuffer const*
+										_snapshot_buffer				{ nullptr };
+	SimulationThread*					_simulation_thread				{ nullptr };
+	rigid_body::SystemSnapshot			_previous_snapshot;
+	rigid_body::SystemSnapshot			_latest_snapshot;
+	rigid_body::SystemSnapshot			_display_snapshot;
+	std::uint64_t						_snapshot_serial				{ 0 };
+	si::Time							_latest_snapshot_timestamp		{ 0_s };
 	RigidBodyPainter					_rigid_body_painter;
 	Evolve								_evolve;
 	QPoint								_last_pos;
@@ -13,6 +13,16 @@
 
 // Standard:
 #include <cstddef>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// System:
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
 
 // Xefis:
 #include <xefis/config/all.h>
@@ -22,63 +32,222 @@
 
 
 namespace xf {
+namespace {
+
+/**
+ * Write little-endian integer to a file.
+ */
+template<class Integer>
+	void
+	write_le (FILE* file, Integer value)
+	{
+		for (std::size_t i = 0; i < sizeof (Integer); ++i)
+			std::fputc ((value >> (8 * i)) & 0xff, file);
+	}
+
+} // namespace
+
+
+void
+SoundManager::NullSink::write (int16_t const*, std::size_t const count)
+{
+	pace (count);
+}
+
+
+void
+SoundManager::NullSink::pace (std::size_t const count)
+{
+	using Clock = std::chrono::steady_clock;
+
+	auto const now = Clock::now();
+
+	// Don't try to catch up after being stalled:
+	if (!_next_write || *_next_write < now)
+		_next_write = now;
+
+	*_next_write += std::chrono::duration_cast<Clock::duration> (std::chrono::duration<double> (static_cast<double> (count) / AudioMixer::kSampleRate));
+	std::this_thread::sleep_until (*_next_write);
+}
+
+
+SoundManager::AplaySink::AplaySink (Logger const& logger):
+	_logger (logger)
+{
+	auto const command = "aplay -q -t raw -f S16_LE -c 1 -r " + std::to_string (AudioMixer::kSampleRate) + " --buffer-time=50000";
+	_pipe = ::popen (command.c_str(), "w");
+
+	if (_pipe)
+	{
+		std::setvbuf (_pipe, nullptr, _IONBF, 0);
+		// Small pipe means small latency; the pipe blocks the audio thread when aplay has enough data:
+		::fcntl (::fileno (_pipe), F_SETPIPE_SZ, 4096);
+	}
+	else
+		_logger << "Could not start aplay: " << strerror (errno) << std::endl;
+}
+
+
+SoundManager::AplaySink::~AplaySink()
+{
+	if (_pipe)
+		::pclose (_pipe);
+}
+
 
-SoundManager::Sound::Sound (QString const& wav_file_name)
+void
+SoundManager::AplaySink::write (int16_t const* const samples, std::size_t const count)
+{
+	if (_pipe)
+	{
+		if (std::fwrite (samples, sizeof (*samples), count, _pipe) == count)
+			return;
+
+		_logger << "aplay stopped accepting data: " << strerror (errno) << std::endl;
+		::pclose (_pipe);
+		_pipe = nullptr;
+	}
+
+	pace (count);
+}
+
+
+SoundManager::WaveFileSink::WaveFileSink (std::string const& path):
+	_file (std::fopen (path.c_str(), "wb"))
 {
-	auto exit = [&](int, QProcess::ExitStatus) {
-		_finished = true;
-	};
-
-	_play_process = std::make_unique<QProcess>();
-	QObject::connect (_play_process.get(),
-					  static_cast<void (QProcess::*)(int, QProcess::ExitStatus)> (&QProcess::finished),
-					  exit);
-	_play_process->start ("aplay", { wav_file_name });
+	if (!_file)
+		throw Exception ("could not open " + path + ": " + strerror (errno));
+
+	// Sizes are updated in the dtor:
+	std::fputs ("RIFF", _file);
+	write_le<uint32_t> (_file, 0);
+	std::fputs ("WAVEfmt ", _file);
+	write_le<uint32_t> (_file, 16);
+	write_le<uint16_t> (_file, 1);
+	write_le<uint16_t> (_file, 1);
+	write_le<uint32_t> (_file, AudioMixer::kSampleRate);
+	write_le<uint32_t> (_file, AudioMixer::kSampleRate * sizeof (int16_t));
+	write_le<uint16_t> (_file, sizeof (int16_t));
+	write_le<uint16_t> (_file, 16);
+	std::fputs ("data", _file);
+	write_le<uint32_t> (_file, 0);
 }
 
 
-SoundManager::Sound::~Sound()
+SoundManager::WaveFileSink::~WaveFileSink()
 {
-	stop();
+	std::fseek (_file, 4, SEEK_SET);
+	write_le<uint32_t> (_file, 36 + _data_bytes);
+	std::fseek (_file, 40, SEEK_SET);
+	write_le<uint32_t> (_file, _data_bytes);
+	std::fclose (_file);
 }
 
 
 void
-SoundManager::Sound::stop()
+SoundManager::WaveFileSink::write (int16_t const* const samples, std::size_t const count)
 {
-	_play_process->terminate();
+	for (std::size_t i = 0; i < count; ++i)
+		write_le<uint16_t> (_file, static_cast<uint16_t> (samples[i]));
+
+	_data_bytes += count * sizeof (int16_t);
+	pace (count);
 }
 
 
 SoundManager::SoundManager (Logger const& logger):
-	_logger (logger.with_scope ("<sound manager>"))
+	SoundManager (logger, std::make_unique<AplaySink> (logger.with_scope ("<sound manager>")))
+{ }
+
+
+SoundManager::SoundManager (Logger const& logger, std::unique_ptr<Sink> sink):
+	_logger (logger.with_scope ("<sound manager>")),
+	_sink (std::move (sink))
 {
 	_logger << "Creating SoundManager" << std::endl;
+	_thread = std::thread (&SoundManager::run, this);
 }
 
 
 SoundManager::~SoundManager()
 {
+	_stop.store (true);
+	_thread.join();
 	_logger << "Destroying SoundManager" << std::endl;
 }
 
 
 std::shared_ptr<SoundManager::Sound>
-SoundManager::play (QString const& wav_file_name)
+SoundManager::play (QString const& wav_file_name, Priority const priority, Preemption const preemption)
+{
+	auto sound = std::make_shared<Sound> (samples_for (wav_file_name), priority, preemption);
+
+	if (!_new_sounds.push (sound))
+	{
+		_logger << "Too many sounds queued, dropping " << wav_file_name.toStdString() << std::endl;
+		AudioMixer::reject (*sound);
+	}
+
+	return sound;
+}
+
+
+void
+SoundManager::preload (QString const& wav_file_name)
 {
-	cleanup();
-	return *_sounds.insert (std::make_shared<Sound> (wav_file_name)).first;
+	samples_for (wav_file_name);
+}
+
+
+std::shared_ptr<AudioMixer::Samples const>
+SoundManager::samples_for (QString const& wav_file_name)
+{
+	if (auto const found = _samples_cache.find (wav_file_name); found != _samples_cache.end())
+		return found->second;
+
+	std::shared_ptr<AudioMixer::Samples const> samples;
+
+	try {
+		std::ifstream file (wav_file_name.toStdString(), std::ios::binary);
+
+		if (!file)
+			throw Exception ("could not open file");
+
+		Blob const wave { std::istreambuf_iterator<char> (file), std::istreambuf_iterator<char>() };
+		samples = std::make_shared<AudioMixer::Samples const> (AudioMixer::decode_wave (wave));
+	}
+	catch (Exception const& e)
+	{
+		_logger << "Could not load " << wav_file_name.toStdString() << ": " << e.message() << std::endl;
+	}
+
+	// Also cache failures, so that broken files aren't reread on every play():
+	_samples_cache[wav_file_name] = samples;
+	return samples;
 }
 
 
 void
-SoundManager::cleanup()
+SoundManager::run()
 {
-	for (auto s = _sounds.begin(); s != _sounds.end(); )
-		if ((*s)->finished())
-			_sounds.erase (s++);
-		else
-			++s;
+	// Get EPIPE instead of SIGPIPE if aplay dies:
+	sigset_t sigpipe;
+	sigemptyset (&sigpipe);
+	sigaddset (&sigpipe, SIGPIPE);
+	pthread_sigmask (SIG_BLOCK, &sigpipe, nullptr);
+
+	std::array<float, kPeriodFrames> mixed;
+	std::array<int16_t, kPeriodFrames> output;
+
+	while (!_stop.load())
+	{
+		while (auto sound = _new_sounds.pop())
+			_mixer.add (std::move (*sound));
+
+		_mixer.mix (mixed.data(), mixed.size());
+		AudioMixer::to_s16 (mixed.data(), output.data(), output.size());
+		_sink->write (output.data(), output.size());
+	}
 }
 
 } // namespace xf
@@ -16,83 +16,173 @@
 
 // Standard:
 #include <cstddef>
-#include <set>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
 
 // Qt:
-#include <QtCore/QProcess>
+#include <QtCore/QString>
 
 // Neutrino:
 #include <neutrino/logger.h>
+#include <neutrino/noncopyable.h>
 
 // Xefis:
 #include <xefis/config/all.h>
+#include <xefis/support/ui/audio_mixer.h>
+#include <xefis/utility/spsc_queue.h>
 
 
 namespace xf {
 
-class SoundManager
+/**
+ * Plays alert sounds. WAV files are decoded once and kept in memory; overlapping sounds are mixed
+ * in a dedicated audio thread by AudioMixer and written to a Sink.
+ *
+ * play() and preload() must be called from one thread at a time.
+ */
+class SoundManager: private Noncopyable
 {
   public:
+	using Sound			= AudioMixer::Voice;
+	using Priority		= AudioMixer::Priority;
+	using Preemption	= AudioMixer::Preemption;
+
+	// Audio is mixed and written in periods of this many frames, which bounds the mixing latency:
+	static constexpr std::size_t	kPeriodFrames	= AudioMixer::kSampleRate / 100;
+
+	/**
+	 * Destination of mixed signed 16-bit mono samples at AudioMixer::kSampleRate.
+	 * write() paces the audio thread: it should return about when given samples have been played.
+	 */
+	class Sink
+	{
+	  public:
+		// Dtor
+		virtual
+		~Sink() = default;
+
+		virtual void
+		write (int16_t const* samples, std::size_t count) = 0;
+	};
+
 	/**
-	 * Represents sound process.
+	 * Sink that discards samples, paced by the real-time clock.
 	 */
-	class Sound
+	class NullSink: public Sink
+	{
+	  public:
+		void
+		write (int16_t const* samples, std::size_t count) override;
+
+	  protected:
+		/**
+		 * Wait until given number of samples would have been played.
+		 */
+		void
+		pace (std::size_t count);
+
+	  private:
+		std::optional<std::chrono::steady_clock::time_point>	_next_write;
+	};
+
+	/**
+	 * Sink that plays samples with a single, long-running aplay process.
+	 * Pacing is done by the pipe to aplay, which is kept small to bound latency.
+	 * If aplay can't be started or dies, samples are discarded.
+	 */
+	class AplaySink: public NullSink
 	{
 	  public:
 		// Ctor
 		explicit
-		Sound (QString const& wav_file_name);
+		AplaySink (Logger const&);
 
 		// Dtor
-		~Sound();
+		~AplaySink();
 
-		/**
-		 * Return true if sound has finished playing.
-		 */
-		bool
-		finished() const noexcept;
+		void
+		write (int16_t const* samples, std::size_t count) override;
+
+	  private:
+		Logger	_logger;
+		FILE*	_pipe	{ nullptr };
+	};
+
+	/**
+	 * Sink that writes samples to a WAV file, paced by the real-time clock. For testing.
+	 */
+	class WaveFileSink: public NullSink
+	{
+	  public:
+		// Ctor
+		explicit
+		WaveFileSink (std::string const& path);
+
+		// Dtor
+		~WaveFileSink();
 
-		/**
-		 * Stop the sound.
-		 */
 		void
-		stop();
+		write (int16_t const* samples, std::size_t count) override;
 
 	  private:
-		std::unique_ptr<QProcess>	_play_process;
-		bool						_finished = false;
+		FILE*		_file			{ nullptr };
+		uint32_t	_data_bytes		{ 0 };
 	};
 
   public:
 	// Ctor
+	explicit
 	SoundManager (Logger const&);
 
+	// Ctor
+	explicit
+	SoundManager (Logger const&, std::unique_ptr<Sink>);
+
 	// Dtor
 	~SoundManager();
 
 	/**
-	 * Play sound.
+	 * Play sound. Returned object can be used to stop the sound or check if it finished.
 	 */
 	std::shared_ptr<Sound>
-	play (QString const& wav_file_name);
+	play (QString const& wav_file_name, Priority = 0, Preemption = Preemption::None);
 
 	/**
-	 * Clean old finished sounds.
+	 * Load and decode WAV file, so that the first play() doesn't need to.
 	 */
 	void
-	cleanup();
+	preload (QString const& wav_file_name);
 
   private:
-	Logger								_logger;
-	std::set<std::shared_ptr<Sound>>	_sounds;
-};
+	/**
+	 * Return decoded samples from the cache, loading them if necessary.
+	 * Return nullptr if file can't be loaded.
+	 */
+	std::shared_ptr<AudioMixer::Samples const>
+	samples_for (QString const& wav_file_name);
 
+	/**
+	 * Audio thread loop.
+	 */
+	void
+	run();
 
-inline bool
-SoundManager::Sound::finished() const noexcept
-{
-	return _finished;
-}
+  private:
+	Logger															_logger;
+	std::unique_ptr<Sink>											_sink;
+	AudioMixer														_mixer;
+	SPSCQueue<std::shared_ptr<Sound>>								_new_sounds		{ 64 };
+	std::map<QString, std::shared_ptr<AudioMixer::Samples const>>	_samples_cache;
+	std::atomic<bool>												_stop			{ false };
+	std::thread														_thread;
+};
 
 } // namespace xf
 
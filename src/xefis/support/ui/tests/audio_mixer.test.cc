@@ -0,0 +1,239 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// System:
+#include <stdlib.h>
+
+// Neutrino:
+#include <neutrino/logger.h>
+#include <neutrino/test/auto_test.h>
+
+// Xefis:
+#include <xefis/support/ui/audio_mixer.h>
+#include <xefis/support/ui/sound_manager.h>
+
+
+namespace xf::test {
+namespace {
+
+xf::LoggerOutput g_logger_output (std::clog);
+xf::Logger g_logger (g_logger_output);
+
+
+/**
+ * Temporary directory removed in dtor.
+ */
+struct TemporaryDirectory
+{
+	TemporaryDirectory()
+	{
+		std::string name_template = std::filesystem::temp_directory_path() / "xefis-audio-XXXXXX";
+
+		if (!::mkdtemp (name_template.data()))
+			throw Exception ("could not create temporary directory");
+
+		path = name_template;
+	}
+
+	~TemporaryDirectory()
+	{
+		std::filesystem::remove_all (path);
+	}
+
+	std::filesystem::path path;
+};
+
+
+auto
+make_voice (std::size_t length, float value, AudioMixer::Priority priority = 0, AudioMixer::Preemption preemption = AudioMixer::Preemption::None)
+{
+	return std::make_shared<AudioMixer::Voice> (std::make_shared<AudioMixer::Samples const> (length, value), priority, preemption);
+}
+
+
+Blob
+make_wave (uint32_t sample_rate, std::vector<int16_t> const& samples)
+{
+	Blob wave;
+
+	auto const append = [&wave] (uint32_t value, std::size_t bytes) {
+		for (std::size_t i = 0; i < bytes; ++i)
+			wave.push_back ((value >> (8 * i)) & 0xff);
+	};
+
+	auto const append_tag = [&wave] (char const* tag) {
+		wave.insert (wave.end(), tag, tag + 4);
+	};
+
+	append_tag ("RIFF");
+	append (36 + 2 * samples.size(), 4);
+	append_tag ("WAVE");
+	append_tag ("fmt ");
+	append (16, 4);
+	append (1, 2);
+	append (1, 2);
+	append (sample_rate, 4);
+	append (2 * sample_rate, 4);
+	append (2, 2);
+	append (16, 2);
+	append_tag ("data");
+	append (2 * samples.size(), 4);
+
+	for (auto const s: samples)
+		append (static_cast<uint16_t> (s), 2);
+
+	return wave;
+}
+
+
+AutoTest t1 ("AudioMixer: mixing overlapping voices", []{
+	AudioMixer mixer;
+	std::array<float, 4> output;
+
+	auto const a = make_voice (6, 0.25f);
+	auto const b = make_voice (2, 0.5f);
+	mixer.add (a);
+	mixer.add (b);
+
+	mixer.mix (output.data(), output.size());
+	test_asserts::verify ("voices are summed", output[0] == 0.75f && output[1] == 0.75f);
+	test_asserts::verify ("finished voice is not mixed", output[2] == 0.25f && output[3] == 0.25f);
+	test_asserts::verify ("short voice finished", b->finished() && !a->finished());
+
+	a->stop();
+	mixer.mix (output.data(), output.size());
+	test_asserts::verify ("stopped voice is silent", output[0] == 0.0f);
+	test_asserts::verify ("stopped voice is finished", a->finished() && mixer.playing() == 0);
+});
+
+
+AutoTest t2 ("AudioMixer: priorities and preemption", []{
+	AudioMixer mixer (2);
+
+	auto const low = make_voice (100, 0.1f, 0);
+	auto const high = make_voice (100, 0.1f, 5);
+	auto const lower = make_voice (100, 0.1f, -1);
+	auto const medium = make_voice (100, 0.1f, 1);
+
+	mixer.add (low);
+	mixer.add (high);
+	mixer.add (lower);
+	test_asserts::verify ("voice with lower priority than all playing voices is rejected", lower->finished() && mixer.playing() == 2);
+
+	mixer.add (medium);
+	test_asserts::verify ("lowest-priority voice is preempted", low->finished() && !medium->finished() && !high->finished());
+
+	auto const alert = make_voice (100, 0.1f, 10, AudioMixer::Preemption::StopLowerPriority);
+	mixer.add (alert);
+	test_asserts::verify ("alert stops lower-priority voices", high->finished() && medium->finished() && mixer.playing() == 1);
+});
+
+
+AutoTest t3 ("AudioMixer: WAV decoding and resampling", []{
+	auto const samples = AudioMixer::decode_wave (make_wave (AudioMixer::kSampleRate / 2, { 0, 16384, -16384 }));
+
+	test_asserts::verify ("sample rate is converted", samples.size() == 5);
+	test_asserts::verify ("samples are normalized", samples[0] == 0.0f && samples[2] == 0.5f && samples[4] == -0.5f);
+	test_asserts::verify ("samples are interpolated", samples[1] == 0.25f && samples[3] == 0.0f);
+
+	bool thrown = false;
+
+	try {
+		AudioMixer::decode_wave (Blob (16, 0));
+	}
+	catch (Exception const&)
+	{
+		thrown = true;
+	}
+
+	test_asserts::verify ("invalid data throws", thrown);
+});
+
+
+AutoTest t4 ("SoundManager: rendering to a WAV file", []{
+	constexpr std::size_t kVoiceSamples = AudioMixer::kSampleRate / 20;
+
+	TemporaryDirectory directory;
+	auto const input_path = directory.path / "input.wav";
+	auto const output_path = directory.path / "output.wav";
+
+	{
+		Blob const input = make_wave (AudioMixer::kSampleRate, std::vector<int16_t> (kVoiceSamples, 8192));
+		std::ofstream (input_path, std::ios::binary).write (reinterpret_cast<char const*> (input.data()), input.size());
+	}
+
+	{
+		SoundManager sound_manager (g_logger, std::make_unique<SoundManager::WaveFileSink> (output_path.string()));
+		auto const sound = sound_manager.play (QString::fromStdString (input_path.string()));
+
+		for (int i = 0; i < 5000 && !sound->finished(); ++i)
+			std::this_thread::sleep_for (std::chrono::milliseconds (1));
+
+		test_asserts::verify ("sound has finished", sound->finished());
+	}
+
+	std::ifstream file (output_path, std::ios::binary);
+	Blob const output { std::istreambuf_iterator<char> (file), std::istreambuf_iterator<char>() };
+
+	auto const read_u16 = [&output] (std::size_t const pos) -> uint32_t {
+		return output[pos] | (output[pos + 1] << 8);
+	};
+
+	auto const read_u32 = [&] (std::size_t const pos) -> uint32_t {
+		return read_u16 (pos) | (read_u16 (pos + 2) << 16);
+	};
+
+	auto const tag_is = [&output] (std::size_t const pos, std::string const& tag) {
+		return std::equal (tag.begin(), tag.end(), output.begin() + pos);
+	};
+
+	test_asserts::verify ("file contains header", output.size() >= 44);
+	test_asserts::verify ("header has correct tags", tag_is (0, "RIFF") && tag_is (8, "WAVEfmt ") && tag_is (36, "data"));
+	test_asserts::verify ("header has correct format", read_u16 (20) == 1 && read_u16 (22) == 1 && read_u32 (24) == AudioMixer::kSampleRate && read_u16 (34) == 16);
+
+	auto const data_bytes = read_u32 (40);
+	test_asserts::verify ("data size is correct", data_bytes == output.size() - 44 && read_u32 (4) == 36 + data_bytes);
+	test_asserts::verify ("whole periods are written", data_bytes % (2 * SoundManager::kPeriodFrames) == 0);
+
+	std::size_t voice_samples = 0;
+	bool correct_values = true;
+
+	for (std::size_t pos = 44; pos + 1 < output.size(); pos += 2)
+	{
+		if (auto const sample = static_cast<int16_t> (read_u16 (pos)); sample != 0)
+		{
+			++voice_samples;
+			correct_values = correct_values && sample == 8192;
+		}
+	}
+
+	test_asserts::verify ("all samples of the voice are rendered", voice_samples == kVoiceSamples);
+	test_asserts::verify ("samples are rendered unchanged", correct_values);
+});
+
+} // namespace
+} // namespace xf::test
+
@@ -0,0 +1,140 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__UTILITY__SPSC_QUEUE_H__INCLUDED
+#define XEFIS__UTILITY__SPSC_QUEUE_H__INCLUDED
+
+// Standard:
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Neutrino:
+#include <neutrino/noncopyable.h>
+
+// Xefis:
+#include <xefis/config/all.h>
+
+
+namespace xf {
+
+/**
+ * Bounded lock-free queue for passing values from one producer thread to one consumer thread.
+ * Neither push() nor pop() ever block; push() fails when the queue is full.
+ */
+template<class pValue>
+	class SPSCQueue: private Noncopyable
+	{
+	  public:
+		using Value = pValue;
+
+		// Keeps producer's and consumer's positions in separate cache lines:
+		static constexpr std::size_t kCacheLineSize = 64;
+
+	  public:
+		/**
+		 * Ctor
+		 *
+		 * \param	capacity
+		 *			Minimum number of values that can be queued. Rounded up to a power of two.
+		 */
+		explicit
+		SPSCQueue (std::size_t capacity);
+
+		/**
+		 * Return max number of values that can be queued.
+		 */
+		[[nodiscard]]
+		std::size_t
+		capacity() const noexcept
+			{ return _slots.size(); }
+
+		/**
+		 * Add value to the queue. Return false if queue is full.
+		 * Call only from the producer thread.
+		 */
+		[[nodiscard]]
+		bool
+		push (Value);
+
+		/**
+		 * Take value from the queue, or return std::nullopt if queue is empty.
+		 * Call only from the consumer thread.
+		 */
+		[[nodiscard]]
+		std::optional<Value>
+		pop();
+
+		/**
+		 * Return true if queue is empty. Exact only when called from the consumer thread.
+		 */
+		[[nodiscard]]
+		bool
+		empty() const noexcept
+			{ return _head.load (std::memory_order_acquire) == _tail.load (std::memory_order_acquire); }
+
+	  private:
+		std::vector<Value>							_slots;
+		std::size_t									_mask;
+		// Position of the next value to pop; written only by the consumer:
+		alignas (kCacheLineSize) std::atomic<std::size_t>	_head	{ 0 };
+		// Position of the next value to push; written only by the producer:
+		alignas (kCacheLineSize) std::atomic<std::size_t>	_tail	{ 0 };
+	};
+
+
+template<class V>
+	inline
+	SPSCQueue<V>::SPSCQueue (std::size_t const capacity):
+		_slots (std::bit_ceil (std::max<std::size_t> (capacity, 1))),
+		_mask (_slots.size() - 1)
+	{ }
+
+
+template<class V>
+	inline bool
+	SPSCQueue<V>::push (Value value)
+	{
+		auto const tail = _tail.load (std::memory_order_relaxed);
+
+		if (tail - _head.load (std::memory_order_acquire) == _slots.size())
+			return false;
+
+		_slots[tail & _mask] = std::move (value);
+		_tail.store (tail + 1, std::memory_order_release);
+		return true;
+	}
+
+
+template<class V>
+	inline auto
+	SPSCQueue<V>::pop() -> std::optional<Value>
+	{
+		auto const head = _head.load (std::memory_order_relaxed);
+
+		if (head == _tail.load (std::memory_order_acquire))
+			return std::nullopt;
+
+		std::optional<Value> result (std::move (_slots[head & _mask]));
+		_head.store (head + 1, std::memory_order_release);
+		return result;
+	}
+
+} // namespace xf
+
+#endif
+
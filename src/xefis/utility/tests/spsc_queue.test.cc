@@ -0,0 +1,91 @@
+/* vim:ts=4
+ *
+ * Copyleft 2019  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Standard:
+#include <cstddef>
+#include <string>
+#include <thread>
+
+// Neutrino:
+#include <neutrino/test/auto_test.h>
+
+// Xefis:
+#include <xefis/utility/spsc_queue.h>
+
+
+namespace xf::test {
+namespace {
+
+AutoTest t1 ("SPSCQueue: push and pop in a single thread", []{
+	SPSCQueue<std::string> queue (3);
+
+	test_asserts::verify ("capacity is rounded up to power of two", queue.capacity() == 4);
+	test_asserts::verify ("new queue is empty", queue.empty() && !queue.pop());
+
+	for (int i = 0; i < 4; ++i)
+		test_asserts::verify ("push succeeds", queue.push (std::to_string (i)));
+
+	test_asserts::verify ("push fails when full", !queue.push ("x"));
+
+	for (int i = 0; i < 4; ++i)
+	{
+		auto const value = queue.pop();
+		test_asserts::verify ("values are popped in order", value && *value == std::to_string (i));
+	}
+
+	test_asserts::verify ("queue is empty again", queue.empty());
+});
+
+
+AutoTest t2 ("SPSCQueue: producer and consumer threads", []{
+	constexpr uint64_t kCount = 1'000'000;
+
+	SPSCQueue<uint64_t> queue (64);
+	uint64_t sum = 0;
+	uint64_t received = 0;
+	bool in_order = true;
+
+	std::thread consumer ([&] {
+		uint64_t expected = 0;
+
+		while (received < kCount)
+		{
+			if (auto const value = queue.pop())
+			{
+				in_order = in_order && *value == expected;
+				sum += *value;
+				++expected;
+				++received;
+			}
+			else
+				std::this_thread::yield();
+		}
+	});
+
+	for (uint64_t i = 0; i < kCount; )
+	{
+		if (queue.push (i))
+			++i;
+		else
+			std::this_thread::yield();
+	}
+
+	consumer.join();
+
+	test_asserts::verify ("all values were received in order", in_order && received == kCount);
+	test_asserts::verify ("sum of values is correct", sum == kCount * (kCount - 1) / 2);
+});
+
+} // namespace
+} // namespace xf::test
+